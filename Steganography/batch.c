@@ -0,0 +1,1013 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Batch Encoding and Decoding
+ *
+ *                              -> ./a.out -b <job_list_file> runs many encode/decode jobs in one process.
+ *                              -> Each line of job list is same as command line args : -e <.bmp> <secret> [out.bmp] or -d <.bmp> [name].
+ *                              -> Empty lines and lines starting with # are skipped.
+ *                              -> Image files are done in blocks, every block is read, encoded/decoded in memory and written back.
+ *                              -> With io_uring (built with -DHAVE_IO_URING), blocks of many files are kept in flight at same time
+ *                                 using registered buffers, so one job is encoded while other jobs' reads and writes are going on.
+ *                              -> If io_uring is not built or not allowed, a thread pool runs jobs with pread/pwrite.
+ *                              -> --io=uring|threads selects engine, --threads=<n> sets thread pool size.
+ *                              -> --direct (or --direct/--buffered at start of a job line for one job) reads source images and writes
+ *                                 stego images of encode jobs with O_DIRECT, so streamed images don't push other data out of page cache.
+ *                                 Blocks are 4096 aligned, last block is read/written rounded up and output is truncated to image size.
+ *                              -> If file system doesn't support O_DIRECT, and for decode jobs (secret data region is not block
+ *                                 aligned), pages are dropped after each block with posix_fadvise(POSIX_FADV_DONTNEED).
+ */
+
+
+
+
+#define _GNU_SOURCE		// O_DIRECT
+#define _FILE_OFFSET_BITS 64	// 64-bit file offsets, for images bigger than 2 GB
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "batch.h"
+#include "stego.h"
+#include "lsb.h"
+#include "png.h"
+#include "cipher.h"
+#include "uring.h"
+#include "trace.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/* Key is loaded once for all jobs */
+static uint8_t batch_key[CIPHER_KEY_SIZE];
+static int batch_have_key;
+
+/* Function Definitions */
+
+/* Reads and validates job list file, every line becomes one job */
+Status read_and_validate_batch_file(const char *fname, BatchJob **jobs, int *count)
+{
+	FILE *fptr = fopen(fname, "r");
+	if(fptr == NULL)
+	{
+		perror("fopen");
+		fprintf(stderr, "ERROR: Unable to open file %s\n", fname);
+		return e_failure;
+	}
+
+	BatchJob *list = NULL;
+	int n = 0, line_no = 0;
+	Status ret = e_success;
+	char line[4096];
+
+	while(fgets(line, sizeof(line), fptr) != NULL)
+	{
+		line_no++;
+
+		// leading spaces are skipped, and empty or comment lines are ignored.
+		char *p = line + strspn(line, " \t\r\n");
+		if(*p == '\0' || *p == '#')
+		{
+			continue;
+		}
+
+		BatchJob *grown = realloc(list, (n + 1) * sizeof(BatchJob));
+		if(grown == NULL)
+		{
+			printf("ERROR: Out of memory reading %s\n", fname);
+			ret = e_failure;
+			break;
+		}
+		list = grown;
+		BatchJob *job = &list[n++];
+		memset(job, 0, sizeof(*job));
+		job->line_no = line_no;
+		job->line = strdup(p);
+		job->fd_in = job->fd_out = -1;
+		job->status = e_success;
+		job->direct = options.direct;
+		if(job->line == NULL)
+		{
+			printf("ERROR: Out of memory reading %s\n", fname);
+			ret = e_failure;
+			break;
+		}
+
+		// line is split into argv like args.
+		int argc = 0;
+		job->args[argc++] = "batch";
+		int bad_option = 0;
+		for(char *tok = strtok(job->line, " \t\r\n"); tok != NULL; tok = strtok(NULL, " \t\r\n"))
+		{
+			// page cache options of this job only.
+			if(strcmp(tok, "--direct") == 0 || strcmp(tok, "--buffered") == 0)
+			{
+				job->direct = (tok[2] == 'd');
+				continue;
+			}
+			if(strncmp(tok, "--", 2) == 0)
+			{
+				bad_option = 1;
+				continue;
+			}
+			if(argc == BATCH_MAX_ARGS)
+			{
+				argc++;
+				break;
+			}
+			job->args[argc++] = tok;
+		}
+		job->args[(argc <= BATCH_MAX_ARGS) ? argc : BATCH_MAX_ARGS] = NULL;
+
+		// same arg count checks as main().
+		if(bad_option)
+		{
+			printf("ERROR: %s line %d : INVALID JOB (only --direct or --buffered options are allowed in job line)\n", fname, line_no);
+			ret = e_failure;
+		}
+		// jobs read and write carrier bytes of bmp files by offset, so .png images (and stdin image) can't be jobs.
+		else if(argc >= 3 && (png_is_png(job->args[2]) || strcmp(job->args[2], "-") == 0 || (argc >= 5 && png_is_png(job->args[4]))))
+		{
+			printf("ERROR: %s line %d : INVALID JOB (.png or stdin image can't be used in batch)\n", fname, line_no);
+			ret = e_failure;
+		}
+		else if(argc >= 4 && argc <= 5 && strcmp(job->args[1], "-e") == 0 && read_and_validate_encode_args(job->args, &job->encInfo) == e_success)
+		{
+			job->type = e_encode;
+		}
+		else if(argc >= 3 && argc <= 4 && strcmp(job->args[1], "-d") == 0 && read_and_validate_decode_args(job->args, &job->decInfo) == e_success)
+		{
+			job->type = e_decode;
+		}
+		else
+		{
+			printf("ERROR: %s line %d : INVALID JOB\n", fname, line_no);
+			ret = e_failure;
+		}
+	}
+	fclose(fptr);
+
+	*jobs = list;
+	*count = n;
+	return ret;
+}
+
+
+
+/* Reads exactly len bytes at offset, short reads are continued */
+static Status pread_full(int fd, uint8_t *buf, size_t len, uint64_t off)
+{
+	while(len > 0)
+	{
+		ssize_t r = pread(fd, buf, len, off);
+		if(r < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if(r <= 0)
+		{
+			return e_failure;
+		}
+		buf += r;
+		len -= r;
+		off += r;
+	}
+	return e_success;
+}
+
+
+
+/* Writes exactly len bytes at offset, short writes are continued */
+static Status pwrite_full(int fd, const uint8_t *buf, size_t len, uint64_t off)
+{
+	while(len > 0)
+	{
+		ssize_t r = pwrite(fd, buf, len, off);
+		if(r < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if(r <= 0)
+		{
+			return e_failure;
+		}
+		buf += r;
+		len -= r;
+		off += r;
+	}
+	return e_success;
+}
+
+
+
+/* Turns on O_DIRECT for fd, returns 0 if file system doesn't support it */
+static int batch_set_direct(int fd)
+{
+	int flags = fcntl(fd, F_GETFL);
+	return (flags != -1 && fcntl(fd, F_SETFL, flags | O_DIRECT) == 0);
+}
+
+
+
+/* Length to read/write for len bytes of block (rounded up to BATCH_DIRECT_ALIGN for O_DIRECT) */
+size_t batch_io_len(int direct, size_t len)
+{
+	return direct ? (len + BATCH_DIRECT_ALIGN - 1) / BATCH_DIRECT_ALIGN * BATCH_DIRECT_ALIGN : len;
+}
+
+
+
+/* Reads block of len bytes at offset, O_DIRECT reads are rounded up and can stop at end of file after len bytes */
+static Status batch_read_block(BatchJob *job, uint8_t *block, size_t len, uint64_t off)
+{
+	if(job->direct_in == 0)
+	{
+		return pread_full(job->fd_in, block, len, off);
+	}
+
+	size_t want = batch_io_len(1, len), done = 0;
+	while(done < len)
+	{
+		ssize_t r = pread(job->fd_in, block + done, want - done, off + done);
+		if(r < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		// if => short read left an unaligned offset, then rest is read without O_DIRECT.
+		if(r < 0 && errno == EINVAL)
+		{
+			int flags = fcntl(job->fd_in, F_GETFL);
+			fcntl(job->fd_in, F_SETFL, flags & ~O_DIRECT);
+			job->direct_in = 0;
+			return pread_full(job->fd_in, block + done, len - done, off + done);
+		}
+		if(r <= 0)
+		{
+			return e_failure;
+		}
+		done += r;
+	}
+	return e_success;
+}
+
+
+
+/* Drops pages of a block from page cache, when O_DIRECT is asked but not supported */
+static void batch_drop_pages(BatchJob *job, uint64_t off, size_t len)
+{
+	if(job->dontneed)
+	{
+		posix_fadvise(job->fd_in, off, len, POSIX_FADV_DONTNEED);
+	}
+}
+
+
+
+/* Opens source image and secret file, builds payload (header and secret data) and opens stego image */
+static Status batch_encode_start(BatchJob *job)
+{
+	EncodeInfo *encInfo = &job->encInfo;
+	struct stat st;
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+
+	job->fd_in = open(encInfo->src_image_fname, O_RDONLY);
+	if(job->fd_in < 0 || fstat(job->fd_in, &st) < 0 || pread_full(job->fd_in, bmp_header, BMP_HEADER_SIZE, 0) == e_failure)
+	{
+		printf("ERROR: Unable to read %s\n", encInfo->src_image_fname);
+		return e_failure;
+	}
+	job->in_size = st.st_size;
+
+	// batch blocks are laid out for 24 bpp, other pixel formats should be encoded one by one with -e.
+	PixelFormat format;
+	uint64_t data_offset;
+	if(stego_bmp_format(bmp_header, &format, &data_offset) == e_failure || format != e_bgr24)
+	{
+		printf("ERROR: %s is not a 24 bpp bmp image, batch supports only 24 bpp.\n", encInfo->src_image_fname);
+		return e_failure;
+	}
+
+	int fd_secret = open(encInfo->secret_fname, O_RDONLY);
+	if(fd_secret < 0 || fstat(fd_secret, &st) < 0)
+	{
+		printf("ERROR: Unable to open file %s\n", encInfo->secret_fname);
+		if(fd_secret >= 0)
+		{
+			close(fd_secret);
+		}
+		return e_failure;
+	}
+
+	// same empty check as check_capacity().
+	if(st.st_size <= 1)
+	{
+		printf("ERROR: %s file is empty\n", encInfo->secret_fname);
+		close(fd_secret);
+		return e_failure;
+	}
+
+	// header fields.
+	StegoHeader *hdr = &job->hdr;
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->extn_size = strlen(encInfo->extn_secret_file);
+	memcpy(hdr->extn, encInfo->extn_secret_file, hdr->extn_size);
+	hdr->data_size = st.st_size;
+	if(options.encrypt)
+	{
+		hdr->flags |= FLAG_ENCRYPTED;
+		if(cipher_make_nonce(hdr->nonce) == e_failure)
+		{
+			close(fd_secret);
+			return e_failure;
+		}
+	}
+
+	// payload is header bytes followed by secret data.
+	job->payload = malloc(STEGO_HEADER_MAX + hdr->data_size);
+	if(job->payload == NULL)
+	{
+		printf("ERROR: Out of memory for %s\n", encInfo->secret_fname);
+		close(fd_secret);
+		return e_failure;
+	}
+	uint hlen = stego_write_header(hdr, job->payload);
+	job->payload_len = hlen + hdr->data_size;
+	Status r = pread_full(fd_secret, job->payload + hlen, hdr->data_size, 0);
+	close(fd_secret);
+	if(r == e_failure)
+	{
+		printf("ERROR: %s file data is not read.\n", encInfo->secret_fname);
+		return e_failure;
+	}
+
+	// if => encrypted, then keystream is XORed into secret data once, blocks only copy bits.
+	if(hdr->flags & FLAG_ENCRYPTED)
+	{
+		CipherCtx cipher;
+		cipher_init(&cipher, batch_key, hdr->nonce);
+		cipher_xor(&cipher, job->payload + hlen, hdr->data_size);
+	}
+
+	// same capacity check as check_capacity().
+	if(stego_required_size(hdr) >= stego_bmp_capacity(bmp_header))
+	{
+		printf("ERROR: \"%s\" doesn't have the capacity to encode \"%s\"\n", encInfo->src_image_fname, encInfo->secret_fname);
+		return e_failure;
+	}
+
+	snprintf(job->out_fname, sizeof(job->out_fname), "%s", encInfo->stego_image_fname);
+	job->fd_out = open(job->out_fname, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if(job->fd_out < 0)
+	{
+		perror("open");
+		printf("ERROR: Unable to open file %s\n", job->out_fname);
+		return e_failure;
+	}
+
+	// header is already read, so blocks from here can be read and written with O_DIRECT.
+	if(job->direct)
+	{
+		job->direct_in = batch_set_direct(job->fd_in);
+		job->direct_out = job->direct_in && batch_set_direct(job->fd_out);
+		job->dontneed = !job->direct_out;
+	}
+
+	// whole image file is read and written, header and left over data are copied as they are.
+	job->region_start = 0;
+	job->region_end = job->in_size;
+	return e_success;
+}
+
+
+
+/* Opens stego image, decodes header and opens decoded secret file */
+static Status batch_decode_start(BatchJob *job)
+{
+	DecodeInfo *decInfo = &job->decInfo;
+	struct stat st;
+
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+
+	job->fd_in = open(decInfo->image_fname, O_RDONLY);
+	if(job->fd_in < 0 || fstat(job->fd_in, &st) < 0 || pread_full(job->fd_in, bmp_header, BMP_HEADER_SIZE, 0) == e_failure)
+	{
+		printf("ERROR: Unable to open file %s\n", decInfo->image_fname);
+		return e_failure;
+	}
+	job->in_size = st.st_size;
+
+	// batch blocks are laid out for 24 bpp, other pixel formats should be decoded one by one with -d.
+	PixelFormat format;
+	uint64_t data_offset;
+	if(stego_bmp_format(bmp_header, &format, &data_offset) == e_failure || format != e_bgr24)
+	{
+		printf("ERROR: %s is not a 24 bpp bmp image, batch supports only 24 bpp.\n", decInfo->image_fname);
+		return e_failure;
+	}
+
+	// image bytes which can hold the biggest header are read and decoded.
+	uint8_t prefix[STEGO_HEADER_MAX * 8];
+	uint64_t avail = (job->in_size > BMP_HEADER_SIZE) ? job->in_size - BMP_HEADER_SIZE : 0;
+	size_t prefix_len = (avail < sizeof(prefix)) ? avail : sizeof(prefix);
+	if(pread_full(job->fd_in, prefix, prefix_len, BMP_HEADER_SIZE) == e_failure)
+	{
+		printf("ERROR: Unable to read %s file to decode header.\n", decInfo->image_fname);
+		return e_failure;
+	}
+	lsb_extract_bytes(prefix, prefix, prefix_len / 8);
+
+	StegoHeader *hdr = &job->hdr;
+	if(stego_read_header(prefix, prefix_len / 8, hdr) == e_failure)
+	{
+		printf("ERROR: Unable to decode header of %s.\n", decInfo->image_fname);
+		return e_failure;
+	}
+
+	if(hdr->flags & FLAG_ENCRYPTED)
+	{
+		if(batch_have_key == 0)
+		{
+			printf("ERROR: %s is encrypted. Use --key-file=<file> or set %s.\n", decInfo->image_fname, CIPHER_KEY_ENV);
+			return e_failure;
+		}
+		cipher_init(&job->cipher, batch_key, hdr->nonce);
+	}
+
+	// secret data region of stego image.
+	job->region_start = BMP_HEADER_SIZE + (uint64_t)hdr->header_size * 8;
+	job->region_end = job->region_start + hdr->data_size * 8;
+	if(job->region_end > job->in_size)
+	{
+		printf("ERROR: Unable to read %s file to decode secret file data.\n", decInfo->image_fname);
+		return e_failure;
+	}
+
+	snprintf(job->out_fname, sizeof(job->out_fname), "%s%s", decInfo->secret_fname, hdr->extn);
+	job->fd_out = open(job->out_fname, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if(job->fd_out < 0)
+	{
+		perror("open");
+		printf("ERROR: Unable to open file %s\n", job->out_fname);
+		return e_failure;
+	}
+
+	// secret data region doesn't start at block boundary, so pages are dropped instead of O_DIRECT.
+	job->dontneed = job->direct;
+	return e_success;
+}
+
+
+
+/* Opens files and prepares payload of a job */
+Status batch_job_start(BatchJob *job)
+{
+	Status ret = (job->type == e_encode) ? batch_encode_start(job) : batch_decode_start(job);
+	job->next_off = job->region_start;
+	if(ret == e_failure)
+	{
+		job->status = e_failure;
+	}
+	return ret;
+}
+
+
+
+/* Encodes/decodes one block in place, block has image bytes [off, off + len) */
+Status batch_job_process(BatchJob *job, uint8_t *block, uint64_t off, size_t len, uint64_t *out_off, size_t *out_len)
+{
+	// encode => payload bits are put in LSB, block is written back at same offset.
+	if(job->type == e_encode)
+	{
+		stego_embed_region(block, off, len, job->payload, job->payload_len);
+
+		// if => --verify, then bits are decoded again from block before it is written.
+		if(options.verify && stego_verify_region(block, off, len, job->payload, job->payload_len) == e_failure)
+		{
+			printf("ERROR: Verify failed, encoded bits of %s don't match payload.\n", job->out_fname);
+			return e_failure;
+		}
+		*out_off = off;
+		*out_len = batch_io_len(job->direct_out, len);
+		return e_success;
+	}
+
+	// decode => blocks start at payload byte boundary, so 8 image bytes give one secret byte.
+	*out_off = (off - job->region_start) / 8;
+	*out_len = len / 8;
+	lsb_extract_bytes(block, block, *out_len);
+	if(job->hdr.flags & FLAG_ENCRYPTED)
+	{
+		// blocks can finish in any order, so keystream is moved to block offset.
+		CipherCtx cipher = job->cipher;
+		cipher_seek(&cipher, *out_off);
+		cipher_xor(&cipher, block, *out_len);
+	}
+	return e_success;
+}
+
+
+
+/* Closes files of a job, output file is removed if job failed */
+void batch_job_finish(BatchJob *job)
+{
+	if(job->fd_in >= 0)
+	{
+		close(job->fd_in);
+		job->fd_in = -1;
+	}
+	if(job->fd_out >= 0)
+	{
+		// O_DIRECT last block is written rounded up, so output is cut to image size.
+		if(job->direct_out && job->status == e_success && ftruncate(job->fd_out, job->in_size) < 0)
+		{
+			job->status = e_failure;
+		}
+		if(job->dontneed)
+		{
+			posix_fadvise(job->fd_out, 0, 0, POSIX_FADV_DONTNEED);
+		}
+		if(close(job->fd_out) < 0)
+		{
+			job->status = e_failure;
+		}
+		job->fd_out = -1;
+	}
+	free(job->payload);
+	job->payload = NULL;
+
+	// if => output is written to temp file, then it is renamed to final name only when it is complete (--watch).
+	const char *out_fname = job->out_fname;
+	if(job->final_fname[0] != '\0')
+	{
+		if(job->status == e_success && rename(job->out_fname, job->final_fname) != 0)
+		{
+			perror("rename");
+			job->status = e_failure;
+		}
+		out_fname = job->final_fname;
+	}
+
+	const char *in_fname = (job->type == e_encode) ? job->encInfo.secret_fname : job->decInfo.image_fname;
+	const char *label = (job->final_fname[0] != '\0') ? "Job" : "Line";
+	if(job->status == e_success)
+	{
+		print_info("INFO: %s %d : %s %s -> %s\n", label, job->line_no, (job->type == e_encode) ? "Encoded" : "Decoded", in_fname, out_fname);
+	}
+	else
+	{
+		if(job->out_fname[0] != '\0')
+		{
+			remove(job->out_fname);
+		}
+		printf("ERROR: %s %d : %s of %s failed.\n", label, job->line_no, (job->type == e_encode) ? "Encoding" : "Decoding", in_fname);
+	}
+}
+
+
+
+/* Runs whole job with pread/pwrite in block buffer (BATCH_BLOCK_SIZE, BATCH_DIRECT_ALIGN aligned), files are closed by batch_job_finish() */
+void batch_run_job(BatchJob *job, uint8_t *block)
+{
+	if(block == NULL)
+	{
+		job->status = e_failure;
+	}
+	else if(TRACE_STAGE("batch_job_start", batch_job_start(job)) == e_success)
+	{
+		for(uint64_t off = job->region_start; off < job->region_end && job->status == e_success; off += BATCH_BLOCK_SIZE)
+		{
+			size_t len = (job->region_end - off < BATCH_BLOCK_SIZE) ? job->region_end - off : BATCH_BLOCK_SIZE;
+			uint64_t out_off;
+			size_t out_len;
+			if(TRACE_STAGE("read_block", batch_read_block(job, block, len, off)) == e_failure || TRACE_STAGE("process_block", batch_job_process(job, block, off, len, &out_off, &out_len)) == e_failure || TRACE_STAGE("write_block", pwrite_full(job->fd_out, block, out_len, out_off)) == e_failure)
+			{
+				job->status = e_failure;
+			}
+			batch_drop_pages(job, off, len);
+		}
+	}
+}
+
+
+
+/* Thread pool engine : next job index shared by all threads */
+typedef struct _BatchPool
+{
+    BatchJob *jobs;
+    int count;
+    int next;				// => next job index, taken with atomic add
+
+} BatchPool;
+
+/* Thread pool worker, runs whole jobs one after another with pread/pwrite */
+static void *batch_worker(void *arg)
+{
+	BatchPool *pool = arg;
+	uint8_t *block = aligned_alloc(BATCH_DIRECT_ALIGN, BATCH_BLOCK_SIZE);
+	trace_thread("batch worker");
+
+	for(;;)
+	{
+		int i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+		if(i >= pool->count)
+		{
+			break;
+		}
+		BatchJob *job = &pool->jobs[i];
+		trace_begin("job", job->args[2]);
+		batch_run_job(job, block);
+		trace_begin("batch_job_finish", NULL);
+		batch_job_finish(job);
+		trace_end(job->status);
+		trace_end(job->status);
+	}
+	free(block);
+	return NULL;
+}
+
+
+
+/* Runs jobs on thread pool */
+static void batch_run_threads(BatchJob *jobs, int count)
+{
+	BatchPool pool = { jobs, count, 0 };
+	int nthreads = options.threads;
+	if(nthreads <= 0)
+	{
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if(nthreads > count)
+	{
+		nthreads = count;
+	}
+	if(nthreads < 1)
+	{
+		nthreads = 1;
+	}
+
+	print_info("INFO: Running %d jobs on %d threads\n", count, nthreads);
+	pthread_t threads[nthreads];
+	int started = 0;
+	for(int i=0; i<nthreads; i++)
+	{
+		if(pthread_create(&threads[i], NULL, batch_worker, &pool) != 0)
+		{
+			break;
+		}
+		started++;
+	}
+
+	// if => no thread started, then jobs are run in this thread.
+	if(started == 0)
+	{
+		batch_worker(&pool);
+	}
+	for(int i=0; i<started; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+}
+
+
+
+#ifdef HAVE_IO_URING
+
+/* One block buffer and the read/write going on with it */
+typedef struct _BatchSlot
+{
+    uint8_t *buffer;			// => registered buffer of BATCH_BLOCK_SIZE
+    BatchJob *job;			// => job of block, NULL if slot is free
+    uint64_t off;			// => image offset of block
+    size_t len;				// => block length
+    uint64_t out_off;			// => output offset after processing
+    size_t out_len;			// => output length after processing
+    size_t done;			// => bytes read/written so far
+    int writing;			// => 0 while reading, 1 while writing
+
+} BatchSlot;
+
+/* Prepares read or write sqe for remaining part of slot */
+static void batch_prep_slot(Uring *ring, BatchSlot *slots, int index, int fixed)
+{
+	BatchSlot *slot = &slots[index];
+	struct io_uring_sqe *sqe = uring_get_sqe(ring);
+
+	// ring has twice as many entries as slots, and each slot has one request at a time.
+	if(slot->writing)
+	{
+		sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+		sqe->fd = slot->job->fd_out;
+		sqe->off = slot->out_off + slot->done;
+		sqe->len = slot->out_len - slot->done;
+	}
+	else
+	{
+		sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+		sqe->fd = slot->job->fd_in;
+		sqe->off = slot->off + slot->done;
+		sqe->len = batch_io_len(slot->job->direct_in, slot->len) - slot->done;
+	}
+	sqe->addr = (uint64_t)(uintptr_t)(slot->buffer + slot->done);
+	sqe->buf_index = fixed ? index : 0;
+	sqe->user_data = index;
+}
+
+
+
+/* Runs jobs with io_uring, returns e_failure if io_uring can't be used (no job is started then) */
+static Status batch_run_uring(BatchJob *jobs, int count)
+{
+	Uring ring;
+	if(uring_init(&ring, 2 * BATCH_SLOTS) == e_failure)
+	{
+		return e_failure;
+	}
+
+	// one big allocation, split in slots and registered as fixed buffers.
+	uint8_t *memory = aligned_alloc(4096, (size_t)BATCH_SLOTS * BATCH_BLOCK_SIZE);
+	if(memory == NULL)
+	{
+		uring_exit(&ring);
+		return e_failure;
+	}
+	BatchSlot slots[BATCH_SLOTS];
+	struct iovec iovs[BATCH_SLOTS];
+	int free_slots[BATCH_SLOTS], free_count = 0;
+	for(int i=0; i<BATCH_SLOTS; i++)
+	{
+		memset(&slots[i], 0, sizeof(slots[i]));
+		slots[i].buffer = memory + (size_t)i * BATCH_BLOCK_SIZE;
+		iovs[i].iov_base = slots[i].buffer;
+		iovs[i].iov_len = BATCH_BLOCK_SIZE;
+		free_slots[free_count++] = BATCH_SLOTS - 1 - i;
+	}
+
+	// if => registering fails (locked memory limit), then plain READ/WRITE are used.
+	int fixed = (uring_register_buffers(&ring, iovs, BATCH_SLOTS) == e_success);
+	print_info("INFO: Running %d jobs with io_uring%s\n", count, fixed ? " (registered buffers)" : "");
+
+	BatchJob *active[BATCH_SLOTS];
+	int active_count = 0, next_job = 0, inflight = 0;
+
+	for(;;)
+	{
+		// every free slot gets next block of an active job, or of a new job.
+		while(free_count > 0)
+		{
+			BatchJob *job = NULL;
+			for(int i=0; i<active_count && job == NULL; i++)
+			{
+				if(active[i]->status == e_success && active[i]->next_off < active[i]->region_end && active[i]->inflight < BATCH_JOB_INFLIGHT)
+				{
+					job = active[i];
+				}
+			}
+			while(job == NULL && next_job < count && active_count < BATCH_SLOTS)
+			{
+				BatchJob *new_job = &jobs[next_job++];
+				// jobs overlap on this thread, so each job is an async event with job no. as id.
+				trace_async_begin("job", next_job, new_job->args[2]);
+				// if => job can't start or has nothing to read, then it is finished now.
+				if(TRACE_STAGE("batch_job_start", batch_job_start(new_job)) == e_failure || new_job->region_start == new_job->region_end)
+				{
+					batch_job_finish(new_job);
+					trace_async_end("job", next_job, new_job->status);
+					continue;
+				}
+				active[active_count++] = new_job;
+				job = new_job;
+			}
+			if(job == NULL)
+			{
+				break;
+			}
+
+			int index = free_slots[--free_count];
+			BatchSlot *slot = &slots[index];
+			slot->job = job;
+			slot->off = job->next_off;
+			slot->len = (job->region_end - job->next_off < BATCH_BLOCK_SIZE) ? job->region_end - job->next_off : BATCH_BLOCK_SIZE;
+			slot->done = 0;
+			slot->writing = 0;
+			job->next_off += slot->len;
+			job->inflight++;
+			batch_prep_slot(&ring, slots, index, fixed);
+			inflight++;
+		}
+
+		if(inflight == 0)
+		{
+			break;
+		}
+
+		// errno of wait is kept, since trace_end() may change it.
+		trace_begin("io_uring_wait", NULL);
+		int waited = uring_submit_and_wait(&ring, 1), wait_errno = errno;
+		trace_end((waited < 0) ? e_failure : e_success);
+		if(waited < 0 && wait_errno != EINTR)
+		{
+			errno = wait_errno;
+			perror("io_uring_enter");
+			break;
+		}
+
+		// while kernel works on submitted blocks, completed blocks are encoded/decoded here.
+		struct io_uring_cqe *cqe;
+		while((cqe = uring_peek_cqe(&ring)) != NULL)
+		{
+			int index = cqe->user_data;
+			int res = cqe->res;
+			uring_cqe_seen(&ring);
+
+			BatchSlot *slot = &slots[index];
+			BatchJob *job = slot->job;
+			int release = 0;
+
+			if(res <= 0 || job->status == e_failure)
+			{
+				// error, or end of file before whole block.
+				job->status = e_failure;
+				release = 1;
+			}
+			else if(slot->writing == 0)
+			{
+				slot->done += res;
+				if(slot->done < slot->len)
+				{
+					batch_prep_slot(&ring, slots, index, fixed);
+					continue;
+				}
+				batch_drop_pages(job, slot->off, slot->len);
+				if(TRACE_STAGE("process_block", batch_job_process(job, slot->buffer, slot->off, slot->len, &slot->out_off, &slot->out_len)) == e_failure)
+				{
+					job->status = e_failure;
+					release = 1;
+				}
+				else
+				{
+					slot->writing = 1;
+					slot->done = 0;
+					batch_prep_slot(&ring, slots, index, fixed);
+					continue;
+				}
+			}
+			else
+			{
+				slot->done += res;
+				if(slot->done < slot->out_len)
+				{
+					batch_prep_slot(&ring, slots, index, fixed);
+					continue;
+				}
+				release = 1;
+			}
+
+			if(release)
+			{
+				slot->job = NULL;
+				free_slots[free_count++] = index;
+				inflight--;
+				job->inflight--;
+
+				// if => last block of job is done (or job failed), then job is finished.
+				if(job->inflight == 0 && (job->status == e_failure || job->next_off >= job->region_end))
+				{
+					batch_job_finish(job);
+					trace_async_end("job", job - jobs + 1, job->status);
+					for(int i=0; i<active_count; i++)
+					{
+						if(active[i] == job)
+						{
+							active[i] = active[--active_count];
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// if => stopped because of io_uring error, then remaining jobs are failed.
+	for(int i=0; i<active_count; i++)
+	{
+		active[i]->status = e_failure;
+		batch_job_finish(active[i]);
+		trace_async_end("job", active[i] - jobs + 1, e_failure);
+	}
+	for(; next_job < count; next_job++)
+	{
+		jobs[next_job].status = e_failure;
+		batch_job_finish(&jobs[next_job]);
+	}
+
+	uring_exit(&ring);
+	free(memory);
+	return e_success;
+}
+
+#endif
+
+
+
+/* Loads key once for all jobs, if => encryption asked or key given in environment for encrypted images */
+Status batch_load_key(void)
+{
+	batch_have_key = 0;
+	if(options.encrypt || getenv(CIPHER_KEY_ENV) != NULL)
+	{
+		if(cipher_load_key(options.key_fname, batch_key) == e_failure)
+		{
+			return e_failure;
+		}
+		batch_have_key = 1;
+	}
+	return e_success;
+}
+
+
+
+/* Wipes key of jobs */
+void batch_clear_key(void)
+{
+	memset(batch_key, 0, sizeof(batch_key));
+	batch_have_key = 0;
+}
+
+
+
+/* Frees job list */
+static void free_jobs(BatchJob *jobs, int count)
+{
+	for(int i=0; i<count; i++)
+	{
+		free(jobs[i].line);
+	}
+	free(jobs);
+}
+
+
+
+/* Performs the batch */
+Status do_batch(char *argv[])
+{
+	BatchJob *jobs;
+	int count;
+
+	print_info("INFO: ## Batch Procedure Started ##\n");
+	// batch jobs encode in all carrier bytes, so channel mask can't be asked.
+	if(options.channels != 0 && options.channels != CHANNEL_ALL)
+	{
+		printf("ERROR: --channels can't be used with batch jobs.\n");
+		return e_failure;
+	}
+	// batch jobs encode plain secret data, so Reed-Solomon parity can't be asked.
+	if(options.ecc_parity != 0)
+	{
+		printf("ERROR: --ecc can't be used with batch jobs.\n");
+		return e_failure;
+	}
+	// read_and_validate_batch_file() function is called and if => e_failure, then no job is run.
+	if(read_and_validate_batch_file(argv[2], &jobs, &count) == e_failure)
+	{
+		free_jobs(jobs, count);
+		return e_failure;
+	}
+
+	// key is loaded once for all jobs.
+	if(batch_load_key() == e_failure)
+	{
+		free_jobs(jobs, count);
+		return e_failure;
+	}
+
+	int ran = 0;
+#ifdef HAVE_IO_URING
+	if(options.io_engine != IO_ENGINE_THREADS && batch_run_uring(jobs, count) == e_success)
+	{
+		ran = 1;
+	}
+#endif
+	if(ran == 0)
+	{
+		batch_run_threads(jobs, count);
+	}
+
+	int ok = 0;
+	for(int i=0; i<count; i++)
+	{
+		ok += (jobs[i].status == e_success);
+	}
+	free_jobs(jobs, count);
+	batch_clear_key();
+
+	print_info("INFO: %d of %d jobs done successfully\n", ok, count);
+	return (ok == count) ? e_success : e_failure;
+}
@@ -0,0 +1,116 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Batch Encoding and Decoding
+ *
+ *                              -> ./a.out -b <job_list_file> runs many encode/decode jobs in one process.
+ *                              -> Each line of job list is same as command line args : -e <.bmp> <secret> [out.bmp] or -d <.bmp> [name].
+ *                              -> Empty lines and lines starting with # are skipped.
+ *                              -> Image files are done in blocks, every block is read, encoded/decoded in memory and written back.
+ *                              -> With io_uring (built with -DHAVE_IO_URING), blocks of many files are kept in flight at same time
+ *                                 using registered buffers, so one job is encoded while other jobs' reads and writes are going on.
+ *                              -> If io_uring is not built or not allowed, a thread pool runs jobs with pread/pwrite.
+ *                              -> --io=uring|threads selects engine, --threads=<n> sets thread pool size.
+ */
+
+
+
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "types.h" // Contains user defined types
+#include "encode.h"
+#include "decode.h"
+#include "stego.h"
+
+/* Size of each block read from image file */
+#define BATCH_BLOCK_SIZE (1024 * 1024)
+
+/* No. of block buffers (registered buffers with io_uring) */
+#define BATCH_SLOTS 32
+
+/* Maximum blocks of one job in flight */
+#define BATCH_JOB_INFLIGHT 4
+
+/* Alignment of O_DIRECT buffers, offsets and lengths (covers 512 and 4096 byte logical blocks) */
+#define BATCH_DIRECT_ALIGN 4096
+
+/* Maximum args in one job line */
+#define BATCH_MAX_ARGS 6
+
+/*
+ * Structure to store one job of batch and its progress
+ */
+
+typedef struct _BatchJob
+{
+    /* Job args */
+    int line_no;			// => line no. in job list file
+    char *line;				// => Stores the job line (args point into it)
+    char *args[BATCH_MAX_ARGS + 1];	// => argv like args, args[0] is "batch"
+    OperationType type;			// => e_encode or e_decode
+    EncodeInfo encInfo;			// => validated encode args
+    DecodeInfo decInfo;			// => validated decode args
+
+    /* Files */
+    int fd_in;				// => fd of source/stego image
+    int fd_out;				// => fd of stego image/decoded secret file
+    char out_fname[256];		// => Stores the output file name
+    char final_fname[256];		// => out_fname is renamed to it when job is done (empty => out_fname is output)
+    uint64_t in_size;			// => image file size
+
+    /* Page cache */
+    int direct;				// => 1 if image files should bypass page cache (--direct, or --direct/--buffered in job line)
+    int direct_in;			// => 1 if fd_in is opened with O_DIRECT
+    int direct_out;			// => 1 if fd_out is opened with O_DIRECT
+    int dontneed;			// => 1 if O_DIRECT is not supported, pages are dropped with posix_fadvise instead
+
+    /* Payload */
+    StegoHeader hdr;			// => header fields
+    uint8_t *payload;			// => encode : header bytes and secret data
+    uint64_t payload_len;		// => no. of payload bytes
+    CipherCtx cipher;			// => decode : ChaCha20 state
+
+    /* Progress */
+    uint64_t region_start;		// => first image byte to read
+    uint64_t region_end;		// => end of image bytes to read
+    uint64_t next_off;			// => next image byte to read
+    int inflight;			// => no. of blocks in flight
+    Status status;			// => e_failure once any step fails
+
+} BatchJob;
+
+
+/* Batch function prototypes */
+
+/* Perform the batch */
+Status do_batch(char *argv[]);
+
+/* Read job list file and validate every job */
+Status read_and_validate_batch_file(const char *fname, BatchJob **jobs, int *count);
+
+/* Open files and prepare payload of a job */
+Status batch_job_start(BatchJob *job);
+
+/* Length to read/write for len bytes of block (rounded up to BATCH_DIRECT_ALIGN for O_DIRECT) */
+size_t batch_io_len(int direct, size_t len);
+
+/* Encode/decode one block in place, gives output offset and length */
+Status batch_job_process(BatchJob *job, uint8_t *block, uint64_t off, size_t len, uint64_t *out_off, size_t *out_len);
+
+/* Close files of a job, output is removed if job failed */
+void batch_job_finish(BatchJob *job);
+
+/* Run whole job with pread/pwrite in block buffer */
+void batch_run_job(BatchJob *job, uint8_t *block);
+
+/* Load key for all jobs (if encryption asked or key given in environment) */
+Status batch_load_key(void);
+
+/* Wipe key of jobs */
+void batch_clear_key(void);
+
+#endif
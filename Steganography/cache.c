@@ -0,0 +1,417 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Encode Result Cache
+ *
+ *                              -> Lookup : secret file is hashed, id is hashed from source image stat and secret hash,
+ *                                 <id>.id file has key, size and mtime of cached image.
+ *                              -> Cached image is used only if its size and mtime are same as when stored, so a cached image changed
+ *                                 in cache dir is not used and is removed.
+ *                              -> Cached images never share an inode with outputs (no hard links), so in-place writes of an output
+ *                                 (-u, editors) can't change cached image or other outputs. Files are cloned with FICLONE (reflink,
+ *                                 shared blocks are copied on write by file system), else copied with copy_file_range or buffer.
+ *                              -> Store : key is hashed from source image hash (done while encoding reads it) and secret hash,
+ *                                 output is cloned as <key>.bmp, and <id>.id is written to temp file and renamed.
+ *                              -> Eviction : cached images are sorted by atime and oldest are removed till cache (images and ids) is
+ *                                 in its size, then ids whose image is removed are removed.
+ */
+
+
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#include "cache.h"
+#include "png.h"
+#include "hash.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/*
+ * Cached image found while evicting
+ */
+
+typedef struct _CacheEntry
+{
+    char name[32];			// => file name in cache dir
+    struct timespec atime;		// => last use time
+    uint64_t size;			// => file size
+    int is_id;				// => 1 => <id>.id file, 0 => <key>.bmp cached image
+
+} CacheEntry;
+
+/* Function Definitions */
+
+/* Makes path of file <key><suffix> in cache dir */
+static void cache_path(char *path, uint64_t key, const char *suffix)
+{
+	snprintf(path, CACHE_PATH_SIZE, "%s/%016llx%s", options.cache_dir, (unsigned long long)key, suffix);
+}
+
+/* Sets last use time of cached image to now */
+static void cache_touch(const char *path)
+{
+	struct timespec times[2];
+	times[0].tv_sec = 0;
+	times[0].tv_nsec = UTIME_NOW;
+	times[1].tv_sec = 0;
+	times[1].tv_nsec = UTIME_OMIT;
+	utimensat(AT_FDCWD, path, times, 0);
+}
+
+/* Copies file src to new file dest, as reflink if file system can share blocks */
+static Status cache_copy(const char *src, const char *dest)
+{
+	struct stat st;
+	int in_fd = open(src, O_RDONLY | O_CLOEXEC);
+	if(in_fd == -1 || fstat(in_fd, &st) != 0)
+	{
+		if(in_fd != -1)
+		{
+			close(in_fd);
+		}
+		return e_failure;
+	}
+	int out_fd = open(dest, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(out_fd == -1)
+	{
+		close(in_fd);
+		return e_failure;
+	}
+
+	// reflink first, then copy_file_range, then buffer copy if it is not supported between these file systems.
+	off_t done = 0;
+	if(ioctl(out_fd, FICLONE, in_fd) == 0)
+	{
+		done = st.st_size;
+	}
+	while(done < st.st_size)
+	{
+		ssize_t n = copy_file_range(in_fd, NULL, out_fd, NULL, st.st_size - done, 0);
+		if(n <= 0)
+		{
+			break;
+		}
+		done += n;
+	}
+	static char buffer[COPY_BLOCK_SIZE];
+	while(done < st.st_size)
+	{
+		ssize_t n = pread(in_fd, buffer, sizeof(buffer), done);
+		if(n <= 0 || pwrite(out_fd, buffer, n, done) != n)
+		{
+			break;
+		}
+		done += n;
+	}
+
+	close(in_fd);
+	if(close(out_fd) != 0 || done != st.st_size)
+	{
+		remove(dest);
+		return e_failure;
+	}
+	return e_success;
+}
+
+/* Hashes whole secret file */
+static Status hash_file(const char *fname, uint64_t *hash)
+{
+	static char buffer[COPY_BLOCK_SIZE];
+	HashState state;
+	size_t r;
+
+	FILE *fptr = fopen(fname, "rb");
+	if(fptr == NULL)
+	{
+		return e_failure;
+	}
+	hash_init(&state, 0);
+	while((r = fread(buffer, 1, sizeof(buffer), fptr)) > 0)
+	{
+		hash_update(&state, buffer, r);
+	}
+	Status status = ferror(fptr) ? e_failure : e_success;
+	fclose(fptr);
+
+	*hash = hash_digest(&state);
+	return status;
+}
+
+/* Look up encoding in cache, and copy cached image to output if found (e_failure => not found, encode it) */
+Status cache_lookup(EncodeInfo *encInfo)
+{
+	struct stat src;
+
+	// encInfo is not cleared by caller, so cache is marked off first.
+	encInfo->cache_enabled = 0;
+
+	// encrypted output differs every time (new nonce), cache id doesn't have channel mask, ECC level or output format, and stream can be read only once, so these are not cached.
+	if(options.cache_dir == NULL || (encInfo->header_flags & (FLAG_ENCRYPTED | FLAG_CHANNELS | FLAG_ECC)) || encInfo->secret_stream || png_is_png(encInfo->src_image_fname) || png_is_png(encInfo->stego_image_fname))
+	{
+		return e_failure;
+	}
+	if(stat(encInfo->src_image_fname, &src) != 0 || hash_file(encInfo->secret_fname, &encInfo->secret_hash) == e_failure)
+	{
+		return e_failure;
+	}
+	encInfo->cache_enabled = 1;
+	hash_init(&encInfo->carrier_hash, 0);
+
+	// id is hashed from source image identity, secret file hash and extension (padding is zeroed).
+	struct
+	{
+		uint64_t dev, ino, size;
+		int64_t mtime_sec, mtime_nsec, ctime_sec, ctime_nsec;
+		uint64_t secret_hash;
+		char extn[16];
+	} id;
+	memset(&id, 0, sizeof(id));
+	id.dev = src.st_dev;
+	id.ino = src.st_ino;
+	id.size = src.st_size;
+	id.mtime_sec = src.st_mtim.tv_sec;
+	id.mtime_nsec = src.st_mtim.tv_nsec;
+	id.ctime_sec = src.st_ctim.tv_sec;
+	id.ctime_nsec = src.st_ctim.tv_nsec;
+	id.secret_hash = encInfo->secret_hash;
+	strncpy(id.extn, encInfo->extn_secret_file, sizeof(id.extn) - 1);
+	encInfo->cache_id = hash64(&id, sizeof(id), 0);
+
+	char id_path[CACHE_PATH_SIZE], key_path[CACHE_PATH_SIZE];
+	unsigned long long key, size;
+	long long mtime_sec;
+	long mtime_nsec;
+	cache_path(id_path, encInfo->cache_id, ".id");
+	FILE *fptr = fopen(id_path, "r");
+	if(fptr == NULL)
+	{
+		return e_failure;
+	}
+	int n = fscanf(fptr, "%llx %llu %lld %ld", &key, &size, &mtime_sec, &mtime_nsec);
+	fclose(fptr);
+	if(n != 4)
+	{
+		unlink(id_path);
+		return e_failure;
+	}
+
+	// if => cached image is removed or changed after it was stored, then it can't be used.
+	struct stat cached;
+	cache_path(key_path, key, ".bmp");
+	if(stat(key_path, &cached) != 0)
+	{
+		unlink(id_path);
+		return e_failure;
+	}
+	if((unsigned long long)cached.st_size != size || cached.st_mtim.tv_sec != mtime_sec || cached.st_mtim.tv_nsec != mtime_nsec)
+	{
+		unlink(id_path);
+		unlink(key_path);
+		return e_failure;
+	}
+
+	// old output is removed and cached image is copied (or reflinked) as new file, so output never shares inode with it.
+	unlink(encInfo->stego_image_fname);
+	if(cache_copy(key_path, encInfo->stego_image_fname) == e_failure)
+	{
+		return e_failure;
+	}
+	cache_touch(key_path);
+	print_info("INFO: Cache hit, %s is taken from %s\n", encInfo->stego_image_fname, key_path);
+	return e_success;
+}
+
+/* Hash source image bytes read by encoding */
+void cache_hash_carrier(EncodeInfo *encInfo, const void *data, size_t len)
+{
+	if(encInfo->cache_enabled)
+	{
+		hash_update(&encInfo->carrier_hash, data, len);
+	}
+}
+
+/* Sorts cached images oldest first */
+static int compare_atime(const void *a, const void *b)
+{
+	const CacheEntry *x = a, *y = b;
+	if(x->atime.tv_sec != y->atime.tv_sec)
+	{
+		return (x->atime.tv_sec < y->atime.tv_sec) ? -1 : 1;
+	}
+	if(x->atime.tv_nsec != y->atime.tv_nsec)
+	{
+		return (x->atime.tv_nsec < y->atime.tv_nsec) ? -1 : 1;
+	}
+	return strcmp(x->name, y->name);
+}
+
+/* Tells if cached image named in id file (in cache dir dir_fd) is there */
+static int cache_id_valid(int dir_fd, const char *id_name)
+{
+	char key_name[32];
+	unsigned long long key;
+	struct stat st;
+	int fd = openat(dir_fd, id_name, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+	{
+		return 0;
+	}
+	FILE *fptr = fdopen(fd, "r");
+	if(fptr == NULL)
+	{
+		close(fd);
+		return 0;
+	}
+	int n = fscanf(fptr, "%llx", &key);
+	fclose(fptr);
+	snprintf(key_name, sizeof(key_name), "%016llx.bmp", key);
+	return n == 1 && fstatat(dir_fd, key_name, &st, AT_SYMLINK_NOFOLLOW) == 0;
+}
+
+/* Removes least recently used cached images till cache (images and ids) is in its size, keep is not removed,
+ * then removes ids whose cached image is removed */
+static void cache_evict(const char *keep)
+{
+	uint64_t max = (uint64_t)((options.cache_max_mb > 0) ? options.cache_max_mb : CACHE_DEFAULT_MAX_MB) << 20;
+	CacheEntry *entries = NULL;
+	size_t count = 0, cap = 0;
+	uint64_t total = 0;
+	struct dirent *ent;
+
+	DIR *dir = opendir(options.cache_dir);
+	if(dir == NULL)
+	{
+		return;
+	}
+	int dir_fd = dirfd(dir);
+	while((ent = readdir(dir)) != NULL)
+	{
+		// only <16 hex digits>.bmp files are cached images, and <16 hex digits>.id files are ids.
+		size_t len = strlen(ent->d_name);
+		struct stat st;
+		int is_id = (len == 19 && strcmp(ent->d_name + 16, ".id") == 0);
+		if((!is_id && (len != 20 || strcmp(ent->d_name + 16, ".bmp") != 0)) || fstatat(dir_fd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+		{
+			continue;
+		}
+		if(count == cap)
+		{
+			cap = cap ? cap * 2 : 64;
+			CacheEntry *grown = realloc(entries, cap * sizeof(CacheEntry));
+			if(grown == NULL)
+			{
+				break;
+			}
+			entries = grown;
+		}
+		strcpy(entries[count].name, ent->d_name);
+		entries[count].atime = st.st_atim;
+		entries[count].size = st.st_size;
+		entries[count].is_id = is_id;
+		total += st.st_size;
+		count++;
+	}
+
+	if(total > max)
+	{
+		qsort(entries, count, sizeof(CacheEntry), compare_atime);
+		for(size_t i=0; i<count && total > max; i++)
+		{
+			if(!entries[i].is_id && strcmp(entries[i].name, keep) != 0 && unlinkat(dir_fd, entries[i].name, 0) == 0)
+			{
+				total -= entries[i].size;
+			}
+		}
+	}
+
+	// if => id names a removed image, then it can't be hit again, it is removed (else ids pile up without limit).
+	for(size_t i=0; i<count; i++)
+	{
+		if(entries[i].is_id && !cache_id_valid(dir_fd, entries[i].name))
+		{
+			unlinkat(dir_fd, entries[i].name, 0);
+		}
+	}
+
+	closedir(dir);
+	free(entries);
+}
+
+/* Store output image of successful encoding in cache, and remove least recently used images over cache size */
+void cache_store(EncodeInfo *encInfo)
+{
+	char key_path[CACHE_PATH_SIZE], id_path[CACHE_PATH_SIZE], tmp_path[CACHE_PATH_SIZE + 32];
+	struct stat cached;
+
+	if(!encInfo->cache_enabled)
+	{
+		return;
+	}
+	if(mkdir(options.cache_dir, 0700) != 0 && errno != EEXIST)
+	{
+		printf("ERROR: Unable to create cache dir %s : %s\n", options.cache_dir, strerror(errno));
+		return;
+	}
+
+	// key is hashed from whole source image, secret file hash and extension.
+	struct
+	{
+		uint64_t carrier_hash, carrier_size, secret_hash;
+		char extn[16];
+	} content;
+	memset(&content, 0, sizeof(content));
+	content.carrier_hash = hash_digest(&encInfo->carrier_hash);
+	content.carrier_size = encInfo->carrier_hash.total_len;
+	content.secret_hash = encInfo->secret_hash;
+	strncpy(content.extn, encInfo->extn_secret_file, sizeof(content.extn) - 1);
+	uint64_t key = hash64(&content, sizeof(content), 0);
+	cache_path(key_path, key, ".bmp");
+
+	// if => same content is already cached (from other source image file), then only id is added.
+	// image is copied to temp file and renamed, so a killed copy never leaves a truncated image under key.
+	if(stat(key_path, &cached) != 0)
+	{
+		snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", key_path, (int)getpid());
+		if(cache_copy(encInfo->stego_image_fname, tmp_path) == e_failure)
+		{
+			return;
+		}
+		if(rename(tmp_path, key_path) != 0 || stat(key_path, &cached) != 0)
+		{
+			remove(tmp_path);
+			return;
+		}
+	}
+
+	// id file is written to temp file and renamed, so lookup never reads half written id.
+	cache_path(id_path, encInfo->cache_id, ".id");
+	snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", id_path, (int)getpid());
+	FILE *fptr = fopen(tmp_path, "w");
+	if(fptr == NULL)
+	{
+		return;
+	}
+	fprintf(fptr, "%016llx %llu %lld %ld\n", (unsigned long long)key, (unsigned long long)cached.st_size, (long long)cached.st_mtim.tv_sec, (long)cached.st_mtim.tv_nsec);
+	if(fclose(fptr) != 0 || rename(tmp_path, id_path) != 0)
+	{
+		remove(tmp_path);
+		return;
+	}
+
+	cache_touch(key_path);
+	print_info("INFO: Stored %s in cache as %s\n", encInfo->stego_image_fname, key_path);
+	cache_evict(strrchr(key_path, '/') + 1);
+}
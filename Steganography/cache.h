@@ -0,0 +1,48 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Encode Result Cache
+ *
+ *                              -> --cache=<dir> keeps encoded images in dir, so same secret file encoded again into same image is not redone.
+ *                              -> Cached images are content-addressed : <dir>/<key>.bmp, key is hash of (source image bytes,
+ *                                 secret file bytes, extension), source image hash is done along with read pass of encoding.
+ *                              -> <dir>/<id>.id maps source image file identity (device, inode, size, mtime, ctime) and secret file hash
+ *                                 to key, so a cache hit only stats source image and reads secret file, image pixels are not read.
+ *                              -> On hit cached image is copied to output (reflink where file system supports it), outputs and cached
+ *                                 images are never hard links, so writing one output in place doesn't change others.
+ *                              -> Cache size is bounded (--cache-max=<MB>, default 256 MB), least recently used images are removed first,
+ *                                 last use time is kept in atime of cached image.
+ *                              -> Encrypted encoding is never cached, since each encoding should have new nonce.
+ */
+
+
+
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+#include "encode.h"
+
+/* Default maximum size of cache in MB */
+#define CACHE_DEFAULT_MAX_MB 256
+
+/* Cache file name size (dir, '/', 16 hex digits, extension) */
+#define CACHE_PATH_SIZE 4096
+
+
+/* Cache function prototypes */
+
+/* Look up encoding in cache, and copy cached image to output if found (e_failure => not found, encode it) */
+Status cache_lookup(EncodeInfo *encInfo);
+
+/* Hash source image bytes read by encoding */
+void cache_hash_carrier(EncodeInfo *encInfo, const void *data, size_t len);
+
+/* Store output image of successful encoding in cache, and remove least recently used images over cache size */
+void cache_store(EncodeInfo *encInfo);
+
+#endif
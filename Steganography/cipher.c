@@ -0,0 +1,249 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Payload Encryption
+ *
+ *                              -> Secret file data can optionally be encrypted with ChaCha20 stream cipher (RFC 8439).
+ *                              -> Keystream is generated 64 bytes at a time and XORed into the same buffer that is given to LSB encoding.
+ *                              -> So encryption is done in the same pass as encoding and decryption in the same pass as decoding.
+ *                              -> Key is 32 bytes, read from key file (--key-file=<file>) or from STEGO_KEY environment variable.
+ *                              -> Key file can have 32 raw bytes or 64 hex characters, STEGO_KEY should have 64 hex characters.
+ *                              -> Random 12 byte nonce is generated for every encoding and stored in the stego header.
+ */
+
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/random.h>
+#include "cipher.h"
+#include "types.h"
+
+/* Function Definitions */
+
+#define ROTL32(v, n)	(((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTER_ROUND(a, b, c, d)			\
+	do						\
+	{						\
+		a += b; d ^= a; d = ROTL32(d, 16);	\
+		c += d; b ^= c; b = ROTL32(b, 12);	\
+		a += b; d ^= a; d = ROTL32(d, 8);	\
+		c += d; b ^= c; b = ROTL32(b, 7);	\
+	} while(0)
+
+/* Reads 4 bytes as little endian word */
+static uint32_t load32_le(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Generates one 64 byte keystream block and increments block counter */
+static void cipher_block(CipherCtx *ctx, uint8_t out[CIPHER_BLOCK_SIZE])
+{
+	uint32_t x[16];
+	memcpy(x, ctx->state, sizeof(x));
+
+	// 20 rounds => 10 column rounds + 10 diagonal rounds.
+	for(int i=0; i<10; i++)
+	{
+		QUARTER_ROUND(x[0], x[4], x[8],  x[12]);
+		QUARTER_ROUND(x[1], x[5], x[9],  x[13]);
+		QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+		QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+		QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+		QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+		QUARTER_ROUND(x[2], x[7], x[8],  x[13]);
+		QUARTER_ROUND(x[3], x[4], x[9],  x[14]);
+	}
+
+	for(int i=0; i<16; i++)
+	{
+		uint32_t v = x[i] + ctx->state[i];
+		out[4 * i]     = (uint8_t)v;
+		out[4 * i + 1] = (uint8_t)(v >> 8);
+		out[4 * i + 2] = (uint8_t)(v >> 16);
+		out[4 * i + 3] = (uint8_t)(v >> 24);
+	}
+
+	// block counter is word 12.
+	ctx->state[12]++;
+}
+
+
+
+/* Initialises ChaCha20 state with key and nonce, block counter starts from 0 */
+void cipher_init(CipherCtx *ctx, const uint8_t key[CIPHER_KEY_SIZE], const uint8_t nonce[CIPHER_NONCE_SIZE])
+{
+	// "expand 32-byte k" constant.
+	ctx->state[0] = 0x61707865;
+	ctx->state[1] = 0x3320646e;
+	ctx->state[2] = 0x79622d32;
+	ctx->state[3] = 0x6b206574;
+
+	for(int i=0; i<8; i++)
+	{
+		ctx->state[4 + i] = load32_le(key + 4 * i);
+	}
+
+	ctx->state[12] = 0;
+	ctx->state[13] = load32_le(nonce);
+	ctx->state[14] = load32_le(nonce + 4);
+	ctx->state[15] = load32_le(nonce + 8);
+
+	// no keystream generated yet.
+	ctx->keystream_used = CIPHER_BLOCK_SIZE;
+}
+
+
+
+/* XORs keystream into buffer, called for every block of secret data before encoding or after decoding */
+void cipher_xor(CipherCtx *ctx, uint8_t *buffer, size_t len)
+{
+	size_t i = 0;
+
+	// first use left over keystream bytes of previous call.
+	while(i < len && ctx->keystream_used < CIPHER_BLOCK_SIZE)
+	{
+		buffer[i++] ^= ctx->keystream[ctx->keystream_used++];
+	}
+
+	// full blocks are XORed 8 bytes at a time.
+	while(len - i >= CIPHER_BLOCK_SIZE)
+	{
+		uint64_t ks[CIPHER_BLOCK_SIZE / 8], data[CIPHER_BLOCK_SIZE / 8];
+		cipher_block(ctx, (uint8_t *)ks);
+		memcpy(data, buffer + i, CIPHER_BLOCK_SIZE);
+		for(int j=0; j<CIPHER_BLOCK_SIZE / 8; j++)
+		{
+			data[j] ^= ks[j];
+		}
+		memcpy(buffer + i, data, CIPHER_BLOCK_SIZE);
+		i += CIPHER_BLOCK_SIZE;
+	}
+
+	// tail, remaining keystream bytes are kept for next call.
+	if(i < len)
+	{
+		cipher_block(ctx, ctx->keystream);
+		ctx->keystream_used = 0;
+		while(i < len)
+		{
+			buffer[i++] ^= ctx->keystream[ctx->keystream_used++];
+		}
+	}
+}
+
+
+
+/* Moves keystream to byte offset, so blocks of data can be encrypted/decrypted in any order */
+void cipher_seek(CipherCtx *ctx, uint64_t offset)
+{
+	ctx->state[12] = (uint32_t)(offset / CIPHER_BLOCK_SIZE);
+	ctx->keystream_used = CIPHER_BLOCK_SIZE;
+
+	// if => offset is in middle of a block, then that block is generated and partly used.
+	if(offset % CIPHER_BLOCK_SIZE != 0)
+	{
+		cipher_block(ctx, ctx->keystream);
+		ctx->keystream_used = offset % CIPHER_BLOCK_SIZE;
+	}
+}
+
+
+
+/* Converts 64 hex characters to 32 byte key */
+static Status hex_to_key(const char *hex, size_t len, uint8_t key[CIPHER_KEY_SIZE])
+{
+	// trailing new line or spaces are ignored.
+	while(len > 0 && isspace((unsigned char)hex[len - 1]))
+	{
+		len--;
+	}
+
+	if(len != 2 * CIPHER_KEY_SIZE)
+	{
+		return e_failure;
+	}
+
+	for(int i=0; i<CIPHER_KEY_SIZE; i++)
+	{
+		unsigned int byte;
+		if(!isxdigit((unsigned char)hex[2 * i]) || !isxdigit((unsigned char)hex[2 * i + 1]) || sscanf(hex + 2 * i, "%2x", &byte) != 1)
+		{
+			return e_failure;
+		}
+		key[i] = (uint8_t)byte;
+	}
+	return e_success;
+}
+
+
+
+/* Loads key from key file, or from STEGO_KEY environment variable if key file is not given */
+Status cipher_load_key(const char *key_fname, uint8_t key[CIPHER_KEY_SIZE])
+{
+	// if => key file is not given, then key is taken from environment variable.
+	if(key_fname == NULL)
+	{
+		const char *env = getenv(CIPHER_KEY_ENV);
+		if(env == NULL)
+		{
+			printf("ERROR: Encryption key not given. Use --key-file=<file> or set %s.\n", CIPHER_KEY_ENV);
+			return e_failure;
+		}
+		if(hex_to_key(env, strlen(env), key) == e_failure)
+		{
+			printf("ERROR: %s should contain 64 hex characters.\n", CIPHER_KEY_ENV);
+			return e_failure;
+		}
+		return e_success;
+	}
+
+	FILE *fptr_key = fopen(key_fname, "rb");
+	if(fptr_key == NULL)
+	{
+		perror("fopen");
+		fprintf(stderr, "ERROR: Unable to open file %s\n", key_fname);
+		return e_failure;
+	}
+
+	// one extra byte is read to find key files which are too long.
+	char buffer[2 * CIPHER_KEY_SIZE + 3];
+	size_t len = fread(buffer, 1, sizeof(buffer), fptr_key);
+	fclose(fptr_key);
+
+	// 32 raw bytes.
+	if(len == CIPHER_KEY_SIZE)
+	{
+		memcpy(key, buffer, CIPHER_KEY_SIZE);
+		return e_success;
+	}
+
+	// 64 hex characters.
+	if(len < sizeof(buffer) && hex_to_key(buffer, len, key) == e_success)
+	{
+		return e_success;
+	}
+
+	printf("ERROR: Key file %s should contain 32 raw bytes or 64 hex characters.\n", key_fname);
+	return e_failure;
+}
+
+
+
+/* Generates random nonce, so same key can be used for many images */
+Status cipher_make_nonce(uint8_t nonce[CIPHER_NONCE_SIZE])
+{
+	if(getrandom(nonce, CIPHER_NONCE_SIZE, 0) != CIPHER_NONCE_SIZE)
+	{
+		perror("getrandom");
+		return e_failure;
+	}
+	return e_success;
+}
@@ -0,0 +1,63 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Payload Encryption
+ *
+ *                              -> Secret file data can optionally be encrypted with ChaCha20 stream cipher (RFC 8439).
+ *                              -> Keystream is generated 64 bytes at a time and XORed into the same buffer that is given to LSB encoding.
+ *                              -> So encryption is done in the same pass as encoding and decryption in the same pass as decoding.
+ *                              -> Key is 32 bytes, read from key file (--key-file=<file>) or from STEGO_KEY environment variable.
+ *                              -> Key file can have 32 raw bytes or 64 hex characters, STEGO_KEY should have 64 hex characters.
+ *                              -> Random 12 byte nonce is generated for every encoding and stored in the stego header.
+ */
+
+
+
+
+#ifndef CIPHER_H
+#define CIPHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+
+#define CIPHER_KEY_SIZE		32
+#define CIPHER_NONCE_SIZE	12
+#define CIPHER_BLOCK_SIZE	64
+
+/* Environment variable checked for key, when key file is not given */
+#define CIPHER_KEY_ENV		"STEGO_KEY"
+
+/*
+ * ChaCha20 state, keeps track of block counter and
+ * unused keystream bytes of last generated block
+ */
+typedef struct _CipherCtx
+{
+    uint32_t state[16];				// => key, nonce and block counter
+    uint8_t keystream[CIPHER_BLOCK_SIZE];	// => last generated keystream block
+    uint32_t keystream_used;			// => no. of bytes already used from keystream
+
+} CipherCtx;
+
+
+/* Cipher function prototypes */
+
+/* Initialise ChaCha20 state with key and nonce */
+void cipher_init(CipherCtx *ctx, const uint8_t key[CIPHER_KEY_SIZE], const uint8_t nonce[CIPHER_NONCE_SIZE]);
+
+/* XOR keystream into buffer (same call encrypts and decrypts) */
+void cipher_xor(CipherCtx *ctx, uint8_t *buffer, size_t len);
+
+/* Move keystream to byte offset, for blocks of data done out of order */
+void cipher_seek(CipherCtx *ctx, uint64_t offset);
+
+/* Load key from key file or from environment variable */
+Status cipher_load_key(const char *key_fname, uint8_t key[CIPHER_KEY_SIZE]);
+
+/* Generate random nonce */
+Status cipher_make_nonce(uint8_t nonce[CIPHER_NONCE_SIZE]);
+
+#endif
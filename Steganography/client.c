@@ -0,0 +1,459 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Stego Daemon Client
+ *
+ *                              -> Requests are sent with sendmsg and fds in SCM_RIGHTS, replies are read with recvmsg.
+ *                              -> stego_client_encode/decode/query send one request and wait for its reply.
+ *                              -> stego_client_send/receive can be used to keep many requests in flight on one connection.
+ *                              -> For -e, output image is made as copy of source image (copy_file_range, no user space copy),
+ *                                 then daemon encodes it in place, output is removed if daemon fails.
+ *                              -> For -d, decoded secret data memfd is copied to output file with copy_file_range.
+ */
+
+
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "client.h"
+#include "stegod.h"
+#include "lsb.h"
+#include "png.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Connect to daemon socket */
+Status stego_client_connect(StegoClient *client, const char *socket_path)
+{
+	struct sockaddr_un addr;
+
+	if(strlen(socket_path) >= sizeof(addr.sun_path))
+	{
+		printf("ERROR: Socket path %s is too long.\n", socket_path);
+		return e_failure;
+	}
+
+	client->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	client->next_id = 1;
+	if(client->fd == -1)
+	{
+		perror("socket");
+		return e_failure;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socket_path);
+	if(connect(client->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+	{
+		printf("ERROR: Unable to connect to daemon %s : %s\n", socket_path, strerror(errno));
+		close(client->fd);
+		client->fd = -1;
+		return e_failure;
+	}
+
+	return e_success;
+}
+
+/* Close connection */
+void stego_client_close(StegoClient *client)
+{
+	if(client->fd != -1)
+	{
+		close(client->fd);
+		client->fd = -1;
+	}
+}
+
+/* Send request with carrier fd and secret data fd (-1 if not needed), returns request id */
+Status stego_client_send(StegoClient *client, uint32_t op, uint32_t flags, const char *extn, int carrier_fd, int secret_fd, uint64_t *id)
+{
+	StegodRequest req;
+	int fds[2] = { carrier_fd, secret_fd };
+	int nfds = (secret_fd != -1) ? 2 : 1;
+
+	memset(&req, 0, sizeof(req));
+	req.magic = STEGOD_MAGIC;
+	req.op = op;
+	req.id = client->next_id++;
+	req.flags = flags;
+	if(extn != NULL)
+	{
+		if(strlen(extn) > STEGO_EXTN_MAX)
+		{
+			printf("ERROR: Secret file extension %s is too long.\n", extn);
+			return e_failure;
+		}
+		strcpy(req.extn, extn);
+	}
+
+	struct iovec iov = { &req, sizeof(req) };
+	union
+	{
+		struct cmsghdr hdr;
+		char buf[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+	struct msghdr msg;
+
+	memset(&msg, 0, sizeof(msg));
+	memset(&control, 0, sizeof(control));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = CMSG_SPACE(nfds * sizeof(int));
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(nfds * sizeof(int));
+	memcpy(CMSG_DATA(cmsg), fds, nfds * sizeof(int));
+
+	if(sendmsg(client->fd, &msg, MSG_NOSIGNAL) != sizeof(req))
+	{
+		printf("ERROR: Unable to send request to daemon : %s\n", strerror(errno));
+		return e_failure;
+	}
+
+	if(id != NULL)
+	{
+		*id = req.id;
+	}
+	return e_success;
+}
+
+/* Receive next reply, secret data memfd of decode is stored in secret_fd (-1 if none) */
+Status stego_client_receive(StegoClient *client, StegodReply *reply, int *secret_fd)
+{
+	struct iovec iov = { reply, sizeof(*reply) };
+	union
+	{
+		struct cmsghdr hdr;
+		char buf[CMSG_SPACE(sizeof(int))];
+	} control;
+	struct msghdr msg;
+	int fd = -1;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	ssize_t n = recvmsg(client->fd, &msg, MSG_CMSG_CLOEXEC);
+	for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); n > 0 && cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+	{
+		if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+		{
+			memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+		}
+	}
+
+	if(n != sizeof(*reply) || reply->magic != STEGOD_MAGIC)
+	{
+		printf("ERROR: Invalid reply from daemon.\n");
+		if(fd != -1)
+		{
+			close(fd);
+		}
+		return e_failure;
+	}
+	reply->error[STEGOD_ERROR_SIZE - 1] = '\0';
+	reply->extn[STEGO_EXTN_MAX] = '\0';
+
+	if(secret_fd != NULL)
+	{
+		*secret_fd = fd;
+	}
+	else if(fd != -1)
+	{
+		close(fd);
+	}
+	return e_success;
+}
+
+/* Send one request and wait for its reply */
+static Status client_request(StegoClient *client, uint32_t op, uint32_t flags, const char *extn, int carrier_fd, int secret_fd, StegodReply *reply, int *out_fd)
+{
+	if(stego_client_send(client, op, flags, extn, carrier_fd, secret_fd, NULL) == e_failure)
+	{
+		return e_failure;
+	}
+	if(stego_client_receive(client, reply, out_fd) == e_failure)
+	{
+		return e_failure;
+	}
+	return (reply->status == e_success) ? e_success : e_failure;
+}
+
+/* Encode secret data into carrier in place, and wait for reply */
+Status stego_client_encode(StegoClient *client, int carrier_fd, int secret_fd, const char *extn, uint32_t flags, StegodReply *reply)
+{
+	return client_request(client, STEGOD_ENCODE, flags, extn, carrier_fd, secret_fd, reply, NULL);
+}
+
+/* Decode secret data from carrier into new memfd, and wait for reply */
+Status stego_client_decode(StegoClient *client, int carrier_fd, int *secret_fd, StegodReply *reply)
+{
+	*secret_fd = -1;
+	return client_request(client, STEGOD_DECODE, 0, NULL, carrier_fd, -1, reply, secret_fd);
+}
+
+/* Decode only header of carrier, and wait for reply */
+Status stego_client_query(StegoClient *client, int carrier_fd, StegodReply *reply)
+{
+	return client_request(client, STEGOD_QUERY, 0, NULL, carrier_fd, -1, reply, NULL);
+}
+
+/* Create memfd of len bytes, for carriers and secret data which are already in memory */
+int stego_client_memfd(const char *name, uint64_t len)
+{
+	// memfd is sealed against shrinking, so daemon can map it instead of copying it.
+	int fd = memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if(fd != -1 && (ftruncate(fd, len) != 0 || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) != 0))
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/* Copy len bytes of in_fd to out_fd from start, with copy_file_range and read/write if it is not supported */
+static Status copy_fd(int in_fd, int out_fd, uint64_t len)
+{
+	uint64_t done = 0;
+	loff_t in_off = 0, out_off = 0;
+
+	while(done < len)
+	{
+		ssize_t n = copy_file_range(in_fd, &in_off, out_fd, &out_off, len - done, 0);
+		if(n <= 0)
+		{
+			break;
+		}
+		done += n;
+	}
+
+	// if => copy_file_range is not supported for these files, then rest is copied through buffer.
+	char buffer[64 * 1024];
+	while(done < len)
+	{
+		ssize_t n = pread(in_fd, buffer, sizeof(buffer), done);
+		if(n <= 0 || pwrite(out_fd, buffer, n, done) != n)
+		{
+			return e_failure;
+		}
+		done += n;
+	}
+
+	return e_success;
+}
+
+/* Performs the encoding with daemon (--connect) */
+Status client_encoding(char *argv[], EncodeInfo *encInfo)
+{
+	StegoClient client;
+	StegodReply reply;
+	struct stat st;
+
+	// daemon maps bmp files directly, so .png images can't be given to it.
+	if(png_is_png(encInfo->src_image_fname) || png_is_png(encInfo->stego_image_fname))
+	{
+		fprintf(stderr, "ERROR: .png image can't be used with --connect.\n");
+		return e_failure;
+	}
+
+	// daemon encodes in all carrier bytes, so channel mask can't be asked.
+	if(options.channels != 0 && options.channels != CHANNEL_ALL)
+	{
+		fprintf(stderr, "ERROR: --channels can't be used with --connect.\n");
+		return e_failure;
+	}
+
+	// daemon encodes plain secret data, so Reed-Solomon parity can't be asked.
+	if(options.ecc_parity != 0)
+	{
+		fprintf(stderr, "ERROR: --ecc can't be used with --connect.\n");
+		return e_failure;
+	}
+
+	// daemon maps secret file, so it can't be stdin or a pipe.
+	if(strcmp(encInfo->secret_fname, "-") == 0 || (stat(encInfo->secret_fname, &st) == 0 && !S_ISREG(st.st_mode)))
+	{
+		fprintf(stderr, "ERROR: Streamed secret file can't be used with --connect.\n");
+		return e_failure;
+	}
+
+	print_info("INFO: ## Encoding Procedure Started (daemon %s) ##\n", options.connect_socket);
+	int src_fd = open(encInfo->src_image_fname, O_RDONLY | O_CLOEXEC);
+	if(src_fd == -1 || fstat(src_fd, &st) != 0)
+	{
+		fprintf(stderr, "ERROR: Unable to open file %s\n", encInfo->src_image_fname);
+		return e_failure;
+	}
+	int secret_fd = open(encInfo->secret_fname, O_RDONLY | O_CLOEXEC);
+	if(secret_fd == -1)
+	{
+		fprintf(stderr, "ERROR: Unable to open file %s\n", encInfo->secret_fname);
+		close(src_fd);
+		return e_failure;
+	}
+
+	if(stego_client_connect(&client, options.connect_socket) == e_failure)
+	{
+		close(src_fd);
+		close(secret_fd);
+		return e_failure;
+	}
+
+	if(argv[4] == NULL)
+	{
+		print_info("INFO: Output File not mentioned. Creating %s as default\n", encInfo->stego_image_fname);
+	}
+	else
+	{
+		print_info("INFO: Creating %s as encoded output image file.\n", encInfo->stego_image_fname);
+	}
+
+	// output image is copy of source image, daemon encodes it in place.
+	Status status = e_failure;
+	reply.magic = 0;
+	int out_fd = open(encInfo->stego_image_fname, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(out_fd == -1)
+	{
+		fprintf(stderr, "ERROR: Unable to open file %s\n", encInfo->stego_image_fname);
+	}
+	else if(copy_fd(src_fd, out_fd, st.st_size) == e_failure)
+	{
+		printf("ERROR: Unable to copy %s to %s.\n", encInfo->src_image_fname, encInfo->stego_image_fname);
+	}
+	else if(stego_client_encode(&client, out_fd, secret_fd, encInfo->extn_secret_file, options.encrypt ? FLAG_ENCRYPTED : 0, &reply) == e_failure)
+	{
+		if(reply.magic == STEGOD_MAGIC)
+		{
+			printf("ERROR: Daemon : %s\n", reply.error);
+		}
+	}
+	else
+	{
+		print_info("INFO: Encoded %llu bytes of %s (capacity %llu bytes)\n", (unsigned long long)reply.data_size, encInfo->secret_fname, (unsigned long long)reply.capacity);
+		status = e_success;
+	}
+
+	if(out_fd != -1)
+	{
+		close(out_fd);
+		if(status == e_failure)
+		{
+			remove(encInfo->stego_image_fname);
+		}
+	}
+	stego_client_close(&client);
+	close(src_fd);
+	close(secret_fd);
+	return status;
+}
+
+/* Performs the decoding with daemon (--connect) */
+Status client_decoding(char *argv[], DecodeInfo *decInfo)
+{
+	StegoClient client;
+	StegodReply reply;
+	int secret_fd = -1;
+
+	print_info("INFO: ## Decoding Procedure Started (daemon %s) ##\n", options.connect_socket);
+	// if => image is stdin or a pipe, then daemon can't map it, so it is decoded without daemon.
+	if(decode_is_stream(decInfo->image_fname))
+	{
+		printf("ERROR: Streamed image can't be used with --connect.\n");
+		return e_failure;
+	}
+	// daemon maps bmp files directly, so .png images can't be given to it.
+	if(png_is_png(decInfo->image_fname))
+	{
+		fprintf(stderr, "ERROR: .png image can't be used with --connect.\n");
+		return e_failure;
+	}
+	int image_fd = open(decInfo->image_fname, O_RDONLY | O_CLOEXEC);
+	if(image_fd == -1)
+	{
+		fprintf(stderr, "ERROR: Unable to open file %s\n", decInfo->image_fname);
+		return e_failure;
+	}
+
+	if(stego_client_connect(&client, options.connect_socket) == e_failure)
+	{
+		close(image_fd);
+		return e_failure;
+	}
+
+	reply.magic = 0;
+	if(stego_client_decode(&client, image_fd, &secret_fd, &reply) == e_failure)
+	{
+		if(reply.magic == STEGOD_MAGIC)
+		{
+			printf("ERROR: Daemon : %s\n", reply.error);
+		}
+		stego_client_close(&client);
+		close(image_fd);
+		return e_failure;
+	}
+	stego_client_close(&client);
+	close(image_fd);
+
+	// output file name is given name and decoded extension.
+	char fname[strlen(decInfo->secret_fname) + strlen(reply.extn) + 1];
+	strcpy(fname, decInfo->secret_fname);
+	strcat(fname, reply.extn);
+	if(argv[3] == NULL)
+	{
+		print_info("INFO: Output File not mentioned. Creating %s as default\n", fname);
+	}
+	else
+	{
+		print_info("INFO: Creating %s as decoded output file.\n", fname);
+	}
+
+	Status status = e_failure;
+	int out_fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(out_fd == -1)
+	{
+		fprintf(stderr, "ERROR: Unable to open file %s\n", fname);
+	}
+	else if(secret_fd == -1 || copy_fd(secret_fd, out_fd, reply.data_size) == e_failure)
+	{
+		printf("ERROR: Unable to write %s.\n", fname);
+	}
+	else
+	{
+		print_info("INFO: Decoded %llu bytes into %s\n", (unsigned long long)reply.data_size, fname);
+		status = e_success;
+	}
+
+	if(out_fd != -1)
+	{
+		close(out_fd);
+		if(status == e_failure)
+		{
+			remove(fname);
+		}
+	}
+	if(secret_fd != -1)
+	{
+		close(secret_fd);
+	}
+	return status;
+}
@@ -0,0 +1,72 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Stego Daemon Client
+ *
+ *                              -> Client library for stego daemon (stegod.h), other programs can link client.c and stegod.h only.
+ *                              -> Carrier and secret data are passed as fds (file or memfd), nothing is copied on socket. Daemon maps
+ *                                 memfds of stego_client_memfd() (sealed against shrinking), and reads/writes other fds with pread/pwrite.
+ *                              -> Requests can be sent one after other on same connection, replies are matched by request id.
+ *                              -> --connect=<socket_path> makes -e/-d of this program use a running daemon instead of encoding itself,
+ *                                 output image is copied from source image with copy_file_range and daemon encodes it in place.
+ */
+
+
+
+
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+#include "stegod.h"
+#include "encode.h"
+#include "decode.h"
+
+/*
+ * Connection to daemon
+ */
+
+typedef struct _StegoClient
+{
+    int fd;				// => connected socket
+    uint64_t next_id;			// => id of next request
+
+} StegoClient;
+
+
+/* Client function prototypes */
+
+/* Connect to daemon socket */
+Status stego_client_connect(StegoClient *client, const char *socket_path);
+
+/* Close connection */
+void stego_client_close(StegoClient *client);
+
+/* Send request with carrier fd and secret data fd (-1 if not needed), returns request id */
+Status stego_client_send(StegoClient *client, uint32_t op, uint32_t flags, const char *extn, int carrier_fd, int secret_fd, uint64_t *id);
+
+/* Receive next reply, secret data memfd of decode is stored in secret_fd (-1 if none) */
+Status stego_client_receive(StegoClient *client, StegodReply *reply, int *secret_fd);
+
+/* Encode secret data into carrier in place, and wait for reply */
+Status stego_client_encode(StegoClient *client, int carrier_fd, int secret_fd, const char *extn, uint32_t flags, StegodReply *reply);
+
+/* Decode secret data from carrier into new memfd, and wait for reply */
+Status stego_client_decode(StegoClient *client, int carrier_fd, int *secret_fd, StegodReply *reply);
+
+/* Decode only header of carrier, and wait for reply */
+Status stego_client_query(StegoClient *client, int carrier_fd, StegodReply *reply);
+
+/* Create memfd of len bytes sealed against shrinking (daemon maps it), for carriers and secret data which are already in memory */
+int stego_client_memfd(const char *name, uint64_t len);
+
+/* Performs the encoding with daemon (--connect) */
+Status client_encoding(char *argv[], EncodeInfo *encInfo);
+
+/* Performs the decoding with daemon (--connect) */
+Status client_decoding(char *argv[], DecodeInfo *decInfo);
+
+#endif
@@ -49,4 +49,28 @@
 /* Magic string to identify whether stegged or not */
 #define MAGIC_STRING "#*"
 
+/* Magic string of extended header, it is followed by version byte */
+#define MAGIC_STRING_EXT "#+"
+
+/* Extended header versions, images are encoded with HEADER_VERSION, older ones are still decoded */
+#define HEADER_VERSION_FIXED 1		// => flags byte, 32-bit extension size and size fields (and "#*" header without flags)
+#define HEADER_VERSION 2		// => flags, extension size and size fields are varints
+
+/* Max. no. of bytes of a varint (64-bit value, 7 bits per byte), streamed secret file size is padded to it so it can be patched */
+#define VARINT_MAX_SIZE 10
+
+/* Extended header flags */
+#define FLAG_ENCRYPTED 0x01		// => secret data is encrypted, 12 bytes nonce follows flags
+#define FLAG_CHANNELS 0x02		// => secret data is only in channels of mask byte, which follows nonce (or flags)
+#define FLAG_ECC 0x04			// => secret data is Reed-Solomon codewords, parity bytes per codeword follow mask byte
+
+/* Secret file size field value of header version 1 which says 64-bit size follows (for sizes of 4 GB and more) */
+#define SIZE_FIELD_EXTENDED 0xFFFFFFFFu
+
+/* Secret data is read/written in blocks of this size */
+#define SECRET_BLOCK_SIZE 4096
+
+/* Left over image data is copied in blocks of this size */
+#define COPY_BLOCK_SIZE (64 * 1024)
+
 #endif
@@ -42,11 +42,24 @@
 
 
 
+#define _FILE_OFFSET_BITS 64	// 64-bit file offsets, for images bigger than 2 GB
+
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 #include "decode.h"
 #include "types.h"
 #include "common.h"
+#include "options.h"
+#include "stats.h"
+#include "pipeline.h"
+#include "stego.h"
+#include "lsb.h"
+#include "rs.h"
+#include "delta.h"
+#include "lsbplane.h"
+#include "pushdec.h"
+#include "png.h"
 
 /* Function Definitions */
 
@@ -56,9 +69,26 @@
  */
 Status open_img_file(DecodeInfo *decInfo)
 {
-	printf("INFO: Opening required image file\n");
+	// if => --delta, then image file is made from carrier and delta file.
+	if(options.delta_fname != NULL)
+	{
+		// delta file has carrier bytes of bmp carrier image.
+		if(png_is_png(decInfo->image_fname))
+		{
+			printf("ERROR: .png image can't be used with --delta.\n");
+			return e_failure;
+		}
+		return delta_open_image(decInfo, options.delta_fname);
+	}
+
+	print_info("INFO: Opening required image file\n");
 	
-    	// Image file
+    	// Image file (.png is decoded into 32 bpp bmp temp file)
+	int alpha;
+	if(png_is_png(decInfo->image_fname))
+	{
+		return png_open_image(decInfo->image_fname, &decInfo->fptr_image, &alpha);
+	}
     	decInfo->fptr_image = fopen(decInfo->image_fname, "rb");
     	// Do Error handling
     	if(decInfo->fptr_image == NULL)
@@ -67,7 +97,7 @@ Status open_img_file(DecodeInfo *decInfo)
         	fprintf(stderr, "ERROR: Unable to open file %s\n", decInfo->image_fname);
         	return e_failure;
     	}
-	printf("INFO: Opened %s\n", decInfo->image_fname);
+	print_info("INFO: Opened %s\n", decInfo->image_fname);
     	
 	// No failure return e_success
     	return e_success;
@@ -78,15 +108,15 @@ Status open_img_file(DecodeInfo *decInfo)
 /* Reads and validates Decode args from argv */
 Status read_and_validate_decode_args(char *argv[], DecodeInfo *decInfo)
 {
-	// if => 3rd command-line argument doesn't contain extention, then print error and return e_failure.
-	if(strstr(argv[2], ".") == NULL)
+	// if => 3rd command-line argument doesn't contain extention (and is not "-" for stdin), then print error and return e_failure.
+	if(strcmp(argv[2], "-") != 0 && strstr(argv[2], ".") == NULL)
 	{
-		printf("ERROR: Entered %s is not .bmp file.\n", argv[2]);
+		printf("ERROR: Entered %s is not .bmp/.png file.\n", argv[2]);
 		return e_failure;
 	}
 
-	// if => argv[2] is .bmp file then if condition is true else print error and return e_failure.
-	if(strcmp(strstr(argv[2], "."), ".bmp") == 0)
+	// if => argv[2] is .bmp (or .png) file (or "-" for stdin) then if condition is true else print error and return e_failure.
+	if(strcmp(argv[2], "-") == 0 || strcmp(strstr(argv[2], "."), ".bmp") == 0 || png_is_png(argv[2]))
 	{
 		decInfo->image_fname = argv[2];
 	
@@ -113,42 +143,66 @@ Status read_and_validate_decode_args(char *argv[], DecodeInfo *decInfo)
 			}
 		}	
 	}
-	printf("ERROR: Entered %s is not .bmp file.\n", argv[2]);
+	printf("ERROR: Entered %s is not .bmp/.png file.\n", argv[2]);
 	return e_failure;
 }
 
+/* Checks whether image is stdin ("-") or a pipe/socket, which can only be read in order */
+int decode_is_stream(const char *image_fname)
+{
+	struct stat st;
+	if(strcmp(image_fname, "-") == 0)
+	{
+		return 1;
+	}
+	return stat(image_fname, &st) == 0 && (S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode));
+}
+
 /* Performs the decoding */
 Status do_decoding(char *argv[], DecodeInfo *decInfo)
 {
-	printf("INFO: ## Decoding Procedure Started ##\n");
+	print_info("INFO: ## Decoding Procedure Started ##\n");
+	// if => image is stdin or a pipe, then it can't be read with fseek()/fread() stages, so it is decoded as it arrives with push decoder.
+	// .png pipe is read whole and decoded into temp file instead.
+	if(!png_is_png(decInfo->image_fname) && decode_is_stream(decInfo->image_fname))
+	{
+		if(options.delta_fname != NULL)
+		{
+			printf("ERROR: --delta can't be used with a streamed image.\n");
+			return e_failure;
+		}
+		return STATS_STAGE("decode_stream", decode_stream(decInfo));
+	}
 	// open_img_file() function is called and if => e_success.
-	if(open_img_file(decInfo) == e_success)
+	if(STATS_STAGE("open_img_file", open_img_file(decInfo)) == e_success)
 	{
 		// skip_bmp_header() function is called and if => e_success.
-		if(skip_bmp_header(decInfo) == e_success)
+		if(STATS_STAGE("skip_bmp_header", skip_bmp_header(decInfo)) == e_success)
 		{
 			// decode_magic_string() function is called and if => e_success.
-			if(decode_magic_string(decInfo) == e_success)
+			if(STATS_STAGE("decode_magic_string", decode_magic_string(decInfo)) == e_success)
 			{
 				// decode_secret_file_extn_size() function is called and if => e_success.
-				if(decode_secret_file_extn_size(decInfo) == e_success)
+				if(STATS_STAGE("decode_secret_file_extn_size", decode_secret_file_extn_size(decInfo)) == e_success)
 				{
 					// decode_secret_file_extn() function is called and if => e_success.
-					if(decode_secret_file_extn(decInfo->secret_file_extn_size, decInfo, argv) == e_success)
+					if(STATS_STAGE("decode_secret_file_extn", decode_secret_file_extn(decInfo->secret_file_extn_size, decInfo, argv)) == e_success)
 					{
 						// decode_secret_file_size() function is called and if => e_success.
-						if(decode_secret_file_size(decInfo) == e_success)
+						if(STATS_STAGE("decode_secret_file_size", decode_secret_file_size(decInfo)) == e_success)
 						{
-							// decode_secret_file_data() function is called and if => e_success.
-							if(decode_secret_file_data(decInfo->secret_file_size, decInfo) == e_success)
+							// decode_secret_file_data() (or decode_pipeline() for --engine=pipeline, 24 bpp, no LSB plane, no channel mask and no ECC) function is called and if => e_success.
+							if(STATS_STAGE("decode_secret_file_data", (options.engine == ENGINE_PIPELINE && decInfo->pixel_format == e_bgr24 && decInfo->plane == NULL && decInfo->channel_mask == 0 && decInfo->ecc_parity == 0) ? decode_pipeline(decInfo->secret_file_size, decInfo) : decode_secret_file_data(decInfo->secret_file_size, decInfo)) == e_success)
 							{
 								fclose(decInfo->fptr_image);	
+								plane_close(decInfo);
 								fclose(decInfo->fptr_secret);	
 								return e_success;
 							}
 							else
 							{
 								fclose(decInfo->fptr_image);	
+								plane_close(decInfo);
 								fclose(decInfo->fptr_secret);	
 								remove(decInfo->secret_fname);
 								return e_failure;
@@ -157,6 +211,7 @@ Status do_decoding(char *argv[], DecodeInfo *decInfo)
 						else
 						{
 							fclose(decInfo->fptr_image);	
+							plane_close(decInfo);
 							fclose(decInfo->fptr_secret);	
 							remove(decInfo->secret_fname);
 							return e_failure;
@@ -165,24 +220,28 @@ Status do_decoding(char *argv[], DecodeInfo *decInfo)
 					else
 					{
 						fclose(decInfo->fptr_image);	
+						plane_close(decInfo);
 						return e_failure;
 					}
 				}
 				else
 				{
 					fclose(decInfo->fptr_image);	
+					plane_close(decInfo);
 					return e_failure;
 				}
 			}
 			else
 			{
 				fclose(decInfo->fptr_image);	
+				plane_close(decInfo);
 				return e_failure;
 			}
 		}
 		else
 		{
 			fclose(decInfo->fptr_image);	
+			plane_close(decInfo);
 			return e_failure;
 		}
 	}
@@ -192,18 +251,34 @@ Status do_decoding(char *argv[], DecodeInfo *decInfo)
 
 
 
-/* Skips bmp image header */
+/* Skips bmp image header, pixel format is taken from it */
 Status skip_bmp_header(DecodeInfo *decInfo)
 {
-	// skips 54 bytes of bmp header in fptr_image file pointer.
-	int fs = fseek(decInfo->fptr_image, 54, SEEK_CUR);
-	// if 54 bytes are not skiped, then print error and return e_failure.
-	if(fs != 0)
+	// no LSB plane till it is opened.
+	decInfo->plane_map = NULL;
+
+	// reads 54 bytes of bmp header from fptr_image file pointer.
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+	int r = fread(bmp_header, BMP_HEADER_SIZE, 1, decInfo->fptr_image);
+	// if 54 bytes are not read, then print error and return e_failure.
+	if(r != 1)
 	{
 		printf("ERROR: No 54 - bytes header in %s file.\n", decInfo->image_fname);
 		return e_failure;
 	}
 
+	// if => not 24, 32 or 16 bpp, then nothing can be encoded in it.
+	if(stego_bmp_format(bmp_header, &decInfo->pixel_format, &decInfo->data_offset) == e_failure)
+	{
+		printf("ERROR: %s is not a 24, 32 or 16 bpp uncompressed bmp image.\n", decInfo->image_fname);
+		return e_failure;
+	}
+	decInfo->bits_decoded = 0;
+	decInfo->data_bit = UINT64_MAX;
+
+	// if => --plane-cache, then payload bytes are taken from LSB plane of image (pixels are read only if not cached).
+	plane_open(decInfo);
+
 	return e_success;
 }
 
@@ -213,26 +288,32 @@ Status skip_bmp_header(DecodeInfo *decInfo)
 /* Decodes Magic String */
 Status decode_magic_string(DecodeInfo *decInfo)
 {
-	printf("INFO: Decoding Magic String Signature\n");
+	print_info("INFO: Decoding Magic String Signature\n");
 	
+	decInfo->header_version = HEADER_VERSION_FIXED;
+	decInfo->header_flags = 0;
+	decInfo->channel_mask = 0;
+	decInfo->ecc_parity = 0;
+
 	char magic_string[3];
-	for(int i=0; i<2; i++)
+	// decode_data_from_image() function is called and if => e_failure.
+	if(decode_data_from_image(magic_string, 2, decInfo) == e_failure)
 	{
-		char image_buffer[9];
-		int r = fread(image_buffer, (sizeof(image_buffer) - 1), 1, decInfo->fptr_image);
-		image_buffer[8] = '\0';
+		printf("ERROR: Unable to read %s file to decode magic string.\n", decInfo->image_fname);
+		return e_failure;
+	}
+	magic_string[2] = '\0';
 
-		// if fread doesn't read 8 bytes, then r will be 0 else r will be 1.
-		if(r == 0)
+	// if => extended header magic string, then version and flags are decoded next.
+	if(strcmp(magic_string, MAGIC_STRING_EXT) == 0)
+	{
+		if(decode_header_flags(decInfo) == e_failure)
 		{
-			printf("ERROR: Unable to read %s file to decode magic string.\n", decInfo->image_fname);
 			return e_failure;
 		}
-		
-		// decoded character data from image_buffer is stored in magic_string of ith index.
-		magic_string[i] = decode_char_bytes_from_lsb(image_buffer);		// decode_char_bytes_from_lsb() function is called.
+		print_info("INFO: Done\n");
+		return e_success;
 	}
-	magic_string[2] = '\0';
 
 	// if => decoded magic string is not equal to original magic string then print error and return e_failure.
 	if(strcmp(magic_string, MAGIC_STRING) != 0)
@@ -241,29 +322,166 @@ Status decode_magic_string(DecodeInfo *decInfo)
 		return e_failure;
 	}
 	
-	printf("INFO: Done\n");
+	print_info("INFO: Done\n");
+	return e_success;
+}
+
+
+
+
+/* Decodes extended header version, flags, nonce (if encrypted), channel mask and ECC parity bytes */
+Status decode_header_flags(DecodeInfo *decInfo)
+{
+	char header[2];
+	if(decode_data_from_image(header, 2, decInfo) == e_failure)
+	{
+		printf("ERROR: Unable to read %s file to decode header flags.\n", decInfo->image_fname);
+		return e_failure;
+	}
+
+	// if => header is written by newer version, then it can't be decoded.
+	if(header[0] != HEADER_VERSION && header[0] != HEADER_VERSION_FIXED)
+	{
+		printf("ERROR: Unsupported header version %d in %s.\n", header[0], decInfo->image_fname);
+		return e_failure;
+	}
+	decInfo->header_version = header[0];
+
+	// if => unknown flags are set (or flags varint is longer than 1 byte), then it can't be decoded.
+	decInfo->header_flags = header[1];
+	if((uint8_t)header[1] & ~(FLAG_ENCRYPTED | FLAG_CHANNELS | FLAG_ECC))
+	{
+		printf("ERROR: Unsupported header flags 0x%02x in %s.\n", (uint8_t)header[1], decInfo->image_fname);
+		return e_failure;
+	}
+
+	// if => encrypted, then nonce is decoded and key is loaded.
+	if(decInfo->header_flags & FLAG_ENCRYPTED)
+	{
+		print_info("INFO: Secret data is encrypted. Loading decryption key\n");
+		char nonce[CIPHER_NONCE_SIZE];
+		if(decode_data_from_image(nonce, CIPHER_NONCE_SIZE, decInfo) == e_failure)
+		{
+			printf("ERROR: Unable to read %s file to decode nonce.\n", decInfo->image_fname);
+			return e_failure;
+		}
+
+		uint8_t key[CIPHER_KEY_SIZE];
+		if(cipher_load_key(options.key_fname, key) == e_failure)
+		{
+			return e_failure;
+		}
+		cipher_init(&decInfo->cipher, key, (uint8_t *)nonce);
+		memset(key, 0, sizeof(key));
+	}
+
+	// if => secret data is only in some channels, then channel mask is decoded.
+	if(decInfo->header_flags & FLAG_CHANNELS)
+	{
+		char mask;
+		if(decode_data_from_image(&mask, 1, decInfo) == e_failure)
+		{
+			printf("ERROR: Unable to read %s file to decode channel mask.\n", decInfo->image_fname);
+			return e_failure;
+		}
+		if(mask == 0 || (mask & ~CHANNEL_ALL) != 0 || mask == CHANNEL_ALL || decInfo->pixel_format == e_rgb16)
+		{
+			printf("ERROR: Unsupported channel mask 0x%02x in %s.\n", (uint8_t)mask, decInfo->image_fname);
+			return e_failure;
+		}
+		decInfo->channel_mask = mask;
+		print_info("INFO: Secret data is in channels 0x%02x only\n", decInfo->channel_mask);
+	}
+
+	// if => secret data is Reed-Solomon coded, then parity bytes per codeword are decoded.
+	if(decInfo->header_flags & FLAG_ECC)
+	{
+		char parity;
+		if(decode_data_from_image(&parity, 1, decInfo) == e_failure)
+		{
+			printf("ERROR: Unable to read %s file to decode ECC parity bytes.\n", decInfo->image_fname);
+			return e_failure;
+		}
+		if((uint8_t)parity < RS_MIN_PARITY || (uint8_t)parity > RS_MAX_PARITY)
+		{
+			printf("ERROR: Unsupported ECC parity bytes %u in %s.\n", (uint8_t)parity, decInfo->image_fname);
+			return e_failure;
+		}
+		decInfo->ecc_parity = parity;
+		print_info("INFO: Secret data is Reed-Solomon coded, %u parity bytes per codeword\n", decInfo->ecc_parity);
+	}
+
 	return e_success;
 }
 
 
 
 
+/* Reads 32-bit value msb first, same bit order as decode_int_bytes_from_lsb() */
+static uint32_t get_size_field(const char *field)
+{
+	const uint8_t *p = (const uint8_t *)field;
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+
+
+
+/* Decodes varint field of header version 2 one byte at a time, till byte without continuation bit */
+static Status decode_varint_field(DecodeInfo *decInfo, uint64_t *value)
+{
+	uint8_t field[VARINT_MAX_SIZE];
+	for(uint n = 0; n < VARINT_MAX_SIZE; n++)
+	{
+		if(decode_data_from_image((char *)field + n, 1, decInfo) == e_failure)
+		{
+			return e_failure;
+		}
+		if((field[n] & 0x80) == 0)
+		{
+			return (stego_get_varint(field, n + 1, value) > 0) ? e_success : e_failure;
+		}
+	}
+	return e_failure;
+}
+
+
+
+
 /* Decodes secret file extention size */
 Status decode_secret_file_extn_size(DecodeInfo *decInfo)
 {
-	char image_buffer[33];
-	int r = fread(image_buffer, (sizeof(image_buffer) - 1), 1, decInfo->fptr_image);
-	image_buffer[32] = '\0';
+	// if => header version 2, then extension size is a varint.
+	if(decInfo->header_version == HEADER_VERSION)
+	{
+		uint64_t extn_size;
+		if(decode_varint_field(decInfo, &extn_size) == e_failure || extn_size > STEGO_EXTN_MAX)
+		{
+			printf("ERROR: Unable to read %s file to decode secret file extension size.\n", decInfo->image_fname);
+			return e_failure;
+		}
+		decInfo->secret_file_extn_size = extn_size;
+		return e_success;
+	}
 
-	// if fread doesn't read 32 bytes, then r will be 0 else r will be 1.
-	if(r == 0)
+	char field[4];
+
+	// decode_data_from_image() function is called and if => e_failure.
+	if(decode_data_from_image(field, 4, decInfo) == e_failure)
 	{
 		printf("ERROR: Unable to read %s file to decode secret file extension size.\n", decInfo->image_fname);
 		return e_failure;
 	}
 
-	// decoded int data from image_buffer is stored in extn_size and then copied to secret_file_extn_size pointer.
-	int extn_size = decode_int_bytes_from_lsb(image_buffer);	// decode_int_byte_from_lsb() function is called.
+	// decoded int data from field is stored in extn_size and then copied to secret_file_extn_size pointer.
+	int extn_size = get_size_field(field);
+
+	// if => extension size is out of bounds (not a stego image or crafted header), then it is not decoded.
+	if(extn_size < 0 || extn_size > STEGO_EXTN_MAX)
+	{
+		printf("ERROR: %s file has invalid secret file extension size %d.\n", decInfo->image_fname, extn_size);
+		return e_failure;
+	}
 	decInfo->secret_file_extn_size = extn_size;
 
 	return e_success;
@@ -275,30 +493,20 @@ Status decode_secret_file_extn_size(DecodeInfo *decInfo)
 /* Decodes secret file extenstion */
 Status decode_secret_file_extn(int size, DecodeInfo *decInfo, char *argv[])
 {
-	printf("INFO: Decoding Output File Extension\n");
+	print_info("INFO: Decoding Output File Extension\n");
 
 	char secret_file_extn[size + 1];
-	for(int i=0; i<size; i++)
+	// decode_data_from_image() function is called and if => e_failure.
+	if(decode_data_from_image(secret_file_extn, size, decInfo) == e_failure)
 	{
-		char image_buffer[9];
-		int r = fread(image_buffer, (sizeof(image_buffer) - 1), 1, decInfo->fptr_image);
-		image_buffer[8] = '\0';
-
-		// if fread doesn't read 8 bytes, then r will be 0 else r will be 1.
-		if(r == 0)
-		{
-			printf("ERROR: Unable to read %s file to decode secret file extention.\n", decInfo->image_fname);
-			return e_failure;
-		}
-
-		// decoded character data from image_buffer is stored in secret_file_extn of ith index.
-		secret_file_extn[i] = decode_char_bytes_from_lsb(image_buffer);			// decode_char_bytes_from_lsb() function is called.
+		printf("ERROR: Unable to read %s file to decode secret file extention.\n", decInfo->image_fname);
+		return e_failure;
 	}
 	secret_file_extn[size] = '\0';
 
 	// decoded secret file extension base address is stored to secret_file_extn pointer.
 	decInfo->secret_file_extn = secret_file_extn;
-	printf("INFO: Done\n");
+	print_info("INFO: Done\n");
 	
 	char str[100];
 	strcpy(str, decInfo->secret_fname);			// file name is copied to string str.
@@ -307,11 +515,11 @@ Status decode_secret_file_extn(int size, DecodeInfo *decInfo, char *argv[])
 
 	if(argv[3] == NULL)
 	{
-		printf("INFO: Output File not mentioned. Creating %s as default\n", decInfo->secret_fname);
+		print_info("INFO: Output File not mentioned. Creating %s as default\n", decInfo->secret_fname);
 	}
 	else
 	{
-		printf("INFO: Creating %s as decoded output file.\n", decInfo->secret_fname);
+		print_info("INFO: Creating %s as decoded output file.\n", decInfo->secret_fname);
 	}
 
 	// decoded secret file is oped in write mode.
@@ -324,8 +532,8 @@ Status decode_secret_file_extn(int size, DecodeInfo *decInfo, char *argv[])
 		remove(decInfo->secret_fname);
         	return e_failure;
     	}
-	printf("INFO: Opened %s\n", decInfo->secret_fname);
-	printf("INFO: Done. Opened all required files\n");
+	print_info("INFO: Opened %s\n", decInfo->secret_fname);
+	print_info("INFO: Done. Opened all required files\n");
 	
     	// No failure return e_success
 	return e_success;
@@ -337,22 +545,43 @@ Status decode_secret_file_extn(int size, DecodeInfo *decInfo, char *argv[])
 /* Decodes secret file size */
 Status decode_secret_file_size(DecodeInfo *decInfo)
 {
-	printf("INFO: Decoding File Size\n");
+	print_info("INFO: Decoding File Size\n");
+
+	// if => header version 2, then size is a varint (padded to longest varint for streamed secret file).
+	if(decInfo->header_version == HEADER_VERSION)
+	{
+		if(decode_varint_field(decInfo, &decInfo->secret_file_size) == e_failure)
+		{
+			printf("ERROR: Unable to read %s file to decode secret file size.\n", decInfo->image_fname);
+			return e_failure;
+		}
+		print_info("INFO: Done\n");
+		return e_success;
+	}
 	
-	char image_buffer[33];
-	int r = fread(image_buffer, (sizeof(image_buffer) - 1), 1, decInfo->fptr_image);
-	image_buffer[32] = '\0';
+	char field[8];
 
-	// if fread doesn't read 32 bytes, then r will be 0 else r will be 1.
-	if(r == 0)
+	// decode_data_from_image() function is called and if => e_failure.
+	if(decode_data_from_image(field, 4, decInfo) == e_failure)
 	{
 		printf("ERROR: Unable to read %s file to decode secret file size.\n", decInfo->image_fname);
 		return e_failure;
 	}
 
-	// decoded int data from image_buffer is stored in secret_file_size pointer.
-	decInfo->secret_file_size = decode_int_bytes_from_lsb(image_buffer); 		// decode_int_bytes_from_lsb() function is called.
-	printf("INFO: Done\n");
+	// decoded int data from field is stored in secret_file_size pointer.
+	decInfo->secret_file_size = get_size_field(field);
+
+	// if => extended size field marker, then 64-bit size follows.
+	if(decInfo->secret_file_size == SIZE_FIELD_EXTENDED)
+	{
+		if(decode_data_from_image(field, 8, decInfo) == e_failure)
+		{
+			printf("ERROR: Unable to read %s file to decode secret file size.\n", decInfo->image_fname);
+			return e_failure;
+		}
+		decInfo->secret_file_size = ((uint64_t)get_size_field(field) << 32) | get_size_field(field + 4);
+	}
+	print_info("INFO: Done\n");
 
 	return e_success;
 }
@@ -362,31 +591,73 @@ Status decode_secret_file_size(DecodeInfo *decInfo)
 
 
 /* Decodes secret file data */
-Status decode_secret_file_data(int size, DecodeInfo *decInfo)
+Status decode_secret_file_data(uint64_t size, DecodeInfo *decInfo)
 {
-	printf("INFO: Decoding File Data\n");
+	print_info("INFO: Decoding File Data\n");
+
+	// if => channel mask, then secret data starts at next pixel after header.
+	if(decInfo->channel_mask != 0)
+	{
+		decInfo->data_bit = decInfo->bits_decoded;
+		decInfo->data_start = decInfo->data_offset + stego_channel_start(decInfo->pixel_format, decInfo->data_bit);
+	}
 	
-	for(int i=0; i<size; i++)
+	// if => --ecc was used, then blocks are whole codewords, which are decoded and corrected before decryption.
+	static RsCode rs;
+	static uint8_t code[RS_BLOCK_CODEWORDS * RS_CODEWORD_SIZE];
+	size_t block = SECRET_BLOCK_SIZE;
+	decInfo->ecc_corrected = 0;
+	if(decInfo->ecc_parity != 0)
 	{
-		char ch;
-		char image_buffer[9];
-		int r = fread(image_buffer, (sizeof(image_buffer) - 1), 1, decInfo->fptr_image);
-		image_buffer[8] = '\0';
-		
-		// if fread doesn't read 8 bytes, then r will be 0 else r will be 1.
-		if(r == 0)
+		rs_init(&rs, decInfo->ecc_parity);
+		block = RS_BLOCK_CODEWORDS * rs.ndata;
+	}
+
+	// secret file data is decoded and written block by block.
+	char secret_file_data[SECRET_BLOCK_SIZE];
+	uint64_t remaining = size;
+	while(remaining > 0)
+	{
+		int len = (remaining < block) ? (int)remaining : (int)block;
+
+		// decode_data_from_image() function is called and if => e_failure.
+		if(decInfo->ecc_parity == 0 && decode_data_from_image(secret_file_data, len, decInfo) == e_failure)
 		{
 			printf("ERROR: Unable to read %s file to decode secret file data.\n", decInfo->image_fname);
 			return e_failure;
-		}	
+		}
 
-		// decoded character data from image_buffer is stored in ch.
-		ch = decode_char_bytes_from_lsb(image_buffer); 			// decode_char_bytes_from_lsb() function is called.
-		
-		// writes character ch to fptr_secret file pointer size times.
-		fwrite(&ch, sizeof(char), 1, decInfo->fptr_secret);
+		// if => --ecc, then codewords of block are decoded, and wrong bytes are corrected.
+		if(decInfo->ecc_parity != 0)
+		{
+			size_t code_len = rs_encoded_size(len, decInfo->ecc_parity);
+			if(decode_data_from_image((char *)code, code_len, decInfo) == e_failure)
+			{
+				printf("ERROR: Unable to read %s file to decode secret file data.\n", decInfo->image_fname);
+				return e_failure;
+			}
+			if(rs_decode(&rs, code, code_len, (uint8_t *)secret_file_data, &decInfo->ecc_corrected) == e_failure)
+			{
+				printf("ERROR: Too many wrong bytes in a codeword of %s, secret data can't be corrected.\n", decInfo->image_fname);
+				return e_failure;
+			}
+		}
+
+		// if => encrypted, then keystream is XORed into same block after decoding.
+		if(decInfo->header_flags & FLAG_ENCRYPTED)
+		{
+			cipher_xor(&decInfo->cipher, (uint8_t *)secret_file_data, len);
+		}
+
+		// writes decoded block to fptr_secret file pointer.
+		fwrite(secret_file_data, len, 1, decInfo->fptr_secret);
+		remaining -= len;
+	}
+	if(decInfo->ecc_parity != 0)
+	{
+		print_info("INFO: Reed-Solomon corrected %llu bytes\n", (unsigned long long)decInfo->ecc_corrected);
 	}
-	printf("INFO: Done\n");
+	print_info("INFO: Done\n");
 	
 	return e_success;
 }
@@ -394,6 +665,71 @@ Status decode_secret_file_data(int size, DecodeInfo *decInfo)
 
 
 
+/* Gets file offset of carrier byte of payload bit, secret data bits with channel mask are counted from data_start */
+static uint64_t decode_carrier_offset(const DecodeInfo *decInfo, uint64_t bit)
+{
+	if(bit >= decInfo->data_bit)
+	{
+		return decInfo->data_start + lsb_channel_offset(decInfo->pixel_format, decInfo->channel_mask, bit - decInfo->data_bit);
+	}
+	return decInfo->data_offset + lsb_carrier_offset(decInfo->pixel_format, bit);
+}
+
+/* Decode function, which does the real decoding, header fields and secret data are all decoded through it */
+Status decode_data_from_image(char *data, int size, DecodeInfo *decInfo)
+{
+	// image bytes from current position till carrier byte of next bit are read,
+	// bytes in between which are not carriers (alpha, unused, before pixel data) are skipped.
+	// buffer holds 4 image bytes per bit, for one channel of 32 bpp (channel mask).
+	static uint8_t image_buffer[SECRET_BLOCK_SIZE * 8 * 4 + STEGO_MAX_DATA_OFFSET];
+	uint64_t bit_pos = decInfo->bits_decoded;
+
+	// if => LSB plane is mapped, then payload bytes are copied from it, and pixels are not read.
+	// plane has LSBs of all carrier bytes, so secret data with channel mask is read from pixels.
+	if(decInfo->plane != NULL && bit_pos < decInfo->data_bit)
+	{
+		if(bit_pos / 8 + size > decInfo->plane_size)
+		{
+			return e_failure;
+		}
+		memcpy(data, decInfo->plane + bit_pos / 8, size);
+		decInfo->bits_decoded += 8 * (uint64_t)size;
+		return e_success;
+	}
+
+	uint64_t first = decode_carrier_offset(decInfo, bit_pos);
+	uint64_t begin = (bit_pos == 0) ? BMP_HEADER_SIZE : first;
+	uint64_t end = decode_carrier_offset(decInfo, bit_pos + 8 * (uint64_t)size);
+	size_t len = end - begin;
+
+	// if => first block of secret data with channel mask, then image is read from its first pixel (header may be from LSB plane).
+	uint mask = 0;
+	uint64_t kernel_bit = bit_pos;
+	if(bit_pos >= decInfo->data_bit)
+	{
+		mask = decInfo->channel_mask;
+		kernel_bit = bit_pos - decInfo->data_bit;
+		if(bit_pos == decInfo->data_bit && fseeko(decInfo->fptr_image, first, SEEK_SET) != 0)
+		{
+			return e_failure;
+		}
+	}
+
+	// if fread doesn't read len bytes, then return e_failure.
+	if(len > sizeof(image_buffer) || fread(image_buffer, 1, len, decInfo->fptr_image) != len)
+	{
+		return e_failure;
+	}
+
+	// lsb_extract_channels() function is called, kernel of pixel format (and channel mask) takes bits only from carrier bytes.
+	lsb_extract_channels(decInfo->pixel_format, mask, image_buffer + (first - begin), (uint8_t *)data, kernel_bit, 8 * (size_t)size);
+	decInfo->bits_decoded += 8 * (uint64_t)size;
+	return e_success;
+}
+
+
+
+
 /* Decodes char bytes from LSB of image data array */
 char decode_char_bytes_from_lsb(char *image_buffer)
 {
@@ -432,3 +768,16 @@ int decode_int_bytes_from_lsb(char *image_buffer)
 }
 
 
+
+
+/* Decodes long (64-bit) bytes from LSB of image data array */
+uint64_t decode_long_bytes_from_lsb(char *image_buffer)
+{
+	uint64_t in = 0;
+
+	for(int j=0; j<64; j++)				// to decode extended secret file size.
+	{
+		in = (in << 1) | (image_buffer[j] & 1);	// lsb bit of image_buffer is obtained and added from msb to lsb one by one through loop.
+	}
+	return in;
+}
@@ -45,6 +45,8 @@
 #define DECODE_H
 
 #include "types.h" // Contains user defined types
+#include "cipher.h" // Contains payload decryption
+#include "stego.h" // Contains extension size
 
 /*
  * Structure to store information required for
@@ -56,13 +58,33 @@ typedef struct _DecodeInfo
     /* Image Info */
     char *image_fname;            	// => Stores the image_fname
     FILE *fptr_image;             	// => File pointer for image file
+    PixelFormat pixel_format;		// => Stores the image pixel format (24/32/16 bpp)
+    uint64_t data_offset;		// => file offset of first carrier byte
+    uint64_t bits_decoded;		// => no. of payload bits decoded so far
 
     /* Secret File Info */
     char *secret_fname;             	// => Stores the Secret_fname
     FILE *fptr_secret;           	// => File pointer for decoded_secret_file
     uint secret_file_extn_size;		// => Stores secret_file_extension_size
     char *secret_file_extn;         	// => Stores the secret_file extention
-    uint secret_file_size;              // => stores the secret_file filesize.
+    uint64_t secret_file_size;          // => stores the secret_file filesize.
+    char stream_fname[100 + STEGO_EXTN_MAX];	// => decoded secret file name of push decoder (name given by user and extension from header)
+
+    /* Header Info */
+    uint8_t header_version;		// => HEADER_VERSION_* of header, fields are varints from version 2 ("#*" => HEADER_VERSION_FIXED)
+    uint8_t header_flags;		// => Stores FLAG_* bits of extended header (0 => old "#*" header)
+    CipherCtx cipher;			// => ChaCha20 state for decryption
+    uint8_t channel_mask;		// => CHANNEL_* carriers of secret data (0 => all carrier bytes)
+    uint64_t data_bit;			// => payload bit where secret data starts (UINT64_MAX => not with channel mask)
+    uint64_t data_start;		// => file offset of first pixel of secret data with channel mask
+    uint8_t ecc_parity;			// => Reed-Solomon parity bytes per codeword (0 => no error correction)
+    uint64_t ecc_corrected;		// => no. of wrong bytes corrected by Reed-Solomon decoding
+
+    /* Plane Cache Info */
+    uint8_t *plane_map;			// => mapped plane file (NULL => decode from pixels)
+    size_t plane_map_size;		// => size of mapped plane file
+    const uint8_t *plane;		// => payload bytes of plane (LSBs of carrier bytes)
+    uint64_t plane_size;		// => no. of payload bytes in plane
 
 } DecodeInfo;
 
@@ -72,6 +94,9 @@ typedef struct _DecodeInfo
 /* Read and validate Decode args from argv */
 Status read_and_validate_decode_args(char *argv[], DecodeInfo *decInfo);
 
+/* Check whether image is stdin ("-") or a pipe, decoded with push decoder */
+int decode_is_stream(const char *image_fname);
+
 /* Perform the decoding */
 Status do_decoding(char *argv[], DecodeInfo *decInfo);
 
@@ -84,6 +109,9 @@ Status skip_bmp_header(DecodeInfo *decInfo);
 /* Decode Magic String */
 Status decode_magic_string(DecodeInfo *decInfo);
 
+/* Decode extended header version, flags and nonce */
+Status decode_header_flags(DecodeInfo *decInfo);
+
 /* Decode secret file extention size */
 Status decode_secret_file_extn_size(DecodeInfo *decInfo);
 
@@ -94,7 +122,10 @@ Status decode_secret_file_extn(int size, DecodeInfo *decInfo, char *argv[]);
 Status decode_secret_file_size(DecodeInfo *decInfo);
 
 /* Decode secret file data */
-Status decode_secret_file_data(int size, DecodeInfo *decInfo);
+Status decode_secret_file_data(uint64_t size, DecodeInfo *decInfo);
+
+/* Decode function, which does the real decoding of char bytes */
+Status decode_data_from_image(char *data, int size, DecodeInfo *decInfo);
 
 /* Decode char bytes from LSB of image buffer */
 char decode_char_bytes_from_lsb(char *image_buffer);
@@ -102,4 +133,7 @@ char decode_char_bytes_from_lsb(char *image_buffer);
 /* Decode int bytes from LSB of image buffer */
 int decode_int_bytes_from_lsb(char *image_buffer);
 
+/* Decode long (64-bit) bytes from LSB of image buffer */
+uint64_t decode_long_bytes_from_lsb(char *image_buffer);
+
 #endif
@@ -0,0 +1,424 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Delta Output Format
+ *
+ *                              -> Encoding : payload bytes are made same as encoding (stego_write_header() and secret data, encrypted
+ *                                 if --encrypt), carrier is only read to hash it, and header and payload are written to delta file.
+ *                              -> Applying : carrier is copied (and hashed in same pass), then payload is read chunk by chunk,
+ *                                 carrier bytes of each chunk are read back, encoded with lsb_embed_pixels() and written.
+ *                              -> For decoding, only bytes up to end of payload carrier bytes are copied to a temp file,
+ *                                 and normal decode stages read it as image file.
+ *                              -> If carrier hash doesn't match after copy, then output is removed.
+ */
+
+
+
+
+#define _FILE_OFFSET_BITS 64	// 64-bit file offsets, for images bigger than 2 GB
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "delta.h"
+#include "stego.h"
+#include "lsb.h"
+#include "hash.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Stores 64-bit value as 8 bytes, little endian */
+static void put64(uint8_t *p, uint64_t v)
+{
+	for(int i=0; i<8; i++)
+	{
+		p[i] = v >> (8 * i);
+	}
+}
+
+/* Gets 64-bit value from 8 bytes, little endian */
+static uint64_t get64(const uint8_t *p)
+{
+	uint64_t v = 0;
+	for(int i=0; i<8; i++)
+	{
+		v |= (uint64_t)p[i] << (8 * i);
+	}
+	return v;
+}
+
+/* Writes delta file header */
+static Status delta_write_header(FILE *fptr, const DeltaHeader *dh)
+{
+	uint8_t buffer[DELTA_HEADER_SIZE] = {0};
+	memcpy(buffer, DELTA_MAGIC, 4);
+	buffer[4] = DELTA_VERSION;
+	buffer[5] = dh->format;
+	put64(buffer + 8, dh->carrier_size);
+	put64(buffer + 16, dh->carrier_hash);
+	put64(buffer + 24, dh->data_offset);
+	put64(buffer + 32, dh->payload_size);
+	return (fwrite(buffer, DELTA_HEADER_SIZE, 1, fptr) == 1) ? e_success : e_failure;
+}
+
+/* Reads and validates delta file header */
+static Status delta_read_header(FILE *fptr, const char *fname, DeltaHeader *dh)
+{
+	uint8_t buffer[DELTA_HEADER_SIZE];
+	if(fread(buffer, DELTA_HEADER_SIZE, 1, fptr) != 1 || memcmp(buffer, DELTA_MAGIC, 4) != 0)
+	{
+		printf("ERROR: %s is not a delta file.\n", fname);
+		return e_failure;
+	}
+	if(buffer[4] != DELTA_VERSION || buffer[5] > e_rgb16)
+	{
+		printf("ERROR: %s has unsupported delta version %d.\n", fname, buffer[4]);
+		return e_failure;
+	}
+	dh->format = buffer[5];
+	dh->carrier_size = get64(buffer + 8);
+	dh->carrier_hash = get64(buffer + 16);
+	dh->data_offset = get64(buffer + 24);
+	dh->payload_size = get64(buffer + 32);
+
+	// if => payload carrier bytes are beyond carrier file, then delta is broken.
+	if(dh->payload_size == 0 || dh->payload_size > dh->carrier_size || dh->data_offset + lsb_carrier_offset(dh->format, dh->payload_size * 8 - 1) >= dh->carrier_size)
+	{
+		printf("ERROR: %s has invalid payload size.\n", fname);
+		return e_failure;
+	}
+	return e_success;
+}
+
+/* Reads carrier file, hashes all of it and copies first copy_len bytes to out_fd (-1 => no copy) */
+static Status delta_copy(int in_fd, int out_fd, uint64_t size, uint64_t copy_len, uint64_t *hash)
+{
+	static uint8_t buffer[COPY_BLOCK_SIZE];
+	HashState state;
+	uint64_t off = 0;
+
+	hash_init(&state, 0);
+	while(off < size)
+	{
+		ssize_t n = pread(in_fd, buffer, sizeof(buffer), off);
+		if(n <= 0)
+		{
+			return e_failure;
+		}
+		hash_update(&state, buffer, n);
+		if(out_fd != -1 && off < copy_len)
+		{
+			size_t w = (copy_len - off < (uint64_t)n) ? copy_len - off : (size_t)n;
+			if(pwrite(out_fd, buffer, w, off) != (ssize_t)w)
+			{
+				return e_failure;
+			}
+		}
+		off += n;
+	}
+	*hash = hash_digest(&state);
+	return e_success;
+}
+
+/* Opens carrier and checks it is the carrier delta was made from (except hash, checked while copying) */
+static Status delta_open_carrier(const char *fname, const DeltaHeader *dh, int *fd)
+{
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+	PixelFormat format;
+	uint64_t data_offset;
+	struct stat st;
+
+	*fd = open(fname, O_RDONLY);
+	if(*fd == -1)
+	{
+		perror("open");
+		printf("ERROR: Unable to open file %s\n", fname);
+		return e_failure;
+	}
+	if(fstat(*fd, &st) != 0 || (uint64_t)st.st_size != dh->carrier_size || pread(*fd, bmp_header, BMP_HEADER_SIZE, 0) != BMP_HEADER_SIZE ||
+	   stego_bmp_format(bmp_header, &format, &data_offset) == e_failure || format != dh->format || data_offset != dh->data_offset)
+	{
+		printf("ERROR: %s is not the carrier image of delta file.\n", fname);
+		close(*fd);
+		return e_failure;
+	}
+	return e_success;
+}
+
+/* Encodes payload of delta file into carrier bytes of fd, chunk by chunk */
+static Status delta_apply(int fd, const DeltaHeader *dh, FILE *fptr_delta)
+{
+	// carrier bytes of a chunk are at most 2 bytes per bit (16 bpp).
+	static uint8_t chunk[DELTA_CHUNK_SIZE];
+	static uint8_t span[2 * 8 * DELTA_CHUNK_SIZE];
+
+	for(uint64_t done = 0; done < dh->payload_size; )
+	{
+		size_t n = (dh->payload_size - done < DELTA_CHUNK_SIZE) ? dh->payload_size - done : DELTA_CHUNK_SIZE;
+		uint64_t bit_pos = done * 8;
+		uint64_t from = dh->data_offset + lsb_carrier_offset(dh->format, bit_pos);
+		size_t len = dh->data_offset + lsb_carrier_offset(dh->format, bit_pos + n * 8 - 1) + 1 - from;
+		if(fread(chunk, 1, n, fptr_delta) != n)
+		{
+			printf("ERROR: Delta file is shorter than its payload size.\n");
+			return e_failure;
+		}
+		if(pread(fd, span, len, from) != (ssize_t)len)
+		{
+			return e_failure;
+		}
+		lsb_embed_pixels(dh->format, span, chunk, bit_pos, n * 8);
+		// if => --verify, then encoded bits are checked before they are written.
+		if(options.verify && !lsb_verify_pixels(dh->format, span, chunk, bit_pos, n * 8))
+		{
+			printf("ERROR: Verify failed, encoded bits don't match delta payload.\n");
+			return e_failure;
+		}
+		if(pwrite(fd, span, len, from) != (ssize_t)len)
+		{
+			return e_failure;
+		}
+		done += n;
+	}
+	return e_success;
+}
+
+/* Encode payload of encInfo as delta file, instead of output image (--delta) */
+Status delta_encode(EncodeInfo *encInfo, const char *delta_fname)
+{
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+	uint8_t header[STEGO_HEADER_MAX];
+	static uint8_t buffer[DELTA_CHUNK_SIZE];
+	DeltaHeader dh;
+	StegoHeader hdr;
+	struct stat st, secret_st;
+
+	print_info("INFO: ## Delta Encoding Procedure Started ##\n");
+	int fd = open(encInfo->src_image_fname, O_RDONLY);
+	if(fd == -1 || fstat(fd, &st) != 0)
+	{
+		perror("open");
+		printf("ERROR: Unable to open file %s\n", encInfo->src_image_fname);
+		if(fd != -1)
+		{
+			close(fd);
+		}
+		return e_failure;
+	}
+	if(pread(fd, bmp_header, BMP_HEADER_SIZE, 0) != BMP_HEADER_SIZE || stego_bmp_format(bmp_header, &dh.format, &dh.data_offset) == e_failure)
+	{
+		printf("ERROR: %s is not a 24, 32 or 16 bpp uncompressed bmp image.\n", encInfo->src_image_fname);
+		close(fd);
+		return e_failure;
+	}
+	if(stat(encInfo->secret_fname, &secret_st) != 0 || secret_st.st_size <= 1)
+	{
+		printf("ERROR: %s file is empty\n", encInfo->secret_fname);
+		close(fd);
+		return e_failure;
+	}
+
+	// payload header is same as encoding, so applied delta gives same image.
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.flags = encInfo->header_flags;
+	memcpy(hdr.nonce, encInfo->nonce, CIPHER_NONCE_SIZE);
+	hdr.extn_size = strlen(encInfo->extn_secret_file);
+	memcpy(hdr.extn, encInfo->extn_secret_file, hdr.extn_size);
+	hdr.data_size = secret_st.st_size;
+	uint header_len = stego_write_header(&hdr, header);
+	dh.carrier_size = st.st_size;
+	dh.payload_size = header_len + hdr.data_size;
+
+	// if => payload doesn't fit in image, or in carrier file.
+	if(stego_required_size(&hdr) >= stego_bmp_capacity(bmp_header) || dh.data_offset + lsb_carrier_offset(dh.format, dh.payload_size * 8 - 1) >= dh.carrier_size)
+	{
+		printf("ERROR: \"%s\" doesn't have the capacity to encode \"%s\"\n", encInfo->src_image_fname, encInfo->secret_fname);
+		close(fd);
+		return e_failure;
+	}
+
+	// carrier is only hashed, none of it is written.
+	Status ret = delta_copy(fd, -1, dh.carrier_size, 0, &dh.carrier_hash);
+	close(fd);
+	if(ret == e_failure)
+	{
+		printf("ERROR: Unable to read %s\n", encInfo->src_image_fname);
+		return e_failure;
+	}
+
+	FILE *fptr_secret = fopen(encInfo->secret_fname, "rb");
+	FILE *fptr_delta = fopen(delta_fname, "wb");
+	if(fptr_secret == NULL || fptr_delta == NULL)
+	{
+		perror("fopen");
+		printf("ERROR: Unable to open file %s\n", (fptr_secret == NULL) ? encInfo->secret_fname : delta_fname);
+		if(fptr_secret != NULL)
+		{
+			fclose(fptr_secret);
+		}
+		if(fptr_delta != NULL)
+		{
+			fclose(fptr_delta);
+			remove(delta_fname);
+		}
+		return e_failure;
+	}
+
+	// header, then secret data as it is or encrypted.
+	ret = (delta_write_header(fptr_delta, &dh) == e_success && fwrite(header, 1, header_len, fptr_delta) == header_len) ? e_success : e_failure;
+	for(uint64_t done = 0; ret == e_success && done < hdr.data_size; )
+	{
+		size_t n = fread(buffer, 1, sizeof(buffer), fptr_secret);
+		if(n == 0 || done + n > hdr.data_size)
+		{
+			ret = e_failure;
+			break;
+		}
+		if(hdr.flags & FLAG_ENCRYPTED)
+		{
+			cipher_xor(&encInfo->cipher, buffer, n);
+		}
+		if(fwrite(buffer, 1, n, fptr_delta) != n)
+		{
+			ret = e_failure;
+		}
+		done += n;
+	}
+	fclose(fptr_secret);
+	if(fclose(fptr_delta) != 0 || ret == e_failure)
+	{
+		printf("ERROR: Writing delta file %s failed.\n", delta_fname);
+		remove(delta_fname);
+		return e_failure;
+	}
+
+	print_info("INFO: Delta written to %s (%llu bytes, carrier is %llu bytes)\n", delta_fname, (unsigned long long)(DELTA_HEADER_SIZE + dh.payload_size), (unsigned long long)dh.carrier_size);
+	return e_success;
+}
+
+/* Make full encoded image from carrier and delta file (./a.out -m) */
+Status do_materialize(char *argv[])
+{
+	DeltaHeader dh;
+	uint64_t hash;
+	int in_fd;
+
+	// carrier and output should be .bmp files, same as encode args.
+	char *out_fname = (argv[4] != NULL) ? argv[4] : "stego.bmp";
+	if(strstr(argv[2], ".") == NULL || strcmp(strstr(argv[2], "."), ".bmp") != 0 || strstr(out_fname, ".") == NULL || strcmp(strstr(out_fname, "."), ".bmp") != 0)
+	{
+		printf("ERROR: Carrier and output image should be .bmp files.\n");
+		return e_failure;
+	}
+
+	print_info("INFO: ## Materializing Procedure Started ##\n");
+	FILE *fptr_delta = fopen(argv[3], "rb");
+	if(fptr_delta == NULL)
+	{
+		perror("fopen");
+		printf("ERROR: Unable to open file %s\n", argv[3]);
+		return e_failure;
+	}
+	if(delta_read_header(fptr_delta, argv[3], &dh) == e_failure || delta_open_carrier(argv[2], &dh, &in_fd) == e_failure)
+	{
+		fclose(fptr_delta);
+		return e_failure;
+	}
+
+	int out_fd = open(out_fname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(out_fd == -1)
+	{
+		perror("open");
+		printf("ERROR: Unable to open file %s\n", out_fname);
+		close(in_fd);
+		fclose(fptr_delta);
+		return e_failure;
+	}
+
+	// carrier is copied and hashed in one pass, then payload is encoded into copy.
+	Status ret = delta_copy(in_fd, out_fd, dh.carrier_size, dh.carrier_size, &hash);
+	if(ret == e_success && hash != dh.carrier_hash)
+	{
+		printf("ERROR: %s is not the carrier image of delta file.\n", argv[2]);
+		ret = e_failure;
+	}
+	if(ret == e_success)
+	{
+		ret = delta_apply(out_fd, &dh, fptr_delta);
+	}
+	close(in_fd);
+	fclose(fptr_delta);
+	if(close(out_fd) != 0 || ret == e_failure)
+	{
+		printf("ERROR: Materializing %s failed.\n", out_fname);
+		remove(out_fname);
+		return e_failure;
+	}
+
+	print_info("INFO: Created %s from %s and %s\n", out_fname, argv[2], argv[3]);
+	return e_success;
+}
+
+/* Open carrier with payload of delta file applied as image file of decInfo (-d with --delta) */
+Status delta_open_image(DecodeInfo *decInfo, const char *delta_fname)
+{
+	DeltaHeader dh;
+	uint64_t hash;
+	int in_fd;
+
+	print_info("INFO: Opening %s with delta file %s\n", decInfo->image_fname, delta_fname);
+	FILE *fptr_delta = fopen(delta_fname, "rb");
+	if(fptr_delta == NULL)
+	{
+		perror("fopen");
+		printf("ERROR: Unable to open file %s\n", delta_fname);
+		return e_failure;
+	}
+	if(delta_read_header(fptr_delta, delta_fname, &dh) == e_failure || delta_open_carrier(decInfo->image_fname, &dh, &in_fd) == e_failure)
+	{
+		fclose(fptr_delta);
+		return e_failure;
+	}
+
+	// only bmp header and carrier bytes of payload are needed for decoding,
+	// decode reads till carrier byte of next bit, so bytes till it are also copied.
+	uint64_t region_end = dh.data_offset + lsb_carrier_offset(dh.format, dh.payload_size * 8);
+	if(region_end > dh.carrier_size)
+	{
+		region_end = dh.carrier_size;
+	}
+	FILE *fptr_image = tmpfile();
+	Status ret = (fptr_image != NULL) ? delta_copy(in_fd, fileno(fptr_image), dh.carrier_size, region_end, &hash) : e_failure;
+	if(ret == e_success && hash != dh.carrier_hash)
+	{
+		printf("ERROR: %s is not the carrier image of delta file.\n", decInfo->image_fname);
+		ret = e_failure;
+	}
+	if(ret == e_success)
+	{
+		ret = delta_apply(fileno(fptr_image), &dh, fptr_delta);
+	}
+	close(in_fd);
+	fclose(fptr_delta);
+	if(ret == e_failure)
+	{
+		printf("ERROR: Unable to apply delta file %s\n", delta_fname);
+		if(fptr_image != NULL)
+		{
+			fclose(fptr_image);
+		}
+		return e_failure;
+	}
+
+	rewind(fptr_image);
+	decInfo->fptr_image = fptr_image;
+	print_info("INFO: Opened %s\n", decInfo->image_fname);
+	return e_success;
+}
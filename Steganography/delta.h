@@ -0,0 +1,66 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Delta Output Format
+ *
+ *                              -> Encoded image differs from its carrier only in LSBs of carrier bytes of payload (prefix of pixel data),
+ *                                 so with --delta=<file> encoding writes only those LSBs, instead of full copy of image.
+ *                              -> Delta file : "SDLT", version, pixel format, carrier size, carrier hash (XXH64 of whole carrier),
+ *                                 offset of first carrier byte, payload size and then payload bytes (8 packed LSBs per byte).
+ *                              -> ./a.out -m <carrier.bmp> <delta_file> [output.bmp] makes full encoded image from carrier and delta,
+ *                                 image is same byte by byte as one encoded without --delta.
+ *                              -> ./a.out -d <carrier.bmp> [output] --delta=<delta_file> decodes from carrier and delta,
+ *                                 only header and carrier bytes of payload are made (in a temp file), full image is not written.
+ *                              -> Carrier hash and size are checked before use, so delta is never applied on other carrier.
+ */
+
+
+
+
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+#include "encode.h"
+#include "decode.h"
+
+/* Delta file magic string and version */
+#define DELTA_MAGIC "SDLT"
+#define DELTA_VERSION 1
+
+/* Delta file header size : magic, version, format, 2 reserved bytes, then 4 x 8 byte fields */
+#define DELTA_HEADER_SIZE 40
+
+/* Payload bytes applied to carrier at a time */
+#define DELTA_CHUNK_SIZE (64 * 1024)
+
+/*
+ * Structure to store delta file header fields
+ */
+
+typedef struct _DeltaHeader
+{
+    PixelFormat format;			// => pixel format of carrier
+    uint64_t carrier_size;		// => size of carrier file
+    uint64_t carrier_hash;		// => XXH64 of whole carrier file
+    uint64_t data_offset;		// => file offset of first carrier byte
+    uint64_t payload_size;		// => no. of payload bytes (header and secret data)
+
+} DeltaHeader;
+
+
+/* Delta function prototypes */
+
+/* Encode payload of encInfo as delta file, instead of output image (--delta) */
+Status delta_encode(EncodeInfo *encInfo, const char *delta_fname);
+
+/* Make full encoded image from carrier and delta file (./a.out -m) */
+Status do_materialize(char *argv[]);
+
+/* Open carrier with payload of delta file applied as image file of decInfo (-d with --delta) */
+Status delta_open_image(DecodeInfo *decInfo, const char *delta_fname);
+
+#endif
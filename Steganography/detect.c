@@ -0,0 +1,546 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       LSB Steganalysis Detector
+ *
+ *                              -> ./a.out --detect <.bmp file or directory>... screens images for LSB stego (any tool, not only "#*").
+ *                              -> Directories are walked recursively and every .bmp file in them is screened.
+ *                              -> Carrier bytes of image (same as encoding, alpha is skipped) are done in blocks of 64K pixels.
+ *                              -> Chi-square attack : in each block, histogram counts of pairs of values (2k, 2k+1) are compared,
+ *                                 LSB embedding makes them equal, so chi-square close to its degrees of freedom marks block as embedded.
+ *                              -> Sample pair analysis : neighbour pixels of same channel are counted (X, Y, K sets),
+ *                                 and length of embedded message is estimated from them.
+ *                              -> Score is average of embedded block ratio and estimated message length, 0 => clean, 1 => LSB plane looks random.
+ *                              -> Pair counts are done 16 bytes at a time with SSE2, histograms with 4 banks fed by 64-bit loads.
+ *                              -> Images are screened on thread pool (--threads=<n>, default is no. of CPUs).
+ */
+
+
+
+
+#define _FILE_OFFSET_BITS 64	// 64-bit file offsets, for images bigger than 2 GB
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "detect.h"
+#include "stego.h"
+#include "lsb.h"
+#include "trace.h"
+#include "options.h"
+#include "types.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Counts of sample pair analysis */
+typedef struct _PairCounts
+{
+    uint64_t x;				// => pairs (u, v) with v even and u < v, or v odd and u > v
+    uint64_t y;				// => pairs with v even and u > v, or v odd and u < v
+    uint64_t k;				// => pairs with u / 2 == v / 2
+    uint64_t pairs;			// => no. of pairs
+
+} PairCounts;
+
+/* Images to be screened, workers take next image one by one */
+typedef struct _DetectPool
+{
+    DetectResult *results;
+    int count;
+    int next;
+
+} DetectPool;
+
+/* Function Definitions */
+
+/* Square root by Newton's method, so libm is not needed */
+static double detect_sqrt(double v)
+{
+	if(v <= 0)
+	{
+		return 0;
+	}
+
+	// starts above root, so every step goes down till it stops changing.
+	double r = (v > 1) ? v : 1;
+	for(int i=0; i<128; i++)
+	{
+		double next = 0.5 * (r + v / r);
+		if(next >= r)
+		{
+			break;
+		}
+		r = next;
+	}
+	return r;
+}
+
+
+
+/* Histogram of carrier bytes, 4 banks so back to back same values don't wait on each other */
+static void detect_histogram(const uint8_t *c, size_t n, uint32_t hist[256])
+{
+	uint32_t bank[4][256];
+	memset(bank, 0, sizeof(bank));
+
+	size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+	{
+		uint64_t v;
+		memcpy(&v, c + i, 8);
+		bank[0][v & 0xFF]++;
+		bank[1][(v >> 8) & 0xFF]++;
+		bank[2][(v >> 16) & 0xFF]++;
+		bank[3][(v >> 24) & 0xFF]++;
+		bank[0][(v >> 32) & 0xFF]++;
+		bank[1][(v >> 40) & 0xFF]++;
+		bank[2][(v >> 48) & 0xFF]++;
+		bank[3][v >> 56]++;
+	}
+	for(; i < n; i++)
+	{
+		bank[0][c[i]]++;
+	}
+
+	for(int j=0; j<256; j++)
+	{
+		hist[j] = bank[0][j] + bank[1][j] + bank[2][j] + bank[3][j];
+	}
+}
+
+
+
+/* Chi-square attack on one block, returns 1 if values of each pair (2k, 2k+1) are as equal as after embedding */
+static int detect_chi_block(const uint32_t hist[256])
+{
+	double chi = 0;
+	int dof = -1;
+
+	for(int k=0; k<128; k++)
+	{
+		double h0 = hist[2 * k], h1 = hist[2 * k + 1];
+		// if => pair doesn't occur, then it is not counted.
+		if(h0 + h1 == 0)
+		{
+			continue;
+		}
+		chi += (h0 - h1) * (h0 - h1) / (2 * (h0 + h1));
+		dof++;
+	}
+
+	// if => flat block (only one pair), then nothing can be said.
+	if(dof < 1)
+	{
+		return 0;
+	}
+
+	// only even values are compared, so chi-square of embedded block is around dof / 2 (variance dof / 2),
+	// clean blocks are above it, block is taken as embedded within 2 standard deviations.
+	return chi <= dof / 2.0 + 2 * detect_sqrt(dof / 2.0);
+}
+
+
+
+#ifdef __SSE2__
+/* Sum of 16 byte counters */
+static uint64_t detect_hsum(__m128i v)
+{
+	__m128i s = _mm_sad_epu8(v, _mm_setzero_si128());
+	return (uint64_t)_mm_cvtsi128_si64(s) + (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(s, s));
+}
+#endif
+
+/* Counts sample pairs (c[i], c[i + dist]) of one block */
+static void detect_pairs(const uint8_t *c, size_t n, size_t dist, PairCounts *pc)
+{
+	if(n <= dist)
+	{
+		return;
+	}
+	size_t m = n - dist, i = 0;
+
+#ifdef __SSE2__
+	const __m128i sign = _mm_set1_epi8((char)0x80);
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i half = _mm_set1_epi8(0x7F);
+	const __m128i zero = _mm_setzero_si128();
+
+	while(m - i >= 16)
+	{
+		__m128i ax = zero, ay = zero, ak = zero;
+
+		// byte counters are added up every 255 rounds, before they overflow.
+		for(int r=0; r<255 && m - i >= 16; r++, i += 16)
+		{
+			__m128i u = _mm_loadu_si128((const __m128i *)(c + i));
+			__m128i v = _mm_loadu_si128((const __m128i *)(c + i + dist));
+
+			// unsigned compare, by flipping sign bits.
+			__m128i lt = _mm_cmplt_epi8(_mm_xor_si128(u, sign), _mm_xor_si128(v, sign));
+			__m128i gt = _mm_cmpgt_epi8(_mm_xor_si128(u, sign), _mm_xor_si128(v, sign));
+			__m128i even = _mm_cmpeq_epi8(_mm_and_si128(v, one), zero);
+
+			__m128i x = _mm_or_si128(_mm_and_si128(even, lt), _mm_andnot_si128(even, gt));
+			__m128i y = _mm_or_si128(_mm_and_si128(even, gt), _mm_andnot_si128(even, lt));
+			__m128i k = _mm_cmpeq_epi8(_mm_and_si128(_mm_srli_epi16(u, 1), half), _mm_and_si128(_mm_srli_epi16(v, 1), half));
+
+			// compare result is -1, so subtracting counts it.
+			ax = _mm_sub_epi8(ax, x);
+			ay = _mm_sub_epi8(ay, y);
+			ak = _mm_sub_epi8(ak, k);
+		}
+		pc->x += detect_hsum(ax);
+		pc->y += detect_hsum(ay);
+		pc->k += detect_hsum(ak);
+	}
+#endif
+
+	// tail (or all pairs without SSE2).
+	for(; i < m; i++)
+	{
+		uint8_t u = c[i], v = c[i + dist];
+		if(v % 2 == 0)
+		{
+			pc->x += (u < v);
+			pc->y += (u > v);
+		}
+		else
+		{
+			pc->x += (u > v);
+			pc->y += (u < v);
+		}
+		pc->k += (u / 2 == v / 2);
+	}
+	pc->pairs += m;
+}
+
+
+
+/* Estimates embedded message length (0 to 1) from sample pair counts */
+static double detect_spa(const PairCounts *pc)
+{
+	double a = 2.0 * pc->k;
+	double b = 2.0 * (2.0 * pc->x - (double)pc->pairs);
+	double c = (double)pc->y - (double)pc->x;
+
+	if(a == 0)
+	{
+		return 0;
+	}
+
+	// smaller root of a * p^2 + b * p + c = 0 is ratio of changed LSBs,
+	// random message changes half of the LSBs, so message length is twice of it.
+	double disc = b * b - 4 * a * c;
+	double p = 2 * (-b - detect_sqrt(disc)) / (2 * a);
+	if(p < 0)
+	{
+		p = 0;
+	}
+	if(p > 1)
+	{
+		p = 1;
+	}
+	return p;
+}
+
+
+
+/* Reads till len bytes or end of file */
+static size_t detect_read(int fd, uint8_t *buffer, size_t len, uint64_t off)
+{
+	size_t done = 0;
+	while(done < len)
+	{
+		ssize_t r = pread(fd, buffer + done, len - done, off + done);
+		if(r < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if(r <= 0)
+		{
+			break;
+		}
+		done += r;
+	}
+	return done;
+}
+
+
+
+/* Screens one image, carrier bytes are done block by block */
+Status detect_image(const char *fname, DetectResult *result)
+{
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+	PixelFormat format;
+	uint64_t off;
+
+	result->blocks = result->chi_blocks = 0;
+	result->score = result->spa = 0;
+
+	int fd = open(fname, O_RDONLY);
+	if(fd < 0)
+	{
+		return e_failure;
+	}
+	if(detect_read(fd, bmp_header, BMP_HEADER_SIZE, 0) != BMP_HEADER_SIZE || stego_bmp_format(bmp_header, &format, &off) == e_failure)
+	{
+		close(fd);
+		return e_failure;
+	}
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	// pairs are taken between same channel of neighbour pixels.
+	size_t stride = lsb_format_stride(format), channels = lsb_format_channels(format);
+	size_t dist = (format == e_rgb16) ? 1 : 3;
+	size_t block_carriers = DETECT_BLOCK_PIXELS * channels;
+
+	// if => all bytes are carriers (24 bpp), then image buffer is used as it is.
+	uint8_t *buffer = malloc(DETECT_BLOCK_PIXELS * stride * DETECT_READ_BLOCKS);
+	uint8_t *carriers = (stride == channels) ? buffer : malloc(block_carriers * DETECT_READ_BLOCKS);
+	if(buffer == NULL || carriers == NULL)
+	{
+		free(buffer);
+		if(carriers != buffer)
+		{
+			free(carriers);
+		}
+		close(fd);
+		return e_failure;
+	}
+
+	PairCounts pc = { 0, 0, 0, 0 };
+	size_t len;
+	while((len = detect_read(fd, buffer, DETECT_BLOCK_PIXELS * stride * DETECT_READ_BLOCKS, off)) >= stride)
+	{
+		off += len;
+		size_t pixels = len / stride, n = pixels * channels;
+
+		// carrier bytes are packed, alpha/unused bytes are left out.
+		if(format == e_bgra32)
+		{
+			for(size_t p=0; p<pixels; p++)
+			{
+				carriers[3 * p] = buffer[4 * p];
+				carriers[3 * p + 1] = buffer[4 * p + 1];
+				carriers[3 * p + 2] = buffer[4 * p + 2];
+			}
+		}
+		else if(format == e_rgb16)
+		{
+			for(size_t p=0; p<pixels; p++)
+			{
+				carriers[p] = buffer[2 * p];
+			}
+		}
+
+		for(size_t b=0; b<n; b+=block_carriers)
+		{
+			size_t blen = (n - b < block_carriers) ? n - b : block_carriers;
+			uint32_t hist[256];
+			detect_histogram(carriers + b, blen, hist);
+			result->chi_blocks += detect_chi_block(hist);
+			result->blocks++;
+			detect_pairs(carriers + b, blen, dist, &pc);
+		}
+	}
+
+	free(buffer);
+	if(carriers != buffer)
+	{
+		free(carriers);
+	}
+	close(fd);
+
+	result->spa = detect_spa(&pc);
+	result->score = (result->spa + ((result->blocks > 0) ? (double)result->chi_blocks / result->blocks : 0)) / 2;
+	return e_success;
+}
+
+
+
+/* Adds image file to list */
+static Status detect_add(DetectResult **list, int *count, const char *fname)
+{
+	DetectResult *grown = realloc(*list, (*count + 1) * sizeof(DetectResult));
+	if(grown == NULL || (grown[*count].fname = strdup(fname)) == NULL)
+	{
+		printf("ERROR: Out of memory adding %s\n", fname);
+		if(grown != NULL)
+		{
+			*list = grown;
+		}
+		return e_failure;
+	}
+	*list = grown;
+	(*count)++;
+	return e_success;
+}
+
+/* Sorts images by file name, so output order doesn't depend on directory order */
+static int detect_compare(const void *a, const void *b)
+{
+	return strcmp(((const DetectResult *)a)->fname, ((const DetectResult *)b)->fname);
+}
+
+/* Adds every .bmp file under directory, symbolic links are not followed */
+static Status detect_walk(const char *dname, DetectResult **list, int *count)
+{
+	DIR *dir = opendir(dname);
+	if(dir == NULL)
+	{
+		printf("ERROR: Unable to open directory %s\n", dname);
+		return e_failure;
+	}
+
+	Status ret = e_success;
+	struct dirent *entry;
+	while(ret == e_success && (entry = readdir(dir)) != NULL)
+	{
+		if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+		{
+			continue;
+		}
+
+		char path[4096];
+		struct stat st;
+		if(snprintf(path, sizeof(path), "%s/%s", dname, entry->d_name) >= (int)sizeof(path) || lstat(path, &st) < 0)
+		{
+			continue;
+		}
+
+		if(S_ISDIR(st.st_mode))
+		{
+			ret = detect_walk(path, list, count);
+		}
+		else if(S_ISREG(st.st_mode) && strstr(entry->d_name, ".") != NULL && strcmp(strrchr(entry->d_name, '.'), ".bmp") == 0)
+		{
+			ret = detect_add(list, count, path);
+		}
+	}
+	closedir(dir);
+	return ret;
+}
+
+
+
+/* Screens images till list is over */
+static void *detect_worker(void *arg)
+{
+	DetectPool *pool = arg;
+	trace_thread("detect worker");
+	for(;;)
+	{
+		int i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+		if(i >= pool->count)
+		{
+			return NULL;
+		}
+		trace_begin("detect_image", pool->results[i].fname);
+		pool->results[i].status = trace_end(detect_image(pool->results[i].fname, &pool->results[i]));
+	}
+}
+
+
+
+/* Screens images and directories given in args, and prints score of each image */
+Status do_detect(int count, char *paths[])
+{
+	DetectResult *results = NULL;
+	int n = 0;
+	Status ret = e_success;
+
+	print_info("INFO: ## Detection Started ##\n");
+
+	// files are taken as they are, directories are walked and sorted.
+	for(int i=0; i<count && ret == e_success; i++)
+	{
+		struct stat st;
+		if(stat(paths[i], &st) == 0 && S_ISDIR(st.st_mode))
+		{
+			int first = n;
+			ret = detect_walk(paths[i], &results, &n);
+			qsort(results + first, n - first, sizeof(DetectResult), detect_compare);
+		}
+		else
+		{
+			ret = detect_add(&results, &n, paths[i]);
+		}
+	}
+
+	if(ret == e_success && n > 0)
+	{
+		DetectPool pool = { results, n, 0 };
+		int nthreads = options.threads;
+		if(nthreads <= 0)
+		{
+			nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+		}
+		if(nthreads > n)
+		{
+			nthreads = n;
+		}
+		if(nthreads < 1)
+		{
+			nthreads = 1;
+		}
+
+		print_info("INFO: Screening %d images on %d threads\n", n, nthreads);
+		pthread_t threads[nthreads];
+		int started = 0;
+		for(int i=0; i<nthreads; i++)
+		{
+			if(pthread_create(&threads[i], NULL, detect_worker, &pool) != 0)
+			{
+				break;
+			}
+			started++;
+		}
+
+		// if => no thread started, then images are screened in this thread.
+		if(started == 0)
+		{
+			detect_worker(&pool);
+		}
+		for(int i=0; i<started; i++)
+		{
+			pthread_join(threads[i], NULL);
+		}
+
+		// results are printed in same order as args.
+		int suspicious = 0, failed = 0;
+		for(int i=0; i<n; i++)
+		{
+			DetectResult *r = &results[i];
+			if(r->status == e_failure)
+			{
+				printf("ERROR: %s is not a 24, 32 or 16 bpp bmp image or can't be read.\n", r->fname);
+				failed++;
+				continue;
+			}
+			suspicious += (r->score >= DETECT_THRESHOLD);
+			printf("%-10s %.3f  %s  (spa=%.3f, chi=%u/%u blocks)\n", (r->score >= DETECT_THRESHOLD) ? "SUSPICIOUS" : "CLEAN", r->score, r->fname, r->spa, r->chi_blocks, r->blocks);
+		}
+		print_info("INFO: %d images screened, %d suspicious, %d failed\n", n - failed, suspicious, failed);
+		if(failed > 0)
+		{
+			ret = e_failure;
+		}
+	}
+
+	for(int i=0; i<n; i++)
+	{
+		free(results[i].fname);
+	}
+	free(results);
+	return ret;
+}
@@ -0,0 +1,62 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       LSB Steganalysis Detector
+ *
+ *                              -> ./a.out --detect <.bmp file or directory>... screens images for LSB stego (any tool, not only "#*").
+ *                              -> Directories are walked recursively and every .bmp file in them is screened.
+ *                              -> Carrier bytes of image (same as encoding, alpha is skipped) are done in blocks of 64K pixels.
+ *                              -> Chi-square attack : in each block, histogram counts of pairs of values (2k, 2k+1) are compared,
+ *                                 LSB embedding makes them equal, so chi-square close to its degrees of freedom marks block as embedded.
+ *                              -> Sample pair analysis : neighbour pixels of same channel are counted (X, Y, K sets),
+ *                                 and length of embedded message is estimated from them.
+ *                              -> Score is average of embedded block ratio and estimated message length, 0 => clean, 1 => LSB plane looks random.
+ *                              -> Pair counts are done 16 bytes at a time with SSE2, histograms with 4 banks fed by 64-bit loads.
+ *                              -> Images are screened on thread pool (--threads=<n>, default is no. of CPUs).
+ */
+
+
+
+
+#ifndef DETECT_H
+#define DETECT_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+
+/* Pixels in each block of chi-square attack */
+#define DETECT_BLOCK_PIXELS (64 * 1024)
+
+/* Blocks read from image file at a time */
+#define DETECT_READ_BLOCKS 16
+
+/* Images with score from this are reported as suspicious */
+#define DETECT_THRESHOLD 0.5
+
+/*
+ * Screening result of one image
+ */
+
+typedef struct _DetectResult
+{
+    char *fname;			// => Stores the image file name
+    Status status;			// => e_failure if image can't be screened
+    double score;			// => suspicion score 0 to 1
+    double spa;				// => message length estimated by sample pair analysis (0 to 1)
+    uint32_t blocks;			// => no. of blocks
+    uint32_t chi_blocks;		// => no. of blocks which look embedded by chi-square attack
+
+} DetectResult;
+
+
+/* Detect function prototypes */
+
+/* Screen images and directories given in args, and print score of each image */
+Status do_detect(int count, char *paths[]);
+
+/* Screen one image */
+Status detect_image(const char *fname, DetectResult *result);
+
+#endif
@@ -43,23 +43,40 @@
 
 
 
+#define _FILE_OFFSET_BITS 64	// 64-bit ftello/fseeko, for images and secret files bigger than 2 GB
+
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "encode.h"
 #include "types.h"
 #include "common.h"
+#include "options.h"
+#include "stats.h"
+#include "pipeline.h"
+#include "stego.h"
+#include "lsb.h"
+#include "rs.h"
+#include "cache.h"
+#include "delta.h"
+#include "png.h"
 
 /* Function Definitions */
 
 /* Get image size
  * Input: Image file ptr
- * Output: width * height * bytes per pixel (3 in our case)
+ * Output: width * height * carrier bytes per pixel (3 for 24/32 bpp, 1 for 16 bpp)
  * Description: In BMP Image, width is stored in offset 18,
  * and height after that. size is 4 bytes
+ * height is negative for top-down images, size is 64-bit
+ * so big images don't overflow
+ * bits per pixel is at offset 28, size is 2 bytes
  */
-uint get_image_size_for_bmp(FILE *fptr_image)
+uint64_t get_image_size_for_bmp(FILE *fptr_image)
 {
-    uint width, height;
+    int32_t width, height;
+    uint16_t bpp = 24;
     // Seek to 18th byte
     fseek(fptr_image, 18, SEEK_SET);
 
@@ -71,8 +88,16 @@ uint get_image_size_for_bmp(FILE *fptr_image)
     fread(&height, sizeof(int), 1, fptr_image);
     //printf("height = %u\n", height);
 
+    // Read bits per pixel (skip 2 bytes of planes)
+    fseek(fptr_image, 28, SEEK_SET);
+    fread(&bpp, sizeof(uint16_t), 1, fptr_image);
+
     // Return image capacity
-    return width * height * 3;
+    if (height < 0)
+    {
+        height = -height;
+    }
+    return (uint64_t)(uint32_t)width * (uint32_t)height * ((bpp == 16) ? 1 : 3);
 }
 
 /* 
@@ -84,10 +109,21 @@ uint get_image_size_for_bmp(FILE *fptr_image)
  */
 Status open_files(EncodeInfo *encInfo)
 {
-	printf("INFO: Opening required files\n");
+	print_info("INFO: Opening required files\n");
 
-    	// Src Image file
-    	encInfo->fptr_src_image = fopen(encInfo->src_image_fname, "rb");
+    	// Src Image file (.png is decoded into 32 bpp bmp temp file)
+	encInfo->png_alpha = 0;
+	if(png_is_png(encInfo->src_image_fname))
+	{
+		if(png_open_image(encInfo->src_image_fname, &encInfo->fptr_src_image, &encInfo->png_alpha) == e_failure)
+		{
+			return e_failure;
+		}
+	}
+	else
+	{
+    		encInfo->fptr_src_image = fopen(encInfo->src_image_fname, "rb");
+	}
     	// Do Error handling
     	if (encInfo->fptr_src_image == NULL)
     	{
@@ -95,10 +131,10 @@ Status open_files(EncodeInfo *encInfo)
     		fprintf(stderr, "ERROR: Unable to open file %s\n", encInfo->src_image_fname);
     		return e_failure;
     	}
-	printf("INFO: Opened %s\n", encInfo->src_image_fname);
+	print_info("INFO: Opened %s\n", encInfo->src_image_fname);
 
-    	// Secret file
-    	encInfo->fptr_secret = fopen(encInfo->secret_fname, "rb");
+    	// Secret file ("-" => stdin)
+    	encInfo->fptr_secret = (strcmp(encInfo->secret_fname, "-") == 0) ? stdin : fopen(encInfo->secret_fname, "rb");
     	// Do Error handling
     	if (encInfo->fptr_secret == NULL)
     	{
@@ -107,10 +143,17 @@ Status open_files(EncodeInfo *encInfo)
 		fclose(encInfo->fptr_src_image);
     		return e_failure;
     	}
-	printf("INFO: Opened %s\n", encInfo->secret_fname);
+	print_info("INFO: Opened %s\n", encInfo->secret_fname);
 
-    	// Stego Image file
-    	encInfo->fptr_stego_image = fopen(encInfo->stego_image_fname, "wb");
+    	// Stego Image file (for .png, stego bmp is made in temp file and saved as .png at end)
+	encInfo->stego_png = png_is_png(encInfo->stego_image_fname);
+	if(encInfo->stego_png && png_check_bmp(encInfo->fptr_src_image, encInfo->stego_image_fname) == e_failure)
+	{
+		fclose(encInfo->fptr_src_image);
+		fclose(encInfo->fptr_secret);
+		return e_failure;
+	}
+    	encInfo->fptr_stego_image = encInfo->stego_png ? tmpfile() : fopen(encInfo->stego_image_fname, "wb");
     	// Do Error handling
     	if (encInfo->fptr_stego_image == NULL)
     	{
@@ -121,36 +164,60 @@ Status open_files(EncodeInfo *encInfo)
 		remove(encInfo->stego_image_fname);
     		return e_failure;
     	}
-	printf("INFO: Opened %s\n", encInfo->stego_image_fname);
+	print_info("INFO: Opened %s\n", encInfo->stego_image_fname);
 
     	// No failure return e_success
     	return e_success;
 }
 
 
-/* Checks for operation type (for both encode and decode) */
+/* Checks for operation type (for encode, decode, batch, materialize and update) */
 OperationType check_operation_type(char *argv[])
 {
 	// If 2nd command-line argument "-e" then return e_encode.
-	printf("-------------------------------------------------------------------------\n");
+	print_info("-------------------------------------------------------------------------\n");
 	if(strcmp(argv[1], "-e") == 0)
 	{
-		printf("Operation Type = encode\n");
-		printf("-------------------------------------------------------------------------\n");
+		print_info("Operation Type = encode\n");
+		print_info("-------------------------------------------------------------------------\n");
 		return e_encode;
 	}
 
 	// If 2nd command-line argument "-d" then return e_decode.
 	if(strcmp(argv[1], "-d") == 0)
 	{
-		printf("Operation Type = decode\n");
-		printf("-------------------------------------------------------------------------\n");
+		print_info("Operation Type = decode\n");
+		print_info("-------------------------------------------------------------------------\n");
 		return e_decode;
 	}
 
-	// If no either of e_encode or e_decode is returned then return e_unsupported.
-	printf("Operation Type = unsupported\n");
-	printf("-------------------------------------------------------------------------\n");
+	// If 2nd command-line argument "-b" then return e_batch.
+	if(strcmp(argv[1], "-b") == 0)
+	{
+		print_info("Operation Type = batch\n");
+		print_info("-------------------------------------------------------------------------\n");
+		return e_batch;
+	}
+
+	// If 2nd command-line argument "-m" then return e_materialize.
+	if(strcmp(argv[1], "-m") == 0)
+	{
+		print_info("Operation Type = materialize\n");
+		print_info("-------------------------------------------------------------------------\n");
+		return e_materialize;
+	}
+
+	// If 2nd command-line argument "-u" then return e_update.
+	if(strcmp(argv[1], "-u") == 0)
+	{
+		print_info("Operation Type = update\n");
+		print_info("-------------------------------------------------------------------------\n");
+		return e_update;
+	}
+
+	// If no either of e_encode, e_decode, e_batch, e_materialize or e_update is returned then return e_unsupported.
+	print_info("Operation Type = unsupported\n");
+	print_info("-------------------------------------------------------------------------\n");
 	return e_unsupported;
 }
 
@@ -161,28 +228,31 @@ Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
 	// if => 3rd command-line argument doesn't contain extention, then print error and return e_failure.
 	if(strstr(argv[2], ".") == NULL)
 	{
-		printf("ERROR: %s is not a .bmp file.\n", argv[2]);
+		printf("ERROR: %s is not a .bmp/.png file.\n", argv[2]);
 		return e_failure;
 	}
 
-	// if => argv[2] is .bmp file then if condition is true else print error and return e_failure.
-	if(strcmp(strstr(argv[2], "."), ".bmp") == 0)
+	// if => argv[2] is .bmp (or .png) file then if condition is true else print error and return e_failure.
+	if(strcmp(strstr(argv[2], "."), ".bmp") == 0 || png_is_png(argv[2]))
 	{
 		int r1, r2, r3;	
-		//copy base address of ".bmp" to extn_image_file pointer.
-		encInfo->extn_image_file = ".bmp";
+		//copy base address of ".bmp" (or ".png") to extn_image_file pointer.
+		encInfo->extn_image_file = png_is_png(argv[2]) ? ".png" : ".bmp";
 		//copy base address of argv[2] to src_image_fname pointer.
 		encInfo->src_image_fname = argv[2];
 		
+		// if => 4th command-line argument is "-", then secret data is streamed from stdin, and it is decoded as .txt file.
+		char *secret_extn = (strcmp(argv[3], "-") == 0) ? ".txt" : strstr(argv[3], ".");
+
 		// if => 4th command-line argument doesn't contain extention, then print error and return e_failure.
-		if(strstr(argv[3], ".") == NULL)
+		if(secret_extn == NULL)
 		{
 			printf("ERROR: Secret message file should be .txt/.sh/.c file only.\n");	
 			return e_failure;
 		}
 
 		// if => argv[3] is .txt/.sh/.c file then if condition is true else print error and return e_failure.
-		if((r1 = (strcmp(strstr(argv[3], "."), ".txt") == 0)) || (r2 = (strcmp(strstr(argv[3], "."), ".sh") == 0)) || (r3 = (strcmp(strstr(argv[3], "."), ".c") == 0)))
+		if((r1 = (strcmp(secret_extn, ".txt") == 0)) || (r2 = (strcmp(secret_extn, ".sh") == 0)) || (r3 = (strcmp(secret_extn, ".c") == 0)))
 		{
 			// if => r1 is 1, then stores .txt base address in extn_secret_file pointer.
 			// if => r2 is 1, then stores .sh base address in extn_secret_file pointer.
@@ -208,12 +278,12 @@ Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
 				// if => 5th command-line argument doesn't contain extention, then print error and return e_failure.
 				if(strstr(argv[4], ".") == NULL)
 				{
-					printf("ERROR: Destination file %s is not a .bmp file.\n", argv[4]);
+					printf("ERROR: Destination file %s is not a .bmp/.png file.\n", argv[4]);
 					return e_failure;
 				}
 
-				// if => argv[4] is .bmp file then if condition is true else print error and return e_failure.
-				if(strcmp(strstr(argv[4], "."), ".bmp") == 0)
+				// if => argv[4] is .bmp (or .png) file then if condition is true else print error and return e_failure.
+				if(strcmp(strstr(argv[4], "."), ".bmp") == 0 || png_is_png(argv[4]))
 				{
 					// Stores argv[4] base address in stego_image_fname pointer.
 					encInfo->stego_image_fname = argv[4];
@@ -221,13 +291,13 @@ Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
 				}
 				else
 				{
-					printf("ERROR: Destination file %s is not a .bmp file.\n", argv[4]);
+					printf("ERROR: Destination file %s is not a .bmp/.png file.\n", argv[4]);
 					return e_failure;
 				}
 			}
-			else	// if => argv[4] is not entered by user, then store "stego.bmp" base address in stego_image_fname and return e_success.
+			else	// if => argv[4] is not entered by user, then store "stego.bmp" (or "stego.png" for .png source) base address in stego_image_fname and return e_success.
 			{
-				encInfo->stego_image_fname = "stego.bmp";
+				encInfo->stego_image_fname = png_is_png(argv[2]) ? "stego.png" : "stego.bmp";
 				return e_success;
 			}
 		}
@@ -237,7 +307,7 @@ Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
 			return e_failure;
 		}
 	}
-	printf("ERROR: %s is not a .bmp file.\n", argv[2]);
+	printf("ERROR: %s is not a .bmp/.png file.\n", argv[2]);
 	return e_failure;
 }
 
@@ -245,49 +315,131 @@ Status read_and_validate_encode_args(char *argv[], EncodeInfo *encInfo)
 /* Performs the encoding */
 Status do_encoding(char *argv[], EncodeInfo *encInfo)
 {
+	// encryption key is loaded before any file is created.
+	if(init_encryption(encInfo) == e_failure)
+	{
+		return e_failure;
+	}
+
+	// if => --channels, then secret data is encoded only in those channels, and mask is stored in header.
+	encInfo->channel_mask = 0;
+	encInfo->data_bit = UINT64_MAX;
+	if(options.channels != 0 && options.channels != CHANNEL_ALL)
+	{
+		if(options.delta_fname != NULL)
+		{
+			printf("ERROR: --channels can't be used with --delta.\n");
+			return e_failure;
+		}
+		encInfo->channel_mask = options.channels;
+		encInfo->header_flags |= FLAG_CHANNELS;
+	}
+
+	// if => --ecc, then secret data is encoded as Reed-Solomon codewords, and parity bytes per codeword are stored in header.
+	encInfo->ecc_parity = 0;
+	if(options.ecc_parity != 0)
+	{
+		if(options.delta_fname != NULL)
+		{
+			printf("ERROR: --ecc can't be used with --delta.\n");
+			return e_failure;
+		}
+		encInfo->ecc_parity = options.ecc_parity;
+		encInfo->header_flags |= FLAG_ECC;
+	}
+
+	// if => secret file is stdin or a pipe, then it is read as stream and its size is patched after secret data.
+	struct stat st;
+	encInfo->secret_stream = (strcmp(encInfo->secret_fname, "-") == 0) || (stat(encInfo->secret_fname, &st) == 0 && !S_ISREG(st.st_mode));
+	if(encInfo->secret_stream && options.delta_fname != NULL)
+	{
+		printf("ERROR: Streamed secret file can't be used with --delta.\n");
+		return e_failure;
+	}
+
+	// if => --delta, then only payload is written to delta file, and output image is not created.
+	if(options.delta_fname != NULL)
+	{
+		// delta file is made from bmp carrier bytes as they are in source image file.
+		if(png_is_png(encInfo->src_image_fname))
+		{
+			printf("ERROR: .png image can't be used with --delta.\n");
+			return e_failure;
+		}
+		return STATS_STAGE("delta_encode", delta_encode(encInfo, options.delta_fname));
+	}
+
+	// if => --cache has output of same source image and secret file, then it is used and nothing is encoded.
+	if(cache_lookup(encInfo) == e_success)
+	{
+		return e_success;
+	}
+
 	//open_files() function is called and if => e_success.
-	if(open_files(encInfo) == e_success)
+	if(STATS_STAGE("open_files", open_files(encInfo)) == e_success)
 	{
-		printf("INFO: Done\n");
-		printf("INFO: ## Encoding Procedure Started ##\n");
+		print_info("INFO: Done\n");
+		print_info("INFO: ## Encoding Procedure Started ##\n");
 		// check_capacity() function is called and if => e_success.
-		if(check_capacity(encInfo) == e_success)
+		if(STATS_STAGE("check_capacity", check_capacity(encInfo)) == e_success)
 		{
 			if(argv[4] == NULL)
 			{
-				printf("INFO: Output File not mentioned. Creating %s as default\n", encInfo->stego_image_fname);
+				print_info("INFO: Output File not mentioned. Creating %s as default\n", encInfo->stego_image_fname);
 			}
 			else
 			{
-				printf("INFO: Creating %s as encoded output image file.\n", encInfo->stego_image_fname);
+				print_info("INFO: Creating %s as encoded output image file.\n", encInfo->stego_image_fname);
+			}
+
+			// if => pipeline engine, then header, secret data and remaining image data are all encoded by pipeline.
+			// pipeline blocks are laid out for 24 bpp, all carrier bytes, plain secret data and known secret size, others are encoded stage by stage.
+			if(options.engine == ENGINE_PIPELINE && encInfo->pixel_format == e_bgr24 && encInfo->channel_mask == 0 && encInfo->ecc_parity == 0 && !encInfo->secret_stream)
+			{
+				Status ret = STATS_STAGE("encode_pipeline", encode_pipeline(encInfo));
+				fclose(encInfo->fptr_src_image);
+				fclose(encInfo->fptr_secret);
+				fclose(encInfo->fptr_stego_image);
+				if(ret == e_failure)
+				{
+					printf("ERROR: Encoding with pipeline failed.\n");
+					remove(encInfo->stego_image_fname);
+				}
+				else
+				{
+					cache_store(encInfo);
+				}
+				return ret;
 			}
 
 			// copy_bmp_header() function is called and if => e_success.
-			if(copy_bmp_header(encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_success)
+			if(STATS_STAGE("copy_bmp_header", copy_bmp_header(encInfo->fptr_src_image, encInfo->fptr_stego_image)) == e_success)
 			{
 				// encode_magic_string() function is called and if => e_success.
-				if(encode_magic_string(MAGIC_STRING, encInfo) == e_success)
+				// extended header magic string is followed by version and flags, old "#*" header is only decoded.
+				if(STATS_STAGE("encode_magic_string", encode_magic_string(MAGIC_STRING_EXT, encInfo)) == e_success)
 				{
 					// secret file extention size is stored in extn_secret_file_len.
 					int extn_secret_file_len = strlen(encInfo->extn_secret_file);
 					// encode_secret_file_extn_size() function is called and if => e_success.
-					if(encode_secret_file_extn_size(extn_secret_file_len, encInfo) == e_success)
+					if(STATS_STAGE("encode_secret_file_extn_size", encode_secret_file_extn_size(extn_secret_file_len, encInfo)) == e_success)
 					{
 						// encode_secret_file_extn() function is called and if => e_success.
-						if(encode_secret_file_extn(encInfo->extn_secret_file, encInfo) == e_success)
+						if(STATS_STAGE("encode_secret_file_extn", encode_secret_file_extn(encInfo->extn_secret_file, encInfo)) == e_success)
 						{
 							// encode_secret_file_size() function called and if => e_success.
-							if(encode_secret_file_size(encInfo->secret_file_size, encInfo) == e_success)
+							if(STATS_STAGE("encode_secret_file_size", encode_secret_file_size(encInfo->secret_file_size, encInfo)) == e_success)
 							{
 								// encode_secret_file_data() function is called and if => e_success.
-								if(encode_secret_file_data(encInfo) == e_success)
+								if(STATS_STAGE("encode_secret_file_data", encode_secret_file_data(encInfo)) == e_success)
 								{
-									// copy_remaining_img_data() function is called and if => e_success.
-									if(copy_remaining_img_data(encInfo->fptr_src_image, encInfo->fptr_stego_image, encInfo) == e_success)
+									// copy_remaining_img_data() function is called (and png_save_image() for .png output) and if => e_success.
+									if(STATS_STAGE("copy_remaining_img_data", copy_remaining_img_data(encInfo->fptr_src_image, encInfo->fptr_stego_image, encInfo)) == e_success && (!encInfo->stego_png || STATS_STAGE("png_save_image", png_save_image(encInfo->fptr_stego_image, encInfo->stego_image_fname, encInfo->png_alpha)) == e_success))
 									{
 										fclose(encInfo->fptr_src_image);
 										fclose(encInfo->fptr_secret);
 										fclose(encInfo->fptr_stego_image);
+										cache_store(encInfo);
 										return e_success;
 									}
 									else
@@ -375,11 +527,78 @@ Status do_encoding(char *argv[], EncodeInfo *encInfo)
 
 
 
+/* Loads key and initialises cipher, if encryption is asked in options */
+Status init_encryption(EncodeInfo *encInfo)
+{
+	encInfo->header_flags = 0;
+
+	// if => encryption is not asked, then nothing to do.
+	if(options.encrypt == 0)
+	{
+		return e_success;
+	}
+
+	print_info("INFO: Loading encryption key\n");
+	uint8_t key[CIPHER_KEY_SIZE];
+	if(cipher_load_key(options.key_fname, key) == e_failure)
+	{
+		return e_failure;
+	}
+
+	// new nonce for every encoding, it is stored in header for decoding.
+	if(cipher_make_nonce(encInfo->nonce) == e_failure)
+	{
+		printf("ERROR: Unable to generate nonce for encryption.\n");
+		return e_failure;
+	}
+	cipher_init(&encInfo->cipher, key, encInfo->nonce);
+	memset(key, 0, sizeof(key));
+
+	encInfo->header_flags |= FLAG_ENCRYPTED;
+	print_info("INFO: Done\n");
+	return e_success;
+}
+
+
+
+
 /* checks capacity of image file RGB data with secret message to encode */
 Status check_capacity(EncodeInfo *encInfo)
 {
+	// pixel format and offset of first carrier byte are taken from bmp header.
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+	rewind(encInfo->fptr_src_image);
+	if(fread(bmp_header, BMP_HEADER_SIZE, 1, encInfo->fptr_src_image) != 1 || stego_bmp_format(bmp_header, &encInfo->pixel_format, &encInfo->data_offset) == e_failure)
+	{
+		printf("ERROR: %s is not a 24, 32 or 16 bpp uncompressed bmp image.\n", encInfo->src_image_fname);
+		return e_failure;
+	}
+	encInfo->bits_encoded = 0;
+
+	// if => --channels, then pixels should be whole carrier units : 24 bpp rows without padding, or 32 bpp.
+	uint32_t width;
+	int32_t height;
+	memcpy(&width, bmp_header + 18, 4);
+	memcpy(&height, bmp_header + 22, 4);
+	if(encInfo->channel_mask != 0 && (encInfo->pixel_format == e_rgb16 || (encInfo->pixel_format == e_bgr24 && (width * 3) % 4 != 0)))
+	{
+		printf("ERROR: --channels needs 32 bpp or 24 bpp image with width multiple of 4, %s is not.\n", encInfo->src_image_fname);
+		return e_failure;
+	}
+	uint64_t pixels = (uint64_t)width * (uint32_t)((height < 0) ? -height : height);
+	encInfo->pixel_end = encInfo->data_offset + pixels * ((encInfo->pixel_format == e_bgra32) ? 4 : (encInfo->pixel_format == e_rgb16) ? 2 : 3);
+
+	// if => --metrics, then MSE is over carrier bytes of all pixels (8-bit samples, low byte for 16 bpp).
+	if(options.metrics)
+	{
+		stats_set_samples(stego_bmp_capacity(bmp_header) - BMP_HEADER_SIZE);
+	}
+
+	// bmp header is start of source image hash for cache, rest is hashed while encoding reads it.
+	cache_hash_carrier(encInfo, bmp_header, BMP_HEADER_SIZE);
+
 	// Image size plus 54 bytes bmp header size is stored in Image_capacity and then stores it to image_capacity pointer.
-	int Image_capacity = (get_image_size_for_bmp(encInfo->fptr_src_image) + 54); 		//get_image_size_for_bmp() function is called.
+	uint64_t Image_capacity = (get_image_size_for_bmp(encInfo->fptr_src_image) + 54); 		//get_image_size_for_bmp() function is called.
 	encInfo->image_capacity = Image_capacity;
 
 	// Magic String length is stored.
@@ -388,27 +607,65 @@ Status check_capacity(EncodeInfo *encInfo)
 	// secret file extension length is stored.
 	int Secret_file_extn_len = strlen(encInfo->extn_secret_file);		
 
-	printf("INFO: Checking for %s size\n", encInfo->secret_fname);
-	// secret file size is stored and then copied to secret_file_size pointer.
-	int secret_fsize = get_file_size(encInfo->fptr_secret);					//get_file_size() function is called.
-	encInfo->secret_file_size = secret_fsize - 1;
+	// extended header has version and flags bytes, and nonce if encrypted.
+	int Header_ext_len = 1 + stego_varint_size(encInfo->header_flags);
+	if(encInfo->header_flags & FLAG_ENCRYPTED)
+	{
+		Header_ext_len += CIPHER_NONCE_SIZE;
+	}
+	if(encInfo->header_flags & FLAG_CHANNELS)
+	{
+		Header_ext_len += 1;
+	}
+	if(encInfo->header_flags & FLAG_ECC)
+	{
+		Header_ext_len += 1;
+	}
 
-	//if secret file is empty then print empty.
-	if(encInfo->secret_file_size == 1 || encInfo->secret_file_size == 0)
+	// if => streamed secret file, then its size is not known, so only header is checked here and secret data is checked block by block.
+	if(encInfo->secret_stream)
 	{
-		printf("ERROR: %s file is empty\n", encInfo->secret_fname);			
-		return e_failure;
+		print_info("INFO: %s is a stream, size is encoded after secret data\n", encInfo->secret_fname);
+		encInfo->secret_file_size = 0;
 	}
-	printf("INFO: Done. Not Empty\n");
+	else
+	{
+		print_info("INFO: Checking for %s size\n", encInfo->secret_fname);
+		// secret file size is stored and then copied to secret_file_size pointer.
+		encInfo->secret_file_size = get_file_size(encInfo->fptr_secret);			//get_file_size() function is called.
+
+		//if secret file is empty then print empty.
+		if(encInfo->secret_file_size == 1 || encInfo->secret_file_size == 0)
+		{
+			printf("ERROR: %s file is empty\n", encInfo->secret_fname);			
+			return e_failure;
+		}
+		print_info("INFO: Done. Not Empty\n");
+	}
+
+	// extension size and secret file size fields are varints, size field of stream is longest varint, since size is not known yet.
+	int Extn_size_field_len = stego_varint_size(Secret_file_extn_len);
+	int Size_field_len = encInfo->secret_stream ? VARINT_MAX_SIZE : stego_varint_size(encInfo->secret_file_size);
 
-	// 54 bmp header plus (magic_string,4 - secret_file_extention_size,secret_file_extention_length,4 - secret_file_extention_size,secret_file_size)*8.
-	int Encoding_things = 54 + ((Magic_string_len + sizeof(int) + Secret_file_extn_len + 4 + encInfo->secret_file_size) * 8);
+	// if => --ecc, then parity bytes of each codeword are encoded with secret data.
+	uint64_t Secret_data_len = (encInfo->ecc_parity != 0) ? rs_encoded_size(encInfo->secret_file_size, encInfo->ecc_parity) : encInfo->secret_file_size;
 
-	printf("INFO: Checking for %s capacity to handle %s\n", encInfo->src_image_fname, encInfo->secret_fname);
+	// 54 bmp header plus (magic_string,version and flags,secret_file_extention_size,secret_file_extention_length,secret_file_size,secret_data)*8.
+	uint64_t Encoding_things = 54 + ((Magic_string_len + Header_ext_len + Extn_size_field_len + Secret_file_extn_len + Size_field_len + Secret_data_len) * 8);
+
+	// if => --channels, then secret data starts at next pixel after header and takes only carrier bytes of mask.
+	if(encInfo->channel_mask != 0)
+	{
+		uint64_t header_bits = (Magic_string_len + Header_ext_len + Extn_size_field_len + Secret_file_extn_len + Size_field_len) * 8;
+		Encoding_things = encInfo->data_offset + stego_channel_start(encInfo->pixel_format, header_bits) + lsb_channel_offset(encInfo->pixel_format, encInfo->channel_mask, Secret_data_len * 8);
+		Image_capacity = encInfo->pixel_end + 1;	// + 1, since last carrier can be last byte of pixel data
+	}
+
+	print_info("INFO: Checking for %s capacity to handle %s\n", encInfo->src_image_fname, encInfo->secret_fname);
 	//if encoding data id less then image header plus RGB data and end of file, then if condition is true.
 	if(Encoding_things < Image_capacity)
 	{
-		printf("INFO: Done. Found OK\n");
+		print_info("INFO: Done. Found OK\n");
 		return e_success;
 	}
 	printf("ERROR: \"%s\" doesn't have the capacity to encode \"%s\"\n", encInfo->src_image_fname, encInfo->secret_fname);
@@ -418,17 +675,17 @@ Status check_capacity(EncodeInfo *encInfo)
 
 
 
-/* Gets file size and the returns size as unsigned int */
-uint get_file_size(FILE *fptr)
+/* Gets file size and the returns size as 64-bit unsigned int */
+uint64_t get_file_size(FILE *fptr)
 {
 	// file pointer position is moved to end of file.
-	fseek(fptr, SEEK_CUR, SEEK_END);
+	fseeko(fptr, 0, SEEK_END);
 
 	// current position of fptr is stored in ret.
-	unsigned int ret = ftell(fptr);
+	off_t ret = ftello(fptr);
 	
 	// return ret value.
-	return ret;
+	return (ret < 0) ? 0 : (uint64_t)ret;
 }
 
 
@@ -441,7 +698,7 @@ Status copy_bmp_header(FILE *fptr_src_image, FILE *fptr_dest_image)
 	// rewind source file pointer to 0th position.
 	rewind(fptr_src_image);
 	
-	printf("INFO: Copying Image Header\n");
+	print_info("INFO: Copying Image Header\n");
 	
 	char buffer[55];
 	int r = fread(buffer, (sizeof(buffer) - 1), 1, fptr_src_image);
@@ -457,7 +714,7 @@ Status copy_bmp_header(FILE *fptr_src_image, FILE *fptr_dest_image)
 	// writes 54 bytes of data buffer to destination image file pointer.
 	fwrite(buffer, (sizeof(buffer) - 1), 1, fptr_dest_image);
 	
-	printf("INFO: Done\n");
+	print_info("INFO: Done\n");
 	return e_success;
 }
 
@@ -467,7 +724,7 @@ Status copy_bmp_header(FILE *fptr_src_image, FILE *fptr_dest_image)
 /* Stores Magic String (#*) */
 Status encode_magic_string(const char *magic_string, EncodeInfo *encInfo)
 {
-	printf("INFO: Encoding Magic String Signature\n");
+	print_info("INFO: Encoding Magic String Signature\n");
 
 	// magic string length is stored.
 	int magic_string_len = strlen(magic_string);				
@@ -476,7 +733,12 @@ Status encode_magic_string(const char *magic_string, EncodeInfo *encInfo)
 	// encode_data_to_image() function is called and if => e_success.
 	if(encode_data_to_image(magic_str, magic_string_len, encInfo) == e_success)
 	{
-		printf("INFO: Done\n");
+		// if => extended header, then version and flags are stored after magic string.
+		if(strcmp(magic_string, MAGIC_STRING_EXT) == 0 && encode_header_flags(encInfo) == e_failure)
+		{
+			return e_failure;
+		}
+		print_info("INFO: Done\n");
 		return e_success;
 	}
 	return e_failure;
@@ -484,103 +746,157 @@ Status encode_magic_string(const char *magic_string, EncodeInfo *encInfo)
 
 
 
-/* Encode function, which does the real encoding except for secret file size and extention size */
-Status encode_data_to_image(char *data, int size, EncodeInfo *encInfo)
+
+/* Stores extended header version, flags, nonce (if encrypted), channel mask and ECC parity bytes */
+Status encode_header_flags(EncodeInfo *encInfo)
+{
+	char header[1 + VARINT_MAX_SIZE + CIPHER_NONCE_SIZE + 1 + 1];
+	int header_len = 0;
+
+	// flags are a varint, so more flags can be added later (one byte while they are below 0x80).
+	header[header_len++] = HEADER_VERSION;
+	header_len += stego_put_varint((uint8_t *)header + header_len, encInfo->header_flags, 1);
+
+	// if => encrypted, then nonce is stored for decoding.
+	if(encInfo->header_flags & FLAG_ENCRYPTED)
+	{
+		memcpy(header + header_len, encInfo->nonce, CIPHER_NONCE_SIZE);
+		header_len += CIPHER_NONCE_SIZE;
+	}
+
+	// if => --channels, then channel mask is stored for decoding.
+	if(encInfo->header_flags & FLAG_CHANNELS)
+	{
+		header[header_len++] = encInfo->channel_mask;
+	}
+
+	// if => --ecc, then parity bytes per codeword are stored for decoding.
+	if(encInfo->header_flags & FLAG_ECC)
+	{
+		header[header_len++] = encInfo->ecc_parity;
+	}
+
+	// encode_data_to_image() function is called.
+	return encode_data_to_image(header, header_len, encInfo);
+}
+
+
+
+/* Gets file offset of carrier byte of payload bit, secret data bits with channel mask are counted from data_start */
+static uint64_t encode_carrier_offset(const EncodeInfo *encInfo, uint64_t bit)
 {
-	for(int i=0; i<size; i++)
+	if(bit >= encInfo->data_bit)
 	{
-		char buffer[9];
-		int r = fread(buffer, (sizeof(buffer) - 1), 1, encInfo->fptr_src_image);     	
-		buffer[8] = '\0';
+		return encInfo->data_start + lsb_channel_offset(encInfo->pixel_format, encInfo->channel_mask, bit - encInfo->data_bit);
+	}
+	return encInfo->data_offset + lsb_carrier_offset(encInfo->pixel_format, bit);
+}
 
-		// if fread doesn't read 8 bytes, then r will be 0 else r will be 1.
-		if(r == 0)							
+/* Encode function, which does the real encoding, header fields and secret data are all encoded through it */
+Status encode_data_to_image(char *data, int size, EncodeInfo *encInfo)
+{
+	// image bytes from current position till carrier byte of next bit are read and written back,
+	// so bytes in between which are not carriers (alpha, unused, before pixel data) are copied as it is.
+	// buffer holds 4 image bytes per bit, for one channel of 32 bpp (--channels).
+	static uint8_t image_buffer[SECRET_BLOCK_SIZE * 8 * 4 + STEGO_MAX_DATA_OFFSET];
+	uint64_t bit_pos = encInfo->bits_encoded;
+	uint64_t first = encode_carrier_offset(encInfo, bit_pos);
+	uint64_t begin = (bit_pos == 0) ? BMP_HEADER_SIZE : first;
+	uint64_t end = encode_carrier_offset(encInfo, bit_pos + 8 * (uint64_t)size);
+
+	// if => first block of secret data with channel mask, then rest of header's last pixel is copied with it.
+	uint mask = 0;
+	uint64_t kernel_bit = bit_pos;
+	if(bit_pos >= encInfo->data_bit)
+	{
+		mask = encInfo->channel_mask;
+		kernel_bit = bit_pos - encInfo->data_bit;
+		if(bit_pos == encInfo->data_bit)
 		{
-			printf("ERROR: 8-bytes of characters from %s image file is not read for encoding data.\n", encInfo->src_image_fname);
-			return e_failure;
+			begin = encInfo->data_offset + lsb_carrier_offset(encInfo->pixel_format, bit_pos);
 		}
-		
-		// encode_byte_to_lsb() function is called.
-		encode_byte_to_lsb(data[i], buffer, 8);
+	}
+	size_t len = end - begin;
+
+	// if fread doesn't read len bytes, then print error and return e_failure.
+	if(len > sizeof(image_buffer) || fread(image_buffer, 1, len, encInfo->fptr_src_image) != len)
+	{
+		printf("ERROR: %zu-bytes of characters from %s image file is not read for encoding data.\n", len, encInfo->src_image_fname);
+		return e_failure;
+	}
+	cache_hash_carrier(encInfo, image_buffer, len);
+
+	// if => --metrics, then carrier bytes which will change are counted while they are in image_buffer.
+	if(options.metrics)
+	{
+		stats_add_changes(lsb_count_flips(encInfo->pixel_format, mask, image_buffer + (first - begin), (uint8_t *)data, kernel_bit, 8 * (size_t)size));
+	}
+
+	// lsb_embed_channels() function is called, kernel of pixel format (and channel mask) puts bits only in carrier bytes.
+	lsb_embed_channels(encInfo->pixel_format, mask, image_buffer + (first - begin), (uint8_t *)data, kernel_bit, 8 * (size_t)size);
 
-		// writes 8 bytes of data buffer to fptr_stego_image file pointer.
-		fwrite(buffer, (sizeof(buffer) - 1), 1, encInfo->fptr_stego_image);          	
+	// if => --verify, then bits are decoded again from image_buffer before it is written.
+	if(options.verify && !lsb_verify_channels(encInfo->pixel_format, mask, image_buffer + (first - begin), (uint8_t *)data, kernel_bit, 8 * (size_t)size))
+	{
+		printf("ERROR: Verify failed, encoded bits of %s don't match payload.\n", encInfo->stego_image_fname);
+		return e_failure;
 	}
+
+	// writes len bytes of image_buffer to fptr_stego_image file pointer.
+	if(fwrite(image_buffer, 1, len, encInfo->fptr_stego_image) != len)
+	{
+		printf("ERROR: Unable to write %s encoded file.\n", encInfo->stego_image_fname);
+		return e_failure;
+	}
+	encInfo->bits_encoded += 8 * (uint64_t)size;
 	return e_success;
 }
 
 
 
 
-/* Encodes secret file extention size */
+/* Encodes secret file extention size, as varint */
 Status encode_secret_file_extn_size(int size, EncodeInfo *encInfo)
 {
-	char buffer[33];
-	int r = fread(buffer, (sizeof(buffer) - 1), 1, encInfo->fptr_src_image);        
-	buffer[32] = '\0';
+	char field[VARINT_MAX_SIZE];
+	int field_len = stego_put_varint((uint8_t *)field, size, 1);
 
-	// if fread doesn't read 32 bytes, then r will be 0 else r will be 1.
-	if(r == 0)								
+	// encode_data_to_image() function is called and if => e_failure.
+	if(encode_data_to_image(field, field_len, encInfo) == e_failure)
 	{
-		printf("ERROR: 32-bytes of characters from %s image file is not read for encoding secret file extention size.\n", encInfo->src_image_fname);
+		printf("ERROR: %d-bytes of characters from %s image file is not read for encoding secret file extention size.\n", 8 * field_len, encInfo->src_image_fname);
 		return e_failure;
 	}
 	
-	// encode_byte_to_lsb() function is called.
-	encode_byte_to_lsb(size, buffer, 32);
-
-	// writes 32 bytes of data buffer to fptr_stego_image file pointer.
-	fwrite(buffer, (sizeof(buffer) - 1), 1, encInfo->fptr_stego_image);	
-	
 	return e_success;
 }
 
 
 
-/* Encodes a byte into LSB of image data array */
-Status encode_byte_to_lsb(char data, char *image_buffer, int bytes)			
+/* Encodes a byte (8), int (32) or long (64) into LSB of image data array, msb first */
+Status encode_byte_to_lsb(uint64_t data, char *image_buffer, int bytes)			
 {
 	int l = bytes;						
 	int j = 0, bit;
 
-	// if => l is 32.
-	if(l == 32)
+	// if => l is not 8, 32 or 64.
+	if(l != 8 && l != 32 && l != 64)
 	{
-		int size = data;
-	
-		for(int i=31; i>=0; i--)
-		{
-			bit = ((unsigned)size & (1 << i)) >> i;			// gets each bits of int data one by one.
-			if(bit == 1)
-			{
-				image_buffer[j] = image_buffer[j] | 1;		// if bit is 1, then 1 is replaced to lsb of image_buffer.
-			}
-			else
-			{
-				image_buffer[j] = image_buffer[j] & (~(1));	// if bit is 0, then 0 is replaced to lsb of image_buffer.
-			}
-			j++;
-		}
+		return e_failure;
 	}
-	else if(l == 8)		// if => l is 8.
+
+	for(int i=l-1; i>=0; i--)
 	{
-		for(int i=7; i>=0; i--)
+		bit = (data >> i) & 1;					// gets each bits of data one by one.
+		if(bit == 1)
 		{
-			bit = ((unsigned)data & (1 << i)) >> i;			// gets each bits of char data one by one.
-			if(bit == 1)
-			{
-				image_buffer[j] = image_buffer[j] | 1;		// if bit is 1, then 1 is replaced to lsb of image_buffer.
-			}
-			else
-			{
-				image_buffer[j] = image_buffer[j] & (~(1));	// if bit is 0, then 0 is replaced to lsb of image_buffer.
-			}
-			j++;
+			image_buffer[j] = image_buffer[j] | 1;		// if bit is 1, then 1 is replaced to lsb of image_buffer.
 		}
-	}
-	else			// if => l is not 8 or 32.
-	{
-		return e_failure;
+		else
+		{
+			image_buffer[j] = image_buffer[j] & (~(1));	// if bit is 0, then 0 is replaced to lsb of image_buffer.
+		}
+		j++;
 	}
 
 	return e_success;
@@ -593,7 +909,7 @@ Status encode_byte_to_lsb(char data, char *image_buffer, int bytes)
 /* Encodes secret file extenstion */
 Status encode_secret_file_extn(const char *ext, EncodeInfo *encInfo)
 {
-	printf("INFO: Encoding %s File Extension\n", encInfo->secret_fname);
+	print_info("INFO: Encoding %s File Extension\n", encInfo->secret_fname);
 	
 	// length of ext pointing data is stored.
 	int ext_len = strlen(ext);
@@ -602,7 +918,7 @@ Status encode_secret_file_extn(const char *ext, EncodeInfo *encInfo)
 	// encode_data_to_image() function is called and if => e_success.
 	if(encode_data_to_image(ext_char, ext_len, encInfo) == e_success)
 	{
-		printf("INFO: Done\n");
+		print_info("INFO: Done\n");
 		return e_success;
 	}
 	return e_failure;
@@ -612,62 +928,197 @@ Status encode_secret_file_extn(const char *ext, EncodeInfo *encInfo)
 
 
 
-/* Encodes secret file size */
-Status encode_secret_file_size(int size, EncodeInfo *encInfo)
+/* Encodes secret file size as varint, 1 byte for sizes below 128, 2 bytes below 16 KB, and so on */
+Status encode_secret_file_size(uint64_t size, EncodeInfo *encInfo)
 {
-	printf("INFO: Encoding %s File Size\n", encInfo->secret_fname);
+	print_info("INFO: Encoding %s File Size\n", encInfo->secret_fname);
 	
-	char buffer[33];
-	int r = fread(buffer, (sizeof(buffer) - 1), 1, encInfo->fptr_src_image);
-	buffer[32] = '\0';
+	// streamed secret file has longest varint, since its size is patched after secret data is encoded.
+	encInfo->size_field_bit = encInfo->bits_encoded;
+
+	char field[VARINT_MAX_SIZE];
+	int field_len = stego_put_varint((uint8_t *)field, size, encInfo->secret_stream ? VARINT_MAX_SIZE : 1);
+
+	// encode_data_to_image() function is called and if => e_failure.
+	if(encode_data_to_image(field, field_len, encInfo) == e_failure)
+	{
+		printf("ERROR: %d-bytes of characters from %s image file is not read for encoding secret file size.\n", 8 * field_len, encInfo->src_image_fname);
+		return e_failure;
+	}
 	
-	// if fread doesn't read 32 bytes, then r will be 0 else r will be 1.
-	if(r == 0)
+	print_info("INFO: Done\n");
+	return e_success;
+}
+
+
+
+
+/* Patches secret file size field after streamed secret data, carrier bytes of field are encoded again with real size */
+Status patch_secret_file_size(EncodeInfo *encInfo)
+{
+	// size varint is padded to same length as zero size encoded before.
+	uint8_t field[VARINT_MAX_SIZE];
+	stego_put_varint(field, encInfo->secret_file_size, VARINT_MAX_SIZE);
+	uint64_t bit_pos = encInfo->size_field_bit;
+	size_t nbits = 8 * VARINT_MAX_SIZE;
+
+	// carrier bytes of size are read again from source image (at most 2 bytes per bit, 16 bpp), and written over output.
+	uint8_t image[2 * 8 * VARINT_MAX_SIZE];
+	uint64_t first = encInfo->data_offset + lsb_carrier_offset(encInfo->pixel_format, bit_pos);
+	size_t len = encInfo->data_offset + lsb_carrier_offset(encInfo->pixel_format, bit_pos + nbits - 1) + 1 - first;
+	if(pread(fileno(encInfo->fptr_src_image), image, len, first) != (ssize_t)len)
 	{
-		printf("ERROR: 32-bytes of characters from %s image file is not read for encoding secret file size.\n", encInfo->src_image_fname);
+		printf("ERROR: Unable to read %s image file to patch secret file size.\n", encInfo->src_image_fname);
 		return e_failure;
 	}
 
-	// encode_byte_to_lsb() function is called.
-	encode_byte_to_lsb(size, buffer, 32);
+	// if => --metrics, then changes of zero size encoded before are replaced by changes of real size (wraps back to right total).
+	if(options.metrics)
+	{
+		uint8_t zero[VARINT_MAX_SIZE];
+		stego_put_varint(zero, 0, VARINT_MAX_SIZE);
+		stats_add_changes(lsb_count_flips(encInfo->pixel_format, 0, image, field, bit_pos, nbits) - lsb_count_flips(encInfo->pixel_format, 0, image, zero, bit_pos, nbits));
+	}
 
-	// writes 32 bytes of data buffer to fptr_stego_image file pointer.
-	fwrite(buffer, (sizeof(buffer) - 1), 1, encInfo->fptr_stego_image);
-	
-	printf("INFO: Done\n");
+	lsb_embed_pixels(encInfo->pixel_format, image, field, bit_pos, nbits);
+	if(options.verify && !lsb_verify_pixels(encInfo->pixel_format, image, field, bit_pos, nbits))
+	{
+		printf("ERROR: Verify failed, encoded bits of %s don't match payload.\n", encInfo->stego_image_fname);
+		return e_failure;
+	}
+
+	// output is flushed first, so patch is not overwritten by buffered data.
+	if(fflush(encInfo->fptr_stego_image) != 0 || pwrite(fileno(encInfo->fptr_stego_image), image, len, first) != (ssize_t)len)
+	{
+		printf("ERROR: Unable to patch secret file size in %s encoded file.\n", encInfo->stego_image_fname);
+		return e_failure;
+	}
+	print_info("INFO: Patched %s File Size (%llu bytes)\n", encInfo->secret_fname, (unsigned long long)encInfo->secret_file_size);
 	return e_success;
 }
 
 
 
 
+/* Encodes a block of secret data : keystream is XORed (if encrypted), then it is made into codewords (if --ecc) and encoded */
+static Status encode_secret_block(EncodeInfo *encInfo, const RsCode *rs, char *data, size_t len)
+{
+	static uint8_t code[RS_BLOCK_CODEWORDS * RS_CODEWORD_SIZE];
+
+	// if => encrypted, then keystream is XORed into same block before encoding.
+	if(encInfo->header_flags & FLAG_ENCRYPTED)
+	{
+		cipher_xor(&encInfo->cipher, (uint8_t *)data, len);
+	}
+
+	// if => --ecc, then codewords (data and parity bytes) are encoded instead of data.
+	if(encInfo->ecc_parity != 0)
+	{
+		size_t code_len = rs_encode(rs, (uint8_t *)data, len, code);
+		return encode_data_to_image((char *)code, code_len, encInfo);
+	}
+	return encode_data_to_image(data, len, encInfo);
+}
+
+/* Encodes streamed secret data as it arrives, till end of stream, capacity is checked before each block */
+static Status encode_secret_stream_data(EncodeInfo *encInfo, const RsCode *rs, size_t block)
+{
+	char secret_file_data[SECRET_BLOCK_SIZE];
+	size_t len;
+
+	encInfo->secret_file_size = 0;
+	while((len = fread(secret_file_data, 1, block, encInfo->fptr_secret)) > 0)
+	{
+		// if => block (with its parity bytes) doesn't fit in image, then encoding is stopped before block is written.
+		uint64_t code_len = (encInfo->ecc_parity != 0) ? rs_encoded_size(len, encInfo->ecc_parity) : len;
+		if(encode_carrier_offset(encInfo, encInfo->bits_encoded + 8 * code_len) > encInfo->pixel_end)
+		{
+			printf("ERROR: \"%s\" doesn't have the capacity to encode \"%s\", stream is longer than %llu bytes.\n", encInfo->src_image_fname, encInfo->secret_fname, (unsigned long long)encInfo->secret_file_size);
+			return e_failure;
+		}
+		if(encode_secret_block(encInfo, rs, secret_file_data, len) == e_failure)
+		{
+			return e_failure;
+		}
+		encInfo->secret_file_size += len;
+	}
+
+	if(ferror(encInfo->fptr_secret))
+	{
+		printf("ERROR: %s stream is not read.\n", encInfo->secret_fname);
+		return e_failure;
+	}
+	if(encInfo->secret_file_size == 0)
+	{
+		printf("ERROR: %s stream is empty\n", encInfo->secret_fname);
+		return e_failure;
+	}
+	return patch_secret_file_size(encInfo);
+}
+
+
+
+
 /* Encodes secret file data */
 Status encode_secret_file_data(EncodeInfo *encInfo)
 {
-	// rewind fptr_secret file pointer to 0th position.
-	rewind(encInfo->fptr_secret);
-	
-	printf("INFO: Encoding %s File Data\n", encInfo->secret_fname);
+	print_info("INFO: Encoding %s File Data\n", encInfo->secret_fname);
 
-	// secret file data is read.
-	char secret_file_data[(encInfo->secret_file_size) + 1];
-	int r = fread(secret_file_data, (sizeof(secret_file_data) - 1), 1, encInfo->fptr_secret);
-	secret_file_data[encInfo->secret_file_size] = '\0';
+	// if => --channels, then secret data starts at next pixel after header.
+	if(encInfo->channel_mask != 0)
+	{
+		encInfo->data_bit = encInfo->bits_encoded;
+		encInfo->data_start = encInfo->data_offset + stego_channel_start(encInfo->pixel_format, encInfo->data_bit);
+	}
 
-	// if fread doesn't read secret_file_size number of bytes, then r will be 0 else r will be 1.
-	if(r == 0)
+	// if => --ecc, then blocks are whole codewords, so only last codeword of secret data is shortened.
+	static RsCode rs;
+	size_t block = SECRET_BLOCK_SIZE;
+	if(encInfo->ecc_parity != 0)
 	{
-		printf("ERROR: %s file data is not read.\n", encInfo->secret_fname);
-		return e_failure;
+		rs_init(&rs, encInfo->ecc_parity);
+		block = RS_BLOCK_CODEWORDS * rs.ndata;
+		print_info("INFO: Secret data is Reed-Solomon coded, %u parity bytes per %u byte codeword\n", rs.nparity, RS_CODEWORD_SIZE);
 	}
 
-	// encode_data_to_image() function is called and if => e_success.
-	if(encode_data_to_image(secret_file_data, encInfo->secret_file_size, encInfo) == e_success)
+	// if => streamed secret file, then it is read till end, and size is patched after it.
+	if(encInfo->secret_stream)
 	{
-		printf("INFO: Done\n");
+		if(encode_secret_stream_data(encInfo, &rs, block) == e_failure)
+		{
+			return e_failure;
+		}
+		print_info("INFO: Done\n");
 		return e_success;
 	}
-	return e_failure;
+
+	// rewind fptr_secret file pointer to 0th position.
+	rewind(encInfo->fptr_secret);
+
+	// secret file data is read and encoded block by block.
+	char secret_file_data[SECRET_BLOCK_SIZE];
+	uint64_t remaining = encInfo->secret_file_size;
+	while(remaining > 0)
+	{
+		int len = (remaining < block) ? (int)remaining : (int)block;
+		int r = fread(secret_file_data, len, 1, encInfo->fptr_secret);
+
+		// if fread doesn't read len number of bytes, then r will be 0 else r will be 1.
+		if(r == 0)
+		{
+			printf("ERROR: %s file data is not read.\n", encInfo->secret_fname);
+			return e_failure;
+		}
+
+		// encode_secret_block() function is called and if => e_failure.
+		if(encode_secret_block(encInfo, &rs, secret_file_data, len) == e_failure)
+		{
+			return e_failure;
+		}
+		remaining -= len;
+	}
+	print_info("INFO: Done\n");
+	return e_success;
 }
 
 
@@ -676,29 +1127,29 @@ Status encode_secret_file_data(EncodeInfo *encInfo)
 /* Copies remaining image bytes from source image file to destination image file after encoding secret message */
 Status copy_remaining_img_data(FILE* fptr_src, FILE* fptr_dest, EncodeInfo *encInfo)
 {
-	printf("INFO: Copying Left Over Data\n");
-
-	// current position of fptr_src file pointer is stored in cur_pos.
-	int cur_pos = ftell(fptr_src);
+	print_info("INFO: Copying Left Over Data\n");
 
-	// i value loops from cur_pos value to image_capacity value.
-	for(int i=cur_pos; i<=(encInfo->image_capacity); i++)
+	// remaining bytes are copied block by block till end of source image file.
+	static char buffer[COPY_BLOCK_SIZE];
+	size_t r;
+	while((r = fread(buffer, 1, sizeof(buffer), fptr_src)) > 0)
 	{
-		char ch;
-		int r = fread(&ch, sizeof(char), 1, fptr_src);
+		cache_hash_carrier(encInfo, buffer, r);
 
-		// if fread doesn't read 1 byte each loop, then r will be 0 else r will be 1.
-		if(r == 0)
+		// if fwrite doesn't write all r bytes, then print error and return e_failure.
+		if(fwrite(buffer, 1, r, fptr_dest) != r)
 		{
-			printf("ERROR: Character from %s image file is not read for copying remaining data to %s encoded file.\n", encInfo->src_image_fname, encInfo->secret_fname);
+			printf("ERROR: Unable to write remaining image data to %s encoded file.\n", encInfo->stego_image_fname);
 			return e_failure;
 		}
+	}
 
-		// writes 1 byte of data from ch to fptr_dest file pointer for each loop.
-		fwrite(&ch, sizeof(char), 1, fptr_dest);
+	// if => stopped because of read error and not end of file, then print error and return e_failure.
+	if(ferror(fptr_src))
+	{
+		printf("ERROR: Unable to read remaining image data from %s image file.\n", encInfo->src_image_fname);
+		return e_failure;
 	}
-	printf("INFO: Done\n");
+	print_info("INFO: Done\n");
 	return e_success;
 }
-
-
@@ -46,6 +46,8 @@
 #define ENCODE_H
 
 #include "types.h" // Contains user defined types
+#include "cipher.h" // Contains payload encryption
+#include "hash.h" // Contains hash of cached encodings
 
 /* 
  * Structure to store information required for
@@ -60,17 +62,42 @@ typedef struct _EncodeInfo
     char *src_image_fname;		// => stores the src_Image_fname
     FILE *fptr_src_image;		// => File pointer for src_image
     char *extn_image_file;		// => stores image_file extension
-    uint image_capacity;		// => Stores the src_img_filesize
+    uint64_t image_capacity;		// => Stores the src_img_filesize
+    int png_alpha;			// => 1 if src_image is RGBA .png, alpha is kept in .png output
 
     /* Secret File Info */
     char *secret_fname;			// => Stores the Secret_fname	
     FILE *fptr_secret;			// => File pointer for secret_file
     char *extn_secret_file;		// => Stores the secret_file extention
-    uint secret_file_size;		// => stores the secret_file filesize.
+    uint64_t secret_file_size;		// => stores the secret_file filesize.
+    int secret_stream;			// => 1 if secret file is stdin ("-") or a pipe, its size is known only at end
+    uint64_t size_field_bit;		// => payload bit of secret file size field, which is patched for stream
 
     /* Stego Image Info */
     char *stego_image_fname;		// => Stores the Output_img_fname
-    FILE *fptr_stego_image;		// => File pointer for stego_image
+    FILE *fptr_stego_image;		// => File pointer for stego_image (temp file for .png output)
+    int stego_png;			// => 1 if stego_image is .png, it is saved from temp file at end
+
+    /* Pixel Format Info */
+    PixelFormat pixel_format;		// => Stores the src_image pixel format (24/32/16 bpp)
+    uint64_t data_offset;		// => file offset of first carrier byte
+    uint64_t bits_encoded;		// => no. of payload bits encoded so far
+    uint64_t pixel_end;			// => file offset after last pixel byte (capacity of streamed secret)
+
+    /* Header Info */
+    uint8_t header_flags;		// => Stores FLAG_* bits of extended header (0 => no flags)
+    uint8_t nonce[CIPHER_NONCE_SIZE];	// => Stores the nonce used for encryption
+    uint8_t channel_mask;		// => CHANNEL_* carriers of secret data (0 => all carrier bytes)
+    uint64_t data_bit;			// => payload bit where secret data starts (UINT64_MAX => not with channel mask)
+    uint64_t data_start;		// => file offset of first pixel of secret data with channel mask
+    uint8_t ecc_parity;			// => Reed-Solomon parity bytes per codeword (0 => no error correction)
+    CipherCtx cipher;			// => ChaCha20 state for encryption
+
+    /* Cache Info */
+    int cache_enabled;			// => 1 if output should be stored in cache (--cache)
+    HashState carrier_hash;		// => hash of src_image bytes read so far
+    uint64_t secret_hash;		// => hash of secret file bytes
+    uint64_t cache_id;			// => hash of src_image file identity and secret file
 
 } EncodeInfo;
 
@@ -89,14 +116,17 @@ Status do_encoding(char *argv[], EncodeInfo *encInfo);
 /* Get File pointers for i/p and o/p files */
 Status open_files(EncodeInfo *encInfo);
 
+/* Load key and prepare encryption, if asked */
+Status init_encryption(EncodeInfo *encInfo);
+
 /* check capacity */
 Status check_capacity(EncodeInfo *encInfo);
 
 /* Get image size */
-uint get_image_size_for_bmp(FILE *fptr_image);
+uint64_t get_image_size_for_bmp(FILE *fptr_image);
 
 /* Get file size */
-uint get_file_size(FILE *fptr);
+uint64_t get_file_size(FILE *fptr);
 
 /* Copy bmp image header */
 Status copy_bmp_header(FILE *fptr_src_image, FILE *fptr_dest_image);
@@ -104,6 +134,9 @@ Status copy_bmp_header(FILE *fptr_src_image, FILE *fptr_dest_image);
 /* Store Magic String */
 Status encode_magic_string(const char *magic_string, EncodeInfo *encInfo);
 
+/* Store extended header version, flags and nonce */
+Status encode_header_flags(EncodeInfo *encInfo);
+
 /* Encode secret file extention size */
 Status encode_secret_file_extn_size(int size, EncodeInfo *encInfo);
 
@@ -111,7 +144,10 @@ Status encode_secret_file_extn_size(int size, EncodeInfo *encInfo);
 Status encode_secret_file_extn(const char *file_extn, EncodeInfo *encInfo);
 
 /* Encode secret file size */
-Status encode_secret_file_size(int file_size, EncodeInfo *encInfo);
+Status encode_secret_file_size(uint64_t file_size, EncodeInfo *encInfo);
+
+/* Patch secret file size field after streamed secret data */
+Status patch_secret_file_size(EncodeInfo *encInfo);
 
 /* Encode secret file data */
 Status encode_secret_file_data(EncodeInfo *encInfo);
@@ -119,8 +155,8 @@ Status encode_secret_file_data(EncodeInfo *encInfo);
 /* Encode function, which does the real encoding */
 Status encode_data_to_image(char *data, int size, EncodeInfo *encInfo);
 
-/* Encode a byte into LSB of image data array */
-Status encode_byte_to_lsb(char data, char *image_buffer, int bytes);
+/* Encode a byte (8), int (32) or long (64) into LSB of image data array */
+Status encode_byte_to_lsb(uint64_t data, char *image_buffer, int bytes);
 
 /* Copy remaining image bytes from src to stego image after encoding */
 Status copy_remaining_img_data(FILE *fptr_src, FILE *fptr_dest, EncodeInfo *encInfo);
@@ -0,0 +1,180 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Fast 64-bit Hash
+ *
+ *                              -> XXH64 : 4 lanes of 64-bit multiply/rotate on each 32 byte stripe, then lanes are merged,
+ *                                 tail bytes are mixed and result is avalanched.
+ *                              -> Bytes which don't make full stripe are kept in state buffer till next update.
+ */
+
+
+
+
+#include <string.h>
+#include "hash.h"
+
+#define PRIME1 0x9E3779B185EBCA87ULL
+#define PRIME2 0xC2B2AE3D27D4EB4FULL
+#define PRIME3 0x165667B19E3779F9ULL
+#define PRIME4 0x85EBCA77C2B2AE63ULL
+#define PRIME5 0x27D4EB2F165667C5ULL
+
+/* Function Definitions */
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, 8);
+	return v;
+}
+
+static inline uint32_t read32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+/* Mixes 8 input bytes into lane */
+static inline uint64_t hash_round(uint64_t acc, uint64_t input)
+{
+	acc += input * PRIME2;
+	acc = rotl64(acc, 31);
+	return acc * PRIME1;
+}
+
+/* Merges lane into hash */
+static inline uint64_t hash_merge(uint64_t h, uint64_t lane)
+{
+	h ^= hash_round(0, lane);
+	return h * PRIME1 + PRIME4;
+}
+
+/* Hashes full stripes of p, returns no. of bytes done */
+static size_t hash_stripes(uint64_t v[4], const uint8_t *p, size_t len)
+{
+	size_t done = 0;
+	uint64_t v1 = v[0], v2 = v[1], v3 = v[2], v4 = v[3];
+
+	for(; done + 32 <= len; done += 32)
+	{
+		v1 = hash_round(v1, read64(p + done));
+		v2 = hash_round(v2, read64(p + done + 8));
+		v3 = hash_round(v3, read64(p + done + 16));
+		v4 = hash_round(v4, read64(p + done + 24));
+	}
+
+	v[0] = v1;
+	v[1] = v2;
+	v[2] = v3;
+	v[3] = v4;
+	return done;
+}
+
+/* Initialise hash state with seed */
+void hash_init(HashState *state, uint64_t seed)
+{
+	memset(state, 0, sizeof(*state));
+	state->v[0] = seed + PRIME1 + PRIME2;
+	state->v[1] = seed + PRIME2;
+	state->v[2] = seed;
+	state->v[3] = seed - PRIME1;
+}
+
+/* Hash len bytes of data */
+void hash_update(HashState *state, const void *data, size_t len)
+{
+	const uint8_t *p = data;
+	state->total_len += len;
+
+	// if => bytes are left from last update, then stripe is completed first.
+	if(state->buffer_len > 0)
+	{
+		size_t n = 32 - state->buffer_len;
+		if(n > len)
+		{
+			n = len;
+		}
+		memcpy(state->buffer + state->buffer_len, p, n);
+		state->buffer_len += n;
+		p += n;
+		len -= n;
+		if(state->buffer_len < 32)
+		{
+			return;
+		}
+		hash_stripes(state->v, state->buffer, 32);
+		state->buffer_len = 0;
+	}
+
+	size_t done = hash_stripes(state->v, p, len);
+	memcpy(state->buffer, p + done, len - done);
+	state->buffer_len = len - done;
+}
+
+/* Get hash of all bytes hashed so far (state is not changed) */
+uint64_t hash_digest(const HashState *state)
+{
+	uint64_t h;
+	const uint8_t *p = state->buffer;
+	uint32_t len = state->buffer_len;
+
+	if(state->total_len >= 32)
+	{
+		h = rotl64(state->v[0], 1) + rotl64(state->v[1], 7) + rotl64(state->v[2], 12) + rotl64(state->v[3], 18);
+		for(int i=0; i<4; i++)
+		{
+			h = hash_merge(h, state->v[i]);
+		}
+	}
+	else
+	{
+		// v[2] is seed.
+		h = state->v[2] + PRIME5;
+	}
+	h += state->total_len;
+
+	// tail bytes, 8 then 4 then 1 at a time.
+	for(; len >= 8; p += 8, len -= 8)
+	{
+		h ^= hash_round(0, read64(p));
+		h = rotl64(h, 27) * PRIME1 + PRIME4;
+	}
+	if(len >= 4)
+	{
+		h ^= (uint64_t)read32(p) * PRIME1;
+		h = rotl64(h, 23) * PRIME2 + PRIME3;
+		p += 4;
+		len -= 4;
+	}
+	for(; len > 0; p++, len--)
+	{
+		h ^= *p * PRIME5;
+		h = rotl64(h, 11) * PRIME1;
+	}
+
+	// avalanche.
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+	return h;
+}
+
+/* Hash of len bytes of data */
+uint64_t hash64(const void *data, size_t len, uint64_t seed)
+{
+	HashState state;
+	hash_init(&state, seed);
+	hash_update(&state, data, len);
+	return hash_digest(&state);
+}
@@ -0,0 +1,49 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Fast 64-bit Hash
+ *
+ *                              -> XXH64 hash, done in parts (init, update, digest) so it can be done along with read pass of a file.
+ *                              -> Used for keys of result cache, not for security.
+ */
+
+
+
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Hash state, data of update calls is hashed in 32 byte stripes
+ */
+
+typedef struct _HashState
+{
+    uint64_t v[4];			// => 4 accumulators of stripes
+    uint64_t total_len;			// => no. of bytes hashed so far
+    uint8_t buffer[32];			// => bytes of incomplete stripe
+    uint32_t buffer_len;		// => no. of bytes in buffer
+
+} HashState;
+
+
+/* Hash function prototypes */
+
+/* Initialise hash state with seed */
+void hash_init(HashState *state, uint64_t seed);
+
+/* Hash len bytes of data */
+void hash_update(HashState *state, const void *data, size_t len);
+
+/* Get hash of all bytes hashed so far (state is not changed) */
+uint64_t hash_digest(const HashState *state);
+
+/* Hash of len bytes of data */
+uint64_t hash64(const void *data, size_t len, uint64_t seed);
+
+#endif
@@ -0,0 +1,555 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       LSB Kernels for In-memory Encoding and Decoding
+ *
+ *                              -> Same bit layout as encode_byte_to_lsb() and decode_char_bytes_from_lsb().
+ *                              -> Each payload byte takes 8 image bytes, msb of payload byte goes to lsb of first image byte.
+ *                              -> Whole bytes are done 8 image bytes at a time with one 64-bit load and store (SWAR).
+ *                              -> Bit functions take a bit position, so a block of image data can start in middle of a payload byte.
+ *                              -> Pixel functions do the same for 24, 32 and 16 bpp images, only carrier bytes of each pixel are changed.
+ *                              -> Kernel of each pixel format is made from one macro with bytes per pixel and carrier bytes fixed at compile time.
+ *                              -> With SSSE3 (-mssse3 or -march=native), alpha/unused bytes are skipped with one pshufb per 16 image bytes.
+ *                              -> Channel functions take a channel mask (blue, green, red), only those bytes of each pixel are carriers,
+ *                                 kernels of every mask are made from same macro, 3 byte pixels use groups of 3 vectors, each with own shuffle.
+ */
+
+
+
+
+#include <string.h>
+#include "lsb.h"
+#include "types.h"
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+/* LSB of each of 8 bytes */
+#define LSB_MASK 0x0101010101010101ull
+
+/* Bit of payload byte kept in each of 8 bytes, bit 7 in first byte */
+#define SPREAD_SELECT 0x0102040810204080ull
+
+/* Multiplier which gathers LSB of 8 bytes into top byte, first byte's LSB becomes msb */
+#define GATHER_MUL 0x8040201008040201ull
+
+/* Payload bytes decoded at a time by verify */
+#define LSB_VERIFY_BYTES 1024
+
+/* Function Definitions */
+
+/* Loads 8 bytes, first byte in low bits (same as little endian) */
+static inline uint64_t load64(const uint8_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+	return v;
+}
+
+/* Stores 8 bytes, low bits in first byte */
+static inline void store64(uint8_t *p, uint64_t v)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+	memcpy(p, &v, 8);
+}
+
+/* Spreads 8 bits of a byte to LSB of 8 bytes, msb to first byte */
+static inline uint64_t spread_byte(uint8_t b)
+{
+	// byte is copied to all 8 bytes, and first byte keeps bit 7, second keeps bit 6 and so on.
+	uint64_t t = ((uint64_t)b * LSB_MASK) & SPREAD_SELECT;
+
+	// each byte is now 0 or one bit set, adding 0x7F moves non zero to bit 7 without carry.
+	return ((t + 0x7F7F7F7F7F7F7F7Full) >> 7) & LSB_MASK;
+}
+
+
+
+/* Encodes len payload bytes into LSB of 8 * len image bytes */
+void lsb_embed_bytes(uint8_t *image, const uint8_t *data, size_t len)
+{
+	for(size_t i=0; i<len; i++)
+	{
+		uint64_t v = load64(image + 8 * i);
+		store64(image + 8 * i, (v & ~LSB_MASK) | spread_byte(data[i]));
+	}
+}
+
+
+
+/* Decodes len payload bytes from LSB of 8 * len image bytes, works in place */
+void lsb_extract_bytes(const uint8_t *image, uint8_t *data, size_t len)
+{
+	for(size_t i=0; i<len; i++)
+	{
+		uint64_t v = load64(image + 8 * i) & LSB_MASK;
+		data[i] = (uint8_t)((v * GATHER_MUL) >> 56);
+	}
+}
+
+
+
+/* Encodes payload bits [bit_pos, bit_pos + nbits) into LSB of nbits image bytes */
+void lsb_embed_bits(uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	size_t i = 0;
+
+	// head, till payload byte boundary.
+	while(i < nbits && (bit_pos + i) % 8 != 0)
+	{
+		uint64_t b = bit_pos + i;
+		image[i] = (image[i] & ~1) | ((payload[b / 8] >> (7 - b % 8)) & 1);
+		i++;
+	}
+
+	// whole payload bytes.
+	size_t whole = (nbits - i) / 8;
+	lsb_embed_bytes(image + i, payload + (bit_pos + i) / 8, whole);
+	i += 8 * whole;
+
+	// tail.
+	while(i < nbits)
+	{
+		uint64_t b = bit_pos + i;
+		image[i] = (image[i] & ~1) | ((payload[b / 8] >> (7 - b % 8)) & 1);
+		i++;
+	}
+}
+
+
+
+/* Decodes payload bits [bit_pos, bit_pos + nbits) from LSB of nbits image bytes */
+void lsb_extract_bits(const uint8_t *image, uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	size_t i = 0;
+
+	// head, till payload byte boundary.
+	while(i < nbits && (bit_pos + i) % 8 != 0)
+	{
+		uint64_t b = bit_pos + i;
+		uint8_t mask = 1 << (7 - b % 8);
+		payload[b / 8] = (image[i] & 1) ? (payload[b / 8] | mask) : (payload[b / 8] & ~mask);
+		i++;
+	}
+
+	// whole payload bytes.
+	size_t whole = (nbits - i) / 8;
+	lsb_extract_bytes(image + i, payload + (bit_pos + i) / 8, whole);
+	i += 8 * whole;
+
+	// tail.
+	while(i < nbits)
+	{
+		uint64_t b = bit_pos + i;
+		uint8_t mask = 1 << (7 - b % 8);
+		payload[b / 8] = (image[i] & 1) ? (payload[b / 8] | mask) : (payload[b / 8] & ~mask);
+		i++;
+	}
+}
+
+
+
+
+/*
+ * Pixel format kernels
+ *
+ * Carrier bytes of each pixel are chosen by channel mask : bit c of mask => byte c of pixel is a carrier.
+ * Group is GROUP_PIXELS pixels => whole 16 byte vectors of image bytes, and whole payload bytes.
+ * Groups start at pixel and payload byte boundary, so whole groups need no bit shifting.
+ */
+
+/* No. of carrier bytes per pixel of channel mask */
+#define MASK_CHANNELS(M)	(((M) & 1) + (((M) >> 1) & 1) + (((M) >> 2) & 1) + (((M) >> 3) & 1))
+
+/* Byte of pixel which is carrier i of channel mask => byte b whose bit is set and is (i + 1)th set bit of mask */
+#define MASK_NTH(i, M)		(((M) & 1) && (i) == 0 ? 0 : ((M) & 2) && (i) + 1 == MASK_CHANNELS((M) & 3) ? 1 :	\
+				 ((M) & 4) && (i) + 1 == MASK_CHANNELS((M) & 7) ? 2 : 3)
+
+/* Pixels per group, 16 for 3 byte pixels so group is 3 whole vectors */
+#define GROUP_PIXELS(STRIDE)	(((STRIDE) % 2) ? 16 : 8)
+
+/* Carrier bytes (payload bits) per group */
+#define GROUP_BITS(STRIDE, MASK)	(GROUP_PIXELS(STRIDE) * MASK_CHANNELS(MASK))
+
+/* Offset of carrier byte k in pixel data */
+#define CARRIER_OFFSET(k, STRIDE, MASK)	(((k) / MASK_CHANNELS(MASK)) * (STRIDE) + MASK_NTH((k) % MASK_CHANNELS(MASK), MASK))
+
+/* Is image byte j a carrier byte */
+#define IS_CARRIER(j, STRIDE, MASK)		(((MASK) >> ((j) % (STRIDE))) & 1)
+
+/* No. of carrier bytes before image byte j (so index of j, if j is a carrier) */
+#define CARRIER_INDEX(j, STRIDE, MASK)	(((j) / (STRIDE)) * MASK_CHANNELS(MASK) + MASK_CHANNELS((MASK) & ((1 << ((j) % (STRIDE))) - 1)))
+
+#ifdef __SSSE3__
+
+/* First carrier byte of vector of image byte j */
+#define VECTOR_BASE(j, S, M)	CARRIER_INDEX((j) / 16 * 16, S, M)
+
+/* pshufb index for image byte j : carrier byte it gets (from first carrier of its vector), or 0x80 (zero) for other bytes */
+#define EMBED_SHUF(j, S, M)	(char)(IS_CARRIER(j, S, M) ? CARRIER_INDEX(j, S, M) - VECTOR_BASE(j, S, M) : 0x80)
+
+/* pshufb index for carrier q = j % 16 of vector of image byte j : image byte it comes from, or 0x80 after last carrier of vector */
+#define EXTRACT_SHUF(j, S, M)	(char)(VECTOR_BASE(j, S, M) + (j) % 16 < VECTOR_BASE((j) + 16, S, M) ? CARRIER_OFFSET(VECTOR_BASE(j, S, M) + (j) % 16, S, M) - (j) / 16 * 16 : 0x80)
+
+/* AND mask which clears LSB of carrier bytes only */
+#define KEEP_MASK(j, S, M)	(char)(IS_CARRIER(j, S, M) ? 0xFE : 0xFF)
+
+/* 16 bytes of pshufb index / mask for vector v of group */
+#define SHUF16(F, v, S, M)	_mm_setr_epi8(F(16 * (v) + 0, S, M), F(16 * (v) + 1, S, M), F(16 * (v) + 2, S, M), F(16 * (v) + 3, S, M),	\
+					      F(16 * (v) + 4, S, M), F(16 * (v) + 5, S, M), F(16 * (v) + 6, S, M), F(16 * (v) + 7, S, M),	\
+					      F(16 * (v) + 8, S, M), F(16 * (v) + 9, S, M), F(16 * (v) + 10, S, M), F(16 * (v) + 11, S, M),	\
+					      F(16 * (v) + 12, S, M), F(16 * (v) + 13, S, M), F(16 * (v) + 14, S, M), F(16 * (v) + 15, S, M))
+
+/* All vectors of a group (at most 3), so each vector has its own shuffle */
+#define SHUF_GROUP(F, S, M)	{ SHUF16(F, 0, S, M), SHUF16(F, 1, S, M), SHUF16(F, 2, S, M) }
+
+/* Encodes whole groups, carrier bits are moved to pixel positions with one pshufb per vector (STRIDE > CHANNELS) */
+#define EMBED_GROUPS_BODY(STRIDE, MASK)											\
+	const __m128i shuf[3] = SHUF_GROUP(EMBED_SHUF, STRIDE, MASK);							\
+	const __m128i keep[3] = SHUF_GROUP(KEEP_MASK, STRIDE, MASK);							\
+	for(size_t g=0; g<groups; g++, image += GROUP_PIXELS(STRIDE) * (STRIDE), data += GROUP_BITS(STRIDE, MASK) / 8)	\
+	{														\
+		uint8_t bits[GROUP_BITS(STRIDE, MASK) + 16];								\
+		for(int c=0; c<GROUP_BITS(STRIDE, MASK) / 8; c++)							\
+		{													\
+			store64(bits + 8 * c, spread_byte(data[c]));							\
+		}													\
+		for(int v=0; v<GROUP_PIXELS(STRIDE) * (STRIDE) / 16; v++)						\
+		{													\
+			__m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(bits + CARRIER_INDEX(16 * v, STRIDE, MASK))), shuf[v]);	\
+			__m128i img = _mm_loadu_si128((const __m128i *)(image + 16 * v));				\
+			_mm_storeu_si128((__m128i *)(image + 16 * v), _mm_or_si128(_mm_and_si128(img, keep[v]), b));	\
+		}													\
+	}
+
+/* Decodes whole groups, carrier bytes are packed together with one pshufb per vector (STRIDE > CHANNELS) */
+#define EXTRACT_GROUPS_BODY(STRIDE, MASK)										\
+	const __m128i shuf[3] = SHUF_GROUP(EXTRACT_SHUF, STRIDE, MASK);							\
+	const __m128i one = _mm_set1_epi8(1);										\
+	for(size_t g=0; g<groups; g++, image += GROUP_PIXELS(STRIDE) * (STRIDE), data += GROUP_BITS(STRIDE, MASK) / 8)	\
+	{														\
+		uint8_t bits[GROUP_BITS(STRIDE, MASK) + 16];								\
+		for(int v=0; v<GROUP_PIXELS(STRIDE) * (STRIDE) / 16; v++)						\
+		{													\
+			__m128i img = _mm_loadu_si128((const __m128i *)(image + 16 * v));				\
+			_mm_storeu_si128((__m128i *)(bits + CARRIER_INDEX(16 * v, STRIDE, MASK)), _mm_and_si128(_mm_shuffle_epi8(img, shuf[v]), one));	\
+		}													\
+		for(int c=0; c<GROUP_BITS(STRIDE, MASK) / 8; c++)							\
+		{													\
+			data[c] = (uint8_t)((load64(bits + 8 * c) * GATHER_MUL) >> 56);				\
+		}													\
+	}
+
+#else
+
+/* Encodes whole groups, carrier bits are moved to pixel positions byte by byte (positions are constants) */
+#define EMBED_GROUPS_BODY(STRIDE, MASK)											\
+	for(size_t g=0; g<groups; g++, image += GROUP_PIXELS(STRIDE) * (STRIDE), data += GROUP_BITS(STRIDE, MASK) / 8)	\
+	{														\
+		uint8_t spread[GROUP_BITS(STRIDE, MASK)], bits[GROUP_PIXELS(STRIDE) * (STRIDE)], mask[GROUP_PIXELS(STRIDE) * (STRIDE)];	\
+		for(int c=0; c<GROUP_BITS(STRIDE, MASK) / 8; c++)							\
+		{													\
+			store64(spread + 8 * c, spread_byte(data[c]));							\
+		}													\
+		for(int j=0; j<GROUP_PIXELS(STRIDE) * (STRIDE); j++)							\
+		{													\
+			bits[j] = IS_CARRIER(j, STRIDE, MASK) ? spread[CARRIER_INDEX(j, STRIDE, MASK)] : 0;		\
+			mask[j] = IS_CARRIER(j, STRIDE, MASK) ? 1 : 0;							\
+		}													\
+		for(int w=0; w<GROUP_PIXELS(STRIDE) * (STRIDE) / 8; w++)						\
+		{													\
+			store64(image + 8 * w, (load64(image + 8 * w) & ~load64(mask + 8 * w)) | load64(bits + 8 * w));	\
+		}													\
+	}
+
+/* Decodes whole groups, carrier bytes are packed together byte by byte (positions are constants) */
+#define EXTRACT_GROUPS_BODY(STRIDE, MASK)										\
+	for(size_t g=0; g<groups; g++, image += GROUP_PIXELS(STRIDE) * (STRIDE), data += GROUP_BITS(STRIDE, MASK) / 8)	\
+	{														\
+		uint8_t bits[GROUP_BITS(STRIDE, MASK)];									\
+		for(int k=0; k<GROUP_BITS(STRIDE, MASK); k++)								\
+		{													\
+			bits[k] = image[CARRIER_OFFSET(k, STRIDE, MASK)] & 1;						\
+		}													\
+		for(int c=0; c<GROUP_BITS(STRIDE, MASK) / 8; c++)							\
+		{													\
+			data[c] = (uint8_t)((load64(bits + 8 * c) * GATHER_MUL) >> 56);				\
+		}													\
+	}
+
+#endif
+
+/* Encodes payload bit b into its carrier byte, first is payload byte which payload points to */
+#define EMBED_BIT(b, STRIDE, MASK)											\
+	do														\
+	{														\
+		uint8_t *p = image + CARRIER_OFFSET(b, STRIDE, MASK) - base;						\
+		*p = (*p & ~1) | ((payload[(b) / 8 - first] >> (7 - (b) % 8)) & 1);					\
+	} while(0)
+
+/* Decodes payload bit b from its carrier byte */
+#define EXTRACT_BIT(b, STRIDE, MASK)											\
+	do														\
+	{														\
+		uint8_t mask = 1 << (7 - (b) % 8);									\
+		uint8_t *p = payload + (b) / 8 - first;									\
+		*p = (image[CARRIER_OFFSET(b, STRIDE, MASK) - base] & 1) ? (*p | mask) : (*p & ~mask);			\
+	} while(0)
+
+/*
+ * Defines embed/extract functions of one pixel format and channel mask,
+ * head and tail bits are done one by one and whole groups with kernel above
+ * (if all bytes are carriers, groups are same as lsb_embed_bytes()),
+ * groups start at first byte of pixel, which is before first carrier if blue is not in mask,
+ * so first group is done bit by bit then (image before carrier of bit_pos is never touched)
+ */
+#define DEFINE_PIXEL_KERNELS(name, STRIDE, MASK)									\
+static void embed_groups_##name(uint8_t *image, const uint8_t *data, size_t groups)					\
+{															\
+	if((STRIDE) == MASK_CHANNELS(MASK))										\
+	{														\
+		lsb_embed_bytes(image, data, groups * GROUP_BITS(STRIDE, MASK) / 8);					\
+		return;													\
+	}														\
+	EMBED_GROUPS_BODY(STRIDE, MASK)											\
+}															\
+															\
+static void extract_groups_##name(const uint8_t *image, uint8_t *data, size_t groups)					\
+{															\
+	if((STRIDE) == MASK_CHANNELS(MASK))										\
+	{														\
+		lsb_extract_bytes(image, data, groups * GROUP_BITS(STRIDE, MASK) / 8);					\
+		return;													\
+	}														\
+	EXTRACT_GROUPS_BODY(STRIDE, MASK)										\
+}															\
+															\
+static void embed_pixels_##name(uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits)		\
+{															\
+	uint64_t base = CARRIER_OFFSET(bit_pos, STRIDE, MASK), first = bit_pos / 8;					\
+	uint64_t b = bit_pos, end = bit_pos + nbits;									\
+	for(; b < end && (b % GROUP_BITS(STRIDE, MASK) != 0 || (b == bit_pos && MASK_NTH(0, MASK) != 0)); b++)		\
+	{														\
+		EMBED_BIT(b, STRIDE, MASK);										\
+	}														\
+	size_t groups = (end - b) / GROUP_BITS(STRIDE, MASK);								\
+	embed_groups_##name(image + CARRIER_OFFSET(b, STRIDE, MASK) - MASK_NTH(0, MASK) - base, payload + b / 8 - first, groups);		\
+	for(b += groups * GROUP_BITS(STRIDE, MASK); b < end; b++)							\
+	{														\
+		EMBED_BIT(b, STRIDE, MASK);										\
+	}														\
+}															\
+															\
+static void extract_pixels_##name(const uint8_t *image, uint8_t *payload, uint64_t bit_pos, size_t nbits)		\
+{															\
+	uint64_t base = CARRIER_OFFSET(bit_pos, STRIDE, MASK), first = bit_pos / 8;					\
+	uint64_t b = bit_pos, end = bit_pos + nbits;									\
+	for(; b < end && (b % GROUP_BITS(STRIDE, MASK) != 0 || (b == bit_pos && MASK_NTH(0, MASK) != 0)); b++)		\
+	{														\
+		EXTRACT_BIT(b, STRIDE, MASK);										\
+	}														\
+	size_t groups = (end - b) / GROUP_BITS(STRIDE, MASK);								\
+	extract_groups_##name(image + CARRIER_OFFSET(b, STRIDE, MASK) - MASK_NTH(0, MASK) - base, payload + b / 8 - first, groups);	\
+	for(b += groups * GROUP_BITS(STRIDE, MASK); b < end; b++)							\
+	{														\
+		EXTRACT_BIT(b, STRIDE, MASK);										\
+	}														\
+}
+
+/* name, bytes per pixel, channel mask of carrier bytes */
+DEFINE_PIXEL_KERNELS(bgr24, 1, 0x1)
+DEFINE_PIXEL_KERNELS(bgra32, 4, 0x7)
+DEFINE_PIXEL_KERNELS(rgb16, 2, 0x1)
+
+/* 24 bpp with chosen channels, pixels are 3 bytes (row padding is not skipped, so rows should have none) */
+DEFINE_PIXEL_KERNELS(bgr24_b, 3, CHANNEL_BLUE)
+DEFINE_PIXEL_KERNELS(bgr24_g, 3, CHANNEL_GREEN)
+DEFINE_PIXEL_KERNELS(bgr24_gb, 3, CHANNEL_GREEN | CHANNEL_BLUE)
+DEFINE_PIXEL_KERNELS(bgr24_r, 3, CHANNEL_RED)
+DEFINE_PIXEL_KERNELS(bgr24_rb, 3, CHANNEL_RED | CHANNEL_BLUE)
+DEFINE_PIXEL_KERNELS(bgr24_rg, 3, CHANNEL_RED | CHANNEL_GREEN)
+
+/* 32 bpp with chosen channels */
+DEFINE_PIXEL_KERNELS(bgra32_b, 4, CHANNEL_BLUE)
+DEFINE_PIXEL_KERNELS(bgra32_g, 4, CHANNEL_GREEN)
+DEFINE_PIXEL_KERNELS(bgra32_gb, 4, CHANNEL_GREEN | CHANNEL_BLUE)
+DEFINE_PIXEL_KERNELS(bgra32_r, 4, CHANNEL_RED)
+DEFINE_PIXEL_KERNELS(bgra32_rb, 4, CHANNEL_RED | CHANNEL_BLUE)
+DEFINE_PIXEL_KERNELS(bgra32_rg, 4, CHANNEL_RED | CHANNEL_GREEN)
+
+/* Kernels by channel mask, no mask (0) and all channels are default kernel of pixel format */
+typedef void (*EmbedKernel)(uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits);
+typedef void (*ExtractKernel)(const uint8_t *image, uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+static const EmbedKernel embed_bgr24_channels[CHANNEL_ALL + 1] = { embed_pixels_bgr24, embed_pixels_bgr24_b, embed_pixels_bgr24_g, embed_pixels_bgr24_gb,
+								   embed_pixels_bgr24_r, embed_pixels_bgr24_rb, embed_pixels_bgr24_rg, embed_pixels_bgr24 };
+static const EmbedKernel embed_bgra32_channels[CHANNEL_ALL + 1] = { embed_pixels_bgra32, embed_pixels_bgra32_b, embed_pixels_bgra32_g, embed_pixels_bgra32_gb,
+								    embed_pixels_bgra32_r, embed_pixels_bgra32_rb, embed_pixels_bgra32_rg, embed_pixels_bgra32 };
+static const ExtractKernel extract_bgr24_channels[CHANNEL_ALL + 1] = { extract_pixels_bgr24, extract_pixels_bgr24_b, extract_pixels_bgr24_g, extract_pixels_bgr24_gb,
+								       extract_pixels_bgr24_r, extract_pixels_bgr24_rb, extract_pixels_bgr24_rg, extract_pixels_bgr24 };
+static const ExtractKernel extract_bgra32_channels[CHANNEL_ALL + 1] = { extract_pixels_bgra32, extract_pixels_bgra32_b, extract_pixels_bgra32_g, extract_pixels_bgra32_gb,
+									extract_pixels_bgra32_r, extract_pixels_bgra32_rb, extract_pixels_bgra32_rg, extract_pixels_bgra32 };
+
+
+
+/* Returns bytes per pixel of pixel format (24 bpp is seen as 1 byte pixels, since all bytes are carriers) */
+uint lsb_format_stride(PixelFormat format)
+{
+	return (format == e_bgra32) ? 4 : (format == e_rgb16) ? 2 : 1;
+}
+
+/* Returns carrier bytes per pixel of pixel format */
+uint lsb_format_channels(PixelFormat format)
+{
+	return (format == e_bgra32) ? 3 : 1;
+}
+
+/* Returns offset of carrier byte of payload bit from start of pixel data */
+uint64_t lsb_carrier_offset(PixelFormat format, uint64_t bit)
+{
+	return lsb_channel_offset(format, 0, bit);
+}
+
+/* Returns offset of carrier byte of payload bit from start of pixel data, with only channels of mask as carriers */
+uint64_t lsb_channel_offset(PixelFormat format, uint mask, uint64_t bit)
+{
+	mask &= CHANNEL_ALL;
+	if(format == e_rgb16 || mask == 0 || mask == CHANNEL_ALL)
+	{
+		uint64_t stride = lsb_format_stride(format);
+		uint64_t default_mask = (1u << lsb_format_channels(format)) - 1;
+		return CARRIER_OFFSET(bit, stride, default_mask);
+	}
+	return CARRIER_OFFSET(bit, (uint64_t)((format == e_bgra32) ? 4 : 3), (uint64_t)mask);
+}
+
+
+
+/* Encodes payload bits into carrier bytes of pixel format */
+void lsb_embed_pixels(PixelFormat format, uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	lsb_embed_channels(format, 0, image, payload, bit_pos, nbits);
+}
+
+/* Encodes payload bits into carrier bytes of pixel format, only channels of mask are carriers */
+void lsb_embed_channels(PixelFormat format, uint mask, uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	switch(format)
+	{
+		case e_bgra32:
+			embed_bgra32_channels[mask & CHANNEL_ALL](image, payload, bit_pos, nbits);
+			break;
+		case e_rgb16:
+			embed_pixels_rgb16(image, payload, bit_pos, nbits);
+			break;
+		default:
+			embed_bgr24_channels[mask & CHANNEL_ALL](image, payload, bit_pos, nbits);
+			break;
+	}
+}
+
+
+
+/* Decodes payload bits from carrier bytes of pixel format */
+void lsb_extract_pixels(PixelFormat format, const uint8_t *image, uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	lsb_extract_channels(format, 0, image, payload, bit_pos, nbits);
+}
+
+/* Decodes payload bits from carrier bytes of pixel format, only channels of mask are carriers */
+void lsb_extract_channels(PixelFormat format, uint mask, const uint8_t *image, uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	switch(format)
+	{
+		case e_bgra32:
+			extract_bgra32_channels[mask & CHANNEL_ALL](image, payload, bit_pos, nbits);
+			break;
+		case e_rgb16:
+			extract_pixels_rgb16(image, payload, bit_pos, nbits);
+			break;
+		default:
+			extract_bgr24_channels[mask & CHANNEL_ALL](image, payload, bit_pos, nbits);
+			break;
+	}
+}
+
+
+
+/* Checks payload bits are in carrier bytes */
+int lsb_verify_pixels(PixelFormat format, const uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	return lsb_verify_channels(format, 0, image, payload, bit_pos, nbits);
+}
+
+/* Checks payload bits are in carrier bytes of channels of mask, bits are decoded again in chunks and compared with payload */
+int lsb_verify_channels(PixelFormat format, uint mask, const uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	uint8_t check[LSB_VERIFY_BYTES];
+	uint64_t b = bit_pos, end = bit_pos + nbits, first = bit_pos / 8;
+	uint64_t base = lsb_channel_offset(format, mask, bit_pos);
+
+	while(b < end)
+	{
+		// chunk ends at payload byte boundary, so next chunk starts with whole byte.
+		uint64_t stop = (b / 8 + LSB_VERIFY_BYTES) * 8;
+		if(stop > end)
+		{
+			stop = end;
+		}
+		size_t from = b / 8 - first, n = (stop + 7) / 8 - b / 8;
+
+		// bits of first and last byte which are not checked are copied from payload, so only carrier bits can differ.
+		memcpy(check, payload + from, n);
+		lsb_extract_channels(format, mask, image + (lsb_channel_offset(format, mask, b) - base), check, b, stop - b);
+		if(memcmp(check, payload + from, n) != 0)
+		{
+			return 0;
+		}
+		b = stop;
+	}
+	return 1;
+}
+
+
+
+/* Counts carrier bytes whose LSB differs from payload bit (bytes encoding would change), old LSBs are decoded in chunks and XORed with payload */
+uint64_t lsb_count_flips(PixelFormat format, uint mask, const uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	uint8_t check[LSB_VERIFY_BYTES + 8];
+	uint64_t b = bit_pos, end = bit_pos + nbits, first = bit_pos / 8, flips = 0;
+	uint64_t base = lsb_channel_offset(format, mask, bit_pos);
+
+	while(b < end)
+	{
+		uint64_t stop = (b / 8 + LSB_VERIFY_BYTES) * 8;
+		if(stop > end)
+		{
+			stop = end;
+		}
+		size_t from = b / 8 - first, n = (stop + 7) / 8 - b / 8;
+
+		// same as verify, bits of first and last byte which are not counted are copied from payload, so they XOR to 0.
+		memcpy(check, payload + from, n);
+		lsb_extract_channels(format, mask, image + (lsb_channel_offset(format, mask, b) - base), check, b, stop - b);
+		size_t i = 0;
+		for(; i + 8 <= n; i += 8)
+		{
+			flips += __builtin_popcountll(load64(check + i) ^ load64(payload + from + i));
+		}
+		for(; i < n; i++)
+		{
+			flips += __builtin_popcount(check[i] ^ payload[from + i]);
+		}
+		b = stop;
+	}
+	return flips;
+}
+
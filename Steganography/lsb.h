@@ -0,0 +1,82 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       LSB Kernels for In-memory Encoding and Decoding
+ *
+ *                              -> Same bit layout as encode_byte_to_lsb() and decode_char_bytes_from_lsb().
+ *                              -> Each payload byte takes 8 image bytes, msb of payload byte goes to lsb of first image byte.
+ *                              -> Whole bytes are done 8 image bytes at a time with one 64-bit load and store (SWAR).
+ *                              -> Bit functions take a bit position, so a block of image data can start in middle of a payload byte.
+ *                              -> Pixel functions do the same for 24, 32 and 16 bpp images, only carrier bytes of each pixel are changed.
+ *                              -> Kernel of each pixel format is made from one macro with bytes per pixel and carrier bytes fixed at compile time.
+ *                              -> With SSSE3 (-mssse3 or -march=native), alpha/unused bytes are skipped with one pshufb per 16 image bytes.
+ *                              -> Channel functions take a channel mask (blue, green, red), only those bytes of each pixel are carriers,
+ *                                 kernels of every mask are made from same macro, 3 byte pixels use groups of 3 vectors, each with own shuffle.
+ */
+
+
+
+
+#ifndef LSB_H
+#define LSB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+
+/* Channel mask bits, bytes of 24/32 bpp pixels are blue, green, red (and alpha) */
+#define CHANNEL_BLUE	0x1
+#define CHANNEL_GREEN	0x2
+#define CHANNEL_RED	0x4
+#define CHANNEL_ALL	0x7
+
+/* LSB function prototypes */
+
+/* Encode len payload bytes into LSB of 8 * len image bytes */
+void lsb_embed_bytes(uint8_t *image, const uint8_t *data, size_t len);
+
+/* Decode len payload bytes from LSB of 8 * len image bytes (data can be same as image) */
+void lsb_extract_bytes(const uint8_t *image, uint8_t *data, size_t len);
+
+/* Encode payload bits [bit_pos, bit_pos + nbits) into LSB of nbits image bytes */
+void lsb_embed_bits(uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+/* Decode payload bits [bit_pos, bit_pos + nbits) from LSB of nbits image bytes */
+void lsb_extract_bits(const uint8_t *image, uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+/* Bytes per pixel of pixel format */
+uint lsb_format_stride(PixelFormat format);
+
+/* Carrier bytes per pixel of pixel format */
+uint lsb_format_channels(PixelFormat format);
+
+/* Offset of carrier byte of payload bit from start of pixel data */
+uint64_t lsb_carrier_offset(PixelFormat format, uint64_t bit);
+
+/* Offset of carrier byte of payload bit from start of pixel data, only channels of mask are carriers (0 => same as lsb_carrier_offset()) */
+uint64_t lsb_channel_offset(PixelFormat format, uint mask, uint64_t bit);
+
+/* Encode payload bits [bit_pos, bit_pos + nbits) into carrier bytes, image points to carrier of bit_pos and payload to byte bit_pos / 8 */
+void lsb_embed_pixels(PixelFormat format, uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+/* Decode payload bits [bit_pos, bit_pos + nbits) from carrier bytes, image points to carrier of bit_pos and payload to byte bit_pos / 8 */
+void lsb_extract_pixels(PixelFormat format, const uint8_t *image, uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+/* Check payload bits [bit_pos, bit_pos + nbits) are in carrier bytes (same pointers as lsb_extract_pixels), returns 1 if all match */
+int lsb_verify_pixels(PixelFormat format, const uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+/* Same as lsb_embed_pixels(), only channels of mask are carriers (24/32 bpp) */
+void lsb_embed_channels(PixelFormat format, uint mask, uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+/* Same as lsb_extract_pixels(), only channels of mask are carriers (24/32 bpp) */
+void lsb_extract_channels(PixelFormat format, uint mask, const uint8_t *image, uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+/* Same as lsb_verify_pixels(), only channels of mask are carriers (24/32 bpp) */
+int lsb_verify_channels(PixelFormat format, uint mask, const uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+/* Count carrier bytes of payload bits [bit_pos, bit_pos + nbits) whose LSB differs from payload bit (bytes which encoding changes) */
+uint64_t lsb_count_flips(PixelFormat format, uint mask, const uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits);
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       LSB Plane Cache for Repeated Decodes
+ *
+ *                              -> Plane size is no. of carrier bytes in image file / 8, carrier bytes are found with
+ *                                 lsb_format_stride() and lsb_format_channels() of pixel format.
+ *                              -> Miss : image is mapped, plane is extracted chunk by chunk with lsb_extract_pixels() into
+ *                                 temp file, and temp file is renamed to plane file (so a half written plane is never used).
+ *                              -> Hit : plane file is mapped, header (magic, version, format, identity, size) is checked,
+ *                                 and decode_data_from_image() copies payload bytes from it.
+ */
+
+
+
+
+#define _FILE_OFFSET_BITS 64	// 64-bit file offsets, for images bigger than 2 GB
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "lsbplane.h"
+#include "lsb.h"
+#include "hash.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Stores 64-bit value as 8 bytes, little endian */
+static void put64(uint8_t *p, uint64_t v)
+{
+	for(int i=0; i<8; i++)
+	{
+		p[i] = v >> (8 * i);
+	}
+}
+
+/* Makes image file identity fields, stored in plane header and hashed for plane file name */
+static void plane_identity(const struct stat *st, uint64_t identity[7])
+{
+	identity[0] = st->st_dev;
+	identity[1] = st->st_ino;
+	identity[2] = st->st_size;
+	identity[3] = st->st_mtim.tv_sec;
+	identity[4] = st->st_mtim.tv_nsec;
+	identity[5] = st->st_ctim.tv_sec;
+	identity[6] = st->st_ctim.tv_nsec;
+}
+
+/* Makes plane file header */
+static void plane_header(uint8_t *buffer, PixelFormat format, const uint64_t identity[7], uint64_t plane_size)
+{
+	memset(buffer, 0, PLANE_HEADER_SIZE);
+	memcpy(buffer, PLANE_MAGIC, 4);
+	buffer[4] = PLANE_VERSION;
+	buffer[5] = format;
+	for(int i=0; i<7; i++)
+	{
+		put64(buffer + 8 + 8 * i, identity[i]);
+	}
+	put64(buffer + 64, plane_size);
+}
+
+/* Gets no. of plane bytes (whole bytes of carrier LSBs) of image file */
+static uint64_t plane_bytes(PixelFormat format, uint64_t data_offset, uint64_t file_size)
+{
+	uint64_t pixel_bytes = (file_size > data_offset) ? file_size - data_offset : 0;
+	uint64_t stride = lsb_format_stride(format), channels = lsb_format_channels(format);
+	uint64_t rem = pixel_bytes % stride;
+	uint64_t bits = pixel_bytes / stride * channels + ((rem < channels) ? rem : channels);
+	return bits / 8;
+}
+
+/* Maps plane file and checks it is plane of this image (e_failure => not cached) */
+static Status plane_map(const char *path, const uint8_t *header, uint64_t plane_size, DecodeInfo *decInfo)
+{
+	struct stat st;
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+	{
+		return e_failure;
+	}
+	if(fstat(fd, &st) != 0 || (uint64_t)st.st_size != PLANE_HEADER_SIZE + plane_size)
+	{
+		close(fd);
+		return e_failure;
+	}
+	uint8_t *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED)
+	{
+		return e_failure;
+	}
+	if(memcmp(map, header, PLANE_HEADER_SIZE) != 0)
+	{
+		munmap(map, st.st_size);
+		return e_failure;
+	}
+
+	decInfo->plane_map = map;
+	decInfo->plane_map_size = st.st_size;
+	decInfo->plane = map + PLANE_HEADER_SIZE;
+	decInfo->plane_size = plane_size;
+	return e_success;
+}
+
+/* Extracts whole LSB plane of image and stores it as plane file */
+static Status plane_store(const char *path, const uint8_t *header, uint64_t plane_size, DecodeInfo *decInfo, uint64_t file_size)
+{
+	static uint8_t buffer[PLANE_CHUNK_SIZE];
+	char tmp_path[PLANE_PATH_SIZE + 32];
+
+	if(mkdir(options.plane_dir, 0700) != 0 && errno != EEXIST)
+	{
+		printf("ERROR: Unable to create plane cache dir %s : %s\n", options.plane_dir, strerror(errno));
+		return e_failure;
+	}
+	uint8_t *image = mmap(NULL, file_size, PROT_READ, MAP_SHARED, fileno(decInfo->fptr_image), 0);
+	if(image == MAP_FAILED)
+	{
+		return e_failure;
+	}
+	madvise(image, file_size, MADV_SEQUENTIAL);
+
+	snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path, (int)getpid());
+	FILE *fptr = fopen(tmp_path, "wb");
+	if(fptr == NULL)
+	{
+		munmap(image, file_size);
+		return e_failure;
+	}
+
+	// plane bytes are payload bytes, so same kernels as decoding extract them.
+	Status ret = (fwrite(header, PLANE_HEADER_SIZE, 1, fptr) == 1) ? e_success : e_failure;
+	for(uint64_t done = 0; ret == e_success && done < plane_size; )
+	{
+		size_t n = (plane_size - done < PLANE_CHUNK_SIZE) ? plane_size - done : PLANE_CHUNK_SIZE;
+		uint64_t bit_pos = done * 8;
+		lsb_extract_pixels(decInfo->pixel_format, image + decInfo->data_offset + lsb_carrier_offset(decInfo->pixel_format, bit_pos), buffer, bit_pos, n * 8);
+		if(fwrite(buffer, 1, n, fptr) != n)
+		{
+			ret = e_failure;
+		}
+		done += n;
+	}
+	munmap(image, file_size);
+
+	if(fclose(fptr) != 0 || ret == e_failure || rename(tmp_path, path) != 0)
+	{
+		printf("ERROR: Unable to store LSB plane %s\n", path);
+		remove(tmp_path);
+		return e_failure;
+	}
+	print_info("INFO: Stored LSB plane of %s as %s\n", decInfo->image_fname, path);
+	return e_success;
+}
+
+/* Map LSB plane of image of decInfo from cache, extracting and storing it if not cached (e_failure => decode from pixels) */
+Status plane_open(DecodeInfo *decInfo)
+{
+	uint8_t header[PLANE_HEADER_SIZE];
+	uint64_t identity[7];
+	char path[PLANE_PATH_SIZE];
+	struct stat st;
+
+	// decInfo is not cleared by caller, so plane is marked off first.
+	decInfo->plane_map = NULL;
+	decInfo->plane = NULL;
+	// image temp file (--delta or .png) has no name, so its plane would never be used again.
+	if(options.plane_dir == NULL || options.delta_fname != NULL || fstat(fileno(decInfo->fptr_image), &st) != 0 || !S_ISREG(st.st_mode) || st.st_nlink == 0)
+	{
+		return e_failure;
+	}
+
+	plane_identity(&st, identity);
+	uint64_t plane_size = plane_bytes(decInfo->pixel_format, decInfo->data_offset, st.st_size);
+	plane_header(header, decInfo->pixel_format, identity, plane_size);
+	snprintf(path, sizeof(path), "%s/%016llx.plane", options.plane_dir, (unsigned long long)hash64(identity, sizeof(identity), 0));
+
+	if(plane_map(path, header, plane_size, decInfo) == e_success)
+	{
+		print_info("INFO: LSB plane of %s taken from %s\n", decInfo->image_fname, path);
+		return e_success;
+	}
+
+	// if => not cached (or plane of old version of image), then plane is extracted once and stored.
+	if(plane_store(path, header, plane_size, decInfo, st.st_size) == e_failure)
+	{
+		return e_failure;
+	}
+	return plane_map(path, header, plane_size, decInfo);
+}
+
+/* Unmap LSB plane of decInfo */
+void plane_close(DecodeInfo *decInfo)
+{
+	if(decInfo->plane_map != NULL)
+	{
+		munmap(decInfo->plane_map, decInfo->plane_map_size);
+		decInfo->plane_map = NULL;
+		decInfo->plane = NULL;
+	}
+}
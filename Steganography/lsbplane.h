@@ -0,0 +1,49 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       LSB Plane Cache for Repeated Decodes
+ *
+ *                              -> --plane-cache=<dir> keeps LSB plane of decoded images in dir : LSB of every carrier byte,
+ *                                 packed 8 per byte in carrier order, so plane is 1/8 of pixel data and is same as payload bytes.
+ *                              -> Plane file is <dir>/<id>.plane, id is hash of image file identity (device, inode, size, mtime, ctime),
+ *                                 and identity is stored in plane file too, so plane of changed image is never used.
+ *                              -> First decode of an image extracts whole plane once (one pass over pixel data) and stores it,
+ *                                 later decodes map plane file and all header fields and secret data are copied from it.
+ *                              -> Plane is not used with --delta (image is a temp file there).
+ */
+
+
+
+
+#ifndef LSBPLANE_H
+#define LSBPLANE_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+#include "decode.h"
+
+/* Plane file magic string and version */
+#define PLANE_MAGIC "SPLN"
+#define PLANE_VERSION 1
+
+/* Plane file header size : magic, version, format, 2 reserved bytes, 7 x 8 byte identity fields and plane size */
+#define PLANE_HEADER_SIZE 72
+
+/* Plane bytes extracted at a time */
+#define PLANE_CHUNK_SIZE (256 * 1024)
+
+/* Plane file name size (dir, '/', 16 hex digits, extension) */
+#define PLANE_PATH_SIZE 4096
+
+
+/* Plane function prototypes */
+
+/* Map LSB plane of image of decInfo from cache, extracting and storing it if not cached (e_failure => decode from pixels) */
+Status plane_open(DecodeInfo *decInfo);
+
+/* Unmap LSB plane of decInfo */
+void plane_close(DecodeInfo *decInfo);
+
+#endif
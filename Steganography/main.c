@@ -46,13 +46,103 @@
 #include <stdio.h>
 #include "encode.h"
 #include "decode.h"
+#include "batch.h"
+#include "detect.h"
+#include "stegod.h"
+#include "client.h"
+#include "plan.h"
+#include "delta.h"
+#include "update.h"
+#include "selftest.h"
+#include "watch.h"
 #include "types.h"
+#include "options.h"
+#include "stats.h"
+#include "trace.h"
 
 int main(int argc, char *argv[])
 {
 	EncodeInfo encInfo;
 	DecodeInfo decInfo;
 
+	// optional args (--...) are read and removed from argv, and if => e_failure.
+	if(read_and_validate_options(&argc, argv) == e_failure)
+	{
+		printf("USAGE:\n");
+		printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+		printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+		printf("Batch    : ./a.out -b <job_list_file>\n");
+		printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+		printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+		printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+		printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+		printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+		printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+		printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+		printf("Options  : %s\n\n", OPTIONS_USAGE);
+		return 0;
+	}
+
+	// stats and trace of whole run start from here.
+	stats_start();
+	trace_start();
+
+	// if => --detect, then all args are images or directories to screen.
+	if(options.detect && argc >= 2)
+	{
+		// starts the detection, and stats are printed after it.
+		Status status = do_detect(argc - 1, argv + 1);
+		stats_report("detect", status);
+		if(status == e_success)
+		{
+			print_info("INFO: ## Detection Done Successfully ##\n");
+		}
+		return 0;
+	}
+
+	// if => --selftest, then there are no other args.
+	if(options.selftest != 0 && argc == 1)
+	{
+		// starts the self-test, and stats are printed after it, exit status is 1 on any mismatch so it can gate a build.
+		Status status = do_selftest(options.selftest);
+		stats_report("selftest", status);
+		if(status == e_success)
+		{
+			print_info("INFO: ## Self-test Passed ##\n");
+			return 0;
+		}
+		return 1;
+	}
+
+	// if => --daemon, then requests are done till daemon is stopped.
+	if(options.daemon_socket != NULL && argc == 1)
+	{
+		Status status = do_daemon(options.daemon_socket);
+		stats_report("daemon", status);
+		return 0;
+	}
+
+	// if => --watch, then only arg is carrier file (optional), files of dir are encoded till watch is stopped.
+	if(options.watch_dir != NULL && argc <= 2)
+	{
+		Status status = do_watch(options.watch_dir, (argc == 2) ? argv[1] : NULL);
+		stats_report("watch", status);
+		return 0;
+	}
+
+	// if => --plan, then all args are secret files to assign carriers.
+	if(options.plan_dir != NULL && argc >= 2)
+	{
+		// starts the planning, and stats are printed after it.
+		Status status = do_plan(options.plan_dir, argc - 1, argv + 1);
+		stats_report("plan", status);
+		if(status == e_success)
+		{
+			print_info("INFO: ## Planning Done Successfully ##\n");
+		}
+		return 0;
+	}
+
 	// if => argc is 3, 4, or 5.
 	if(argc >= 3 && argc <= 5)
 	{
@@ -69,10 +159,12 @@ int main(int argc, char *argv[])
 				/* Reads and validates Encode args from argv */
 				if(read_and_validate_encode_args(argv, &encInfo) == e_success)
 				{
-					// starts the encooding.
-					if(do_encoding(argv, &encInfo) == e_success)
+					// starts the encooding (with daemon if --connect), and stats are printed after it.
+					Status status = (options.connect_socket != NULL) ? client_encoding(argv, &encInfo) : do_encoding(argv, &encInfo);
+					stats_report("encode", status);
+					if(status == e_success)
 					{
-						printf("INFO: ## Encoding Done Successfully ##\n");
+						print_info("INFO: ## Encoding Done Successfully ##\n");
 						return 0;
 					}
 					else
@@ -88,8 +180,17 @@ int main(int argc, char *argv[])
 						printf("%s ", argv[i]);					// prints command-line arguments user entered.
 					}
 					printf(": INVALID ARGUMENTS\nUSAGE:\n");
-					printf("Encoding : ./a.out -e <.bmp_file> <.c/.sh/.txt_file> [.bmp_output_file(optional)]\n");
-					printf("Decoding : ./a.out -d <.bmp_file> [decoded_output_file_name_without_extention(optional)]\n\n");
+					printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+					printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+					printf("Batch    : ./a.out -b <job_list_file>\n");
+					printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+					printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+					printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+					printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+					printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+					printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+					printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+					printf("Options  : %s\n\n", OPTIONS_USAGE);
 					return 0;
 				}
 			}
@@ -101,8 +202,17 @@ int main(int argc, char *argv[])
 					printf("%s ", argv[i]);						// prints command-line arguments user entered.
 				}
 				printf(": INVALID ARGUMENTS\nUSAGE:\n");
-				printf("Encoding : ./a.out -e <.bmp_file> <.c/.sh/.txt_file> [.bmp_output_file(optional)]\n");
-				printf("Decoding : ./a.out -d <.bmp_file> [decoded_output_file_name_without_extention(optional)]\n\n");
+				printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+				printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+				printf("Batch    : ./a.out -b <job_list_file>\n");
+				printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+				printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+				printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+				printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+				printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+				printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+				printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+				printf("Options  : %s\n\n", OPTIONS_USAGE);
 				return 0;
 			}
 		}
@@ -116,10 +226,12 @@ int main(int argc, char *argv[])
 				/* Reads and validates Decode args from argv */
 				if(read_and_validate_decode_args(argv, &decInfo) == e_success)
 				{
-					// starts the decooding.
-					if(do_decoding(argv, &decInfo) == e_success)
+					// starts the decooding (with daemon if --connect), and stats are printed after it.
+					Status status = (options.connect_socket != NULL) ? client_decoding(argv, &decInfo) : do_decoding(argv, &decInfo);
+					stats_report("decode", status);
+					if(status == e_success)
 					{
-						printf("INFO: ## Decoding Done Successfully ##\n");
+						print_info("INFO: ## Decoding Done Successfully ##\n");
 						return 0;
 					}
 					else
@@ -135,8 +247,17 @@ int main(int argc, char *argv[])
 						printf("%s ", argv[i]);					// prints command-line arguments user entered.
 					}
 					printf(": INVALID ARGUMENTS\nUSAGE:\n");
-					printf("Encoding : ./a.out -e <.bmp_file> <.c/.sh/.txt_file> [.bmp_output_file(optional)]\n");
-					printf("Decoding : ./a.out -d <.bmp_file> [decoded_output_file_name_without_extention(optional)]\n\n");
+					printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+					printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+					printf("Batch    : ./a.out -b <job_list_file>\n");
+					printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+					printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+					printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+					printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+					printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+					printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+					printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+					printf("Options  : %s\n\n", OPTIONS_USAGE);
 					return 0;
 				}
 			}
@@ -148,8 +269,131 @@ int main(int argc, char *argv[])
 					printf("%s ", argv[i]);						// prints command-line arguments user entered.
 				}
 				printf(": INVALID ARGUMENTS\nUSAGE:\n");
-				printf("Encoding : ./a.out -e <.bmp_file> <.c/.sh/.txt_file> [.bmp_output_file(optional)]\n");
-				printf("Decoding : ./a.out -d <.bmp_file> [decoded_output_file_name_without_extention(optional)]\n\n");
+				printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+				printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+				printf("Batch    : ./a.out -b <job_list_file>\n");
+				printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+				printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+				printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+				printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+				printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+				printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+				printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+				printf("Options  : %s\n\n", OPTIONS_USAGE);
+				return 0;
+			}
+		}
+
+		// if => e_batch
+		if(ret == e_batch)
+		{
+			// if => argc is 3.
+			if(argc == 3)
+			{
+				// starts the batch, and stats are printed after it.
+				Status status = do_batch(argv);
+				stats_report("batch", status);
+				if(status == e_success)
+				{
+					print_info("INFO: ## Batch Done Successfully ##\n");
+				}
+				return 0;
+			}
+			else										// prints error message.
+			{
+				printf("\nERROR: ");
+				for(int i=0; i<argc; i++)
+				{
+					printf("%s ", argv[i]);						// prints command-line arguments user entered.
+				}
+				printf(": INVALID ARGUMENTS\nUSAGE:\n");
+				printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+				printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+				printf("Batch    : ./a.out -b <job_list_file>\n");
+				printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+				printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+				printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+				printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+				printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+				printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+				printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+				printf("Options  : %s\n\n", OPTIONS_USAGE);
+				return 0;
+			}
+		}
+
+		// if => e_materialize
+		if(ret == e_materialize)
+		{
+			// if => argc is 4 or 5.
+			if(argc >= 4 && argc <= 5)
+			{
+				// starts the materializing, and stats are printed after it.
+				Status status = do_materialize(argv);
+				stats_report("materialize", status);
+				if(status == e_success)
+				{
+					print_info("INFO: ## Materializing Done Successfully ##\n");
+				}
+				return 0;
+			}
+			else										// prints error message.
+			{
+				printf("\nERROR: ");
+				for(int i=0; i<argc; i++)
+				{
+					printf("%s ", argv[i]);						// prints command-line arguments user entered.
+				}
+				printf(": INVALID ARGUMENTS\nUSAGE:\n");
+				printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+				printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+				printf("Batch    : ./a.out -b <job_list_file>\n");
+				printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+				printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+				printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+				printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+				printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+				printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+				printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+				printf("Options  : %s\n\n", OPTIONS_USAGE);
+				return 0;
+			}
+		}
+
+		// if => e_update
+		if(ret == e_update)
+		{
+			// if => argc is 4.
+			if(argc == 4)
+			{
+				// starts the updating, and stats are printed after it.
+				Status status = do_update(argv);
+				stats_report("update", status);
+				if(status == e_success)
+				{
+					print_info("INFO: ## Updating Done Successfully ##\n");
+				}
+				return 0;
+			}
+			else										// prints error message.
+			{
+				printf("\nERROR: ");
+				for(int i=0; i<argc; i++)
+				{
+					printf("%s ", argv[i]);						// prints command-line arguments user entered.
+				}
+				printf(": INVALID ARGUMENTS\nUSAGE:\n");
+				printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+				printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+				printf("Batch    : ./a.out -b <job_list_file>\n");
+				printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+				printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+				printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+				printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+				printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+				printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+				printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+				printf("Options  : %s\n\n", OPTIONS_USAGE);
 				return 0;
 			}
 		}
@@ -163,8 +407,17 @@ int main(int argc, char *argv[])
 				printf("%s ", argv[i]);							// prints command-line arguments user entered.
 			}
 			printf(": INVALID ARGUMENTS\nUSAGE:\n");
-			printf("Encoding : ./a.out -e <.bmp_file> <.c/.sh/.txt_file> [.bmp_output_file(optional)]\n");
-			printf("Decoding : ./a.out -d <.bmp_file> [decoded_output_file_name_without_extention(optional)]\n\n");
+			printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+			printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+			printf("Batch    : ./a.out -b <job_list_file>\n");
+			printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+			printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+			printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+			printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+			printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+			printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+			printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+			printf("Options  : %s\n\n", OPTIONS_USAGE);
 			return 0;
 		}
 	}
@@ -176,8 +429,17 @@ int main(int argc, char *argv[])
 			printf("%s ", argv[i]);								// prints command-line arguments user entered.
 		}
 		printf(": INVALID ARGUMENTS\nUSAGE:\n");
-		printf("Encoding : ./a.out -e <.bmp_file> <.c/.sh/.txt_file> [.bmp_output_file(optional)]\n");
-		printf("Decoding : ./a.out -d <.bmp_file> [decoded_output_file_name_without_extention(optional)]\n\n");
+		printf("Encoding : ./a.out -e <.bmp/.png_file> <.c/.sh/.txt_file/pipe, or - for stdin> [.bmp/.png_output_file(optional)]\n");
+		printf("Decoding : ./a.out -d <.bmp/.png_file/pipe, or - for stdin> [decoded_output_file_name_without_extention(optional)]\n");
+		printf("Batch    : ./a.out -b <job_list_file>\n");
+		printf("Delta    : ./a.out -m <.bmp_file> <delta_file> [.bmp_output_file(optional)]\n");
+		printf("Update   : ./a.out -u <.bmp_file> <.c/.sh/.txt_file>\n");
+		printf("Detect   : ./a.out --detect <.bmp_file/directory>...\n");
+		printf("Daemon   : ./a.out --daemon=<socket_path>\n");
+		printf("Plan     : ./a.out --plan=<carrier_dir> <.c/.sh/.txt_file>... [--manifest=<job_list_file>]\n");
+		printf("Selftest : ./a.out --selftest[=<rounds>]\n");
+		printf("Watch    : ./a.out --watch=<dir> [.bmp_carrier_file]\n");
+		printf("Options  : %s\n\n", OPTIONS_USAGE);
 	}
 	return 0;
 }
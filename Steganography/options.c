@@ -0,0 +1,214 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Command-line Options
+ *
+ *                              -> Optional arguments start with "--" and can be given anywhere in command line.
+ *                              -> They are removed from argv before encode/decode args are validated, so argc checks are same as before.
+ *                              -> --encrypt            : encrypt secret file data with key from STEGO_KEY environment variable.
+ *                              -> --key-file=<file>    : key file for encryption/decryption (also turns on --encrypt for encoding).
+ *                              -> --stats=json         : print per-stage time, bytes and syscall counts as JSON to stderr.
+ *                              -> --quiet              : don't print INFO messages, only errors are printed.
+ *                              -> --io=uring|threads   : batch I/O engine (io_uring is used by default when built with it).
+ *                              -> --threads=<n>        : no. of threads for batch thread pool (default is no. of CPUs).
+ *                              -> --direct             : batch reads/writes images with O_DIRECT.
+ *                              -> --detect             : screen images/directories given in args for LSB stego, instead of encode/decode.
+ *                              -> --engine=stdio|pipeline : encode/decode stage by stage (default) or with 3 thread reader/encoder/writer pipeline (24 bpp only).
+ *                              -> --daemon=<socket>    : run as stego daemon on UNIX socket, instead of encode/decode.
+ *                              -> --connect=<socket>   : encode/decode with running stego daemon.
+ *                              -> --cache=<dir>        : keep encoded images in dir, same encoding again is taken from it.
+ *                              -> --cache-max=<MB>     : maximum size of cache dir (default 256 MB).
+ *                              -> --verify             : decode encoded bits again from each output block before it is written, encoding fails on mismatch.
+ *                              -> --plan=<dir>         : pick a carrier image of dir for each secret file in args.
+ *                              -> --manifest=<file>    : write --plan as batch job list to file.
+ *                              -> --delta=<file>       : encode to / decode from delta file of carrier image.
+ *                              -> --plane-cache=<dir>  : keep LSB plane of decoded images in dir.
+ *                              -> --channels=<b|g|r..> : encode secret data only in LSB of these colour channels (e.g. --channels=b, --channels=rg).
+ *                              -> --metrics            : measure changed bytes, MSE and PSNR while encoding.
+ *                              -> --ecc=<n>            : add n Reed-Solomon parity bytes to each codeword of secret data.
+ *                              -> --trace=<file>       : write timeline of stages and jobs of each thread as Chrome trace-event JSON.
+ *                              -> --selftest[=<n>]     : run n rounds of self-test of encode/decode paths.
+ *                              -> --watch=<dir>        : encode secret files written to dir as soon as they are closed.
+ */
+
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "options.h"
+#include "lsb.h"
+#include "rs.h"
+#include "selftest.h"
+#include "types.h"
+
+/* Options given in command line, all off by default */
+Options options;
+
+/* Function Definitions */
+
+/* Gets channel mask from letters b, g, r (0 => unknown letter) */
+static uint parse_channels(const char *str)
+{
+	uint mask = 0;
+	for(; *str != '\0'; str++)
+	{
+		if(*str == 'b')
+		{
+			mask |= CHANNEL_BLUE;
+		}
+		else if(*str == 'g')
+		{
+			mask |= CHANNEL_GREEN;
+		}
+		else if(*str == 'r')
+		{
+			mask |= CHANNEL_RED;
+		}
+		else
+		{
+			return 0;
+		}
+	}
+	return mask;
+}
+
+/* Reads and validates optional args, and removes them from argv */
+Status read_and_validate_options(int *argc, char *argv[])
+{
+	int j = 1;
+
+	for(int i=1; i<*argc; i++)
+	{
+		// if => not an option, then it is kept in argv.
+		if(strncmp(argv[i], "--", 2) != 0)
+		{
+			argv[j++] = argv[i];
+			continue;
+		}
+
+		if(strcmp(argv[i], "--encrypt") == 0)
+		{
+			options.encrypt = 1;
+		}
+		else if(strncmp(argv[i], "--key-file=", 11) == 0 && argv[i][11] != '\0')
+		{
+			options.key_fname = argv[i] + 11;
+			options.encrypt = 1;
+		}
+		else if(strcmp(argv[i], "--stats=json") == 0)
+		{
+			options.stats = STATS_JSON;
+		}
+		else if(strcmp(argv[i], "--quiet") == 0)
+		{
+			options.quiet = 1;
+		}
+		else if(strcmp(argv[i], "--metrics") == 0)
+		{
+			options.metrics = 1;
+		}
+		else if(strcmp(argv[i], "--io=uring") == 0)
+		{
+			options.io_engine = IO_ENGINE_URING;
+		}
+		else if(strcmp(argv[i], "--io=threads") == 0)
+		{
+			options.io_engine = IO_ENGINE_THREADS;
+		}
+		else if(strcmp(argv[i], "--verify") == 0)
+		{
+			options.verify = 1;
+		}
+		else if(strcmp(argv[i], "--direct") == 0)
+		{
+			options.direct = 1;
+		}
+		else if(strcmp(argv[i], "--detect") == 0)
+		{
+			options.detect = 1;
+		}
+		else if(strcmp(argv[i], "--engine=stdio") == 0)
+		{
+			options.engine = ENGINE_STDIO;
+		}
+		else if(strcmp(argv[i], "--engine=pipeline") == 0)
+		{
+			options.engine = ENGINE_PIPELINE;
+		}
+		else if(strncmp(argv[i], "--daemon=", 9) == 0 && argv[i][9] != '\0')
+		{
+			options.daemon_socket = argv[i] + 9;
+		}
+		else if(strncmp(argv[i], "--connect=", 10) == 0 && argv[i][10] != '\0')
+		{
+			options.connect_socket = argv[i] + 10;
+		}
+		else if(strncmp(argv[i], "--cache=", 8) == 0 && argv[i][8] != '\0')
+		{
+			options.cache_dir = argv[i] + 8;
+		}
+		else if(strncmp(argv[i], "--cache-max=", 12) == 0 && atoi(argv[i] + 12) > 0)
+		{
+			options.cache_max_mb = atoi(argv[i] + 12);
+		}
+		else if(strncmp(argv[i], "--plan=", 7) == 0 && argv[i][7] != '\0')
+		{
+			options.plan_dir = argv[i] + 7;
+		}
+		else if(strncmp(argv[i], "--manifest=", 11) == 0 && argv[i][11] != '\0')
+		{
+			options.manifest_fname = argv[i] + 11;
+		}
+		else if(strncmp(argv[i], "--delta=", 8) == 0 && argv[i][8] != '\0')
+		{
+			options.delta_fname = argv[i] + 8;
+		}
+		else if(strncmp(argv[i], "--plane-cache=", 14) == 0 && argv[i][14] != '\0')
+		{
+			options.plane_dir = argv[i] + 14;
+		}
+		else if(strncmp(argv[i], "--channels=", 11) == 0 && parse_channels(argv[i] + 11) != 0)
+		{
+			options.channels = parse_channels(argv[i] + 11);
+		}
+		else if(strncmp(argv[i], "--ecc=", 6) == 0 && atoi(argv[i] + 6) >= RS_MIN_PARITY && atoi(argv[i] + 6) <= RS_MAX_PARITY)
+		{
+			options.ecc_parity = atoi(argv[i] + 6);
+		}
+		else if(strncmp(argv[i], "--trace=", 8) == 0 && argv[i][8] != '\0')
+		{
+			options.trace_fname = argv[i] + 8;
+		}
+		else if(strcmp(argv[i], "--selftest") == 0)
+		{
+			options.selftest = SELFTEST_ROUNDS;
+		}
+		else if(strncmp(argv[i], "--selftest=", 11) == 0 && atoi(argv[i] + 11) > 0)
+		{
+			options.selftest = atoi(argv[i] + 11);
+		}
+		else if(strncmp(argv[i], "--watch=", 8) == 0 && argv[i][8] != '\0')
+		{
+			options.watch_dir = argv[i] + 8;
+		}
+		else if(strncmp(argv[i], "--threads=", 10) == 0 && atoi(argv[i] + 10) > 0)
+		{
+			options.threads = atoi(argv[i] + 10);
+		}
+		else
+		{
+			printf("ERROR: Unknown option %s\n", argv[i]);
+			return e_failure;
+		}
+	}
+
+	// argv is kept NULL terminated, since optional args are checked with NULL.
+	argv[j] = NULL;
+	*argc = j;
+
+	return e_success;
+}
@@ -0,0 +1,147 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Command-line Options
+ *
+ *                              -> Optional arguments start with "--" and can be given anywhere in command line.
+ *                              -> They are removed from argv before encode/decode args are validated, so argc checks are same as before.
+ *                              -> --encrypt            : encrypt secret file data with key from STEGO_KEY environment variable.
+ *                              -> --key-file=<file>    : key file for encryption/decryption (also turns on --encrypt for encoding).
+ *                              -> --stats=json         : print per-stage time, bytes and syscall counts as JSON to stderr.
+ *                              -> --quiet              : don't print INFO messages, only errors are printed.
+ *                              -> --io=uring|threads   : batch I/O engine (io_uring is used by default when built with it).
+ *                              -> --threads=<n>        : no. of threads for batch thread pool (default is no. of CPUs).
+ *                              -> --direct             : batch reads/writes images with O_DIRECT (page cache is not filled), job lines can have --direct/--buffered.
+ *                              -> --detect             : screen images/directories given in args for LSB stego, instead of encode/decode.
+ *                              -> --engine=stdio|pipeline : encode/decode stage by stage (default) or with 3 thread reader/encoder/writer pipeline (24 bpp only).
+ *                              -> --daemon=<socket>    : run as stego daemon on UNIX socket, instead of encode/decode (key is loaded only with --encrypt/--key-file).
+ *                              -> --connect=<socket>   : encode/decode with running stego daemon (daemon's key is used for --encrypt).
+ *                              -> --cache=<dir>        : keep encoded images in dir, same encoding again is taken from it (not for --encrypt).
+ *                              -> --cache-max=<MB>     : maximum size of cache dir, least recently used images are removed (default 256 MB).
+ *                              -> --verify             : decode encoded bits again from each output block before it is written, encoding fails on mismatch.
+ *                              -> --plan=<dir>         : pick a carrier image of dir for each secret file in args (best fit), and run it as batch.
+ *                              -> --manifest=<file>    : write --plan as batch job list to file, instead of running it.
+ *                              -> --delta=<file>       : encoding writes only changed LSBs to delta file (no output image), decoding reads them with carrier image.
+ *                              -> --plane-cache=<dir>  : keep packed LSB plane of decoded images in dir, later decodes of same image read it instead of pixels.
+ *                              -> --channels=<b|g|r..> : encode secret data only in LSB of given colour channels (24 bpp without row padding, or 32 bpp).
+ *                              -> --metrics            : encoding prints changed bytes, MSE and PSNR of output image (also in --stats=json).
+ *                              -> --ecc=<n>            : encode secret data as Reed-Solomon codewords with n parity bytes each (2..64), up to n / 2
+ *                                                        wrong bytes of each 255 byte codeword are corrected while decoding.
+ *                              -> --trace=<file>       : write begin/end of stages, batch jobs and pipeline blocks of every thread to file in
+ *                                                        Chrome trace-event JSON format (open it in chrome://tracing or ui.perfetto.dev).
+ *                              -> --selftest[=<n>]     : check all encode/decode paths against reference on n random carriers and secret files
+ *                                                        (default 20), instead of encode/decode, exit status is 1 if any check fails.
+ *                              -> --watch=<dir>        : encode secret files as soon as they are written to dir (inotify), with carrier
+ *                                                        <name>.bmp of dir or carrier file given in args, into <dir>/encoded.
+ */
+
+
+
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store optional arguments,
+ * common for both encoding and decoding
+ */
+
+typedef struct _Options
+{
+    /* Encryption */
+    int encrypt;			// => 1 if secret data should be encrypted
+    char *key_fname;			// => Stores the key file name (NULL => STEGO_KEY)
+
+    /* Output */
+    int stats;				// => STATS_JSON if stats should be printed, else 0
+    int quiet;				// => 1 if INFO messages should not be printed
+    int metrics;			// => 1 if encoding should measure changed bytes, MSE and PSNR
+
+    /* Batch */
+    int io_engine;			// => IO_ENGINE_* for batch
+    int threads;			// => thread pool size (0 => no. of CPUs)
+    int direct;				// => 1 if batch image files should bypass page cache (O_DIRECT)
+
+    /* Encode/decode */
+    int engine;				// => ENGINE_* for single encode/decode
+
+    /* Detect */
+    int detect;				// => 1 if args are images to screen
+
+    /* Daemon */
+    char *daemon_socket;		// => socket path to run daemon on (NULL => no daemon)
+    char *connect_socket;		// => socket path of daemon to encode/decode with (NULL => encode/decode here)
+
+    /* Verify */
+    int verify;				// => 1 if encoded bits should be checked before output is written
+
+    /* Cache */
+    char *cache_dir;			// => dir of encode result cache (NULL => no cache)
+    int cache_max_mb;			// => maximum cache size in MB (0 => default)
+
+    /* Plan */
+    char *plan_dir;			// => dir of carrier images to plan with (NULL => no plan)
+    char *manifest_fname;		// => job list file to write plan to (NULL => run plan)
+
+    /* Delta */
+    char *delta_fname;			// => delta file to encode to / decode from (NULL => full image)
+
+    /* Plane Cache */
+    char *plane_dir;			// => dir of LSB plane cache (NULL => no plane cache)
+
+    /* Channels */
+    uint channels;			// => CHANNEL_* mask of carrier channels of secret data (0 => all channels)
+
+    /* Error Correction */
+    uint ecc_parity;			// => Reed-Solomon parity bytes per codeword (0 => no error correction)
+
+    /* Trace */
+    char *trace_fname;			// => file to write trace-event timeline to (NULL => no trace)
+
+    /* Self-test */
+    uint selftest;			// => no. of self-test rounds (0 => no self-test)
+
+    /* Watch */
+    char *watch_dir;			// => dir to watch for secret files (NULL => no watch)
+
+} Options;
+
+/* Usage of optional args */
+#define OPTIONS_USAGE "[--encrypt] [--key-file=<key_file>] [--stats=json] [--quiet] [--io=uring|threads] [--threads=<n>] [--direct] [--engine=stdio|pipeline] [--detect] [--daemon=<socket>] [--connect=<socket>] [--cache=<dir>] [--cache-max=<MB>] [--verify] [--plan=<carrier_dir>] [--manifest=<job_list_file>] [--delta=<delta_file>] [--plane-cache=<dir>] [--channels=<b|g|r..>] [--metrics] [--ecc=<n>] [--trace=<trace_file>] [--selftest[=<rounds>]] [--watch=<dir>]"
+
+/* Stats output formats */
+#define STATS_JSON 1
+
+/* Batch I/O engines */
+#define IO_ENGINE_DEFAULT 0
+#define IO_ENGINE_URING 1
+#define IO_ENGINE_THREADS 2
+
+/* Encode/decode engines */
+#define ENGINE_STDIO 0
+#define ENGINE_PIPELINE 1
+
+/* Prints INFO messages, unless --quiet is given */
+#define print_info(...)			\
+	do				\
+	{				\
+		if(!options.quiet)	\
+		{			\
+			printf(__VA_ARGS__);	\
+		}			\
+	} while(0)
+
+/* Options given in command line */
+extern Options options;
+
+
+/* Options function prototypes */
+
+/* Read and validate optional args, and remove them from argv */
+Status read_and_validate_options(int *argc, char *argv[]);
+
+#endif
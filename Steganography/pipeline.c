@@ -0,0 +1,446 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Three Stage Reader/Encoder/Writer Pipeline
+ *
+ *                              -> With --engine=pipeline, image data is done in 4 MB blocks by 3 threads.
+ *                              -> Reader thread reads image block (and payload bytes for it), encoder thread puts bits in LSB,
+ *                                 writer thread writes the block, so reading, encoding and writing of different blocks overlap.
+ *                              -> Threads are connected by bounded single-producer/single-consumer rings of block indexes.
+ *                              -> Written blocks go back to reader through a third ring, so only PIPELINE_SLOTS blocks are in memory.
+ *                              -> Same pipeline is used for decoding secret file data with extract instead of encode.
+ */
+
+
+
+
+#define _FILE_OFFSET_BITS 64	// 64-bit file offsets, for images bigger than 2 GB
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "pipeline.h"
+#include "stego.h"
+#include "lsb.h"
+#include "cipher.h"
+#include "cache.h"
+#include "stats.h"
+#include "trace.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Initialises empty ring */
+static void ring_init(SpscRing *ring)
+{
+	ring->head = ring->tail = 0;
+	sem_init(&ring->filled, 0, 0);
+	sem_init(&ring->space, 0, PIPELINE_SLOTS);
+}
+
+/* Destroys ring semaphores */
+static void ring_destroy(SpscRing *ring)
+{
+	sem_destroy(&ring->filled);
+	sem_destroy(&ring->space);
+}
+
+/* Pushes block index, waits while ring is full (only one producer) */
+static void ring_push(SpscRing *ring, int index)
+{
+	while(sem_wait(&ring->space) != 0)
+	{
+		// interrupted by signal, wait again.
+	}
+	ring->items[ring->tail % PIPELINE_SLOTS] = index;
+	ring->tail++;
+	sem_post(&ring->filled);
+}
+
+/* Pops block index, waits while ring is empty (only one consumer) */
+static int ring_pop(SpscRing *ring)
+{
+	while(sem_wait(&ring->filled) != 0)
+	{
+		// interrupted by signal, wait again.
+	}
+	int index = ring->items[ring->head % PIPELINE_SLOTS];
+	ring->head++;
+	sem_post(&ring->space);
+	return index;
+}
+
+
+
+/* Marks pipeline failed, other stages stop working on blocks but keep passing them on */
+static void pipeline_fail(Pipeline *p)
+{
+	__atomic_store_n(&p->failed, 1, __ATOMIC_RELEASE);
+}
+
+static int pipeline_failed(Pipeline *p)
+{
+	return __atomic_load_n(&p->failed, __ATOMIC_ACQUIRE);
+}
+
+
+
+/* Reader stage : takes free block, fills it and passes it to process stage */
+static void *reader_thread(void *arg)
+{
+	Pipeline *p = arg;
+	trace_thread("pipeline reader");
+
+	for(;;)
+	{
+		PipelineBlock *blk = &p->blocks[ring_pop(&p->free_ring)];
+		int index = blk - p->blocks;
+		blk->last = 0;
+		blk->len = blk->aux_len = 0;
+
+		// if => failed here or in other stage, then end of stream is sent so all stages finish.
+		if(pipeline_failed(p) || TRACE_STAGE("read_block", p->read(p->ctx, blk)) == e_failure)
+		{
+			pipeline_fail(p);
+			blk->last = 1;
+		}
+		ring_push(&p->read_ring, index);
+		if(blk->last)
+		{
+			return NULL;
+		}
+	}
+}
+
+
+
+/* Process stage : encodes/decodes block in place and passes it to writer stage */
+static void *process_thread(void *arg)
+{
+	Pipeline *p = arg;
+	trace_thread("pipeline process");
+
+	for(;;)
+	{
+		int index = ring_pop(&p->read_ring);
+		PipelineBlock *blk = &p->blocks[index];
+		if(blk->last == 0 && pipeline_failed(p) == 0 && TRACE_STAGE("process_block", p->process(p->ctx, blk)) == e_failure)
+		{
+			pipeline_fail(p);
+		}
+		ring_push(&p->done_ring, index);
+		if(blk->last)
+		{
+			return NULL;
+		}
+	}
+}
+
+
+
+/* Runs reader and process stages in new threads and writer stage in this thread */
+Status pipeline_run(Pipeline *p)
+{
+	int allocated = 0;
+	p->failed = 0;
+	ring_init(&p->free_ring);
+	ring_init(&p->read_ring);
+	ring_init(&p->done_ring);
+
+	for(int i=0; i<PIPELINE_SLOTS; i++)
+	{
+		p->blocks[i].data = malloc(PIPELINE_BLOCK_SIZE + BMP_HEADER_SIZE);
+		p->blocks[i].aux = malloc(PIPELINE_BLOCK_SIZE / 8 + BMP_HEADER_SIZE);
+		if(p->blocks[i].data == NULL || p->blocks[i].aux == NULL)
+		{
+			free(p->blocks[i].data);
+			free(p->blocks[i].aux);
+			break;
+		}
+		allocated++;
+		ring_push(&p->free_ring, i);
+	}
+
+	pthread_t reader, process;
+	Status ret = e_failure;
+	if(allocated == PIPELINE_SLOTS && pthread_create(&reader, NULL, reader_thread, p) == 0)
+	{
+		if(pthread_create(&process, NULL, process_thread, p) == 0)
+		{
+			// writer stage.
+			for(;;)
+			{
+				int index = ring_pop(&p->done_ring);
+				PipelineBlock *blk = &p->blocks[index];
+				if(blk->last)
+				{
+					break;
+				}
+				if(pipeline_failed(p) == 0 && TRACE_STAGE("write_block", p->write(p->ctx, blk)) == e_failure)
+				{
+					pipeline_fail(p);
+				}
+				ring_push(&p->free_ring, index);
+			}
+			pthread_join(process, NULL);
+			ret = pipeline_failed(p) ? e_failure : e_success;
+		}
+		else
+		{
+			// process thread not started, so reader is stopped through failed flag and its blocks are taken back.
+			pipeline_fail(p);
+			while(p->blocks[ring_pop(&p->read_ring)].last == 0)
+			{
+			}
+		}
+		pthread_join(reader, NULL);
+	}
+	else if(allocated < PIPELINE_SLOTS)
+	{
+		printf("ERROR: Out of memory for pipeline blocks.\n");
+	}
+
+	for(int i=0; i<allocated; i++)
+	{
+		free(p->blocks[i].data);
+		free(p->blocks[i].aux);
+	}
+	ring_destroy(&p->free_ring);
+	ring_destroy(&p->read_ring);
+	ring_destroy(&p->done_ring);
+	return ret;
+}
+
+
+
+/* Encoding : header bytes of payload, and position in image and payload */
+typedef struct _EncodeCtx
+{
+    EncodeInfo *encInfo;
+    uint8_t header[STEGO_HEADER_MAX];
+    uint header_len;
+    uint64_t payload_len;		// => header and secret data bytes
+    uint64_t payload_pos;		// => next payload byte to read
+    uint64_t off;			// => next image byte to read
+
+} EncodeCtx;
+
+/* Reads next image block and payload bytes to be encoded in it */
+static Status encode_read(void *arg, PipelineBlock *blk)
+{
+	EncodeCtx *ctx = arg;
+	EncodeInfo *encInfo = ctx->encInfo;
+
+	// first block also has 54 bytes bmp header, so later blocks start at payload byte boundary.
+	size_t head = (ctx->off == 0) ? BMP_HEADER_SIZE : 0;
+	blk->off = ctx->off;
+	blk->len = fread(blk->data, 1, head + PIPELINE_BLOCK_SIZE, encInfo->fptr_src_image);
+	if(blk->len == 0)
+	{
+		if(ferror(encInfo->fptr_src_image))
+		{
+			printf("ERROR: Unable to read %s image file.\n", encInfo->src_image_fname);
+			return e_failure;
+		}
+		blk->last = 1;
+		return e_success;
+	}
+	ctx->off += blk->len;
+
+	// bmp header is already hashed by check_capacity().
+	cache_hash_carrier(encInfo, blk->data + head, (blk->len > head) ? blk->len - head : 0);
+
+	// no. of payload bytes this block can hold, and how many are left.
+	uint64_t n = (blk->len > head) ? (blk->len - head) / 8 : 0;
+	if(n > ctx->payload_len - ctx->payload_pos)
+	{
+		n = ctx->payload_len - ctx->payload_pos;
+	}
+	blk->aux_len = n;
+
+	// header bytes first, then secret file data.
+	size_t i = 0;
+	while(i < n && ctx->payload_pos < ctx->header_len)
+	{
+		blk->aux[i++] = ctx->header[ctx->payload_pos++];
+	}
+	if(i < n)
+	{
+		size_t m = n - i;
+		if(fread(blk->aux + i, 1, m, encInfo->fptr_secret) != m)
+		{
+			printf("ERROR: %s file data is not read.\n", encInfo->secret_fname);
+			return e_failure;
+		}
+		// if => encrypted, then keystream is XORed while block is read.
+		if(encInfo->header_flags & FLAG_ENCRYPTED)
+		{
+			cipher_xor(&encInfo->cipher, blk->aux + i, m);
+		}
+		ctx->payload_pos += m;
+	}
+	return e_success;
+}
+
+/* Encodes payload bytes into LSB of block */
+static Status encode_process(void *arg, PipelineBlock *blk)
+{
+	(void)arg;
+	size_t head = (blk->off == 0) ? BMP_HEADER_SIZE : 0;
+
+	// if => --metrics, then bytes which will change are counted (only encoder thread adds to it).
+	if(options.metrics)
+	{
+		stats_add_changes(lsb_count_flips(e_bgr24, 0, blk->data + head, blk->aux, 0, 8 * blk->aux_len));
+	}
+	lsb_embed_bytes(blk->data + head, blk->aux, blk->aux_len);
+
+	// if => --verify, then bits are decoded again from block before writer gets it.
+	if(options.verify && !lsb_verify_pixels(e_bgr24, blk->data + head, blk->aux, 0, 8 * blk->aux_len))
+	{
+		printf("ERROR: Verify failed, encoded bits don't match payload.\n");
+		return e_failure;
+	}
+	return e_success;
+}
+
+/* Writes block to stego image */
+static Status encode_write(void *arg, PipelineBlock *blk)
+{
+	EncodeCtx *ctx = arg;
+	if(fwrite(blk->data, 1, blk->len, ctx->encInfo->fptr_stego_image) != blk->len)
+	{
+		printf("ERROR: Unable to write %s encoded file.\n", ctx->encInfo->stego_image_fname);
+		return e_failure;
+	}
+	return e_success;
+}
+
+
+
+/* Encodes header, secret data and copies left over data with pipeline, same output as encoding stages one by one */
+Status encode_pipeline(EncodeInfo *encInfo)
+{
+	print_info("INFO: Encoding %s with 3 stage pipeline\n", encInfo->secret_fname);
+
+	EncodeCtx ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.encInfo = encInfo;
+
+	// header fields are same as encode_magic_string() ... encode_secret_file_size().
+	StegoHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.flags = encInfo->header_flags;
+	memcpy(hdr.nonce, encInfo->nonce, CIPHER_NONCE_SIZE);
+	hdr.extn_size = strlen(encInfo->extn_secret_file);
+	memcpy(hdr.extn, encInfo->extn_secret_file, hdr.extn_size);
+	hdr.data_size = encInfo->secret_file_size;
+	ctx.header_len = stego_write_header(&hdr, ctx.header);
+	ctx.payload_len = ctx.header_len + hdr.data_size;
+
+	rewind(encInfo->fptr_src_image);
+	rewind(encInfo->fptr_secret);
+
+	Pipeline p;
+	p.read = encode_read;
+	p.process = encode_process;
+	p.write = encode_write;
+	p.ctx = &ctx;
+	if(pipeline_run(&p) == e_failure)
+	{
+		return e_failure;
+	}
+
+	// if => image file ended before whole payload is encoded.
+	if(ctx.payload_pos != ctx.payload_len)
+	{
+		printf("ERROR: \"%s\" doesn't have the capacity to encode \"%s\"\n", encInfo->src_image_fname, encInfo->secret_fname);
+		return e_failure;
+	}
+	print_info("INFO: Done\n");
+	return e_success;
+}
+
+
+
+/* Decoding : image bytes left to decode */
+typedef struct _DecodeCtx
+{
+    DecodeInfo *decInfo;
+    uint64_t remaining;
+
+} DecodeCtx;
+
+/* Reads next block of image bytes, always multiple of 8 */
+static Status decode_read(void *arg, PipelineBlock *blk)
+{
+	DecodeCtx *ctx = arg;
+	size_t want = (ctx->remaining < PIPELINE_BLOCK_SIZE) ? ctx->remaining : PIPELINE_BLOCK_SIZE;
+	if(want == 0)
+	{
+		blk->last = 1;
+		return e_success;
+	}
+	blk->len = fread(blk->data, 1, want, ctx->decInfo->fptr_image);
+	if(blk->len != want)
+	{
+		printf("ERROR: Unable to read %s file to decode secret file data.\n", ctx->decInfo->image_fname);
+		return e_failure;
+	}
+	ctx->remaining -= want;
+	return e_success;
+}
+
+/* Decodes secret bytes from LSB of block in place, and decrypts them */
+static Status decode_process(void *arg, PipelineBlock *blk)
+{
+	DecodeCtx *ctx = arg;
+	blk->aux_len = blk->len / 8;
+	lsb_extract_bytes(blk->data, blk->data, blk->aux_len);
+	if(ctx->decInfo->header_flags & FLAG_ENCRYPTED)
+	{
+		cipher_xor(&ctx->decInfo->cipher, blk->data, blk->aux_len);
+	}
+	return e_success;
+}
+
+/* Writes decoded secret bytes */
+static Status decode_write(void *arg, PipelineBlock *blk)
+{
+	DecodeCtx *ctx = arg;
+	if(fwrite(blk->data, 1, blk->aux_len, ctx->decInfo->fptr_secret) != blk->aux_len)
+	{
+		printf("ERROR: Unable to write %s file.\n", ctx->decInfo->secret_fname);
+		return e_failure;
+	}
+	return e_success;
+}
+
+
+
+/* Decodes secret file data with pipeline, same output as decode_secret_file_data() */
+Status decode_pipeline(uint64_t size, DecodeInfo *decInfo)
+{
+	print_info("INFO: Decoding File Data with 3 stage pipeline\n");
+
+	DecodeCtx ctx;
+	ctx.decInfo = decInfo;
+	ctx.remaining = size * 8;
+
+	Pipeline p;
+	p.read = decode_read;
+	p.process = decode_process;
+	p.write = decode_write;
+	p.ctx = &ctx;
+	if(pipeline_run(&p) == e_failure)
+	{
+		return e_failure;
+	}
+	print_info("INFO: Done\n");
+	return e_success;
+}
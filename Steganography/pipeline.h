@@ -0,0 +1,94 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Three Stage Reader/Encoder/Writer Pipeline
+ *
+ *                              -> With --engine=pipeline, image data is done in 4 MB blocks by 3 threads.
+ *                              -> Reader thread reads image block (and payload bytes for it), encoder thread puts bits in LSB,
+ *                                 writer thread writes the block, so reading, encoding and writing of different blocks overlap.
+ *                              -> Threads are connected by bounded single-producer/single-consumer rings of block indexes.
+ *                              -> Written blocks go back to reader through a third ring, so only PIPELINE_SLOTS blocks are in memory.
+ *                              -> Same pipeline is used for decoding secret file data with extract instead of encode.
+ */
+
+
+
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <semaphore.h>
+#include "types.h" // Contains user defined types
+#include "encode.h"
+#include "decode.h"
+
+/* Size of each image block */
+#define PIPELINE_BLOCK_SIZE (4 * 1024 * 1024)
+
+/* No. of blocks in flight */
+#define PIPELINE_SLOTS 4
+
+/*
+ * One block of pipeline
+ */
+
+typedef struct _PipelineBlock
+{
+    uint8_t *data;			// => image bytes (PIPELINE_BLOCK_SIZE + 54)
+    size_t len;				// => no. of valid bytes in data
+    uint64_t off;			// => file offset of data
+    uint8_t *aux;			// => payload bytes for this block
+    size_t aux_len;			// => no. of payload bytes
+    int last;				// => 1 for end of stream marker
+
+} PipelineBlock;
+
+/*
+ * Bounded single-producer/single-consumer ring of block indexes,
+ * semaphores count filled and free places so both sides can sleep
+ */
+
+typedef struct _SpscRing
+{
+    int items[PIPELINE_SLOTS];		// => block indexes
+    unsigned head;			// => next index to pop (only consumer changes)
+    unsigned tail;			// => next index to push (only producer changes)
+    sem_t filled;			// => no. of indexes in ring
+    sem_t space;			// => no. of free places in ring
+
+} SpscRing;
+
+/*
+ * Pipeline stages and state, stage functions get ctx
+ */
+
+typedef struct _Pipeline
+{
+    Status (*read)(void *ctx, PipelineBlock *blk);	// => fills block, sets last at end
+    Status (*process)(void *ctx, PipelineBlock *blk);	// => encodes/decodes block in place
+    Status (*write)(void *ctx, PipelineBlock *blk);	// => writes block
+    void *ctx;
+
+    PipelineBlock blocks[PIPELINE_SLOTS];
+    SpscRing free_ring, read_ring, done_ring;
+    int failed;				// => set by any stage on error, other stages only pass blocks on
+
+} Pipeline;
+
+
+/* Pipeline function prototypes */
+
+/* Run reader, process and writer stages till end of stream */
+Status pipeline_run(Pipeline *p);
+
+/* Encode header, secret data and left over data with pipeline (after check_capacity) */
+Status encode_pipeline(EncodeInfo *encInfo);
+
+/* Decode secret file data with pipeline (after decode_secret_file_size) */
+Status decode_pipeline(uint64_t size, DecodeInfo *decInfo);
+
+#endif
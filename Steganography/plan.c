@@ -0,0 +1,333 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Carrier Pool Planner
+ *
+ *                              -> Carrier dir is read (not recursive), every .bmp file's header is read with pread and
+ *                                 its payload capacity is found with stego_bmp_capacity().
+ *                              -> Payload size of secret file is same as encoding : magic string, header flags and nonce
+ *                                 (--encrypt), extension size, extension, file size field and secret data.
+ *                              -> Secrets are sorted biggest first, carriers smallest first, and for every secret first free
+ *                                 carrier from lower bound of its size is taken.
+ *                              -> Plan is written as batch job list, and when no --manifest is given it is written to a
+ *                                 temp file and run with do_batch().
+ */
+
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "plan.h"
+#include "batch.h"
+#include "stego.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Sorts carriers smallest capacity first */
+static int compare_carrier(const void *a, const void *b)
+{
+	const PlanCarrier *x = a, *y = b;
+	if(x->capacity != y->capacity)
+	{
+		return (x->capacity < y->capacity) ? -1 : 1;
+	}
+	return strcmp(x->fname, y->fname);
+}
+
+/* Sorts secrets biggest first */
+static int compare_secret(const void *a, const void *b)
+{
+	const PlanSecret *x = a, *y = b;
+	if(x->need != y->need)
+	{
+		return (x->need > y->need) ? -1 : 1;
+	}
+	return strcmp(x->fname, y->fname);
+}
+
+/* Index of first free carrier from i, used carriers link to next one (count => none) */
+static int next_free(int *next, int i)
+{
+	int root = i;
+	while(next[root] != root)
+	{
+		root = next[root];
+	}
+	// path compression, so later lookups skip whole run of used carriers.
+	while(next[i] != root)
+	{
+		int up = next[i];
+		next[i] = root;
+		i = up;
+	}
+	return root;
+}
+
+/* Reads bmp header of every .bmp file in dir, and stores carriers which batch can encode */
+static Status read_carriers(const char *dir_name, PlanCarrier **carriers, int *count)
+{
+	// encode args take extension from first '.', so carrier path can have '.' only in file name.
+	if(strchr(dir_name, '.') != NULL)
+	{
+		printf("ERROR: Carrier dir %s should not have '.' in its path.\n", dir_name);
+		return e_failure;
+	}
+
+	DIR *dir = opendir(dir_name);
+	if(dir == NULL)
+	{
+		perror("opendir");
+		printf("ERROR: Unable to open carrier dir %s\n", dir_name);
+		return e_failure;
+	}
+
+	PlanCarrier *list = NULL;
+	int n = 0, cap = 0;
+	struct dirent *ent;
+	while((ent = readdir(dir)) != NULL)
+	{
+		// same .bmp check as encode args.
+		char *dot = strchr(ent->d_name, '.');
+		if(dot == NULL || strcmp(dot, ".bmp") != 0)
+		{
+			continue;
+		}
+
+		char path[PLAN_PATH_SIZE];
+		snprintf(path, sizeof(path), "%s/%s", dir_name, ent->d_name);
+
+		// only bmp header is read.
+		uint8_t bmp_header[BMP_HEADER_SIZE];
+		PixelFormat format;
+		uint64_t data_offset;
+		int fd = open(path, O_RDONLY);
+		ssize_t r = (fd >= 0) ? pread(fd, bmp_header, BMP_HEADER_SIZE, 0) : -1;
+		if(fd >= 0)
+		{
+			close(fd);
+		}
+		if(r != BMP_HEADER_SIZE || stego_bmp_format(bmp_header, &format, &data_offset) == e_failure || format != e_bgr24)
+		{
+			print_info("INFO: %s is skipped, it is not a 24 bpp bmp image.\n", path);
+			continue;
+		}
+
+		if(n == cap)
+		{
+			cap = cap ? cap * 2 : 64;
+			PlanCarrier *grown = realloc(list, cap * sizeof(PlanCarrier));
+			if(grown == NULL)
+			{
+				printf("ERROR: Out of memory reading %s\n", dir_name);
+				break;
+			}
+			list = grown;
+		}
+
+		// capacity check of encoding is 54 + 8 * payload < image capacity.
+		uint64_t image_capacity = stego_bmp_capacity(bmp_header);
+		list[n].capacity = (image_capacity > BMP_HEADER_SIZE) ? (image_capacity - BMP_HEADER_SIZE - 1) / 8 : 0;
+		list[n].fname = strdup(path);
+		if(list[n].fname != NULL)
+		{
+			n++;
+		}
+	}
+	closedir(dir);
+
+	*carriers = list;
+	*count = n;
+	return e_success;
+}
+
+/* Gets payload size of secret file, same fields as encoding */
+static Status secret_need(const char *fname, uint64_t *need)
+{
+	// same extension check as encode args.
+	char *dot = strstr(fname, ".");
+	if(dot == NULL || (strcmp(dot, ".txt") != 0 && strcmp(dot, ".sh") != 0 && strcmp(dot, ".c") != 0))
+	{
+		printf("ERROR: Secret message file %s should be .txt/.sh/.c file only.\n", fname);
+		return e_failure;
+	}
+
+	struct stat st;
+	if(stat(fname, &st) != 0)
+	{
+		printf("ERROR: Unable to open file %s\n", fname);
+		return e_failure;
+	}
+	if(st.st_size <= 1)
+	{
+		printf("ERROR: %s file is empty\n", fname);
+		return e_failure;
+	}
+
+	uint64_t size = st.st_size;
+	*need = strlen(MAGIC_STRING_EXT) + 1 + 1 + (options.encrypt ? CIPHER_NONCE_SIZE : 0) + stego_varint_size(strlen(dot)) + strlen(dot) + stego_varint_size(size) + size;
+	return e_success;
+}
+
+/* Writes plan as batch job list */
+static Status write_plan(FILE *fptr, PlanCarrier *carriers, PlanSecret *secrets, int count)
+{
+	fprintf(fptr, "# plan : carrier, secret, output (payload bytes / carrier capacity)\n");
+	for(int i=0; i<count; i++)
+	{
+		if(secrets[i].carrier < 0)
+		{
+			continue;
+		}
+		PlanCarrier *carrier = &carriers[secrets[i].carrier];
+		const char *base = strrchr(carrier->fname, '/') + 1;
+		fprintf(fptr, "# %llu / %llu\n", (unsigned long long)secrets[i].need, (unsigned long long)carrier->capacity);
+		fprintf(fptr, "-e %s %s stego_%s\n", carrier->fname, secrets[i].fname, base);
+	}
+	return (fflush(fptr) == 0 && !ferror(fptr)) ? e_success : e_failure;
+}
+
+/* Plan carriers of carrier_dir for secret files, and write or run the plan */
+Status do_plan(const char *carrier_dir, int count, char *secret_fnames[])
+{
+	PlanCarrier *carriers;
+	int ncarriers;
+	Status ret = e_success;
+
+	print_info("INFO: ## Planning Procedure Started ##\n");
+	if(read_carriers(carrier_dir, &carriers, &ncarriers) == e_failure)
+	{
+		return e_failure;
+	}
+	print_info("INFO: %d carriers found in %s\n", ncarriers, carrier_dir);
+
+	PlanSecret *secrets = calloc(count, sizeof(PlanSecret));
+	int *next = malloc((ncarriers + 1) * sizeof(int));
+	if(secrets == NULL || next == NULL)
+	{
+		printf("ERROR: Out of memory for plan\n");
+		ret = e_failure;
+		goto out;
+	}
+
+	int nsecrets = 0;
+	for(int i=0; i<count; i++)
+	{
+		secrets[nsecrets].fname = secret_fnames[i];
+		secrets[nsecrets].carrier = -1;
+		if(secret_need(secret_fnames[i], &secrets[nsecrets].need) == e_success)
+		{
+			nsecrets++;
+		}
+		else
+		{
+			ret = e_failure;
+		}
+	}
+
+	// best-fit decreasing : biggest secret first gets smallest carrier which can hold it.
+	qsort(carriers, ncarriers, sizeof(PlanCarrier), compare_carrier);
+	qsort(secrets, nsecrets, sizeof(PlanSecret), compare_secret);
+	for(int i=0; i<=ncarriers; i++)
+	{
+		next[i] = i;
+	}
+	int assigned = 0;
+	for(int i=0; i<nsecrets; i++)
+	{
+		// lower bound of carrier capacity >= need.
+		int lo = 0, hi = ncarriers;
+		while(lo < hi)
+		{
+			int mid = lo + (hi - lo) / 2;
+			if(carriers[mid].capacity < secrets[i].need)
+			{
+				lo = mid + 1;
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+
+		int c = next_free(next, lo);
+		if(c == ncarriers)
+		{
+			printf("ERROR: No free carrier can hold %s (%llu bytes needed).\n", secrets[i].fname, (unsigned long long)secrets[i].need);
+			ret = e_failure;
+			continue;
+		}
+		secrets[i].carrier = c;
+		next[c] = c + 1;
+		assigned++;
+	}
+	print_info("INFO: %d of %d secret files assigned to carriers\n", assigned, count);
+
+	// if => --manifest, then plan is only written.
+	if(options.manifest_fname != NULL)
+	{
+		FILE *fptr = fopen(options.manifest_fname, "w");
+		if(fptr == NULL || write_plan(fptr, carriers, secrets, nsecrets) == e_failure)
+		{
+			printf("ERROR: Unable to write manifest %s\n", options.manifest_fname);
+			ret = e_failure;
+		}
+		else
+		{
+			print_info("INFO: Plan written to %s, run it with ./a.out -b %s\n", options.manifest_fname, options.manifest_fname);
+		}
+		if(fptr != NULL)
+		{
+			fclose(fptr);
+		}
+	}
+	else if(assigned > 0)
+	{
+		// plan is run with batch engine from a temp job list.
+		char job_fname[] = "/tmp/stego_plan_XXXXXX";
+		int fd = mkstemp(job_fname);
+		FILE *fptr = (fd >= 0) ? fdopen(fd, "w") : NULL;
+		if(fptr == NULL || write_plan(fptr, carriers, secrets, nsecrets) == e_failure)
+		{
+			printf("ERROR: Unable to write plan job list %s\n", job_fname);
+			ret = e_failure;
+		}
+		else
+		{
+			char *batch_argv[] = { "plan", "-b", job_fname, NULL };
+			if(do_batch(batch_argv) == e_failure)
+			{
+				ret = e_failure;
+			}
+		}
+		if(fptr != NULL)
+		{
+			fclose(fptr);
+		}
+		else if(fd >= 0)
+		{
+			close(fd);
+		}
+		unlink(job_fname);
+	}
+
+out:
+	for(int i=0; i<ncarriers; i++)
+	{
+		free(carriers[i].fname);
+	}
+	free(carriers);
+	free(secrets);
+	free(next);
+	return ret;
+}
@@ -0,0 +1,61 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Carrier Pool Planner
+ *
+ *                              -> ./a.out --plan=<carrier_dir> <secret files>... picks a carrier image for every secret file,
+ *                                 instead of trying carriers one by one till capacity check passes.
+ *                              -> Only 54 bytes bmp header of each carrier is read to get its capacity (no pixel data is read).
+ *                              -> Carriers are kept sorted by capacity, secrets are assigned biggest first to smallest carrier
+ *                                 that can hold them (best-fit decreasing), so big carriers are left for big secrets.
+ *                              -> Used carriers are skipped with "next free carrier" links (path compressed), so each lookup is
+ *                                 a binary search and near constant time skip.
+ *                              -> Plan is a batch job list (-e <carrier> <secret> stego_<carrier>.bmp lines) :
+ *                                 with --manifest=<file> it is written to file, else it is run at once with batch engine.
+ *                              -> Carriers are 24 bpp only (same as batch), outputs are created in current directory.
+ */
+
+
+
+
+#ifndef PLAN_H
+#define PLAN_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+
+/* Maximum carrier path size */
+#define PLAN_PATH_SIZE 4096
+
+/*
+ * One carrier image of pool
+ */
+
+typedef struct _PlanCarrier
+{
+    char *fname;			// => Stores the carrier image path
+    uint64_t capacity;			// => no. of payload bytes carrier can hold
+
+} PlanCarrier;
+
+/*
+ * One secret file to be assigned
+ */
+
+typedef struct _PlanSecret
+{
+    char *fname;			// => Stores the secret file name
+    uint64_t need;			// => no. of payload bytes (header and secret data)
+    int carrier;			// => index of assigned carrier (-1 => no carrier can hold it)
+
+} PlanSecret;
+
+
+/* Plan function prototypes */
+
+/* Plan carriers of carrier_dir for secret files, and write or run the plan */
+Status do_plan(const char *carrier_dir, int count, char *secrets[]);
+
+#endif
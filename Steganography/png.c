@@ -0,0 +1,1135 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       PNG Carrier and Stego Images
+ *
+ *                              -> Open : chunks are walked and CRC checked, IHDR should be 8-bit RGB/RGBA without interlace, IDAT chunks are
+ *                                 joined and inflated into filtered rows, rows are unfiltered (None, Sub, Up, Average, Paeth) and
+ *                                 written bottom-up as 32 bpp BGRA rows of a bmp temp file.
+ *                              -> Save : rows of stego bmp are read bottom-up with pread(), converted to RGB/RGBA, filtered with each of
+ *                                 5 filters and one with smallest sum of absolute values is kept, then rows are deflated into IDAT chunks.
+ *                              -> Built-in inflater decodes Huffman codes up to PNG_FAST_BITS bits with one table lookup, longer codes
+ *                                 bit by bit with code counts (canonical codes).
+ *                              -> Built-in deflater finds matches with a hash of 3 bytes and chains of previous positions (32 KB window),
+ *                                 and writes one block with fixed Huffman codes.
+ */
+
+
+
+
+#define _FILE_OFFSET_BITS 64	// 64-bit file offsets, for images bigger than 2 GB
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#include "png.h"
+#include "stego.h"
+#include "options.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Reads 32-bit value msb first (png byte order) */
+static uint32_t png_get32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* Stores 32-bit value msb first (png byte order) */
+static void png_put32(uint8_t *p, uint32_t value)
+{
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
+}
+
+/* Stores n byte value lsb first (bmp byte order) */
+static void png_put_le(uint8_t *p, uint32_t value, uint n)
+{
+	for(uint i = 0; i < n; i++)
+	{
+		p[i] = value >> (8 * i);
+	}
+}
+
+/* Paeth predictor of pixel from left (a), above (b) and above left (c) bytes */
+static uint8_t png_paeth(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+	if(pa <= pb && pa <= pc)
+	{
+		return a;
+	}
+	return (pb <= pc) ? b : c;
+}
+
+
+
+#ifdef HAVE_ZLIB
+
+/* Updates CRC-32 of chunk with len bytes */
+static uint32_t png_crc(uint32_t crc, const uint8_t *p, size_t len)
+{
+	return crc32(crc, p, len);
+}
+
+/* Inflates zlib stream of IDAT chunks into exactly out_len bytes of filtered rows */
+static Status png_inflate(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len)
+{
+	uLongf n = out_len;
+	return (uncompress(out, &n, in, in_len) == Z_OK && n == out_len) ? e_success : e_failure;
+}
+
+/* Deflates filtered rows into zlib stream, z is allocated */
+static Status png_compress(const uint8_t *raw, size_t raw_len, uint8_t **z, size_t *z_len)
+{
+	uLongf n = compressBound(raw_len);
+	*z = malloc(n);
+	if(*z == NULL || compress2(*z, &n, raw, raw_len, PNG_ZLIB_LEVEL) != Z_OK)
+	{
+		return e_failure;
+	}
+	*z_len = n;
+	return e_success;
+}
+
+#else
+
+/* Base lengths and extra bits of length symbols 257..285, and of distance symbols 0..29 */
+static const uint16_t png_lbase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t png_lext[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t png_dbase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t png_dext[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+/* Order of code length code lengths in dynamic block header */
+static const uint8_t png_clen_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+/*
+ * Structure to store a Huffman code of
+ * built-in inflater
+ */
+
+typedef struct _PngHuffman
+{
+    uint16_t count[16];				// => no. of codes of each length
+    uint16_t symbol[288];			// => symbols in order of their codes
+    uint16_t fast[1 << PNG_FAST_BITS];		// => symbol << 4 | length, for codes up to PNG_FAST_BITS bits (0 => longer code)
+
+} PngHuffman;
+
+/*
+ * Structure to store state of built-in inflater,
+ * input bits are taken lsb first
+ */
+
+typedef struct _PngInflate
+{
+    const uint8_t *in;			// => zlib stream
+    size_t in_len;			// => no. of bytes of zlib stream
+    size_t in_pos;			// => next byte to load into bit buffer
+    uint64_t bitbuf;			// => bits loaded but not used yet
+    uint bitcnt;			// => no. of bits in bitbuf
+    uint8_t *out;			// => inflated bytes
+    size_t out_len;			// => size of out
+    size_t out_pos;			// => no. of bytes inflated so far
+
+} PngInflate;
+
+/* Updates CRC-32 of chunk with len bytes */
+static uint32_t png_crc(uint32_t crc, const uint8_t *p, size_t len)
+{
+	static uint32_t table[256];
+	if(table[1] == 0)
+	{
+		for(uint32_t n = 0; n < 256; n++)
+		{
+			uint32_t c = n;
+			for(int k = 0; k < 8; k++)
+			{
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			table[n] = c;
+		}
+	}
+	crc = ~crc;
+	while(len--)
+	{
+		crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+/* Gets Adler-32 of zlib stream data */
+static uint32_t png_adler(const uint8_t *p, size_t len)
+{
+	uint32_t a = 1, b = 0;
+	while(len > 0)
+	{
+		// 5552 bytes is most that can be summed before b overflows.
+		size_t n = (len < 5552) ? len : 5552;
+		len -= n;
+		while(n--)
+		{
+			a += *p++;
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	return (b << 16) | a;
+}
+
+/* Loads input bytes into bit buffer till it has 57 bits or input ends */
+static void png_refill(PngInflate *s)
+{
+	while(s->bitcnt <= 56 && s->in_pos < s->in_len)
+	{
+		s->bitbuf |= (uint64_t)s->in[s->in_pos++] << s->bitcnt;
+		s->bitcnt += 8;
+	}
+}
+
+/* Gets next n bits (n <= 16), -1 if input ended */
+static int png_bits(PngInflate *s, uint n)
+{
+	if(s->bitcnt < n)
+	{
+		png_refill(s);
+		if(s->bitcnt < n)
+		{
+			return -1;
+		}
+	}
+	int value = s->bitbuf & ((1u << n) - 1);
+	s->bitbuf >>= n;
+	s->bitcnt -= n;
+	return value;
+}
+
+/* Makes Huffman code from code lengths of n symbols, -1 if code lengths are over-subscribed */
+static int png_build(PngHuffman *h, const uint8_t *lengths, uint n)
+{
+	uint16_t offs[16];
+	int left = 1;
+
+	memset(h->count, 0, sizeof(h->count));
+	for(uint sym = 0; sym < n; sym++)
+	{
+		h->count[lengths[sym]]++;
+	}
+	for(uint len = 1; len < 16; len++)
+	{
+		left = (left << 1) - h->count[len];
+		if(left < 0)
+		{
+			return -1;
+		}
+	}
+	offs[1] = 0;
+	for(uint len = 1; len < 15; len++)
+	{
+		offs[len + 1] = offs[len] + h->count[len];
+	}
+	for(uint sym = 0; sym < n; sym++)
+	{
+		if(lengths[sym] != 0)
+		{
+			h->symbol[offs[lengths[sym]]++] = sym;
+		}
+	}
+
+	// codes are given in order of length and then symbol, fast table is indexed by code bits as they come (reversed).
+	memset(h->fast, 0, sizeof(h->fast));
+	uint code = 0, index = 0;
+	for(uint len = 1; len <= PNG_FAST_BITS; len++)
+	{
+		for(uint i = 0; i < h->count[len]; i++, index++, code++)
+		{
+			uint rev = 0;
+			for(uint b = 0; b < len; b++)
+			{
+				rev |= ((code >> b) & 1) << (len - 1 - b);
+			}
+			for(uint k = rev; k < (1u << PNG_FAST_BITS); k += 1u << len)
+			{
+				h->fast[k] = (h->symbol[index] << 4) | len;
+			}
+		}
+		code <<= 1;
+	}
+	return 0;
+}
+
+/* Decodes next symbol with Huffman code, -1 if input ended or code is not in it */
+static int png_decode_sym(PngInflate *s, const PngHuffman *h)
+{
+	if(s->bitcnt < 15)
+	{
+		png_refill(s);
+	}
+	uint e = h->fast[s->bitbuf & ((1u << PNG_FAST_BITS) - 1)];
+	if(e != 0 && (e & 15) <= s->bitcnt)
+	{
+		s->bitbuf >>= e & 15;
+		s->bitcnt -= e & 15;
+		return e >> 4;
+	}
+
+	// longer code, it is compared with first code of each length.
+	int code = 0, first = 0, index = 0;
+	for(uint len = 1; len < 16; len++)
+	{
+		if(s->bitcnt == 0)
+		{
+			return -1;
+		}
+		code |= s->bitbuf & 1;
+		s->bitbuf >>= 1;
+		s->bitcnt--;
+		int count = h->count[len];
+		if(code - count < first)
+		{
+			return h->symbol[index + (code - first)];
+		}
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+/* Inflates literals and matches of a Huffman block till end of block symbol */
+static int png_codes(PngInflate *s, const PngHuffman *lencode, const PngHuffman *distcode)
+{
+	for(;;)
+	{
+		int sym = png_decode_sym(s, lencode);
+		if(sym < 0)
+		{
+			return -1;
+		}
+		if(sym < 256)
+		{
+			if(s->out_pos == s->out_len)
+			{
+				return -1;
+			}
+			s->out[s->out_pos++] = sym;
+		}
+		else if(sym == 256)
+		{
+			return 0;
+		}
+		else
+		{
+			sym -= 257;
+			if(sym >= 29)
+			{
+				return -1;
+			}
+			int extra = png_bits(s, png_lext[sym]);
+			int dsym = png_decode_sym(s, distcode);
+			if(extra < 0 || dsym < 0 || dsym >= 30)
+			{
+				return -1;
+			}
+			size_t len = png_lbase[sym] + extra;
+			extra = png_bits(s, png_dext[dsym]);
+			if(extra < 0)
+			{
+				return -1;
+			}
+			size_t dist = png_dbase[dsym] + extra;
+			if(dist > s->out_pos || len > s->out_len - s->out_pos)
+			{
+				return -1;
+			}
+
+			// match can overlap bytes it makes, so it is copied byte by byte.
+			uint8_t *d = s->out + s->out_pos;
+			for(size_t i = 0; i < len; i++)
+			{
+				d[i] = d[i - dist];
+			}
+			s->out_pos += len;
+		}
+	}
+}
+
+/* Inflates stored block, it starts at next byte boundary */
+static int png_stored(PngInflate *s)
+{
+	// whole bytes already in bit buffer are given back to input.
+	s->bitbuf >>= s->bitcnt & 7;
+	s->bitcnt -= s->bitcnt & 7;
+	s->in_pos -= s->bitcnt / 8;
+	s->bitbuf = 0;
+	s->bitcnt = 0;
+
+	if(s->in_len - s->in_pos < 4)
+	{
+		return -1;
+	}
+	size_t len = s->in[s->in_pos] | (s->in[s->in_pos + 1] << 8);
+	size_t nlen = s->in[s->in_pos + 2] | (s->in[s->in_pos + 3] << 8);
+	s->in_pos += 4;
+	if(len != (~nlen & 0xFFFF) || len > s->in_len - s->in_pos || len > s->out_len - s->out_pos)
+	{
+		return -1;
+	}
+	memcpy(s->out + s->out_pos, s->in + s->in_pos, len);
+	s->in_pos += len;
+	s->out_pos += len;
+	return 0;
+}
+
+/* Inflates block with fixed Huffman codes */
+static int png_fixed(PngInflate *s)
+{
+	static PngHuffman lencode, distcode;
+	static int built = 0;
+	if(!built)
+	{
+		uint8_t lengths[288];
+		memset(lengths, 8, 144);
+		memset(lengths + 144, 9, 112);
+		memset(lengths + 256, 7, 24);
+		memset(lengths + 280, 8, 8);
+		png_build(&lencode, lengths, 288);
+		memset(lengths, 5, 30);
+		png_build(&distcode, lengths, 30);
+		built = 1;
+	}
+	return png_codes(s, &lencode, &distcode);
+}
+
+/* Inflates block with dynamic Huffman codes, code lengths are given at start of block */
+static int png_dynamic(PngInflate *s)
+{
+	PngHuffman lencode, distcode;
+	uint8_t lengths[320];
+	int nlen = png_bits(s, 5), ndist = png_bits(s, 5), ncode = png_bits(s, 4);
+	if(nlen < 0 || ndist < 0 || ncode < 0)
+	{
+		return -1;
+	}
+	nlen += 257;
+	ndist += 1;
+	ncode += 4;
+	if(nlen > 286 || ndist > 30)
+	{
+		return -1;
+	}
+
+	// code lengths of literal/length and distance codes are Huffman coded with code length code.
+	memset(lengths, 0, 19);
+	for(int i = 0; i < ncode; i++)
+	{
+		int len = png_bits(s, 3);
+		if(len < 0)
+		{
+			return -1;
+		}
+		lengths[png_clen_order[i]] = len;
+	}
+	if(png_build(&lencode, lengths, 19) < 0)
+	{
+		return -1;
+	}
+	int index = 0;
+	while(index < nlen + ndist)
+	{
+		int sym = png_decode_sym(s, &lencode);
+		if(sym < 0)
+		{
+			return -1;
+		}
+		if(sym < 16)
+		{
+			lengths[index++] = sym;
+			continue;
+		}
+		// 16 => repeat last length 3..6 times, 17 => 3..10 zeros, 18 => 11..138 zeros.
+		int len = 0, rep;
+		if(sym == 16)
+		{
+			if(index == 0)
+			{
+				return -1;
+			}
+			len = lengths[index - 1];
+			rep = png_bits(s, 2) + 3;
+		}
+		else
+		{
+			rep = (sym == 17) ? png_bits(s, 3) + 3 : png_bits(s, 7) + 11;
+		}
+		if(rep < 3 || index + rep > nlen + ndist)
+		{
+			return -1;
+		}
+		while(rep--)
+		{
+			lengths[index++] = len;
+		}
+	}
+	if(lengths[256] == 0 || png_build(&lencode, lengths, nlen) < 0 || png_build(&distcode, lengths + nlen, ndist) < 0)
+	{
+		return -1;
+	}
+	return png_codes(s, &lencode, &distcode);
+}
+
+/* Inflates zlib stream of IDAT chunks into exactly out_len bytes of filtered rows */
+static Status png_inflate(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len)
+{
+	PngInflate s;
+	memset(&s, 0, sizeof(s));
+	s.in = in;
+	s.in_len = in_len;
+	s.out = out;
+	s.out_len = out_len;
+
+	// zlib header : deflate method, no preset dictionary, and check bits.
+	if(in_len < 6 || (in[0] & 0x0F) != 8 || ((in[0] << 8) | in[1]) % 31 != 0 || (in[1] & 0x20))
+	{
+		return e_failure;
+	}
+	s.in_pos = 2;
+
+	int last;
+	do
+	{
+		last = png_bits(&s, 1);
+		int type = png_bits(&s, 2);
+		int r = (type == 0) ? png_stored(&s) : (type == 1) ? png_fixed(&s) : (type == 2) ? png_dynamic(&s) : -1;
+		if(last < 0 || r < 0)
+		{
+			return e_failure;
+		}
+	} while(!last);
+
+	// Adler-32 of inflated bytes follows last block, at next byte boundary.
+	s.in_pos -= (s.bitcnt - (s.bitcnt & 7)) / 8;
+	if(s.out_pos != out_len || s.in_len - s.in_pos < 4 || png_get32(in + s.in_pos) != png_adler(out, out_len))
+	{
+		return e_failure;
+	}
+	return e_success;
+}
+
+/*
+ * Structure to store state of built-in deflater,
+ * output bits are stored lsb first
+ */
+
+typedef struct _PngDeflate
+{
+    uint8_t *out;			// => zlib stream
+    size_t pos;				// => no. of bytes of out written
+    uint64_t bitbuf;			// => bits not written yet
+    uint bitcnt;			// => no. of bits in bitbuf
+    uint16_t lit_code[288];		// => fixed literal/length codes, reversed (lsb is first bit)
+    uint8_t lit_len[288];		// => bits of fixed literal/length codes
+
+} PngDeflate;
+
+/* Writes n bits of value */
+static void png_put_bits(PngDeflate *w, uint32_t value, uint n)
+{
+	w->bitbuf |= (uint64_t)value << w->bitcnt;
+	w->bitcnt += n;
+	while(w->bitcnt >= 8)
+	{
+		w->out[w->pos++] = w->bitbuf;
+		w->bitbuf >>= 8;
+		w->bitcnt -= 8;
+	}
+}
+
+/* Reverses n bits of Huffman code, codes are written msb first */
+static uint32_t png_reverse(uint32_t code, uint n)
+{
+	uint32_t rev = 0;
+	while(n--)
+	{
+		rev = (rev << 1) | (code & 1);
+		code >>= 1;
+	}
+	return rev;
+}
+
+/* Writes match of len bytes at distance dist */
+static void png_put_match(PngDeflate *w, uint len, uint dist)
+{
+	int l = 28, d = 29;
+	while(png_lbase[l] > len)
+	{
+		l--;
+	}
+	while(png_dbase[d] > dist)
+	{
+		d--;
+	}
+	png_put_bits(w, w->lit_code[257 + l], w->lit_len[257 + l]);
+	png_put_bits(w, len - png_lbase[l], png_lext[l]);
+	png_put_bits(w, png_reverse(d, 5), 5);
+	png_put_bits(w, dist - png_dbase[d], png_dext[d]);
+}
+
+/* Deflates len bytes into one fixed Huffman block of a zlib stream, out should have len + len / 3 + 64 bytes */
+static size_t png_deflate(const uint8_t *in, size_t len, uint8_t *out)
+{
+	static int32_t head[1 << 15], prev[1 << 15];
+	static PngDeflate w;
+
+	for(uint sym = 0; sym < 288; sym++)
+	{
+		uint code = (sym < 144) ? 0x30 + sym : (sym < 256) ? 0x190 + sym - 144 : (sym < 280) ? sym - 256 : 0xC0 + sym - 280;
+		w.lit_len[sym] = (sym < 144) ? 8 : (sym < 256) ? 9 : (sym < 280) ? 7 : 8;
+		w.lit_code[sym] = png_reverse(code, w.lit_len[sym]);
+	}
+	memset(head, 0xFF, sizeof(head));
+	w.out = out;
+	w.out[0] = 0x78;
+	w.out[1] = 0x01;
+	w.pos = 2;
+	w.bitbuf = 0;
+	w.bitcnt = 0;
+
+	// last block (1), fixed Huffman codes (01).
+	png_put_bits(&w, 3, 3);
+	size_t i = 0;
+	while(i < len)
+	{
+		uint best_len = 0, best_dist = 0;
+		if(len - i >= 3)
+		{
+			uint max = (len - i < 258) ? len - i : 258;
+			uint h = ((in[i] << 10) ^ (in[i + 1] << 5) ^ in[i + 2]) & 0x7FFF;
+			int32_t cand = head[h];
+			for(uint chain = PNG_DEFLATE_CHAIN; cand >= 0 && i - cand <= 32768 && chain > 0; chain--)
+			{
+				if(in[cand + best_len] == in[i + best_len])
+				{
+					uint l = 0;
+					while(l < max && in[cand + l] == in[i + l])
+					{
+						l++;
+					}
+					if(l > best_len)
+					{
+						best_len = l;
+						best_dist = i - cand;
+						if(l == max)
+						{
+							break;
+						}
+					}
+				}
+				cand = prev[cand & 0x7FFF];
+			}
+			prev[i & 0x7FFF] = head[h];
+			head[h] = i;
+		}
+
+		// far 3 byte matches cost more bits than 3 literals.
+		if(best_len > 3 || (best_len == 3 && best_dist <= 4096))
+		{
+			png_put_match(&w, best_len, best_dist);
+			for(size_t k = i + 1; k < i + best_len && len - k >= 3; k++)
+			{
+				uint h = ((in[k] << 10) ^ (in[k + 1] << 5) ^ in[k + 2]) & 0x7FFF;
+				prev[k & 0x7FFF] = head[h];
+				head[h] = k;
+			}
+			i += best_len;
+		}
+		else
+		{
+			png_put_bits(&w, w.lit_code[in[i]], w.lit_len[in[i]]);
+			i++;
+		}
+	}
+
+	// end of block, then Adler-32 at next byte boundary.
+	png_put_bits(&w, w.lit_code[256], w.lit_len[256]);
+	if(w.bitcnt > 0)
+	{
+		png_put_bits(&w, 0, 8 - w.bitcnt);
+	}
+	png_put32(w.out + w.pos, png_adler(in, len));
+	return w.pos + 4;
+}
+
+/* Deflates filtered rows into zlib stream, z is allocated */
+static Status png_compress(const uint8_t *raw, size_t raw_len, uint8_t **z, size_t *z_len)
+{
+	*z = malloc(raw_len + raw_len / 3 + 64);
+	if(*z == NULL)
+	{
+		return e_failure;
+	}
+	*z_len = png_deflate(raw, raw_len, *z);
+	return e_success;
+}
+
+#endif
+
+
+
+/* Checks whether file name has .png extension */
+int png_is_png(const char *fname)
+{
+	const char *extn = strstr(fname, ".");
+	return extn != NULL && strcmp(extn, ".png") == 0;
+}
+
+/* Reads whole file (or pipe) into allocated buffer */
+static Status png_read_file(const char *fname, uint8_t **data, size_t *len)
+{
+	FILE *fptr = fopen(fname, "rb");
+	if(fptr == NULL)
+	{
+		perror("fopen");
+		printf("ERROR: Unable to open file %s\n", fname);
+		return e_failure;
+	}
+
+	size_t cap = 1024 * 1024, n = 0, r;
+	uint8_t *buf = malloc(cap);
+	while(buf != NULL && (r = fread(buf + n, 1, cap - n, fptr)) > 0)
+	{
+		n += r;
+		if(n == cap)
+		{
+			uint8_t *bigger = realloc(buf, cap * 2);
+			if(bigger == NULL)
+			{
+				free(buf);
+			}
+			buf = bigger;
+			cap *= 2;
+		}
+	}
+	if(buf == NULL || ferror(fptr))
+	{
+		printf("ERROR: Unable to read %s\n", fname);
+		free(buf);
+		fclose(fptr);
+		return e_failure;
+	}
+	fclose(fptr);
+	*data = buf;
+	*len = n;
+	return e_success;
+}
+
+/* Walks chunks of png file, IHDR fields are checked and IDAT chunks are joined into allocated idat */
+static Status png_parse(const char *fname, const uint8_t *file, size_t len, uint32_t *width, uint32_t *height, uint *channels, uint8_t **idat, size_t *idat_len)
+{
+	size_t pos = PNG_SIGNATURE_SIZE, cap = 0;
+	int have_ihdr = 0;
+
+	*idat = NULL;
+	*idat_len = 0;
+	if(len < PNG_SIGNATURE_SIZE || memcmp(file, PNG_SIGNATURE, PNG_SIGNATURE_SIZE) != 0)
+	{
+		printf("ERROR: %s is not a .png image.\n", fname);
+		return e_failure;
+	}
+
+	// each chunk is length, type, data and CRC of type and data, till IEND.
+	for(;;)
+	{
+		if(len - pos < 12 || png_get32(file + pos) > len - pos - 12)
+		{
+			printf("ERROR: %s is truncated.\n", fname);
+			return e_failure;
+		}
+		uint32_t clen = png_get32(file + pos);
+		const uint8_t *type = file + pos + 4, *data = file + pos + 8;
+		if(png_crc(0, type, clen + 4) != png_get32(data + clen))
+		{
+			printf("ERROR: CRC of %.4s chunk of %s doesn't match.\n", type, fname);
+			return e_failure;
+		}
+		pos += 12 + (size_t)clen;
+
+		if(memcmp(type, "IHDR", 4) == 0)
+		{
+			// 8-bit samples, RGB (2) or RGBA (6), deflate, adaptive filters and no interlace.
+			if(clen != 13 || data[8] != 8 || (data[9] != 2 && data[9] != 6) || data[10] != 0 || data[11] != 0 || data[12] != 0)
+			{
+				printf("ERROR: %s should be an 8-bit RGB or RGBA .png image without interlace.\n", fname);
+				return e_failure;
+			}
+			*width = png_get32(data);
+			*height = png_get32(data + 4);
+			*channels = (data[9] == 6) ? 4 : 3;
+			have_ihdr = 1;
+		}
+		else if(memcmp(type, "IDAT", 4) == 0)
+		{
+			if(*idat_len + clen > cap)
+			{
+				cap = (*idat_len + clen) * 2;
+				uint8_t *bigger = realloc(*idat, cap);
+				if(bigger == NULL)
+				{
+					printf("ERROR: Unable to read image data of %s\n", fname);
+					return e_failure;
+				}
+				*idat = bigger;
+			}
+			memcpy(*idat + *idat_len, data, clen);
+			*idat_len += clen;
+		}
+		else if(memcmp(type, "IEND", 4) == 0)
+		{
+			break;
+		}
+		// if => unknown critical chunk (type starts with upper case letter), then image can't be decoded without it.
+		else if((type[0] & 0x20) == 0 && memcmp(type, "PLTE", 4) != 0)
+		{
+			printf("ERROR: %s has unsupported %.4s chunk.\n", fname, type);
+			return e_failure;
+		}
+	}
+
+	if(!have_ihdr || *idat_len == 0 || *width == 0 || *height == 0 || *width > INT32_MAX || *height > INT32_MAX)
+	{
+		printf("ERROR: %s has no image data.\n", fname);
+		return e_failure;
+	}
+	return e_success;
+}
+
+/* Unfilters rows in place, raw has filter type byte before each row */
+static Status png_unfilter(uint8_t *raw, uint32_t width, uint32_t height, uint channels)
+{
+	size_t stride = (size_t)width * channels;
+	const uint8_t *prev = NULL;
+
+	for(uint32_t y = 0; y < height; y++)
+	{
+		uint8_t *line = raw + y * (stride + 1);
+		uint8_t *cur = line + 1;
+		switch(line[0])
+		{
+			case 0:
+				break;
+			case 1:
+				for(size_t i = channels; i < stride; i++)
+				{
+					cur[i] += cur[i - channels];
+				}
+				break;
+			case 2:
+				for(size_t i = 0; prev != NULL && i < stride; i++)
+				{
+					cur[i] += prev[i];
+				}
+				break;
+			case 3:
+				for(size_t i = 0; i < stride; i++)
+				{
+					cur[i] += (((i >= channels) ? cur[i - channels] : 0) + ((prev != NULL) ? prev[i] : 0)) >> 1;
+				}
+				break;
+			case 4:
+				for(size_t i = 0; i < stride; i++)
+				{
+					int a = (i >= channels) ? cur[i - channels] : 0;
+					int b = (prev != NULL) ? prev[i] : 0;
+					int c = (prev != NULL && i >= channels) ? prev[i - channels] : 0;
+					cur[i] += png_paeth(a, b, c);
+				}
+				break;
+			default:
+				printf("ERROR: Invalid filter type %u of row %u.\n", line[0], y);
+				return e_failure;
+		}
+		prev = cur;
+	}
+	return e_success;
+}
+
+/* Writes unfiltered rows as bottom-up 32 bpp BGRA bmp into temp file */
+static Status png_write_bmp(const uint8_t *raw, uint32_t width, uint32_t height, uint channels, FILE **fptr_bmp)
+{
+	uint8_t header[BMP_HEADER_SIZE];
+	size_t stride = (size_t)width * channels;
+	uint64_t pixel_size = (uint64_t)width * height * 4;
+
+	memset(header, 0, sizeof(header));
+	header[0] = 'B';
+	header[1] = 'M';
+	png_put_le(header + 2, BMP_HEADER_SIZE + pixel_size, 4);
+	png_put_le(header + 10, BMP_HEADER_SIZE, 4);
+	png_put_le(header + 14, 40, 4);
+	png_put_le(header + 18, width, 4);
+	png_put_le(header + 22, height, 4);
+	png_put_le(header + 26, 1, 2);
+	png_put_le(header + 28, 32, 2);
+	png_put_le(header + 34, pixel_size, 4);
+	png_put_le(header + 38, 2835, 4);
+	png_put_le(header + 42, 2835, 4);
+
+	FILE *fptr = tmpfile();
+	uint8_t *row = malloc((size_t)width * 4);
+	Status ret = (fptr != NULL && row != NULL && fwrite(header, 1, BMP_HEADER_SIZE, fptr) == BMP_HEADER_SIZE) ? e_success : e_failure;
+
+	// last png row is first bmp row, alpha is 0xFF for RGB.
+	for(uint32_t y = height; ret == e_success && y-- > 0; )
+	{
+		const uint8_t *src = raw + y * (stride + 1) + 1;
+		for(uint32_t x = 0; x < width; x++, src += channels)
+		{
+			row[4 * x] = src[2];
+			row[4 * x + 1] = src[1];
+			row[4 * x + 2] = src[0];
+			row[4 * x + 3] = (channels == 4) ? src[3] : 0xFF;
+		}
+		if(fwrite(row, 4, width, fptr) != width)
+		{
+			ret = e_failure;
+		}
+	}
+	free(row);
+	if(ret == e_failure || fflush(fptr) != 0)
+	{
+		perror("tmpfile");
+		if(fptr != NULL)
+		{
+			fclose(fptr);
+		}
+		return e_failure;
+	}
+	rewind(fptr);
+	*fptr_bmp = fptr;
+	return e_success;
+}
+
+
+
+/* Decode .png image into a 32 bpp bmp temp file, alpha is 1 if image has alpha channel */
+Status png_open_image(const char *png_fname, FILE **fptr_bmp, int *alpha)
+{
+	uint8_t *file, *idat, *raw = NULL;
+	size_t file_len, idat_len;
+	uint32_t width = 0, height = 0;
+	uint channels = 3;
+
+	if(png_read_file(png_fname, &file, &file_len) == e_failure)
+	{
+		return e_failure;
+	}
+	Status ret = png_parse(png_fname, file, file_len, &width, &height, &channels, &idat, &idat_len);
+	free(file);
+
+	// bmp file size field is 32-bit.
+	uint64_t raw_len = ((uint64_t)width * channels + 1) * height;
+	if(ret == e_success && BMP_HEADER_SIZE + (uint64_t)width * height * 4 > UINT32_MAX)
+	{
+		printf("ERROR: %s is too big for a bmp image.\n", png_fname);
+		ret = e_failure;
+	}
+	if(ret == e_success && ((raw = malloc(raw_len)) == NULL || png_inflate(idat, idat_len, raw, raw_len) == e_failure))
+	{
+		printf("ERROR: Image data of %s is corrupt.\n", png_fname);
+		ret = e_failure;
+	}
+	free(idat);
+	if(ret == e_success && png_unfilter(raw, width, height, channels) == e_success && png_write_bmp(raw, width, height, channels, fptr_bmp) == e_success)
+	{
+		*alpha = (channels == 4);
+		print_info("INFO: Decoded %s (%ux%u %s) into 32 bpp bmp\n", png_fname, width, height, (channels == 4) ? "RGBA" : "RGB");
+	}
+	else
+	{
+		ret = e_failure;
+	}
+	free(raw);
+	return ret;
+}
+
+
+
+/* Filters row with each filter type and keeps one with smallest sum of absolute values */
+static void png_filter_row(const uint8_t *cur, const uint8_t *prev, size_t stride, uint channels, uint8_t *trial, uint8_t *out)
+{
+	uint64_t best = UINT64_MAX;
+	for(uint f = 0; f < 5; f++)
+	{
+		uint64_t sum = 0;
+		for(size_t i = 0; i < stride; i++)
+		{
+			int a = (i >= channels) ? cur[i - channels] : 0;
+			int b = prev[i];
+			int c = (i >= channels) ? prev[i - channels] : 0;
+			uint8_t pred = (f == 0) ? 0 : (f == 1) ? a : (f == 2) ? b : (f == 3) ? (a + b) >> 1 : png_paeth(a, b, c);
+			uint8_t v = cur[i] - pred;
+			trial[i] = v;
+			sum += (v < 128) ? v : 256 - v;
+		}
+		if(sum < best)
+		{
+			best = sum;
+			out[0] = f;
+			memcpy(out + 1, trial, stride);
+		}
+	}
+}
+
+/* Writes chunk with its length and CRC */
+static Status png_write_chunk(FILE *fptr, const char *type, const uint8_t *data, uint32_t len)
+{
+	uint8_t field[4];
+	png_put32(field, len);
+	uint32_t crc = png_crc(png_crc(0, (const uint8_t *)type, 4), data, len);
+	if(fwrite(field, 1, 4, fptr) != 4 || fwrite(type, 1, 4, fptr) != 4 || fwrite(data, 1, len, fptr) != len)
+	{
+		return e_failure;
+	}
+	png_put32(field, crc);
+	return (fwrite(field, 1, 4, fptr) == 4) ? e_success : e_failure;
+}
+
+/* Check whether bmp image can be saved as .png image without losing carrier bytes */
+Status png_check_bmp(FILE *fptr_bmp, const char *png_fname)
+{
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+	PixelFormat format;
+	uint64_t data_offset;
+	int32_t width, height;
+
+	if(fflush(fptr_bmp) != 0 || pread(fileno(fptr_bmp), bmp_header, BMP_HEADER_SIZE, 0) != BMP_HEADER_SIZE || stego_bmp_format(bmp_header, &format, &data_offset) == e_failure || format == e_rgb16)
+	{
+		printf("ERROR: Only 24 or 32 bpp image can be saved as %s\n", png_fname);
+		return e_failure;
+	}
+	memcpy(&width, bmp_header + 18, 4);
+	memcpy(&height, bmp_header + 22, 4);
+
+	// if => top-down, or 24 bpp rows are padded, then bmp carrier bytes are not same bytes in same order as png samples.
+	if(width <= 0 || height <= 0 || ((uint64_t)width * ((format == e_bgr24) ? 3 : 4)) % 4 != 0)
+	{
+		printf("ERROR: Image can be saved as %s only if it is bottom-up and its rows are not padded.\n", png_fname);
+		return e_failure;
+	}
+	return e_success;
+}
+
+/* Save 24/32 bpp bmp image as .png image (RGBA if alpha, else RGB) */
+Status png_save_image(FILE *fptr_bmp, const char *png_fname, int alpha)
+{
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+	PixelFormat format;
+	uint64_t data_offset;
+	int32_t width, height;
+	int fd = fileno(fptr_bmp);
+
+	if(png_check_bmp(fptr_bmp, png_fname) == e_failure)
+	{
+		return e_failure;
+	}
+	pread(fd, bmp_header, BMP_HEADER_SIZE, 0);
+	stego_bmp_format(bmp_header, &format, &data_offset);
+	memcpy(&width, bmp_header + 18, 4);
+	memcpy(&height, bmp_header + 22, 4);
+	uint bmp_pixel = (format == e_bgr24) ? 3 : 4;
+
+	uint channels = alpha ? 4 : 3;
+	size_t bmp_stride = (size_t)width * bmp_pixel, stride = (size_t)width * channels;
+	size_t raw_len = (stride + 1) * height;
+	uint8_t *raw = malloc(raw_len), *line = malloc(bmp_stride), *trial = malloc(stride);
+	uint8_t *cur = malloc(stride), *prev = calloc(stride, 1);
+	uint8_t *z = NULL;
+	size_t z_len = 0;
+	Status ret = (raw != NULL && line != NULL && trial != NULL && cur != NULL && prev != NULL) ? e_success : e_failure;
+
+	// first png row is last bmp row, row before first one is all zeros.
+	for(int32_t y = 0; ret == e_success && y < height; y++)
+	{
+		if(pread(fd, line, bmp_stride, data_offset + (uint64_t)(height - 1 - y) * bmp_stride) != (ssize_t)bmp_stride)
+		{
+			printf("ERROR: Unable to read pixels of stego image.\n");
+			ret = e_failure;
+			break;
+		}
+		for(int32_t x = 0; x < width; x++)
+		{
+			cur[channels * x] = line[bmp_pixel * x + 2];
+			cur[channels * x + 1] = line[bmp_pixel * x + 1];
+			cur[channels * x + 2] = line[bmp_pixel * x];
+			if(alpha)
+			{
+				cur[channels * x + 3] = line[bmp_pixel * x + 3];
+			}
+		}
+		png_filter_row(cur, prev, stride, channels, trial, raw + y * (stride + 1));
+		uint8_t *swap = prev;
+		prev = cur;
+		cur = swap;
+	}
+	free(line);
+	free(trial);
+	free(cur);
+	free(prev);
+	if(ret == e_success && png_compress(raw, raw_len, &z, &z_len) == e_failure)
+	{
+		printf("ERROR: Unable to compress image data of %s\n", png_fname);
+		ret = e_failure;
+	}
+	free(raw);
+
+	// signature, IHDR, IDAT chunks of compressed rows and IEND.
+	FILE *fptr = NULL;
+	if(ret == e_success && (fptr = fopen(png_fname, "wb")) == NULL)
+	{
+		perror("fopen");
+		printf("ERROR: Unable to open file %s\n", png_fname);
+		ret = e_failure;
+	}
+	if(ret == e_success)
+	{
+		uint8_t ihdr[13] = { 0 };
+		png_put32(ihdr, width);
+		png_put32(ihdr + 4, height);
+		ihdr[8] = 8;
+		ihdr[9] = alpha ? 6 : 2;
+		if(fwrite(PNG_SIGNATURE, 1, PNG_SIGNATURE_SIZE, fptr) != PNG_SIGNATURE_SIZE || png_write_chunk(fptr, "IHDR", ihdr, sizeof(ihdr)) == e_failure)
+		{
+			ret = e_failure;
+		}
+		for(size_t off = 0; ret == e_success && off < z_len; off += PNG_IDAT_SIZE)
+		{
+			ret = png_write_chunk(fptr, "IDAT", z + off, (z_len - off < PNG_IDAT_SIZE) ? z_len - off : PNG_IDAT_SIZE);
+		}
+		if(ret == e_success)
+		{
+			ret = png_write_chunk(fptr, "IEND", (const uint8_t *)"", 0);
+		}
+		if(fclose(fptr) != 0 || ret == e_failure)
+		{
+			printf("ERROR: Unable to write %s\n", png_fname);
+			remove(png_fname);
+			ret = e_failure;
+		}
+	}
+	free(z);
+	if(ret == e_success)
+	{
+		print_info("INFO: Saved stego image as %s (%llu bytes of compressed image data)\n", png_fname, (unsigned long long)z_len);
+	}
+	return ret;
+}
@@ -0,0 +1,62 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       PNG Carrier and Stego Images
+ *
+ *                              -> 8-bit RGB and RGBA .png images (not interlaced) can be used as source image of -e, output image of -e
+ *                                 and image of -d, they are about 2-4 times smaller than same .bmp image.
+ *                              -> .png image is decoded into a 32 bpp bmp temp file (bottom-up, alpha 0xFF for RGB), so all encode and decode
+ *                                 stages work on same pixel bytes as for .bmp, and 32 bpp carriers (alpha skipped) are same bytes in
+ *                                 same order as 24 bpp carriers of same image.
+ *                              -> .png output is made from stego bmp after encoding : each row gets filter with smallest sum of
+ *                                 absolute values, and rows are compressed losslessly, so decoding it gives same LSBs back.
+ *                              -> Built with -DHAVE_ZLIB (and -lz), zlib is used for inflate / deflate and CRCs, else a built-in inflater
+ *                                 (stored, fixed and dynamic Huffman blocks) and a built-in deflater (LZ77 with fixed Huffman codes) are used.
+ *                              -> .bmp source can be saved as .png if it is bottom-up 32 bpp, or 24 bpp without row padding
+ *                                 (padding bytes are carriers in bmp, but they are not in .png).
+ */
+
+
+
+
+#ifndef PNG_H
+#define PNG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+
+/* PNG file signature */
+#define PNG_SIGNATURE "\x89PNG\r\n\x1a\n"
+#define PNG_SIGNATURE_SIZE 8
+
+/* Max. no. of bytes of one IDAT chunk written */
+#define PNG_IDAT_SIZE (1024 * 1024)
+
+/* zlib compression level of .png output (with HAVE_ZLIB) */
+#define PNG_ZLIB_LEVEL 6
+
+/* Bits of Huffman code decoded with one table lookup by built-in inflater */
+#define PNG_FAST_BITS 10
+
+/* Match candidates tried per position by built-in deflater */
+#define PNG_DEFLATE_CHAIN 16
+
+
+/* PNG function prototypes */
+
+/* Check whether file name has .png extension */
+int png_is_png(const char *fname);
+
+/* Decode .png image into a 32 bpp bmp temp file, alpha is 1 if image has alpha channel */
+Status png_open_image(const char *png_fname, FILE **fptr_bmp, int *alpha);
+
+/* Check whether bmp image can be saved as .png image without losing carrier bytes */
+Status png_check_bmp(FILE *fptr_bmp, const char *png_fname);
+
+/* Save 24/32 bpp bmp image as .png image (RGBA if alpha, else RGB) */
+Status png_save_image(FILE *fptr_bmp, const char *png_fname, int alpha);
+
+#endif
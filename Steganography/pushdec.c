@@ -0,0 +1,336 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Push Decoder
+ *
+ *                              -> First 54 fed bytes are bmp header, stego_bmp_format() gives pixel format and offset of first carrier byte.
+ *                              -> After it, fed bytes are walked by carrier span of next payload byte (8 carrier bytes for 24 bpp, and
+ *                                 alpha / high bytes in between for 32 / 16 bpp) : bytes before span are skipped, all payload bytes whose
+ *                                 spans are whole in chunk are decoded with one lsb_extract_pixels(), and a span split at end of chunk
+ *                                 is copied to carry and decoded when next chunk completes it.
+ *                              -> Header bytes are collected till fields read so far say header is complete (magic, version, flags,
+ *                                 nonce, extension size, extension and size field, see stego_header_need()), then stego_read_header() reads it.
+ *                              -> Secret data is given to on_data till secret file size, rest of image is not needed.
+ *                              -> All state and buffers are in PushDecoder (and decoded file name in DecodeInfo), no static buffers,
+ *                                 so many streams can be decoded at same time in one process.
+ */
+
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "pushdec.h"
+#include "lsb.h"
+#include "options.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Marks decoder failed, nothing more is decoded */
+static Status push_fail(PushDecoder *pd)
+{
+	pd->state = e_push_error;
+	return e_failure;
+}
+
+/* Gets no. of payload bits whose carrier byte is before offset limit from start of pixel data */
+static uint64_t push_carrier_bits(PixelFormat format, uint64_t limit)
+{
+	uint64_t stride = lsb_format_stride(format);
+	uint64_t channels = lsb_format_channels(format);
+	uint64_t rest = limit % stride;
+	return limit / stride * channels + ((rest < channels) ? rest : channels);
+}
+
+/* Gets no. of header bytes still needed, from header fields decoded so far (0 => header is complete, -1 => not a stego header) */
+static int push_header_need(const PushDecoder *pd)
+{
+	const uint8_t *h = pd->header;
+
+	// if => --channels or --ecc image, then its carriers or data layout differ, so it is not decoded as stream.
+	if(pd->header_len >= 4 && memcmp(h, MAGIC_STRING_EXT, 2) == 0 && (h[3] & (FLAG_CHANNELS | FLAG_ECC)) != 0)
+	{
+		printf("ERROR: Unsupported header version or flags for a streamed image, decode it from a .bmp file.\n");
+		return -1;
+	}
+	return stego_header_need(h, pd->header_len);
+}
+
+/* Reads complete header, loads key if encrypted and reports header */
+static Status push_header_done(PushDecoder *pd)
+{
+	if(stego_read_header(pd->header, pd->header_len, &pd->hdr) == e_failure)
+	{
+		return push_fail(pd);
+	}
+
+	// if => encrypted, then key is loaded and keystream starts at first byte of secret data.
+	if(pd->hdr.flags & FLAG_ENCRYPTED)
+	{
+		uint8_t key[CIPHER_KEY_SIZE];
+		if(cipher_load_key(options.key_fname, key) == e_failure)
+		{
+			return push_fail(pd);
+		}
+		cipher_init(&pd->cipher, key, pd->hdr.nonce);
+		memset(key, 0, sizeof(key));
+	}
+
+	if(pd->on_header(pd->ctx, &pd->hdr) == e_failure)
+	{
+		return push_fail(pd);
+	}
+	pd->state = (pd->hdr.data_size == 0) ? e_push_done : e_push_data;
+	return e_success;
+}
+
+/* Takes n decoded payload bytes : header bytes till header is complete, then secret data till secret file size */
+static Status push_payload(PushDecoder *pd, uint8_t *data, size_t n)
+{
+	size_t i = 0;
+	pd->bits_decoded += 8 * (uint64_t)n;
+
+	while(i < n && pd->state == e_push_header)
+	{
+		pd->header[pd->header_len++] = data[i++];
+		int need = push_header_need(pd);
+		if(need < 0)
+		{
+			return push_fail(pd);
+		}
+		if(need == 0 && push_header_done(pd) == e_failure)
+		{
+			return e_failure;
+		}
+	}
+
+	if(i < n && pd->state == e_push_data)
+	{
+		uint64_t left = pd->hdr.data_size - pd->data_done;
+		size_t m = (n - i < left) ? n - i : left;
+
+		// if => encrypted, then keystream is XORed into same block before it is given.
+		if(pd->hdr.flags & FLAG_ENCRYPTED)
+		{
+			cipher_xor(&pd->cipher, data + i, m);
+		}
+		if(pd->on_data(pd->ctx, data + i, m) == e_failure)
+		{
+			return push_fail(pd);
+		}
+		pd->data_done += m;
+		if(pd->data_done == pd->hdr.data_size)
+		{
+			pd->state = e_push_done;
+		}
+	}
+	return e_success;
+}
+
+
+
+/* Initialise push decoder with callbacks */
+void push_init(PushDecoder *pd, Status (*on_header)(void *, const StegoHeader *), Status (*on_data)(void *, const uint8_t *, size_t), void *ctx)
+{
+	memset(pd, 0, sizeof(*pd));
+	pd->state = e_push_bmp_header;
+	pd->on_header = on_header;
+	pd->on_data = on_data;
+	pd->ctx = ctx;
+}
+
+
+
+/* Feed next len bytes of image file */
+Status push_feed(PushDecoder *pd, const uint8_t *chunk, size_t len)
+{
+	// payload buffer is in decoder, so many decoders can be fed at same time (from other threads too).
+	uint8_t *payload = pd->payload;
+
+	while(len > 0 && (pd->state == e_push_bmp_header || pd->state == e_push_header || pd->state == e_push_data))
+	{
+		size_t take;
+
+		// if => bmp header is not complete, then bytes are collected, and pixel format is taken from it when complete.
+		if(pd->state == e_push_bmp_header)
+		{
+			take = (len < BMP_HEADER_SIZE - pd->file_pos) ? len : BMP_HEADER_SIZE - pd->file_pos;
+			memcpy(pd->bmp_header + pd->file_pos, chunk, take);
+			if(pd->file_pos + take == BMP_HEADER_SIZE)
+			{
+				if(stego_bmp_format(pd->bmp_header, &pd->pixel_format, &pd->data_offset) == e_failure)
+				{
+					printf("ERROR: Image is not a 24, 32 or 16 bpp uncompressed bmp image.\n");
+					return push_fail(pd);
+				}
+				pd->state = e_push_header;
+			}
+		}
+		else
+		{
+			uint64_t byte = pd->bits_decoded / 8;
+			uint64_t span_from = pd->data_offset + lsb_carrier_offset(pd->pixel_format, byte * 8);
+			uint64_t span_len = pd->data_offset + lsb_carrier_offset(pd->pixel_format, byte * 8 + 7) + 1 - span_from;
+			uint64_t whole = push_carrier_bits(pd->pixel_format, pd->file_pos + len - pd->data_offset) / 8 - byte;
+
+			// if => bytes before carrier span of next payload byte (before pixel data), then they are skipped.
+			if(pd->file_pos < span_from)
+			{
+				take = (len < span_from - pd->file_pos) ? len : span_from - pd->file_pos;
+			}
+			// if => carrier span is split between chunks, then it is kept in carry till it is complete.
+			else if(pd->carry_len > 0 || whole == 0)
+			{
+				take = (len < span_len - pd->carry_len) ? len : span_len - pd->carry_len;
+				memcpy(pd->carry + pd->carry_len, chunk, take);
+				pd->carry_len += take;
+				if(pd->carry_len == span_len)
+				{
+					lsb_extract_pixels(pd->pixel_format, pd->carry, payload, byte * 8, 8);
+					pd->carry_len = 0;
+					pd->file_pos += take;
+					chunk += take;
+					len -= take;
+					if(push_payload(pd, payload, 1) == e_failure)
+					{
+						return e_failure;
+					}
+					continue;
+				}
+			}
+			// else => payload bytes whose carrier spans are whole in chunk are decoded at once.
+			else
+			{
+				size_t n = (whole < PUSH_BLOCK_SIZE) ? whole : PUSH_BLOCK_SIZE;
+				lsb_extract_pixels(pd->pixel_format, chunk + (span_from - pd->file_pos), payload, byte * 8, n * 8);
+				take = pd->data_offset + lsb_carrier_offset(pd->pixel_format, (byte + n) * 8 - 1) + 1 - pd->file_pos;
+				pd->file_pos += take;
+				chunk += take;
+				len -= take;
+				if(push_payload(pd, payload, n) == e_failure)
+				{
+					return e_failure;
+				}
+				continue;
+			}
+		}
+		pd->file_pos += take;
+		chunk += take;
+		len -= take;
+	}
+
+	// bytes after end of secret data are only counted.
+	pd->file_pos += len;
+	return (pd->state == e_push_error) ? e_failure : e_success;
+}
+
+
+
+/* Opens decoded secret file when header is complete, extension is taken from header */
+static Status push_open_output(void *ctx, const StegoHeader *hdr)
+{
+	DecodeInfo *decInfo = ctx;
+
+	snprintf(decInfo->stream_fname, sizeof(decInfo->stream_fname), "%s%s", decInfo->secret_fname, hdr->extn);
+	decInfo->secret_fname = decInfo->stream_fname;
+	decInfo->secret_file_size = hdr->data_size;
+	print_info("INFO: Header decoded, %s has %llu bytes of secret data. Creating %s\n", decInfo->image_fname, (unsigned long long)hdr->data_size, decInfo->secret_fname);
+
+	decInfo->fptr_secret = fopen(decInfo->secret_fname, "w");
+	if(decInfo->fptr_secret == NULL)
+	{
+		perror("fopen");
+		printf("ERROR: Unable to open file %s\n", decInfo->secret_fname);
+		return e_failure;
+	}
+	return e_success;
+}
+
+/* Writes block of secret data to decoded secret file */
+static Status push_write_output(void *ctx, const uint8_t *data, size_t len)
+{
+	DecodeInfo *decInfo = ctx;
+	if(fwrite(data, 1, len, decInfo->fptr_secret) != len)
+	{
+		printf("ERROR: Unable to write %s decoded file.\n", decInfo->secret_fname);
+		return e_failure;
+	}
+	return e_success;
+}
+
+
+
+/* Decode image from stdin or pipe with push decoder (./a.out -d -) */
+Status decode_stream(DecodeInfo *decInfo)
+{
+	PushDecoder pd;
+	Status ret = e_success;
+	ssize_t r;
+
+	uint8_t *chunk = malloc(PUSH_READ_SIZE);
+	if(chunk == NULL)
+	{
+		printf("ERROR: Out of memory for decoding %s\n", decInfo->image_fname);
+		return e_failure;
+	}
+	int fd = (strcmp(decInfo->image_fname, "-") == 0) ? STDIN_FILENO : open(decInfo->image_fname, O_RDONLY);
+	if(fd == -1)
+	{
+		perror("open");
+		printf("ERROR: Unable to open file %s\n", decInfo->image_fname);
+		free(chunk);
+		return e_failure;
+	}
+	print_info("INFO: %s is a stream, secret data is decoded as image arrives\n", decInfo->image_fname);
+
+	// chunks are fed as they are read, of whatever size read() gives, till all secret data is decoded.
+	decInfo->fptr_secret = NULL;
+	push_init(&pd, push_open_output, push_write_output, decInfo);
+	while(pd.state != e_push_done && (r = read(fd, chunk, PUSH_READ_SIZE)) != 0)
+	{
+		if(r < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			perror("read");
+			ret = e_failure;
+			break;
+		}
+		if(push_feed(&pd, chunk, r) == e_failure)
+		{
+			ret = e_failure;
+			break;
+		}
+	}
+	if(ret == e_success && pd.state != e_push_done)
+	{
+		printf("ERROR: %s ended after %llu bytes, before end of secret data.\n", decInfo->image_fname, (unsigned long long)pd.file_pos);
+		ret = e_failure;
+	}
+	if(fd != STDIN_FILENO)
+	{
+		close(fd);
+	}
+	free(chunk);
+
+	// if => decoding failed, then partly written decoded file is removed.
+	if(decInfo->fptr_secret != NULL && (fclose(decInfo->fptr_secret) != 0 || ret == e_failure))
+	{
+		remove(decInfo->secret_fname);
+		ret = e_failure;
+	}
+	if(ret == e_success)
+	{
+		print_info("INFO: Decoded %llu bytes of secret data from first %llu bytes of %s\n", (unsigned long long)pd.hdr.data_size, (unsigned long long)pd.file_pos, decInfo->image_fname);
+	}
+	return ret;
+}
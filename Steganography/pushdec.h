@@ -0,0 +1,97 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Push Decoder
+ *
+ *                              -> Decoder object which is fed image file bytes in chunks of any size, as they arrive from a pipe or socket,
+ *                                 instead of reading image file itself (decode_*() stages fread() whole fields).
+ *                              -> Payload bytes are decoded as soon as all their carrier bytes are fed, carrier bytes of a payload byte
+ *                                 which are split between two chunks are kept till next chunk.
+ *                              -> Header is reported (on_header) as soon as its last byte is decoded, and secret data (decrypted, if
+ *                                 encrypted) is given to on_data block by block, so it can be processed before image is complete.
+ *                              -> ./a.out -d - [output] decodes image from stdin, and a pipe (FIFO) as image file is decoded same way.
+ *                              -> Headers of stego_read_header() are supported (plain and --encrypt), not --channels or --ecc images.
+ */
+
+
+
+
+#ifndef PUSHDEC_H
+#define PUSHDEC_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+#include "common.h"
+#include "stego.h"
+#include "cipher.h"
+#include "decode.h"
+
+/* Payload bytes decoded at a time from a chunk */
+#define PUSH_BLOCK_SIZE 4096
+
+/* Image bytes read at a time from stdin or pipe */
+#define PUSH_READ_SIZE (64 * 1024)
+
+/* PushState tells what next fed bytes are */
+typedef enum
+{
+    e_push_bmp_header,		// => bmp header, pixel format is not known yet
+    e_push_header,		// => carriers of stego header
+    e_push_data,		// => carriers of secret data
+    e_push_done,		// => all secret data is decoded, rest of image is ignored
+    e_push_error		// => decoding failed, nothing more is decoded
+} PushState;
+
+/*
+ * Structure to store state of push decoder,
+ * between two chunks of image file
+ */
+
+typedef struct _PushDecoder
+{
+    /* State */
+    PushState state;				// => what next fed bytes are
+    uint64_t file_pos;				// => no. of image file bytes fed so far
+
+    /* Image Info */
+    uint8_t bmp_header[BMP_HEADER_SIZE];	// => bmp header, pixel format is taken from it
+    PixelFormat pixel_format;			// => pixel format of image (24/32/16 bpp)
+    uint64_t data_offset;			// => file offset of first carrier byte
+
+    /* Payload Info */
+    uint64_t bits_decoded;			// => no. of payload bits decoded so far (always whole bytes)
+    uint8_t carry[2 * 8];			// => carrier span of next payload byte, when it is split between chunks
+    uint carry_len;				// => no. of bytes of carry fed so far
+    uint8_t payload[PUSH_BLOCK_SIZE];		// => payload bytes decoded from current chunk
+
+    /* Header Info */
+    uint8_t header[STEGO_HEADER_MAX];		// => payload bytes of stego header decoded so far
+    uint header_len;				// => no. of header bytes decoded so far
+    StegoHeader hdr;				// => header fields, once header is complete
+    CipherCtx cipher;				// => ChaCha20 state for decryption
+
+    /* Secret Data Info */
+    uint64_t data_done;				// => no. of secret data bytes given to on_data
+
+    /* Callbacks */
+    Status (*on_header)(void *ctx, const StegoHeader *hdr);		// => called once, when header is complete
+    Status (*on_data)(void *ctx, const uint8_t *data, size_t len);	// => called for each block of secret data
+    void *ctx;									// => passed to callbacks
+
+} PushDecoder;
+
+
+/* Push decoder function prototypes */
+
+/* Initialise push decoder with callbacks */
+void push_init(PushDecoder *pd, Status (*on_header)(void *, const StegoHeader *), Status (*on_data)(void *, const uint8_t *, size_t), void *ctx);
+
+/* Feed next len bytes of image file */
+Status push_feed(PushDecoder *pd, const uint8_t *chunk, size_t len);
+
+/* Decode image from stdin or pipe with push decoder (./a.out -d -) */
+Status decode_stream(DecodeInfo *decInfo);
+
+#endif
@@ -0,0 +1,447 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Reed-Solomon Error Correction
+ *
+ *                              -> GF(2^8) with polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d), generator roots are alpha^0 .. alpha^(n-1).
+ *                              -> Parity is remainder of data * x^n by generator, made with a shift register : each data byte gives
+ *                                 feedback byte, and its row of feedback table is XORed into register, which is kept in 64-bit words.
+ *                              -> Decoding makes parity of data bytes again in same way, if it matches parity bytes, codeword has
+ *                                 no error (usual case, same speed as encoding), else syndromes are taken from the difference.
+ *                              -> Errors are found with Berlekamp-Massey and Chien search, and corrected with Forney's formula,
+ *                                 codeword is checked again after correction, so wrong corrections are reported as failure.
+ */
+
+
+
+
+#include <string.h>
+#include "rs.h"
+#include "types.h"
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+/* Antilog (twice, so sum of two logs needs no mod) and log tables */
+static uint8_t gf_exp[2 * 255];
+static uint8_t gf_log[256];
+static int gf_ready;
+
+/* Function Definitions */
+
+/* Makes log/antilog tables of GF(2^8) */
+static void gf_init(void)
+{
+	uint x = 1;
+	for(int i=0; i<255; i++)
+	{
+		gf_exp[i] = gf_exp[i + 255] = x;
+		gf_log[x] = i;
+		x <<= 1;
+		if(x & 0x100)
+		{
+			x ^= 0x11d;
+		}
+	}
+	gf_ready = 1;
+}
+
+/* Multiplies two field elements */
+static uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+	return (a == 0 || b == 0) ? 0 : gf_exp[gf_log[a] + gf_log[b]];
+}
+
+/* Divides field element a by b (b is not 0) */
+static uint8_t gf_div(uint8_t a, uint8_t b)
+{
+	return (a == 0) ? 0 : gf_exp[gf_log[a] + 255 - gf_log[b]];
+}
+
+
+
+/* Make code with nparity parity bytes per codeword */
+void rs_init(RsCode *rs, uint nparity)
+{
+	if(!gf_ready)
+	{
+		gf_init();
+	}
+	rs->nparity = nparity;
+	rs->ndata = RS_CODEWORD_SIZE - nparity;
+
+	// generator is (x + alpha^0)(x + alpha^1)...(x + alpha^(n-1)), multiplied one root at a time.
+	memset(rs->gen, 0, sizeof(rs->gen));
+	rs->gen[0] = 1;
+	for(uint j=0; j<nparity; j++)
+	{
+		for(uint i=j+1; i>0; i--)
+		{
+			rs->gen[i] ^= gf_mul(rs->gen[i - 1], gf_exp[j]);
+		}
+	}
+
+	// feedback rows are packed as register words, byte i in bits 8 * (i % 8) of word i / 8.
+	memset(rs->feedback, 0, sizeof(rs->feedback));
+	for(uint f=0; f<256; f++)
+	{
+		for(uint i=0; i<nparity; i++)
+		{
+			rs->feedback[f][i / 8] |= (uint64_t)gf_mul(f, rs->gen[i + 1]) << (8 * (i % 8));
+		}
+	}
+
+	// split-nibble tables : product of generator coefficient with low nibble and with high nibble of feedback byte.
+	for(uint i=0; i<nparity; i++)
+	{
+		for(uint x=0; x<16; x++)
+		{
+			rs->nibble[i][0][x] = gf_mul(x, rs->gen[i + 1]);
+			rs->nibble[i][1][x] = gf_mul(x << 4, rs->gen[i + 1]);
+		}
+	}
+}
+
+
+
+/* Get size of size data bytes encoded as codewords */
+uint64_t rs_encoded_size(uint64_t size, uint nparity)
+{
+	uint64_t ndata = RS_CODEWORD_SIZE - nparity;
+	return size + (size + ndata - 1) / ndata * nparity;
+}
+
+
+
+/*
+ * Parity kernel for register of NW words, so register is kept in CPU registers and loop is unrolled.
+ * Register byte i is byte i % 8 of word i / 8 (byte 0 is highest degree), shifting one byte moves each word 8 bits down
+ * and takes low byte of next word, bytes after nparity are always 0 since feedback rows are 0 there.
+ */
+#define RS_PARITY_KERNEL(NW)										\
+static void rs_parity_##NW(const RsCode *rs, const uint8_t *data, size_t n, uint64_t *out)		\
+{													\
+	uint64_t reg[NW] = { 0 };									\
+	for(size_t k=0; k<n; k++)									\
+	{												\
+		const uint64_t *row = rs->feedback[(reg[0] & 0xff) ^ data[k]];				\
+		for(uint j=0; j+1<NW; j++)								\
+		{											\
+			reg[j] = ((reg[j] >> 8) | (reg[j + 1] << 56)) ^ row[j];				\
+		}											\
+		reg[NW - 1] = (reg[NW - 1] >> 8) ^ row[NW - 1];						\
+	}												\
+	memcpy(out, reg, sizeof(reg));									\
+}
+
+RS_PARITY_KERNEL(1)
+RS_PARITY_KERNEL(2)
+RS_PARITY_KERNEL(3)
+RS_PARITY_KERNEL(4)
+RS_PARITY_KERNEL(5)
+RS_PARITY_KERNEL(6)
+RS_PARITY_KERNEL(7)
+RS_PARITY_KERNEL(8)
+
+/* Parity kernels by no. of register words - 1 */
+static void (*const rs_parity_kernels[RS_MAX_PARITY / 8])(const RsCode *, const uint8_t *, size_t, uint64_t *) =
+{
+	rs_parity_1, rs_parity_2, rs_parity_3, rs_parity_4, rs_parity_5, rs_parity_6, rs_parity_7, rs_parity_8
+};
+
+/* Makes parity bytes of n data bytes with shift register */
+static void rs_parity(const RsCode *rs, const uint8_t *data, size_t n, uint8_t *parity)
+{
+	uint64_t reg[RS_MAX_PARITY / 8];
+	rs_parity_kernels[(rs->nparity + 7) / 8 - 1](rs, data, n, reg);
+	for(uint i=0; i<rs->nparity; i++)
+	{
+		parity[i] = reg[i / 8] >> (8 * (i % 8));
+	}
+}
+
+#ifdef __SSSE3__
+/*
+ * Parity of 16 codewords at once, codeword c is lane c of each vector, so feedback bytes of all 16 are multiplied
+ * by a generator coefficient with two pshufb (split nibble tables), and register is nparity vectors.
+ */
+static void rs_parity_x16(const RsCode *rs, const uint8_t *data, size_t stride, size_t n, uint8_t *parity)
+{
+	uint8_t lanes[RS_CODEWORD_SIZE][16] __attribute__((aligned(16)));
+	uint8_t out[RS_MAX_PARITY][16] __attribute__((aligned(16)));
+	__m128i reg[RS_MAX_PARITY + 1];
+	const __m128i low = _mm_set1_epi8(0x0f);
+	uint np = rs->nparity;
+
+	// data bytes are transposed, so byte k of all 16 codewords is one vector.
+	for(uint c=0; c<16; c++)
+	{
+		for(size_t k=0; k<n; k++)
+		{
+			lanes[k][c] = data[c * stride + k];
+		}
+	}
+
+	// reg[nparity] is always 0, it is shifted into last parity vector.
+	for(uint i=0; i<=np; i++)
+	{
+		reg[i] = _mm_setzero_si128();
+	}
+	for(size_t k=0; k<n; k++)
+	{
+		__m128i fb = _mm_xor_si128(_mm_load_si128((const __m128i *)lanes[k]), reg[0]);
+		__m128i lo = _mm_and_si128(fb, low);
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(fb, 4), low);
+		for(uint i=0; i<np; i++)
+		{
+			__m128i prod = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)rs->nibble[i][0]), lo),
+						     _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)rs->nibble[i][1]), hi));
+			reg[i] = _mm_xor_si128(reg[i + 1], prod);
+		}
+	}
+
+	for(uint i=0; i<np; i++)
+	{
+		_mm_store_si128((__m128i *)out[i], reg[i]);
+	}
+	for(uint c=0; c<16; c++)
+	{
+		for(uint i=0; i<np; i++)
+		{
+			parity[c * np + i] = out[i][c];
+		}
+	}
+}
+#endif
+
+/* Makes parity bytes of count codewords, codeword c has n data bytes at data + c * stride, its parity goes to parity + c * nparity */
+static void rs_parity_block(const RsCode *rs, const uint8_t *data, size_t stride, size_t n, uint count, uint8_t *parity)
+{
+	uint c = 0;
+#ifdef __SSSE3__
+	for(; c + 16 <= count; c += 16)
+	{
+		rs_parity_x16(rs, data + c * stride, stride, n, parity + c * rs->nparity);
+	}
+#endif
+	for(; c < count; c++)
+	{
+		rs_parity(rs, data + c * stride, n, parity + c * rs->nparity);
+	}
+}
+
+/* Corrects codeword of n bytes in place, parity is made from its data bytes, returns no. of corrected bytes (-1 => too many errors) */
+static int rs_correct(const RsCode *rs, uint8_t *cw, size_t n, const uint8_t *parity)
+{
+	uint np = rs->nparity;
+	uint8_t rem[RS_MAX_PARITY], syn[RS_MAX_PARITY], omega[RS_MAX_PARITY];
+	uint8_t lambda[RS_MAX_PARITY + 1] = { 1 }, prev[RS_MAX_PARITY + 1] = { 1 }, tmp[RS_MAX_PARITY + 1];
+
+	// if => parity of data bytes is same as parity bytes, then codeword has no error.
+	uint8_t diff = 0;
+	for(uint i=0; i<np; i++)
+	{
+		rem[i] = parity[i] ^ cw[n - np + i];
+		diff |= rem[i];
+	}
+	if(diff == 0)
+	{
+		return 0;
+	}
+
+	// syndromes are remainder (codeword mod generator) at roots of generator.
+	for(uint j=0; j<np; j++)
+	{
+		uint8_t s = 0;
+		for(uint i=0; i<np; i++)
+		{
+			s = gf_mul(s, gf_exp[j]) ^ rem[i];
+		}
+		syn[j] = s;
+	}
+
+	// Berlekamp-Massey : shortest shift register (error locator lambda) which makes syndromes.
+	uint len = 0, shift = 1;
+	uint8_t last = 1;
+	for(uint r=0; r<np; r++)
+	{
+		uint8_t d = syn[r];
+		for(uint i=1; i<=len; i++)
+		{
+			d ^= gf_mul(lambda[i], syn[r - i]);
+		}
+		if(d == 0)
+		{
+			shift++;
+			continue;
+		}
+		uint8_t coef = gf_div(d, last);
+		memcpy(tmp, lambda, sizeof(tmp));
+		for(uint i=0; i + shift <= np; i++)
+		{
+			lambda[i + shift] ^= gf_mul(coef, prev[i]);
+		}
+		if(2 * len <= r)
+		{
+			len = r + 1 - len;
+			memcpy(prev, tmp, sizeof(prev));
+			last = d;
+			shift = 1;
+		}
+		else
+		{
+			shift++;
+		}
+	}
+	if(2 * len > np)
+	{
+		return -1;
+	}
+
+	// error evaluator omega = syndromes * lambda mod x^np.
+	for(uint k=0; k<np; k++)
+	{
+		omega[k] = 0;
+		for(uint i=0; i<=k && i<=len; i++)
+		{
+			omega[k] ^= gf_mul(lambda[i], syn[k - i]);
+		}
+	}
+
+	// Chien search : byte idx is coefficient of x^(n-1-idx), it is wrong if lambda is 0 at alpha^-(n-1-idx).
+	int count = 0;
+	for(size_t idx=0; idx<n; idx++)
+	{
+		uint inv = (255 - (n - 1 - idx)) % 255;
+		uint8_t v = 0, om = 0, dv = 0;
+		for(uint i=0; i<=len; i++)
+		{
+			if(lambda[i] != 0)
+			{
+				v ^= gf_exp[(gf_log[lambda[i]] + i * inv) % 255];
+			}
+		}
+		if(v != 0)
+		{
+			continue;
+		}
+
+		// Forney : error value is X * omega(X^-1) / lambda'(X^-1), lambda' has only odd terms in GF(2^8).
+		for(uint i=0; i<np; i++)
+		{
+			if(omega[i] != 0)
+			{
+				om ^= gf_exp[(gf_log[omega[i]] + i * inv) % 255];
+			}
+		}
+		for(uint i=1; i<=len; i+=2)
+		{
+			if(lambda[i] != 0)
+			{
+				dv ^= gf_exp[(gf_log[lambda[i]] + (i - 1) * inv) % 255];
+			}
+		}
+		if(dv == 0)
+		{
+			return -1;
+		}
+		cw[idx] ^= gf_mul(gf_exp[(n - 1 - idx) % 255], gf_div(om, dv));
+		count++;
+	}
+
+	// if => roots are not as many as degree of lambda, or codeword is still wrong, then errors are too many.
+	if(count != (int)len)
+	{
+		return -1;
+	}
+	rs_parity(rs, cw, n - np, rem);
+	if(memcmp(rem, cw + n - np, np) != 0)
+	{
+		return -1;
+	}
+	return count;
+}
+
+
+
+/* Encode len data bytes as codewords into out, returns no. of bytes of out */
+size_t rs_encode(const RsCode *rs, const uint8_t *data, size_t len, uint8_t *out)
+{
+	uint8_t parity[RS_BLOCK_CODEWORDS * RS_MAX_PARITY];
+	uint np = rs->nparity;
+	size_t o = 0;
+
+	// full codewords are done RS_BLOCK_CODEWORDS at a time, and last shortened one alone.
+	for(size_t done=0; done<len; )
+	{
+		size_t count = (len - done) / rs->ndata;
+		size_t n = rs->ndata;
+		if(count > RS_BLOCK_CODEWORDS)
+		{
+			count = RS_BLOCK_CODEWORDS;
+		}
+		if(count == 0)
+		{
+			count = 1;
+			n = len - done;
+		}
+		rs_parity_block(rs, data + done, n, n, count, parity);
+		for(uint c=0; c<count; c++)
+		{
+			memcpy(out + o, data + done + c * n, n);
+			memcpy(out + o + n, parity + c * np, np);
+			o += n + np;
+		}
+		done += count * n;
+	}
+	return o;
+}
+
+
+
+/* Decode codewords of code_len bytes into data, wrong bytes are corrected and counted in corrected */
+Status rs_decode(const RsCode *rs, const uint8_t *code, size_t code_len, uint8_t *data, uint64_t *corrected)
+{
+	uint8_t parity[RS_BLOCK_CODEWORDS * RS_MAX_PARITY];
+	uint8_t cw[RS_CODEWORD_SIZE];
+	uint np = rs->nparity;
+	size_t o = 0;
+
+	// parity of data bytes is made again RS_BLOCK_CODEWORDS codewords at a time, only codewords where it differs are corrected.
+	for(size_t done=0; done<code_len; )
+	{
+		size_t count = (code_len - done) / RS_CODEWORD_SIZE;
+		size_t n = RS_CODEWORD_SIZE;
+		if(count > RS_BLOCK_CODEWORDS)
+		{
+			count = RS_BLOCK_CODEWORDS;
+		}
+		if(count == 0)
+		{
+			count = 1;
+			n = code_len - done;
+		}
+		if(n <= np)
+		{
+			return e_failure;
+		}
+		rs_parity_block(rs, code + done, n, n - np, count, parity);
+		for(uint c=0; c<count; c++)
+		{
+			memcpy(cw, code + done + c * n, n);
+			int r = rs_correct(rs, cw, n, parity + c * np);
+			if(r < 0)
+			{
+				return e_failure;
+			}
+			*corrected += r;
+			memcpy(data + o, cw, n - np);
+			o += n - np;
+		}
+		done += count * n;
+	}
+	return e_success;
+}
@@ -0,0 +1,68 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Reed-Solomon Error Correction
+ *
+ *                              -> With --ecc=<n>, secret data is encoded as RS(255, 255 - n) codewords over GF(2^8) before LSB encoding,
+ *                                 each codeword is 255 - n data bytes followed by n parity bytes (last codeword is shortened).
+ *                              -> Up to n / 2 wrong bytes of each codeword are corrected while decoding, so a few flipped LSBs
+ *                                 (pixels touched by other tools) don't corrupt decoded secret file.
+ *                              -> Header has FLAG_ECC and n, secret file size field is still size of secret file (without parity).
+ *                              -> Multiply is done with log/antilog tables, and parity with a table of feedback byte times generator
+ *                                 polynomial, so each data byte is one table row XORed into parity register.
+ *                              -> With SSSE3, parity of 16 codewords is made at once with split nibble pshufb tables (one lane per codeword).
+ */
+
+
+
+
+#ifndef RS_H
+#define RS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+
+/* Codeword size, data and parity bytes */
+#define RS_CODEWORD_SIZE 255
+
+/* Minimum and maximum no. of parity bytes of a codeword (--ecc=2..64) */
+#define RS_MIN_PARITY 2
+#define RS_MAX_PARITY 64
+
+/* Codewords encoded/decoded at a time, so a block of them fits in SECRET_BLOCK_SIZE */
+#define RS_BLOCK_CODEWORDS 16
+
+/*
+ * Structure to store a Reed-Solomon code,
+ * generator polynomial and its feedback table
+ */
+
+typedef struct _RsCode
+{
+    uint nparity;				// => no. of parity bytes of a codeword
+    uint ndata;					// => no. of data bytes of a full codeword
+    uint8_t gen[RS_MAX_PARITY + 1];		// => generator polynomial, highest degree first (gen[0] is 1)
+    uint64_t feedback[256][RS_MAX_PARITY / 8];	// => byte i of feedback[f] is f * gen[i + 1], one row per parity register step
+    uint8_t nibble[RS_MAX_PARITY][2][16];	// => gen[i + 1] times low nibble x and times high nibble x << 4 (SSSE3 pshufb tables)
+
+} RsCode;
+
+
+/* Reed-Solomon function prototypes */
+
+/* Make code with nparity parity bytes per codeword */
+void rs_init(RsCode *rs, uint nparity);
+
+/* Get size of size data bytes encoded as codewords */
+uint64_t rs_encoded_size(uint64_t size, uint nparity);
+
+/* Encode len data bytes as codewords into out, returns no. of bytes of out */
+size_t rs_encode(const RsCode *rs, const uint8_t *data, size_t len, uint8_t *out);
+
+/* Decode codewords of code_len bytes into data, wrong bytes are corrected and counted in corrected */
+Status rs_decode(const RsCode *rs, const uint8_t *code, size_t code_len, uint8_t *data, uint64_t *corrected);
+
+#endif
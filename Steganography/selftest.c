@@ -0,0 +1,1239 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Differential Self-test of Encoding and Decoding Paths
+ *
+ *                              -> ./a.out --selftest[=<rounds>] checks every optimized path against a bit by bit reference made with
+ *                                 encode_byte_to_lsb() and decode_char_bytes_from_lsb(), on random carriers and payloads.
+ *                              -> Kernels : LSB embed/extract/verify/count of each pixel format and channel mask at random bit positions and
+ *                                 lengths (SWAR and SSSE3 builds), and Reed-Solomon parity (table and SSSE3) and correction.
+ *                              -> Files : random 24 bpp (with row padding), 32 bpp and 16 bpp carriers and secret files (odd sizes,
+ *                                 exactly full capacity, one byte too big) are encoded with stdio, --verify, pipeline, streamed secret,
+ *                                 batch thread pool and io_uring, --channels and --ecc, and outputs should be byte-identical to reference.
+ *                              -> Reference image is decoded with stdio, pipeline, plane cache, push decoder (random chunk sizes), batch and
+ *                                 through .png, and decoded secret file should be same as original, image with old header is decoded too.
+ *                              -> Random seed is printed, and taken from STEGO_SELFTEST_SEED if set, so a failed round can be run again.
+ *                              -> Files of a failed round are kept in temp dir for inspection, else temp dir is removed.
+ */
+
+
+
+
+#define _GNU_SOURCE		// nftw()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include "selftest.h"
+#include "encode.h"
+#include "decode.h"
+#include "batch.h"
+#include "pushdec.h"
+#include "stego.h"
+#include "lsb.h"
+#include "rs.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/* Max. length of a file name in temp dir, and of its path */
+#define SELFTEST_NAME_SIZE 32
+#define SELFTEST_PATH_SIZE (sizeof(SELFTEST_DIR_TEMPLATE) + SELFTEST_NAME_SIZE)
+
+/* Random state (xorshift64*) */
+static uint64_t selftest_state;
+
+/* Temp dir of this run */
+static char selftest_dir[sizeof(SELFTEST_DIR_TEMPLATE)];
+
+/* Options every variant starts from (user options of encoding turned off) */
+static Options selftest_base;
+
+/* No. of checks passed */
+static uint64_t selftest_checks;
+
+/* Reed-Solomon code of RS checks and --ecc reference */
+static RsCode selftest_rs;
+
+/* Secret data collected from push decoder */
+typedef struct _SelftestSink
+{
+    const SelftestCase *tc;		// => case being decoded
+    uint8_t *data;			// => decoded secret data
+    uint64_t len;			// => no. of bytes decoded
+
+} SelftestSink;
+
+/* Secret data written to a pipe by writer thread */
+typedef struct _SelftestWriter
+{
+    const char *path;			// => pipe (FIFO) path
+    const uint8_t *data;		// => secret data
+    uint64_t len;			// => secret data size
+    uint64_t seed;			// => random chunk sizes of writes
+    int done;				// => 1 once all data is written and pipe is closed
+
+} SelftestWriter;
+
+/* Function Definitions */
+
+/* Next random number */
+static uint64_t selftest_rand(void)
+{
+	selftest_state ^= selftest_state >> 12;
+	selftest_state ^= selftest_state << 25;
+	selftest_state ^= selftest_state >> 27;
+	return selftest_state * 0x2545F4914F6CDD1Dull;
+}
+
+/* Random number below n (n > 0) */
+static uint64_t selftest_below(uint64_t n)
+{
+	return selftest_rand() % n;
+}
+
+/* Fills buffer with random bytes */
+static void selftest_fill(uint8_t *buf, size_t len)
+{
+	for(size_t i=0; i<len; i++)
+	{
+		buf[i] = selftest_rand() >> 56;
+	}
+}
+
+/* Gets path of name in temp dir */
+static char *selftest_path(char *path, const char *name)
+{
+	snprintf(path, SELFTEST_PATH_SIZE, "%s/%s", selftest_dir, name);
+	return path;
+}
+
+/* Name of pixel format */
+static const char *selftest_format_name(PixelFormat format)
+{
+	return (format == e_bgra32) ? "32 bpp" : (format == e_rgb16) ? "16 bpp" : "24 bpp";
+}
+
+
+
+/*
+ * Reference implementation
+ *
+ * Layout is taken from BMP pixels, not from lsb.c : 24 bpp pixels are 3 carrier bytes (row padding too), 32 bpp pixels
+ * are blue, green, red carriers and alpha, 16 bpp pixels have only low byte as carrier, channel mask picks bytes of pixel.
+ * Each payload byte is encoded with encode_byte_to_lsb() and decoded with decode_char_bytes_from_lsb(), as before kernels.
+ */
+
+/* Reference offset of carrier byte of payload bit from carrier of bit 0 */
+static uint64_t ref_offset(PixelFormat format, uint mask, uint64_t bit)
+{
+	uint stride = (format == e_bgra32) ? 4 : (format == e_rgb16) ? 2 : 3;
+	uint bytes[3], n = 0;
+
+	if(format == e_rgb16)
+	{
+		mask = CHANNEL_BLUE;
+	}
+	else if(mask == 0)
+	{
+		mask = CHANNEL_ALL;
+	}
+	for(uint c=0; c<3; c++)
+	{
+		if((mask >> c) & 1)
+		{
+			bytes[n++] = c;
+		}
+	}
+	return bit / n * stride + bytes[bit % n];
+}
+
+/* Reference encoding of payload bits [bit_pos, bit_pos + nbits), image points to carrier of bit_pos and payload to byte bit_pos / 8 */
+static void ref_embed(PixelFormat format, uint mask, uint8_t *image, const uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	uint64_t base = ref_offset(format, mask, bit_pos);
+
+	for(uint64_t byte = bit_pos / 8; byte * 8 < bit_pos + nbits; byte++)
+	{
+		// carrier bytes of payload byte are gathered, bits out of range get a dummy byte which is not put back.
+		char carriers[8];
+		for(int j=0; j<8; j++)
+		{
+			uint64_t b = byte * 8 + j;
+			carriers[j] = (b >= bit_pos && b < bit_pos + nbits) ? image[ref_offset(format, mask, b) - base] : 0;
+		}
+		encode_byte_to_lsb(payload[byte - bit_pos / 8], carriers, 8);
+		for(int j=0; j<8; j++)
+		{
+			uint64_t b = byte * 8 + j;
+			if(b >= bit_pos && b < bit_pos + nbits)
+			{
+				image[ref_offset(format, mask, b) - base] = carriers[j];
+			}
+		}
+	}
+}
+
+/* Reference decoding of payload bits [bit_pos, bit_pos + nbits), other bits of payload bytes are kept */
+static void ref_extract(PixelFormat format, uint mask, const uint8_t *image, uint8_t *payload, uint64_t bit_pos, size_t nbits)
+{
+	uint64_t base = ref_offset(format, mask, bit_pos);
+
+	for(uint64_t byte = bit_pos / 8; byte * 8 < bit_pos + nbits; byte++)
+	{
+		char carriers[8];
+		for(int j=0; j<8; j++)
+		{
+			uint64_t b = byte * 8 + j;
+			carriers[j] = (b >= bit_pos && b < bit_pos + nbits) ? image[ref_offset(format, mask, b) - base] : 0;
+		}
+		uint8_t ch = decode_char_bytes_from_lsb(carriers);
+		for(int j=0; j<8; j++)
+		{
+			uint64_t b = byte * 8 + j;
+			if(b >= bit_pos && b < bit_pos + nbits)
+			{
+				uint8_t m = 0x80 >> j;
+				payload[byte - bit_pos / 8] = (payload[byte - bit_pos / 8] & ~m) | (ch & m);
+			}
+		}
+	}
+}
+
+/* Reference multiply of GF(2^8), shift and add with polynomial 0x11d */
+static uint8_t ref_gf_mul(uint8_t a, uint8_t b)
+{
+	uint8_t p = 0;
+	while(b)
+	{
+		if(b & 1)
+		{
+			p ^= a;
+		}
+		a = (a << 1) ^ ((a & 0x80) ? 0x1d : 0);
+		b >>= 1;
+	}
+	return p;
+}
+
+/* Reference Reed-Solomon encoding, each codeword is data and remainder of data * x^n divided by generator (one byte at a time) */
+static size_t ref_rs_encode(const RsCode *rs, const uint8_t *data, size_t len, uint8_t *out)
+{
+	size_t o = 0;
+	for(size_t done=0; done<len; )
+	{
+		size_t n = (len - done < rs->ndata) ? len - done : rs->ndata;
+		uint8_t reg[RS_MAX_PARITY] = { 0 };
+		for(size_t i=0; i<n; i++)
+		{
+			uint8_t f = data[done + i] ^ reg[0];
+			for(uint j=0; j + 1<rs->nparity; j++)
+			{
+				reg[j] = reg[j + 1] ^ ref_gf_mul(f, rs->gen[j + 1]);
+			}
+			reg[rs->nparity - 1] = ref_gf_mul(f, rs->gen[rs->nparity]);
+		}
+		memcpy(out + o, data + done, n);
+		memcpy(out + o + n, reg, rs->nparity);
+		o += n + rs->nparity;
+		done += n;
+	}
+	return o;
+}
+
+/* Stores 32-bit value msb first, as header fields */
+static void ref_put32(uint8_t *p, uint32_t v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+/* Stores reference varint : 7 bits per byte, low bits first, 0x80 on all bytes but last, padded with 0x80 bytes to size bytes */
+static uint ref_put_varint(uint8_t *p, uint64_t v, uint size)
+{
+	uint n = 0;
+	do
+	{
+		p[n] = v % 128;
+		v /= 128;
+		if(v != 0 || n + 1 < size)
+		{
+			p[n] += 128;
+		}
+		n++;
+	} while(v != 0 || n < size);
+	return n;
+}
+
+/* Reference header of case : magic, version, flags, mask and parity (if flags), extension size, extension and size */
+static uint ref_header(const SelftestCase *tc, uint8_t *header)
+{
+	uint n = 0;
+	uint extn_size = strlen(tc->extn);
+
+	// version 2 : flags, extension size and size are varints, streamed secret file has 10 byte size to patch.
+	if(tc->version == HEADER_VERSION)
+	{
+		memcpy(header, MAGIC_STRING_EXT, 2);
+		n += 2;
+		header[n++] = HEADER_VERSION;
+		n += ref_put_varint(header + n, tc->flags, 1);
+		if(tc->flags & FLAG_CHANNELS)
+		{
+			header[n++] = tc->channel_mask;
+		}
+		if(tc->flags & FLAG_ECC)
+		{
+			header[n++] = tc->ecc_parity;
+		}
+		n += ref_put_varint(header + n, extn_size, 1);
+		memcpy(header + n, tc->extn, extn_size);
+		n += extn_size;
+		n += ref_put_varint(header + n, tc->secret_size, tc->streamed ? VARINT_MAX_SIZE : 1);
+		return n;
+	}
+
+	// version 1 : "#*" header if no flags, 32-bit fields.
+	memcpy(header, (tc->flags != 0) ? MAGIC_STRING_EXT : MAGIC_STRING, 2);
+	n += 2;
+	if(tc->flags != 0)
+	{
+		header[n++] = HEADER_VERSION_FIXED;
+		header[n++] = tc->flags;
+		if(tc->flags & FLAG_CHANNELS)
+		{
+			header[n++] = tc->channel_mask;
+		}
+		if(tc->flags & FLAG_ECC)
+		{
+			header[n++] = tc->ecc_parity;
+		}
+	}
+	ref_put32(header + n, extn_size);
+	n += 4;
+	memcpy(header + n, tc->extn, extn_size);
+	n += extn_size;
+
+	// streamed secret file has marker and 64-bit size, since size is not known when header is encoded.
+	if(tc->streamed)
+	{
+		ref_put32(header + n, SIZE_FIELD_EXTENDED);
+		ref_put32(header + n + 4, (uint32_t)(tc->secret_size >> 32));
+		ref_put32(header + n + 8, (uint32_t)tc->secret_size);
+		n += 12;
+	}
+	else
+	{
+		ref_put32(header + n, (uint32_t)tc->secret_size);
+		n += 4;
+	}
+	return n;
+}
+
+/* Gets first byte of pixel which has secret data with channel mask, relative to data offset (first pixel after header) */
+static uint64_t ref_channel_start(const SelftestCase *tc, uint header_size)
+{
+	uint64_t pixel = (tc->format == e_bgra32) ? 4 : 3;
+	return (ref_offset(tc->format, 0, (uint64_t)header_size * 8) + pixel - 1) / pixel * pixel;
+}
+
+/* Gets no. of bytes of pixel data which are carriers of case (last carrier + 1), relative to data offset */
+static uint64_t ref_payload_end(const SelftestCase *tc, uint header_size, uint64_t data_size)
+{
+	if(tc->flags & FLAG_CHANNELS)
+	{
+		return ref_channel_start(tc, header_size) + ref_offset(tc->format, tc->channel_mask, data_size * 8 - 1) + 1;
+	}
+	return ref_offset(tc->format, 0, ((uint64_t)header_size + data_size) * 8 - 1) + 1;
+}
+
+/* Makes reference stego image of case (NULL => out of memory) */
+static uint8_t *ref_stego(const SelftestCase *tc)
+{
+	uint8_t header[STEGO_HEADER_MAX + 2];
+	uint header_size = ref_header(tc, header);
+	uint64_t data_size = (tc->flags & FLAG_ECC) ? rs_encoded_size(tc->secret_size, tc->ecc_parity) : tc->secret_size;
+	uint8_t *image = malloc(tc->file_size);
+	uint8_t *payload = malloc(header_size + data_size);
+
+	if(image == NULL || payload == NULL)
+	{
+		free(image);
+		free(payload);
+		return NULL;
+	}
+	memcpy(image, tc->carrier, tc->file_size);
+	memcpy(payload, header, header_size);
+	if(tc->flags & FLAG_ECC)
+	{
+		rs_init(&selftest_rs, tc->ecc_parity);
+		ref_rs_encode(&selftest_rs, tc->secret, tc->secret_size, payload + header_size);
+	}
+	else
+	{
+		memcpy(payload + header_size, tc->secret, tc->secret_size);
+	}
+
+	// header is always in default layout, secret data with channel mask starts at next pixel.
+	uint8_t *pixels = image + BMP_HEADER_SIZE;
+	if(tc->flags & FLAG_CHANNELS)
+	{
+		// image given to ref_embed() is carrier of first bit, which is not first byte of pixel if blue is not in mask.
+		uint64_t start = ref_channel_start(tc, header_size) + ref_offset(tc->format, tc->channel_mask, 0);
+		ref_embed(tc->format, 0, pixels, payload, 0, (size_t)header_size * 8);
+		ref_embed(tc->format, tc->channel_mask, pixels + start, payload + header_size, 0, data_size * 8);
+	}
+	else
+	{
+		ref_embed(tc->format, 0, pixels, payload, 0, (header_size + data_size) * 8);
+	}
+	free(payload);
+	return image;
+}
+
+
+
+/* Reports kernel result which differs from reference */
+static Status selftest_kernel_fail(const char *kernel, PixelFormat format, uint mask, uint64_t bit_pos, size_t nbits)
+{
+	printf("ERROR: Self-test %s differs from reference (%s, channel mask %u, bit %llu, %zu bits)\n", kernel, selftest_format_name(format), mask, (unsigned long long)bit_pos, nbits);
+	return e_failure;
+}
+
+/* Checks LSB kernels of every pixel format and channel mask against reference at random bit position and length */
+static Status selftest_kernels(void)
+{
+	static uint8_t image[4 * SELFTEST_KERNEL_BITS + 2 * SELFTEST_GUARD], expect[sizeof(image)], work[sizeof(image)];
+	// payload bytes have 8 bytes before them, as lsb_embed_bits() and lsb_extract_bits() index payload from bit 0 (not bit_pos).
+	static uint8_t payload_buf[8 + SELFTEST_KERNEL_BITS / 8 + 2], got_buf[sizeof(payload_buf)], want_buf[sizeof(payload_buf)];
+	uint8_t *payload = payload_buf + 8, *got = got_buf + 8, *want = want_buf + 8;
+	const PixelFormat formats[3] = { e_bgr24, e_bgra32, e_rgb16 };
+
+	for(int f=0; f<3; f++)
+	{
+		PixelFormat format = formats[f];
+		// 16 bpp has one carrier byte per pixel, so it has only default mask.
+		for(uint mask=0; mask <= ((format == e_rgb16) ? 0 : CHANNEL_ALL); mask++)
+		{
+			uint64_t bit_pos = selftest_below(64);
+			size_t nbits = selftest_below(SELFTEST_KERNEL_BITS - 64);
+			size_t nbytes = (bit_pos + nbits + 7) / 8 - bit_pos / 8;
+			uint64_t base = ref_offset(format, mask, bit_pos);
+
+			// embed : bytes before and after carriers, and bytes between them, should stay same.
+			selftest_fill(image, sizeof(image));
+			selftest_fill(payload, nbytes);
+			memcpy(expect, image, sizeof(image));
+			ref_embed(format, mask, expect + SELFTEST_GUARD, payload, bit_pos, nbits);
+			memcpy(work, image, sizeof(image));
+			lsb_embed_channels(format, mask, work + SELFTEST_GUARD, payload, bit_pos, nbits);
+			if(memcmp(work, expect, sizeof(image)) != 0)
+			{
+				return selftest_kernel_fail("lsb_embed_channels", format, mask, bit_pos, nbits);
+			}
+			if(format == e_bgr24 && mask == 0)
+			{
+				memcpy(work, image, sizeof(image));
+				lsb_embed_bits(work + SELFTEST_GUARD, payload - bit_pos / 8, bit_pos, nbits);
+				if(memcmp(work, expect, sizeof(image)) != 0)
+				{
+					return selftest_kernel_fail("lsb_embed_bits", format, mask, bit_pos, nbits);
+				}
+			}
+
+			// verify : encoded bits match, and one flipped carrier is found.
+			if(!lsb_verify_channels(format, mask, expect + SELFTEST_GUARD, payload, bit_pos, nbits))
+			{
+				return selftest_kernel_fail("lsb_verify_channels", format, mask, bit_pos, nbits);
+			}
+			if(nbits > 0)
+			{
+				uint64_t b = bit_pos + selftest_below(nbits);
+				expect[SELFTEST_GUARD + ref_offset(format, mask, b) - base] ^= 1;
+				if(lsb_verify_channels(format, mask, expect + SELFTEST_GUARD, payload, bit_pos, nbits))
+				{
+					return selftest_kernel_fail("lsb_verify_channels (flipped bit)", format, mask, bit_pos, nbits);
+				}
+			}
+
+			// extract : bits of first and last payload byte out of range should stay same.
+			selftest_fill(got, nbytes);
+			memcpy(want, got, nbytes);
+			ref_extract(format, mask, image + SELFTEST_GUARD, want, bit_pos, nbits);
+			lsb_extract_channels(format, mask, image + SELFTEST_GUARD, got, bit_pos, nbits);
+			if(memcmp(got, want, nbytes) != 0)
+			{
+				return selftest_kernel_fail("lsb_extract_channels", format, mask, bit_pos, nbits);
+			}
+			if(format == e_bgr24 && mask == 0)
+			{
+				memcpy(got, payload, nbytes);
+				memcpy(want, payload, nbytes);
+				ref_extract(format, mask, image + SELFTEST_GUARD, want, bit_pos, nbits);
+				lsb_extract_bits(image + SELFTEST_GUARD, got - bit_pos / 8, bit_pos, nbits);
+				if(memcmp(got, want, nbytes) != 0)
+				{
+					return selftest_kernel_fail("lsb_extract_bits", format, mask, bit_pos, nbits);
+				}
+			}
+
+			// count : carriers whose LSB differs from payload bit.
+			uint64_t flips = 0;
+			for(uint64_t b = bit_pos; b < bit_pos + nbits; b++)
+			{
+				uint bit = (payload[b / 8 - bit_pos / 8] >> (7 - b % 8)) & 1;
+				flips += ((image[SELFTEST_GUARD + ref_offset(format, mask, b) - base] & 1) != bit);
+			}
+			if(lsb_count_flips(format, mask, image + SELFTEST_GUARD, payload, bit_pos, nbits) != flips)
+			{
+				return selftest_kernel_fail("lsb_count_flips", format, mask, bit_pos, nbits);
+			}
+			selftest_checks += 4;
+		}
+	}
+	return e_success;
+}
+
+
+
+/* Checks Reed-Solomon encoding against reference, and decoding of codewords with up to n / 2 wrong bytes each */
+static Status selftest_rs_code(void)
+{
+	static uint8_t data[RS_BLOCK_CODEWORDS * 2 * RS_CODEWORD_SIZE + 300], back[sizeof(data)];
+	static uint8_t code[2 * sizeof(data)], expect[sizeof(code)];
+	uint nparity = RS_MIN_PARITY + selftest_below(RS_MAX_PARITY - RS_MIN_PARITY + 1);
+	size_t len = 1 + selftest_below(sizeof(data));
+	uint64_t corrected;
+
+	rs_init(&selftest_rs, nparity);
+	selftest_fill(data, len);
+	size_t code_len = rs_encode(&selftest_rs, data, len, code);
+	if(code_len != rs_encoded_size(len, nparity) || ref_rs_encode(&selftest_rs, data, len, expect) != code_len || memcmp(code, expect, code_len) != 0)
+	{
+		printf("ERROR: Self-test rs_encode differs from reference (%u parity bytes, %zu data bytes)\n", nparity, len);
+		return e_failure;
+	}
+
+	// each codeword gets up to n / 2 wrong bytes (same byte can be picked twice, so maybe fewer).
+	for(size_t off=0; off<code_len; off += selftest_rs.ndata + nparity)
+	{
+		size_t cw_len = (code_len - off < selftest_rs.ndata + nparity) ? code_len - off : selftest_rs.ndata + nparity;
+		for(uint64_t e = selftest_below(nparity / 2 + 1); e > 0; e--)
+		{
+			code[off + selftest_below(cw_len)] ^= 1 + selftest_below(255);
+		}
+	}
+	if(rs_decode(&selftest_rs, code, code_len, back, &corrected) == e_failure || memcmp(back, data, len) != 0)
+	{
+		printf("ERROR: Self-test rs_decode didn't correct codewords (%u parity bytes, %zu data bytes)\n", nparity, len);
+		return e_failure;
+	}
+	selftest_checks += 2;
+	return e_success;
+}
+
+
+
+/* Writes buffer to file in temp dir */
+static Status selftest_write_file(const char *name, const uint8_t *data, uint64_t len)
+{
+	char path[SELFTEST_PATH_SIZE];
+	FILE *fptr = fopen(selftest_path(path, name), "wb");
+	if(fptr == NULL)
+	{
+		perror("fopen");
+		printf("ERROR: Unable to open file %s\n", path);
+		return e_failure;
+	}
+	Status ret = (len == 0 || fwrite(data, len, 1, fptr) == 1) ? e_success : e_failure;
+	if(fclose(fptr) != 0 || ret == e_failure)
+	{
+		printf("ERROR: Unable to write file %s\n", path);
+		return e_failure;
+	}
+	return e_success;
+}
+
+/* Checks file in temp dir is same as expected bytes, and removes it if it is */
+static Status selftest_check_file(const char *variant, const char *name, const uint8_t *expect, uint64_t len)
+{
+	char path[SELFTEST_PATH_SIZE];
+	uint8_t block[COPY_BLOCK_SIZE];
+	uint64_t off = 0;
+	size_t n;
+
+	FILE *fptr = fopen(selftest_path(path, name), "rb");
+	if(fptr == NULL)
+	{
+		printf("ERROR: Self-test %s : output %s is missing\n", variant, path);
+		return e_failure;
+	}
+	while((n = fread(block, 1, sizeof(block), fptr)) > 0)
+	{
+		for(size_t i=0; i<n; i++)
+		{
+			if(off + i >= len || block[i] != expect[off + i])
+			{
+				printf("ERROR: Self-test %s : %s differs from reference at byte %llu\n", variant, path, (unsigned long long)(off + i));
+				fclose(fptr);
+				return e_failure;
+			}
+		}
+		off += n;
+	}
+	fclose(fptr);
+	if(off != len)
+	{
+		printf("ERROR: Self-test %s : %s is %llu bytes, reference is %llu bytes\n", variant, path, (unsigned long long)off, (unsigned long long)len);
+		return e_failure;
+	}
+	remove(path);
+	selftest_checks++;
+	return e_success;
+}
+
+
+
+/* Runs ./a.out -e image secret output in this process, messages are not printed if silent (failure is expected) */
+static Status selftest_encode(const char *image, const char *secret, const char *output, int silent)
+{
+	char path[3][SELFTEST_PATH_SIZE];
+	char *argv[] = { "selftest", "-e", selftest_path(path[0], image), selftest_path(path[1], secret), selftest_path(path[2], output), NULL };
+	EncodeInfo encInfo;
+	int saved_stdout = -1;
+
+	memset(&encInfo, 0, sizeof(encInfo));
+	fflush(stdout);
+	if(silent && (saved_stdout = dup(STDOUT_FILENO)) != -1)
+	{
+		int null_fd = open("/dev/null", O_WRONLY);
+		dup2(null_fd, STDOUT_FILENO);
+		close(null_fd);
+	}
+
+	Status ret = (read_and_validate_encode_args(argv, &encInfo) == e_success) ? do_encoding(argv, &encInfo) : e_failure;
+
+	fflush(stdout);
+	if(saved_stdout != -1)
+	{
+		dup2(saved_stdout, STDOUT_FILENO);
+		close(saved_stdout);
+	}
+	return ret;
+}
+
+/* Runs ./a.out -d image output in this process */
+static Status selftest_decode(const char *image, const char *output)
+{
+	char path[2][SELFTEST_PATH_SIZE];
+	char *argv[] = { "selftest", "-d", selftest_path(path[0], image), selftest_path(path[1], output), NULL };
+	DecodeInfo decInfo;
+
+	memset(&decInfo, 0, sizeof(decInfo));
+	return (read_and_validate_decode_args(argv, &decInfo) == e_success) ? do_decoding(argv, &decInfo) : e_failure;
+}
+
+/* Encodes with current options, output should be same as reference, or encoding should fail if secret file is too big */
+static Status selftest_encode_check(const char *variant, const SelftestCase *tc, const char *secret, const uint8_t *ref, int too_big)
+{
+	char output[SELFTEST_PATH_SIZE];
+	Status ret = selftest_encode("carrier.bmp", secret, "output.bmp", too_big);
+
+	if(too_big)
+	{
+		remove(selftest_path(output, "output.bmp"));
+		if(ret == e_success)
+		{
+			printf("ERROR: Self-test %s encoded a secret file bigger than capacity\n", variant);
+			return e_failure;
+		}
+		selftest_checks++;
+		return e_success;
+	}
+	if(ret == e_failure)
+	{
+		printf("ERROR: Self-test %s : encoding failed\n", variant);
+		return e_failure;
+	}
+	return selftest_check_file(variant, "output.bmp", ref, tc->file_size);
+}
+
+/* Decodes image with current options, decoded secret file should be same as secret file of case */
+static Status selftest_decode_check(const char *variant, const SelftestCase *tc, const char *image)
+{
+	char name[SELFTEST_NAME_SIZE];
+	if(selftest_decode(image, "decoded") == e_failure)
+	{
+		printf("ERROR: Self-test %s : decoding failed\n", variant);
+		return e_failure;
+	}
+	snprintf(name, sizeof(name), "decoded%s", tc->extn);
+	return selftest_check_file(variant, name, tc->secret, tc->secret_size);
+}
+
+
+
+/* Push decoder header callback, header should have extension and size of case */
+static Status selftest_on_header(void *ctx, const StegoHeader *hdr)
+{
+	SelftestSink *sink = ctx;
+	return (hdr->data_size == sink->tc->secret_size && strcmp(hdr->extn, sink->tc->extn) == 0) ? e_success : e_failure;
+}
+
+/* Push decoder data callback, data is collected in sink */
+static Status selftest_on_data(void *ctx, const uint8_t *data, size_t len)
+{
+	SelftestSink *sink = ctx;
+	if(sink->len + len > sink->tc->secret_size)
+	{
+		return e_failure;
+	}
+	memcpy(sink->data + sink->len, data, len);
+	sink->len += len;
+	return e_success;
+}
+
+/* Feeds reference image to push decoder in random chunks (some of few bytes, so payload bytes are split between chunks) */
+static Status selftest_push_check(const SelftestCase *tc, const uint8_t *ref)
+{
+	SelftestSink sink = { tc, malloc(tc->secret_size), 0 };
+	PushDecoder pd;
+	Status ret = (sink.data != NULL) ? e_success : e_failure;
+
+	push_init(&pd, selftest_on_header, selftest_on_data, &sink);
+	for(uint64_t off = 0; off < tc->file_size && ret == e_success; )
+	{
+		uint64_t n = (selftest_below(4) == 0) ? 1 + selftest_below(16) : 1 + selftest_below(70000);
+		if(n > tc->file_size - off)
+		{
+			n = tc->file_size - off;
+		}
+		ret = push_feed(&pd, ref + off, n);
+		off += n;
+	}
+	if(ret == e_failure || pd.state != e_push_done || sink.len != tc->secret_size || memcmp(sink.data, tc->secret, sink.len) != 0)
+	{
+		printf("ERROR: Self-test push decoder : decoded secret data differs from secret file\n");
+		free(sink.data);
+		return e_failure;
+	}
+	free(sink.data);
+	selftest_checks++;
+	return e_success;
+}
+
+
+
+/* Writer thread of streamed secret, writes secret data to pipe in random chunks and closes it */
+static void *selftest_writer(void *arg)
+{
+	SelftestWriter *w = arg;
+	uint64_t state = w->seed | 1;
+
+	// open waits for reader, so data is not lost before encoder opens pipe (write fails with EPIPE if encoder closes it early).
+	int fd = open(w->path, O_WRONLY);
+	for(uint64_t off = 0; fd != -1 && off < w->len; )
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		size_t n = 1 + state % 9000;
+		if(n > w->len - off)
+		{
+			n = w->len - off;
+		}
+		ssize_t r = write(fd, w->data + off, n);
+		if(r <= 0)
+		{
+			break;
+		}
+		off += r;
+	}
+	if(fd != -1)
+	{
+		close(fd);
+	}
+	__atomic_store_n(&w->done, 1, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+/* Encodes secret data streamed through a pipe (size is patched after data), output should be same as streamed reference */
+static Status selftest_stream_check(const SelftestCase *tc)
+{
+	char fifo[SELFTEST_PATH_SIZE], name[SELFTEST_NAME_SIZE];
+	SelftestCase st = *tc;
+	st.streamed = 1;
+	uint8_t *ref = ref_stego(&st);
+	snprintf(name, sizeof(name), "stream%s", tc->extn);
+	if(ref == NULL || mkfifo(selftest_path(fifo, name), 0600) != 0)
+	{
+		perror("mkfifo");
+		free(ref);
+		return e_failure;
+	}
+
+	SelftestWriter w = { fifo, tc->secret, tc->secret_size, selftest_rand(), 0 };
+	pthread_t writer;
+	void (*saved_sigpipe)(int) = signal(SIGPIPE, SIG_IGN);
+	if(pthread_create(&writer, NULL, selftest_writer, &w) != 0)
+	{
+		signal(SIGPIPE, saved_sigpipe);
+		remove(fifo);
+		free(ref);
+		return e_failure;
+	}
+	Status ret = selftest_encode("carrier.bmp", name, "output.bmp", 0);
+
+	// if => encoding stopped before opening pipe or reading all data, then rest is read here, so writer can finish.
+	int fd = open(fifo, O_RDONLY | O_NONBLOCK);
+	while(!__atomic_load_n(&w.done, __ATOMIC_ACQUIRE))
+	{
+		uint8_t drain[4096];
+		if(fd == -1 || read(fd, drain, sizeof(drain)) <= 0)
+		{
+			sched_yield();
+		}
+	}
+	if(fd != -1)
+	{
+		close(fd);
+	}
+	pthread_join(writer, NULL);
+	signal(SIGPIPE, saved_sigpipe);
+	remove(fifo);
+
+	if(ret == e_failure)
+	{
+		printf("ERROR: Self-test streamed secret : encoding failed\n");
+	}
+	else
+	{
+		ret = selftest_check_file("streamed secret", "output.bmp", ref, tc->file_size);
+	}
+
+	// streamed reference has extended size field, it is decoded with stdio.
+	if(ret == e_success && selftest_write_file("streamed.bmp", ref, tc->file_size) == e_success)
+	{
+		options = selftest_base;
+		ret = selftest_decode_check("stdio decode of streamed", tc, "streamed.bmp");
+	}
+	free(ref);
+	return ret;
+}
+
+/* Runs batch of encode job (and decode job of reference image) with current options */
+static Status selftest_batch_check(const char *variant, const SelftestCase *tc, const char *secret, const uint8_t *ref, int too_big)
+{
+	char path[SELFTEST_PATH_SIZE], line[5 * SELFTEST_PATH_SIZE + 64];
+	char *argv[] = { "selftest", "-b", selftest_path(path, "jobs"), NULL };
+	char carrier[SELFTEST_PATH_SIZE], secret_path[SELFTEST_PATH_SIZE], output[SELFTEST_PATH_SIZE], reference[SELFTEST_PATH_SIZE], decoded[SELFTEST_PATH_SIZE];
+
+	// each job randomly reads and writes with O_DIRECT or through page cache.
+	int len = snprintf(line, sizeof(line), "-e %s %s %s%s\n", selftest_path(carrier, "carrier.bmp"), selftest_path(secret_path, secret), selftest_path(output, "batch.bmp"), selftest_below(2) ? " --direct" : "");
+	if(!too_big)
+	{
+		len += snprintf(line + len, sizeof(line) - len, "-d %s %s%s\n", selftest_path(reference, "reference.bmp"), selftest_path(decoded, "batch_decoded"), selftest_below(2) ? " --direct" : "");
+	}
+	if(selftest_write_file("jobs", (uint8_t *)line, len) == e_failure)
+	{
+		return e_failure;
+	}
+
+	options.threads = 1 + selftest_below(4);
+	int saved_stdout = -1;
+	fflush(stdout);
+	if(too_big && (saved_stdout = dup(STDOUT_FILENO)) != -1)
+	{
+		int null_fd = open("/dev/null", O_WRONLY);
+		dup2(null_fd, STDOUT_FILENO);
+		close(null_fd);
+	}
+	Status ret = do_batch(argv);
+	fflush(stdout);
+	if(saved_stdout != -1)
+	{
+		dup2(saved_stdout, STDOUT_FILENO);
+		close(saved_stdout);
+	}
+	remove(path);
+
+	if(too_big)
+	{
+		remove(output);
+		if(ret == e_success)
+		{
+			printf("ERROR: Self-test %s encoded a secret file bigger than capacity\n", variant);
+			return e_failure;
+		}
+		selftest_checks++;
+		return e_success;
+	}
+	if(ret == e_failure)
+	{
+		printf("ERROR: Self-test %s : batch failed\n", variant);
+		return e_failure;
+	}
+	snprintf(decoded, sizeof(decoded), "batch_decoded%s", tc->extn);
+	if(selftest_check_file(variant, "batch.bmp", ref, tc->file_size) == e_failure || selftest_check_file(variant, decoded, tc->secret, tc->secret_size) == e_failure)
+	{
+		return e_failure;
+	}
+	return e_success;
+}
+
+
+
+/* Decodes image with version 1 header of case ("#*", or "#+" with 32-bit fields if flags) with stdio, and push decoder if no flags */
+static Status selftest_old_check(const SelftestCase *tc)
+{
+	SelftestCase old = *tc;
+	old.version = HEADER_VERSION_FIXED;
+
+	// old header has 32-bit fields, so it may not fit in carrier of full capacity case.
+	uint8_t header[STEGO_HEADER_MAX + 2];
+	if(ref_payload_end(&old, ref_header(&old, header), old.secret_size) > tc->file_size - BMP_HEADER_SIZE)
+	{
+		return e_success;
+	}
+	uint8_t *ref = ref_stego(&old);
+	Status ret = (ref != NULL) ? selftest_write_file("old.bmp", ref, old.file_size) : e_failure;
+	if(ret == e_success)
+	{
+		options = selftest_base;
+		ret = selftest_decode_check("stdio decode of version 1 header", &old, "old.bmp");
+	}
+	if(ret == e_success && old.flags == 0)
+	{
+		ret = selftest_push_check(&old, ref);
+	}
+	free(ref);
+	return ret;
+}
+
+/* Checks all encoders and decoders of plain header with case, too_big => secret file is one byte bigger than capacity */
+static Status selftest_plain(const SelftestCase *tc, const char *secret, int too_big, int can_stream)
+{
+	// secret file bigger than capacity has no reference image, all encoders should fail.
+	uint8_t *ref = too_big ? NULL : ref_stego(tc);
+	Status ret = (too_big || ref != NULL) ? e_success : e_failure;
+
+	if(ret == e_success && !too_big)
+	{
+		ret = selftest_write_file("reference.bmp", ref, tc->file_size);
+	}
+
+	// encoders.
+	if(ret == e_success)
+	{
+		options = selftest_base;
+		ret = selftest_encode_check("stdio", tc, secret, ref, too_big);
+	}
+	if(ret == e_success)
+	{
+		options = selftest_base;
+		options.verify = 1;
+		options.metrics = 1;
+		ret = selftest_encode_check("stdio --verify --metrics", tc, secret, ref, too_big);
+	}
+	if(ret == e_success)
+	{
+		options = selftest_base;
+		options.engine = ENGINE_PIPELINE;
+		ret = selftest_encode_check("pipeline", tc, secret, ref, too_big);
+	}
+	if(ret == e_success && !too_big && can_stream)
+	{
+		ret = selftest_stream_check(tc);
+	}
+	// batch jobs are 24 bpp only.
+	if(ret == e_success && tc->format == e_bgr24)
+	{
+		options = selftest_base;
+		options.io_engine = IO_ENGINE_THREADS;
+		ret = selftest_batch_check("batch thread pool", tc, secret, ref, too_big);
+	}
+#ifdef HAVE_IO_URING
+	if(ret == e_success && tc->format == e_bgr24)
+	{
+		options = selftest_base;
+		options.io_engine = IO_ENGINE_URING;
+		ret = selftest_batch_check("batch io_uring", tc, secret, ref, too_big);
+	}
+#endif
+
+	// decoders of reference image.
+	if(ret == e_success && !too_big)
+	{
+		options = selftest_base;
+		ret = selftest_decode_check("stdio decode", tc, "reference.bmp");
+	}
+	if(ret == e_success && !too_big)
+	{
+		options = selftest_base;
+		options.engine = ENGINE_PIPELINE;
+		ret = selftest_decode_check("pipeline decode", tc, "reference.bmp");
+	}
+	if(ret == e_success && !too_big)
+	{
+		// first decode makes plane, second one decodes from it.
+		char planes[SELFTEST_PATH_SIZE];
+		mkdir(selftest_path(planes, "planes"), 0700);
+		options = selftest_base;
+		options.plane_dir = planes;
+		ret = selftest_decode_check("plane cache decode (miss)", tc, "reference.bmp");
+		if(ret == e_success)
+		{
+			ret = selftest_decode_check("plane cache decode (hit)", tc, "reference.bmp");
+		}
+	}
+	if(ret == e_success && !too_big)
+	{
+		ret = selftest_push_check(tc, ref);
+	}
+	if(ret == e_success && !too_big)
+	{
+		ret = selftest_old_check(tc);
+	}
+	// .png keeps carriers of bottom-up 32 bpp and of 24 bpp without row padding.
+	if(ret == e_success && !too_big && (tc->format == e_bgra32 || (tc->format == e_bgr24 && (tc->width * 3) % 4 == 0)))
+	{
+		options = selftest_base;
+		if(selftest_encode("carrier.bmp", secret, "output.png", 0) == e_failure)
+		{
+			printf("ERROR: Self-test .png output : encoding failed\n");
+			ret = e_failure;
+		}
+		else
+		{
+			char png[SELFTEST_PATH_SIZE];
+			ret = selftest_decode_check("png decode", tc, "output.png");
+			remove(selftest_path(png, "output.png"));
+		}
+	}
+	free(ref);
+	return ret;
+}
+
+/* Checks stdio encoder and decoder with --channels and/or --ecc header, secret is first bytes of secret file of case */
+static Status selftest_extended(const SelftestCase *tc)
+{
+	SelftestCase ext = *tc;
+	char secret[SELFTEST_NAME_SIZE];
+	uint8_t header[STEGO_HEADER_MAX + 2];
+	// whole pixels of 24 bpp rows without padding, or 32 bpp, can have channel mask.
+	int channels = (tc->format == e_bgra32 || (tc->format == e_bgr24 && (tc->width * 3) % 4 == 0));
+	uint64_t pixel_bytes = (uint64_t)tc->width * tc->height * ((tc->format == e_bgra32) ? 4 : (tc->format == e_rgb16) ? 2 : 3);
+
+	ext.flags = (channels && selftest_below(2)) ? FLAG_CHANNELS : 0;
+	ext.flags |= (ext.flags == 0 || selftest_below(2)) ? FLAG_ECC : 0;
+	ext.channel_mask = 1 + selftest_below(CHANNEL_ALL - 1);
+	ext.ecc_parity = RS_MIN_PARITY + selftest_below(RS_MAX_PARITY - RS_MIN_PARITY + 1);
+
+	// secret size is halved till payload is well inside capacity, edge of capacity is checked by plain header.
+	uint header_size = ref_header(&ext, header);
+	for(;;)
+	{
+		uint64_t data_size = (ext.flags & FLAG_ECC) ? rs_encoded_size(ext.secret_size, ext.ecc_parity) : ext.secret_size;
+		if(ref_payload_end(&ext, header_size, data_size) < pixel_bytes * 9 / 10)
+		{
+			break;
+		}
+		if(ext.secret_size <= 2)
+		{
+			return e_success;
+		}
+		ext.secret_size /= 2;
+		header_size = ref_header(&ext, header);
+	}
+
+	snprintf(secret, sizeof(secret), "extended%s", ext.extn);
+	uint8_t *ref = ref_stego(&ext);
+	Status ret = (ref != NULL) ? selftest_write_file(secret, ext.secret, ext.secret_size) : e_failure;
+
+	char variant[64];
+	snprintf(variant, sizeof(variant), "stdio%s%s", (ext.flags & FLAG_CHANNELS) ? " --channels" : "", (ext.flags & FLAG_ECC) ? " --ecc" : "");
+	if(ret == e_success)
+	{
+		options = selftest_base;
+		options.channels = (ext.flags & FLAG_CHANNELS) ? ext.channel_mask : 0;
+		options.ecc_parity = (ext.flags & FLAG_ECC) ? ext.ecc_parity : 0;
+		options.verify = selftest_below(2);
+		ret = selftest_encode_check(variant, &ext, secret, ref, 0);
+	}
+	if(ret == e_success && selftest_write_file("reference.bmp", ref, ext.file_size) == e_success)
+	{
+		options = selftest_base;
+		ret = selftest_decode_check(variant, &ext, "reference.bmp");
+	}
+	if(ret == e_success)
+	{
+		ret = selftest_old_check(&ext);
+	}
+	free(ref);
+	return ret;
+}
+
+/* Makes random carrier image and secret file of a round, and checks them with all variants */
+static Status selftest_round(uint round)
+{
+	SelftestCase tc;
+	const char *extns[3] = { ".txt", ".sh", ".c" };
+	const uint16_t bpps[3] = { 24, 32, 16 };
+	char secret[SELFTEST_NAME_SIZE];
+
+	memset(&tc, 0, sizeof(tc));
+	int f = selftest_below(3);
+	tc.format = (f == 0) ? e_bgr24 : (f == 1) ? e_bgra32 : e_rgb16;
+	tc.width = SELFTEST_MIN_SIDE + selftest_below(SELFTEST_MAX_SIDE - SELFTEST_MIN_SIDE + 1);
+	tc.height = SELFTEST_MIN_SIDE + selftest_below(SELFTEST_MAX_SIDE - SELFTEST_MIN_SIDE + 1);
+	tc.extn = extns[selftest_below(3)];
+
+	// bottom-up BI_RGB bmp, rows are padded to 4 bytes.
+	uint32_t row = ((uint32_t)tc.width * bpps[f] / 8 + 3) / 4 * 4;
+	uint32_t data_size = row * tc.height;
+	tc.file_size = BMP_HEADER_SIZE + data_size;
+	tc.carrier = malloc(tc.file_size);
+	if(tc.carrier == NULL)
+	{
+		return e_failure;
+	}
+	uint8_t *hdr = tc.carrier;
+	uint32_t u32;
+	uint16_t u16;
+	int32_t i32;
+	memset(hdr, 0, BMP_HEADER_SIZE);
+	hdr[0] = 'B';
+	hdr[1] = 'M';
+	u32 = tc.file_size;		memcpy(hdr + 2, &u32, 4);
+	u32 = BMP_HEADER_SIZE;		memcpy(hdr + 10, &u32, 4);
+	u32 = 40;			memcpy(hdr + 14, &u32, 4);
+	i32 = tc.width;			memcpy(hdr + 18, &i32, 4);
+	i32 = tc.height;		memcpy(hdr + 22, &i32, 4);
+	u16 = 1;			memcpy(hdr + 26, &u16, 2);
+	u16 = bpps[f];			memcpy(hdr + 28, &u16, 2);
+	u32 = data_size;		memcpy(hdr + 34, &u32, 4);
+	selftest_fill(tc.carrier + BMP_HEADER_SIZE, data_size);
+
+	// biggest secret file : 54 + payload bits should be less than capacity (image size + 54), size varint gets shorter with size.
+	uint8_t header[STEGO_HEADER_MAX + 2];
+	uint64_t max_payload = (stego_bmp_capacity(tc.carrier) - BMP_HEADER_SIZE - 1) / 8;
+	tc.version = HEADER_VERSION;
+	tc.secret_size = max_payload;
+	while(ref_header(&tc, header) + tc.secret_size > max_payload)
+	{
+		tc.secret_size--;
+	}
+	uint64_t max_secret = tc.secret_size;
+
+	// secret size : full capacity, one byte too big, small, or any size (size 1 is taken as empty file).
+	uint pick = selftest_below(8);
+	tc.secret_size = (pick == 0) ? max_secret : (pick == 1) ? max_secret + 1 : (pick == 2) ? 2 + selftest_below(16) : 2 + selftest_below(max_secret - 1);
+	int too_big = (tc.secret_size > max_secret);
+	tc.secret = malloc(tc.secret_size);
+	if(tc.secret == NULL)
+	{
+		free(tc.carrier);
+		return e_failure;
+	}
+	selftest_fill(tc.secret, tc.secret_size);
+	snprintf(secret, sizeof(secret), "secret%s", tc.extn);
+
+	print_info("INFO: Round %u : %s %dx%d carrier, %llu byte %s secret file%s\n", round, selftest_format_name(tc.format), tc.width, tc.height, (unsigned long long)tc.secret_size, tc.extn, too_big ? " (too big)" : (tc.secret_size == max_secret) ? " (full capacity)" : "");
+
+	Status ret = selftest_write_file("carrier.bmp", tc.carrier, tc.file_size);
+	if(ret == e_success)
+	{
+		ret = selftest_write_file(secret, tc.secret, tc.secret_size);
+	}
+	if(ret == e_success)
+	{
+		// streamed secret has longest size varint.
+		SelftestCase st = tc;
+		st.streamed = 1;
+		ret = selftest_plain(&tc, secret, too_big, ref_header(&st, header) + st.secret_size <= max_payload);
+	}
+	if(ret == e_success && !too_big)
+	{
+		ret = selftest_extended(&tc);
+	}
+	free(tc.carrier);
+	free(tc.secret);
+	return ret;
+}
+
+
+
+/* Removes one file or directory of temp dir, called by nftw() children first */
+static int selftest_remove(const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+	(void)st;
+	(void)type;
+	(void)ftw;
+	return remove(path);
+}
+
+/* Runs self-test rounds (./a.out --selftest) */
+Status do_selftest(uint rounds)
+{
+	Options saved = options;
+	Status ret = e_success;
+	uint round;
+
+	// seed is taken from environment to run same rounds again, else from clock.
+	const char *seed_env = getenv(SELFTEST_SEED_ENV);
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	uint64_t seed = (seed_env != NULL) ? strtoull(seed_env, NULL, 10) : (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+	selftest_state = seed ? seed : 1;
+	selftest_checks = 0;
+
+	strcpy(selftest_dir, SELFTEST_DIR_TEMPLATE);
+	if(mkdtemp(selftest_dir) == NULL)
+	{
+		perror("mkdtemp");
+		printf("ERROR: Unable to make temp dir for self-test.\n");
+		return e_failure;
+	}
+	print_info("INFO: ## Self-test Started ##\n");
+	print_info("INFO: Seed %llu (set %s=%llu to run same rounds again), files in %s\n", (unsigned long long)seed, SELFTEST_SEED_ENV, (unsigned long long)seed, selftest_dir);
+
+	// variants run with options of plain encoding, only INFO setting of user is kept for messages of self-test.
+	memset(&selftest_base, 0, sizeof(selftest_base));
+	selftest_base.quiet = 1;
+	selftest_base.trace_fname = saved.trace_fname;
+
+	for(round = 1; round <= rounds && ret == e_success; round++)
+	{
+		options = saved;
+		ret = selftest_kernels();
+		if(ret == e_success)
+		{
+			ret = selftest_rs_code();
+		}
+		if(ret == e_success)
+		{
+			ret = selftest_round(round);
+		}
+		options = saved;
+	}
+
+	if(ret == e_failure)
+	{
+		printf("ERROR: Self-test failed in round %u (seed %llu), files are kept in %s\n", round - 1, (unsigned long long)seed, selftest_dir);
+		return e_failure;
+	}
+	nftw(selftest_dir, selftest_remove, 16, FTW_DEPTH | FTW_PHYS);
+	print_info("INFO: %u rounds, %llu checks passed\n", rounds, (unsigned long long)selftest_checks);
+	return e_success;
+}
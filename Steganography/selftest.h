@@ -0,0 +1,83 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Differential Self-test of Encoding and Decoding Paths
+ *
+ *                              -> ./a.out --selftest[=<rounds>] checks every optimized path against a bit by bit reference made with
+ *                                 encode_byte_to_lsb() and decode_char_bytes_from_lsb(), on random carriers and payloads.
+ *                              -> Kernels : LSB embed/extract/verify/count of each pixel format and channel mask at random bit positions and
+ *                                 lengths (SWAR and SSSE3 builds), and Reed-Solomon parity (table and SSSE3) and correction.
+ *                              -> Files : random 24 bpp (with row padding), 32 bpp and 16 bpp carriers and secret files (odd sizes,
+ *                                 exactly full capacity, one byte too big) are encoded with stdio, --verify, pipeline, streamed secret,
+ *                                 batch thread pool and io_uring, --channels and --ecc, and outputs should be byte-identical to reference.
+ *                              -> Reference image is decoded with stdio, pipeline, plane cache, push decoder (random chunk sizes), batch and
+ *                                 through .png, and decoded secret file should be same as original, image with old header is decoded too.
+ *                              -> Random seed is printed, and taken from STEGO_SELFTEST_SEED if set, so a failed round can be run again.
+ *                              -> Files of a failed round are kept in temp dir for inspection, else temp dir is removed.
+ */
+
+
+
+
+#ifndef SELFTEST_H
+#define SELFTEST_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+
+/* Default no. of rounds of --selftest */
+#define SELFTEST_ROUNDS 20
+
+/* Environment variable with random seed of self-test (not set => seed from clock) */
+#define SELFTEST_SEED_ENV "STEGO_SELFTEST_SEED"
+
+/* Temp dir of carrier, secret and output files (mkdtemp template) */
+#define SELFTEST_DIR_TEMPLATE "/tmp/stego-selftest-XXXXXX"
+
+/* Min. and max. carrier width and height */
+#define SELFTEST_MIN_SIDE 24
+#define SELFTEST_MAX_SIDE 301
+
+/* Max. payload bits of one kernel check */
+#define SELFTEST_KERNEL_BITS 6000
+
+/* Bytes before and after carriers of kernel check, they should never change */
+#define SELFTEST_GUARD 64
+
+/*
+ * Structure to store one file round,
+ * carrier and secret file and header fields of reference image
+ */
+
+typedef struct _SelftestCase
+{
+    /* Carrier */
+    PixelFormat format;			// => pixel format of carrier image
+    int width;				// => carrier width in pixels
+    int height;				// => carrier height in pixels
+    uint8_t *carrier;			// => carrier image file bytes
+    uint64_t file_size;			// => carrier image file size
+
+    /* Secret */
+    uint8_t *secret;			// => secret file bytes
+    uint64_t secret_size;		// => secret file size
+    const char *extn;			// => secret file extension
+
+    /* Header */
+    uint8_t flags;			// => FLAG_CHANNELS / FLAG_ECC of reference (0 => plain "#*" header)
+    uint channel_mask;			// => CHANNEL_* mask (FLAG_CHANNELS)
+    uint ecc_parity;			// => parity bytes per codeword (FLAG_ECC)
+    uint8_t version;			// => HEADER_VERSION, or HEADER_VERSION_FIXED for decoding of old header
+    int streamed;			// => 1 if size field is padded (extended in old header), as for streamed secret file
+
+} SelftestCase;
+
+
+/* Self-test function prototypes */
+
+/* Run self-test rounds (./a.out --selftest) */
+Status do_selftest(uint rounds);
+
+#endif
@@ -0,0 +1,287 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Per-stage Statistics
+ *
+ *                              -> With --stats=json, every encoding/decoding stage is timed with monotonic clock.
+ *                              -> Bytes read, bytes written and read/write syscall counts are taken from /proc/self/io.
+ *                              -> At the end, stages, totals and peak RSS are printed as JSON to stderr.
+ *                              -> When stats are not asked, stats_begin() and stats_end() return immediately.
+ *                              -> With --metrics, encoding counts carrier bytes it changes while embedding (old LSBs XOR payload, popcount),
+ *                                 every change is a flip of LSB, so squared error is 1 per changed byte and MSE/PSNR need no second read.
+ */
+
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "stats.h"
+#include "options.h"
+#include "types.h"
+
+/* Stages recorded so far */
+static StageStats stages[STATS_MAX_STAGES];
+static int stage_count;
+
+/* Snapshots of start of run and start of current stage */
+static StatsSnapshot run_begin, stage_begin;
+static const char *stage_name;
+
+/* Reads of /proc/self/io done by stats itself, these are not counted in stages */
+static int64_t probe_reads, probe_bytes;
+
+/* Distortion of encoding (--metrics) : samples of image and samples changed */
+static uint64_t distortion_samples, distortion_changed;
+
+/* Function Definitions */
+
+/* Gets value of one counter from /proc/self/io text */
+static int64_t io_counter(const char *text, const char *key)
+{
+	const char *p = strstr(text, key);
+	if(p == NULL)
+	{
+		return -1;
+	}
+	return strtoll(p + strlen(key), NULL, 10);
+}
+
+
+
+/* Takes snapshot of monotonic clock and I/O counters */
+static void stats_snapshot(StatsSnapshot *snap)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	snap->time_ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+
+	snap->bytes_read = snap->bytes_written = snap->read_syscalls = snap->write_syscalls = -1;
+
+	// open/read/close are used instead of fopen, so only one read syscall is done for snapshot.
+	int fd = open("/proc/self/io", O_RDONLY);
+	if(fd < 0)
+	{
+		return;
+	}
+	char text[512];
+	ssize_t n = read(fd, text, sizeof(text) - 1);
+	close(fd);
+	if(n <= 0)
+	{
+		return;
+	}
+	text[n] = '\0';
+
+	// counters are adjusted by reads done by earlier snapshots, then read done now is added.
+	snap->bytes_read = io_counter(text, "rchar: ") - probe_bytes;
+	snap->bytes_written = io_counter(text, "wchar: ");
+	snap->read_syscalls = io_counter(text, "syscr: ") - probe_reads;
+	snap->write_syscalls = io_counter(text, "syscw: ");
+	probe_reads += 1;
+	probe_bytes += n;
+}
+
+
+
+/* Difference of two snapshots, -1 if counters are not available */
+static StatsSnapshot stats_delta(const StatsSnapshot *end, const StatsSnapshot *begin)
+{
+	StatsSnapshot d;
+	d.time_ns = end->time_ns - begin->time_ns;
+	d.bytes_read = (begin->bytes_read < 0) ? -1 : end->bytes_read - begin->bytes_read;
+	d.bytes_written = (begin->bytes_written < 0) ? -1 : end->bytes_written - begin->bytes_written;
+	d.read_syscalls = (begin->read_syscalls < 0) ? -1 : end->read_syscalls - begin->read_syscalls;
+	d.write_syscalls = (begin->write_syscalls < 0) ? -1 : end->write_syscalls - begin->write_syscalls;
+	return d;
+}
+
+
+
+/* Starts statistics of whole run */
+void stats_start(void)
+{
+	if(options.stats == 0)
+	{
+		return;
+	}
+	stage_count = 0;
+	stats_snapshot(&run_begin);
+}
+
+
+
+/* Begins a stage */
+void stats_begin(const char *name)
+{
+	if(options.stats == 0)
+	{
+		return;
+	}
+	stage_name = name;
+	stats_snapshot(&stage_begin);
+}
+
+
+
+/* Ends current stage and records it, status is returned as it is */
+Status stats_end(Status status)
+{
+	if(options.stats == 0 || stage_name == NULL)
+	{
+		return status;
+	}
+
+	StatsSnapshot end;
+	stats_snapshot(&end);
+
+	// if => more stages than array size, then extra stages are only counted in totals.
+	if(stage_count < STATS_MAX_STAGES)
+	{
+		stages[stage_count].name = stage_name;
+		stages[stage_count].status = status;
+		stages[stage_count].delta = stats_delta(&end, &stage_begin);
+		stage_count++;
+	}
+	stage_name = NULL;
+	return status;
+}
+
+
+
+/* Sets no. of 8-bit samples of image (carrier bytes of all pixels) */
+void stats_set_samples(uint64_t samples)
+{
+	distortion_samples = samples;
+	distortion_changed = 0;
+}
+
+
+
+/* Adds no. of image bytes changed by encoding, each by 1 (LSB flip) */
+void stats_add_changes(uint64_t changed)
+{
+	distortion_changed += changed;
+}
+
+
+
+/* Natural log, libm is not linked (x > 0) */
+static double stats_ln(double x)
+{
+	// x = m * 2^e with m in [1, 2), then ln(m) = 2 * atanh((m - 1) / (m + 1)) as series.
+	int e = 0;
+	while(x >= 2)
+	{
+		x /= 2;
+		e++;
+	}
+	while(x < 1)
+	{
+		x *= 2;
+		e--;
+	}
+	double y = (x - 1) / (x + 1), y2 = y * y, term = y, sum = 0;
+	for(int k=1; k<40; k+=2)
+	{
+		sum += term / k;
+		term *= y2;
+	}
+	return 2 * sum + e * 0.69314718055994530942;
+}
+
+
+
+/* Gets MSE and PSNR in dB of encoding, returns 0 if image has not changed (PSNR is infinite) */
+static int stats_distortion(double *mse, double *psnr)
+{
+	*mse = (distortion_samples > 0) ? (double)distortion_changed / distortion_samples : 0;
+	if(distortion_changed == 0)
+	{
+		*psnr = 0;
+		return 0;
+	}
+	// PSNR = 10 * log10(255^2 / MSE).
+	*psnr = 10 * stats_ln(255.0 * 255.0 / *mse) / stats_ln(10);
+	return 1;
+}
+
+
+
+/* Prints counters of a snapshot delta as JSON members */
+static void print_counters(FILE *fptr, const StatsSnapshot *d)
+{
+	fprintf(fptr, "\"time_ns\": %llu", (unsigned long long)d->time_ns);
+	fprintf(fptr, ", \"bytes_read\": %lld", (long long)d->bytes_read);
+	fprintf(fptr, ", \"bytes_written\": %lld", (long long)d->bytes_written);
+	fprintf(fptr, ", \"read_syscalls\": %lld", (long long)d->read_syscalls);
+	fprintf(fptr, ", \"write_syscalls\": %lld", (long long)d->write_syscalls);
+}
+
+
+
+/* Prints stages, totals and peak RSS as JSON to stderr */
+void stats_report(const char *operation, Status status)
+{
+	double mse, psnr;
+	int changed = stats_distortion(&mse, &psnr);
+
+	// if => --metrics, then distortion of encoding is printed as INFO also.
+	if(options.metrics && distortion_samples > 0 && status == e_success)
+	{
+		if(changed)
+		{
+			print_info("INFO: Distortion : %llu of %llu bytes changed, MSE %.8f, PSNR %.2f dB\n", (unsigned long long)distortion_changed, (unsigned long long)distortion_samples, mse, psnr);
+		}
+		else
+		{
+			print_info("INFO: Distortion : no byte changed, PSNR is infinite\n");
+		}
+	}
+
+	if(options.stats == 0)
+	{
+		return;
+	}
+
+	StatsSnapshot end;
+	stats_snapshot(&end);
+	StatsSnapshot total = stats_delta(&end, &run_begin);
+
+	struct rusage usage;
+	long peak_rss_kb = (getrusage(RUSAGE_SELF, &usage) == 0) ? usage.ru_maxrss : -1;
+
+	fprintf(stderr, "{\"operation\": \"%s\", \"status\": \"%s\",\n", operation, (status == e_success) ? "success" : "failure");
+	fprintf(stderr, " \"stages\": [");
+	for(int i=0; i<stage_count; i++)
+	{
+		fprintf(stderr, "%s\n  {\"name\": \"%s\", \"status\": \"%s\", ", (i == 0) ? "" : ",", stages[i].name, (stages[i].status == e_success) ? "success" : "failure");
+		print_counters(stderr, &stages[i].delta);
+		fprintf(stderr, "}");
+	}
+	fprintf(stderr, "\n ],\n \"total\": {");
+	print_counters(stderr, &total);
+	fprintf(stderr, ", \"peak_rss_kb\": %ld}", peak_rss_kb);
+
+	// if => --metrics, then distortion is added (psnr_db is null when nothing changed).
+	if(options.metrics && distortion_samples > 0)
+	{
+		fprintf(stderr, ",\n \"distortion\": {\"samples\": %llu, \"changed_bytes\": %llu, \"mse\": %.10f, \"psnr_db\": ", (unsigned long long)distortion_samples, (unsigned long long)distortion_changed, mse);
+		if(changed)
+		{
+			fprintf(stderr, "%.4f}", psnr);
+		}
+		else
+		{
+			fprintf(stderr, "null}");
+		}
+	}
+	fprintf(stderr, "}\n");
+}
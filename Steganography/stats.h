@@ -0,0 +1,72 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Per-stage Statistics
+ *
+ *                              -> With --stats=json, every encoding/decoding stage is timed with monotonic clock.
+ *                              -> Bytes read, bytes written and read/write syscall counts are taken from /proc/self/io.
+ *                              -> At the end, stages, totals and peak RSS are printed as JSON to stderr.
+ *                              -> When stats are not asked, stats_begin() and stats_end() return immediately.
+ *                              -> With --metrics, encoding counts carrier bytes it changes while embedding (old LSBs XOR payload, popcount),
+ *                                 every change is a flip of LSB, so squared error is 1 per changed byte and MSE/PSNR need no second read.
+ */
+
+
+
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+#include "trace.h"
+
+#define STATS_MAX_STAGES 32
+
+/* Runs one stage function call between stats_begin() and stats_end() (and in trace), value is Status of call */
+#define STATS_STAGE(name, call)	(stats_begin(name), stats_end(TRACE_STAGE(name, call)))
+
+/* Snapshot of clock and I/O counters */
+typedef struct _StatsSnapshot
+{
+    uint64_t time_ns;			// => monotonic clock in nanoseconds
+    int64_t bytes_read;			// => rchar of /proc/self/io (-1 => not available)
+    int64_t bytes_written;		// => wchar of /proc/self/io
+    int64_t read_syscalls;		// => syscr of /proc/self/io
+    int64_t write_syscalls;		// => syscw of /proc/self/io
+
+} StatsSnapshot;
+
+/* Statistics of one stage */
+typedef struct _StageStats
+{
+    const char *name;			// => Stores stage (function) name
+    Status status;			// => Stores stage result
+    StatsSnapshot delta;		// => Stores difference of end and begin snapshots
+
+} StageStats;
+
+
+/* Stats function prototypes */
+
+/* Start statistics of whole run */
+void stats_start(void);
+
+/* Begin a stage */
+void stats_begin(const char *name);
+
+/* End current stage, returns status as it is */
+Status stats_end(Status status);
+
+/* Set no. of 8-bit samples of image, MSE is over them (--metrics) */
+void stats_set_samples(uint64_t samples);
+
+/* Add no. of image bytes changed by encoding (--metrics) */
+void stats_add_changes(uint64_t changed);
+
+/* Print statistics as JSON */
+void stats_report(const char *operation, Status status);
+
+#endif
@@ -0,0 +1,339 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       In-memory Stego Header and Region Encoding
+ *
+ *                              -> Encoded data is seen as one payload byte stream : header bytes and then secret file data.
+ *                              -> Header bytes are magic string, version, flags, [nonce], extension size, extension and file size.
+ *                              -> Header version 2 has flags, extension size and file size as varints, so a small secret file has a
+ *                                 short header, version 1 (32-bit fields) and old "#*" headers are still read.
+ *                              -> Byte order and field sizes are same as encode_secret_file_extn_size() etc, so images are same.
+ *                              -> Payload bit k is stored in LSB of image byte 54 + k (24 bpp, see lsb_carrier_offset() for 32/16 bpp).
+ *                              -> So any block of image file can be encoded/decoded alone, if its file offset is known.
+ */
+
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include "stego.h"
+#include "lsb.h"
+#include "common.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Reads 32-bit value msb first */
+static uint32_t get32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+
+
+/* Gets image size plus bmp header, same as get_image_size_for_bmp() + 54 */
+uint64_t stego_bmp_capacity(const uint8_t *bmp_header)
+{
+	int32_t width, height;
+	uint16_t bpp;
+	memcpy(&width, bmp_header + 18, 4);
+	memcpy(&height, bmp_header + 22, 4);
+	memcpy(&bpp, bmp_header + 28, 2);
+	if(height < 0)
+	{
+		height = -height;
+	}
+
+	// carrier bytes per pixel : 1 for 16 bpp, else 3.
+	uint channels = (bpp == 16) ? 1 : 3;
+	return (uint64_t)(uint32_t)width * (uint32_t)height * channels + BMP_HEADER_SIZE;
+}
+
+
+
+/* Gets pixel format from bits per pixel and compression fields, and file offset of first carrier byte */
+Status stego_bmp_format(const uint8_t *bmp_header, PixelFormat *format, uint64_t *data_offset)
+{
+	uint32_t offset, compression;
+	uint16_t bpp;
+	memcpy(&offset, bmp_header + 10, 4);
+	memcpy(&bpp, bmp_header + 28, 2);
+	memcpy(&compression, bmp_header + 30, 4);
+
+	// 24 bpp always starts at 54, same as old images.
+	if(bpp == 24)
+	{
+		*format = e_bgr24;
+		*data_offset = BMP_HEADER_SIZE;
+		return e_success;
+	}
+
+	// 32/16 bpp should be uncompressed (BI_RGB) or bit fields (BI_BITFIELDS, BI_ALPHABITFIELDS), alpha is taken as 4th byte.
+	if((bpp != 32 && bpp != 16) || (compression != 0 && compression != 3 && compression != 6))
+	{
+		return e_failure;
+	}
+	if(offset < BMP_HEADER_SIZE || offset > STEGO_MAX_DATA_OFFSET)
+	{
+		return e_failure;
+	}
+	*format = (bpp == 32) ? e_bgra32 : e_rgb16;
+	*data_offset = offset;
+	return e_success;
+}
+
+
+
+/* Gets no. of bytes of varint of value */
+uint stego_varint_size(uint64_t value)
+{
+	uint n = 1;
+	while(value >= 0x80)
+	{
+		value >>= 7;
+		n++;
+	}
+	return n;
+}
+
+/* Stores value as varint (7 bits per byte, low bits first, high bit set if more bytes follow), padded to at least min_size bytes */
+uint stego_put_varint(uint8_t *p, uint64_t value, uint min_size)
+{
+	uint n = 0;
+	// padding bytes are 0x80 (more bytes, value bits 0), so field can be patched later with any value of same size.
+	while(value >= 0x80 || n + 1 < min_size)
+	{
+		p[n++] = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+	p[n++] = value;
+	return n;
+}
+
+/* Reads varint, returns no. of bytes (0 => more than avail bytes, -1 => longer than VARINT_MAX_SIZE) */
+int stego_get_varint(const uint8_t *p, uint avail, uint64_t *value)
+{
+	*value = 0;
+	for(uint n = 0; n < VARINT_MAX_SIZE; n++)
+	{
+		if(n >= avail)
+		{
+			return 0;
+		}
+		*value |= (uint64_t)(p[n] & 0x7f) << (7 * n);
+		if((p[n] & 0x80) == 0)
+		{
+			return n + 1;
+		}
+	}
+	return -1;
+}
+
+
+
+/* Stores header fields as payload bytes (current header version), header_size is updated and returned */
+uint stego_write_header(StegoHeader *hdr, uint8_t *payload)
+{
+	uint n = 0;
+
+	// magic string, version and flags.
+	memcpy(payload, MAGIC_STRING_EXT, 2);
+	n += 2;
+	payload[n++] = HEADER_VERSION;
+	n += stego_put_varint(payload + n, hdr->flags, 1);
+	if(hdr->flags & FLAG_ENCRYPTED)
+	{
+		memcpy(payload + n, hdr->nonce, CIPHER_NONCE_SIZE);
+		n += CIPHER_NONCE_SIZE;
+	}
+
+	n += stego_put_varint(payload + n, hdr->extn_size, 1);
+	memcpy(payload + n, hdr->extn, hdr->extn_size);
+	n += hdr->extn_size;
+	n += stego_put_varint(payload + n, hdr->data_size, 1);
+
+	hdr->header_size = n;
+	return n;
+}
+
+
+
+/* Reads 32-bit field of old header, or varint field of current one (0 => more bytes needed, -1 => invalid) */
+static int stego_get_field(const uint8_t *payload, uint avail, uint version, uint64_t *value)
+{
+	if(version == HEADER_VERSION)
+	{
+		return stego_get_varint(payload, avail, value);
+	}
+	if(avail < 4)
+	{
+		return 0;
+	}
+	*value = get32(payload);
+	return 4;
+}
+
+/* Reads header fields from payload bytes, returns no. of bytes still needed (at least), 0 => header is complete, -1 => not a valid header */
+static int stego_parse_header(const uint8_t *payload, uint avail, StegoHeader *hdr)
+{
+	uint n = 0;
+	uint version = HEADER_VERSION_FIXED;
+	uint64_t value;
+	int len;
+	memset(hdr, 0, sizeof(*hdr));
+
+	if(avail < 2)
+	{
+		return 2 - avail;
+	}
+
+	// if => extended header, then version, flags and nonce are read, fields after them are varints from version 2.
+	if(memcmp(payload, MAGIC_STRING_EXT, 2) == 0)
+	{
+		if(avail < 4)
+		{
+			return 4 - avail;
+		}
+		// flags are one byte (varint of version 2 is same byte while flags are below 0x80).
+		version = payload[2];
+		if((version != HEADER_VERSION && version != HEADER_VERSION_FIXED) || (payload[3] & ~FLAG_ENCRYPTED) != 0)
+		{
+			printf("ERROR: Unsupported header version or flags.\n");
+			return -1;
+		}
+		hdr->flags = payload[3];
+		n = 4;
+		if(hdr->flags & FLAG_ENCRYPTED)
+		{
+			if(avail < n + CIPHER_NONCE_SIZE)
+			{
+				return n + CIPHER_NONCE_SIZE - avail;
+			}
+			memcpy(hdr->nonce, payload + n, CIPHER_NONCE_SIZE);
+			n += CIPHER_NONCE_SIZE;
+		}
+	}
+	else if(memcmp(payload, MAGIC_STRING, 2) == 0)
+	{
+		n = 2;
+	}
+	else
+	{
+		printf("ERROR: Decoded magic string doesn't match original magic string(#*).\n");
+		return -1;
+	}
+
+	// extension size varint is one byte too, so header is never bigger than STEGO_HEADER_MAX.
+	len = stego_get_field(payload + n, avail - n, version, &value);
+	if(len <= 0 || value > STEGO_EXTN_MAX || (version == HEADER_VERSION && len != 1))
+	{
+		if(len == 0)
+		{
+			return (version == HEADER_VERSION) ? 1 : n + 4 - avail;
+		}
+		printf("ERROR: Invalid secret file extension size %llu.\n", (unsigned long long)value);
+		return -1;
+	}
+	hdr->extn_size = value;
+	n += len;
+	if(avail < n + hdr->extn_size)
+	{
+		return n + hdr->extn_size - avail;
+	}
+	memcpy(hdr->extn, payload + n, hdr->extn_size);
+	hdr->extn[hdr->extn_size] = '\0';
+	n += hdr->extn_size;
+
+	len = stego_get_field(payload + n, avail - n, version, &hdr->data_size);
+	if(len <= 0)
+	{
+		if(len == 0)
+		{
+			return (version == HEADER_VERSION) ? 1 : n + 4 - avail;
+		}
+		printf("ERROR: Invalid secret file size field.\n");
+		return -1;
+	}
+	n += len;
+
+	// old header has sizes of 4 GB and more as marker and then 64-bit size.
+	if(version == HEADER_VERSION_FIXED && hdr->data_size == SIZE_FIELD_EXTENDED)
+	{
+		if(avail < n + 8)
+		{
+			return n + 8 - avail;
+		}
+		hdr->data_size = ((uint64_t)get32(payload + n) << 32) | get32(payload + n + 4);
+		n += 8;
+	}
+
+	hdr->header_size = n;
+	return 0;
+}
+
+/* Reads header fields from decoded payload bytes, avail is no. of bytes decoded */
+Status stego_read_header(const uint8_t *payload, uint avail, StegoHeader *hdr)
+{
+	return (stego_parse_header(payload, avail, hdr) == 0) ? e_success : e_failure;
+}
+
+/* Gets no. of header bytes still needed after avail bytes (0 => header is complete, -1 => not a valid header) */
+int stego_header_need(const uint8_t *payload, uint avail)
+{
+	StegoHeader hdr;
+	return stego_parse_header(payload, avail, &hdr);
+}
+
+
+
+/* Image file size needed for header and secret data, same as Encoding_things of check_capacity() */
+uint64_t stego_required_size(const StegoHeader *hdr)
+{
+	return BMP_HEADER_SIZE + (hdr->header_size + hdr->data_size) * 8;
+}
+
+
+
+/* Encodes payload into a block of image file, block starts at file_off and has len bytes */
+void stego_embed_region(uint8_t *block, uint64_t file_off, size_t len, const uint8_t *payload, uint64_t payload_len)
+{
+	uint64_t start = BMP_HEADER_SIZE, end = BMP_HEADER_SIZE + payload_len * 8;
+	uint64_t from = (file_off > start) ? file_off : start;
+	uint64_t to = (file_off + len < end) ? file_off + len : end;
+
+	// if => block doesn't overlap with encoded region, then nothing to do.
+	if(from >= to)
+	{
+		return;
+	}
+	lsb_embed_bits(block + (from - file_off), payload, from - start, to - from);
+}
+
+
+
+/* Checks payload bits of encoded region in block, same overlap as stego_embed_region */
+Status stego_verify_region(const uint8_t *block, uint64_t file_off, size_t len, const uint8_t *payload, uint64_t payload_len)
+{
+	uint64_t start = BMP_HEADER_SIZE, end = BMP_HEADER_SIZE + payload_len * 8;
+	uint64_t from = (file_off > start) ? file_off : start;
+	uint64_t to = (file_off + len < end) ? file_off + len : end;
+
+	if(from >= to)
+	{
+		return e_success;
+	}
+	return lsb_verify_pixels(e_bgr24, block + (from - file_off), payload + (from - start) / 8, from - start, to - from) ? e_success : e_failure;
+}
+
+
+
+/* Gets offset of first pixel after carrier bytes of header bits, secret data with channel mask starts there */
+uint64_t stego_channel_start(PixelFormat format, uint64_t data_bit)
+{
+	// header is in default layout, so it can end in middle of a pixel.
+	uint64_t pixel = (format == e_bgra32) ? 4 : 3;
+	return (lsb_carrier_offset(format, data_bit) + pixel - 1) / pixel * pixel;
+}
@@ -0,0 +1,93 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       In-memory Stego Header and Region Encoding
+ *
+ *                              -> Encoded data is seen as one payload byte stream : header bytes and then secret file data.
+ *                              -> Header bytes are magic string, version, flags, [nonce], extension size, extension and file size.
+ *                              -> Header version 2 has flags, extension size and file size as varints, older headers are still read.
+ *                              -> Byte order and field sizes are same as encode_secret_file_extn_size() etc, so images are same.
+ *                              -> Payload bit k is stored in LSB of image byte 54 + k (24 bpp, see lsb_carrier_offset() for 32/16 bpp).
+ *                              -> So any block of image file can be encoded/decoded alone, if its file offset is known.
+ */
+
+
+
+
+#ifndef STEGO_H
+#define STEGO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+#include "cipher.h" // Contains nonce size
+
+/* Size of bmp header before RGB data */
+#define BMP_HEADER_SIZE 54
+
+/* Maximum pixel data offset of 32/16 bpp images (V4/V5 headers and bit masks are before pixel data) */
+#define STEGO_MAX_DATA_OFFSET 1024
+
+/* Maximum secret file extension size */
+#define STEGO_EXTN_MAX 32
+
+/* Maximum header size : magic, version, flags, nonce, extension size, extension and extended file size (of version 1, biggest one) */
+#define STEGO_HEADER_MAX (2 + 2 + CIPHER_NONCE_SIZE + 4 + STEGO_EXTN_MAX + 4 + 8)
+
+/*
+ * Structure to store stego header fields
+ */
+
+typedef struct _StegoHeader
+{
+    uint8_t flags;			// => FLAG_* bits
+    uint8_t nonce[CIPHER_NONCE_SIZE];	// => Stores the nonce if encrypted
+    uint extn_size;			// => Stores secret file extension size
+    char extn[STEGO_EXTN_MAX + 1];	// => Stores secret file extension
+    uint64_t data_size;			// => Stores secret file size
+    uint header_size;			// => no. of payload bytes before secret data
+
+} StegoHeader;
+
+
+/* Stego function prototypes */
+
+/* Get image size plus bmp header from 54 bytes of bmp header */
+uint64_t stego_bmp_capacity(const uint8_t *bmp_header);
+
+/* Get pixel format and file offset of first carrier byte from 54 bytes of bmp header */
+Status stego_bmp_format(const uint8_t *bmp_header, PixelFormat *format, uint64_t *data_offset);
+
+/* Get no. of bytes of varint of value */
+uint stego_varint_size(uint64_t value);
+
+/* Store value as varint of at least min_size bytes, returns no. of bytes */
+uint stego_put_varint(uint8_t *p, uint64_t value, uint min_size);
+
+/* Read varint, returns no. of bytes (0 => more than avail bytes, -1 => too long) */
+int stego_get_varint(const uint8_t *p, uint avail, uint64_t *value);
+
+/* Store header fields as payload bytes (current version), returns no. of bytes */
+uint stego_write_header(StegoHeader *hdr, uint8_t *payload);
+
+/* Read header fields (any version) from payload bytes */
+Status stego_read_header(const uint8_t *payload, uint avail, StegoHeader *hdr);
+
+/* Get no. of header bytes still needed after avail bytes (0 => complete, -1 => not a valid header) */
+int stego_header_need(const uint8_t *payload, uint avail);
+
+/* Image file size needed to encode header and secret data */
+uint64_t stego_required_size(const StegoHeader *hdr);
+
+/* Encode payload into a block of image file starting at file offset */
+void stego_embed_region(uint8_t *block, uint64_t file_off, size_t len, const uint8_t *payload, uint64_t payload_len);
+
+/* Offset of first pixel after carrier bytes of data_bit header bits, secret data of channel mask starts there (--channels) */
+uint64_t stego_channel_start(PixelFormat format, uint64_t data_bit);
+
+/* Check payload encoded in a block of image file by stego_embed_region (--verify) */
+Status stego_verify_region(const uint8_t *block, uint64_t file_off, size_t len, const uint8_t *payload, uint64_t payload_len);
+
+#endif
@@ -0,0 +1,786 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Stego Daemon over UNIX Socket
+ *
+ *                              -> Socket is SOCK_SEQPACKET, so every request/reply is one message and fds come with it (SCM_RIGHTS).
+ *                              -> Main thread polls listening socket and clients, each request is pushed to job queue with dup() of
+ *                                 client socket, so reply can be sent even if main thread has already closed client.
+ *                              -> Job queue is bounded MPMC ring (sequence number per cell), push/pop are done with atomic
+ *                                 compare and swap, semaphore only wakes idle workers.
+ *                              -> Memfd sealed with F_SEAL_SHRINK is mapped with mmap, encode changes LSB of mapped carrier bytes
+ *                                 directly (MAP_SHARED). Seal is checked, so client can't truncate mapped file and kill daemon with SIGBUS.
+ *                              -> Other fds (files, memfd without seal) are read to heap buffer with pread(), and encoded carrier bytes
+ *                                 are written back with pwrite(), so file changed by client during job never faults.
+ *                              -> Secret data is mapped (or read) read only, encrypted secret data is done in chunks of 64K on worker stack buffer.
+ *                              -> Decoded secret data is put in new memfd which is sent back with reply.
+ *                              -> Carrier and secret file sizes are taken from fstat of passed fds, bounds are checked before any
+ *                                 mapped byte is touched.
+ */
+
+
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "stegod.h"
+#include "stego.h"
+#include "lsb.h"
+#include "cipher.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/*
+ * One request, with fds passed with it
+ */
+
+typedef struct _StegodJob
+{
+    StegodRequest req;			// => request message
+    int conn_fd;			// => dup() of client socket, reply is sent on it
+    int fds[2];				// => passed fds (-1 if not passed)
+
+} StegodJob;
+
+/*
+ * Bounded lock-free job queue
+ */
+
+typedef struct _StegodCell
+{
+    uint64_t seq;			// => position this cell is ready for
+    StegodJob *job;			// => job stored in cell
+
+} StegodCell;
+
+typedef struct _StegodQueue
+{
+    StegodCell cells[STEGOD_QUEUE_SIZE];	// => ring of jobs
+    uint64_t head __attribute__((aligned(64)));	// => next position to push
+    uint64_t tail __attribute__((aligned(64)));	// => next position to pop
+    sem_t items;				// => no. of jobs in queue
+
+} StegodQueue;
+
+/* Daemon state */
+static StegodQueue queue;
+static uint8_t daemon_key[CIPHER_KEY_SIZE];
+static int daemon_has_key;
+static volatile sig_atomic_t daemon_stop;
+
+/* Function Definitions */
+
+/* Initialise cell sequence numbers */
+static void queue_init(StegodQueue *q)
+{
+	for(uint64_t i=0; i<STEGOD_QUEUE_SIZE; i++)
+	{
+		q->cells[i].seq = i;
+		q->cells[i].job = NULL;
+	}
+	q->head = 0;
+	q->tail = 0;
+	sem_init(&q->items, 0, 0);
+}
+
+/* Push job, returns e_failure if queue is full */
+static Status queue_push(StegodQueue *q, StegodJob *job)
+{
+	uint64_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+	StegodCell *cell;
+
+	for(;;)
+	{
+		cell = &q->cells[pos & (STEGOD_QUEUE_SIZE - 1)];
+		int64_t diff = (int64_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+
+		// if => cell is free for this position, then it is claimed.
+		if(diff == 0)
+		{
+			if(__atomic_compare_exchange_n(&q->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			return e_failure;
+		}
+		else
+		{
+			pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+		}
+	}
+
+	cell->job = job;
+	__atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+	sem_post(&q->items);
+	return e_success;
+}
+
+/* Pop job, waits till a job is pushed, NULL job means stop */
+static StegodJob *queue_pop(StegodQueue *q)
+{
+	while(sem_wait(&q->items) != 0 && errno == EINTR)
+	{
+	}
+
+	uint64_t pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+	StegodCell *cell;
+
+	for(;;)
+	{
+		cell = &q->cells[pos & (STEGOD_QUEUE_SIZE - 1)];
+		int64_t diff = (int64_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+
+		// if => cell has job for this position, then it is claimed.
+		if(diff == 0)
+		{
+			if(__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else
+		{
+			// other worker has taken this position, or push is not yet stored.
+			pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+		}
+	}
+
+	StegodJob *job = cell->job;
+	__atomic_store_n(&cell->seq, pos + STEGOD_QUEUE_SIZE, __ATOMIC_RELEASE);
+	return job;
+}
+
+/* Sends reply, with fd if fd is not -1 */
+static void send_reply(int conn_fd, StegodReply *reply, int fd)
+{
+	struct iovec iov = { reply, sizeof(*reply) };
+	union
+	{
+		struct cmsghdr hdr;
+		char buf[CMSG_SPACE(sizeof(int))];
+	} control;
+	struct msghdr msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	if(fd != -1)
+	{
+		memset(&control, 0, sizeof(control));
+		msg.msg_control = control.buf;
+		msg.msg_controllen = sizeof(control.buf);
+		struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+		memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+	}
+
+	// client may have gone, reply is just dropped then.
+	sendmsg(conn_fd, &msg, MSG_NOSIGNAL);
+}
+
+/* Stores error message in reply */
+static Status reply_error(StegodReply *reply, const char *error)
+{
+	reply->status = e_failure;
+	snprintf(reply->error, sizeof(reply->error), "%s", error);
+	return e_failure;
+}
+
+/* Maps fd if it is sealed against shrinking, else reads it to heap buffer (NULL => failure, mapped => 1 if mapped) */
+static uint8_t *map_fd(int fd, uint64_t len, int writable, int *mapped)
+{
+	// if => fd can't shrink, then mapped bytes are always backed by file.
+	int seals = fcntl(fd, F_GET_SEALS);
+	if(seals != -1 && (seals & F_SEAL_SHRINK))
+	{
+		*mapped = 1;
+		uint8_t *map = mmap(NULL, len, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+		return (map == MAP_FAILED) ? NULL : map;
+	}
+
+	*mapped = 0;
+	uint8_t *buf = malloc(len);
+	for(uint64_t done = 0; buf != NULL && done < len; )
+	{
+		ssize_t n = pread(fd, buf + done, len - done, done);
+		if(n <= 0)
+		{
+			free(buf);
+			return NULL;
+		}
+		done += n;
+	}
+	return buf;
+}
+
+/* Unmaps or frees buffer of map_fd() */
+static void unmap_fd(uint8_t *map, uint64_t len, int mapped)
+{
+	if(mapped)
+	{
+		munmap(map, len);
+	}
+	else
+	{
+		free(map);
+	}
+}
+
+/* Writes bytes [start, end) of heap buffer of carrier back to its fd (mapped carrier is changed in place) */
+static Status write_back_fd(int fd, const uint8_t *map, uint64_t start, uint64_t end, int mapped)
+{
+	for(uint64_t done = start; !mapped && done < end; )
+	{
+		ssize_t n = pwrite(fd, map + done, end - done, done);
+		if(n <= 0)
+		{
+			return e_failure;
+		}
+		done += n;
+	}
+	return e_success;
+}
+
+/* Maps (or reads) carrier fd, and gets pixel format and capacity from its bmp header */
+static Status map_carrier(int fd, int writable, uint8_t **map, uint64_t *len, int *mapped, PixelFormat *format, uint64_t *data_offset, StegodReply *reply)
+{
+	struct stat st;
+	if(fd == -1 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		return reply_error(reply, "carrier is not a regular file or memfd");
+	}
+	if((uint64_t)st.st_size < BMP_HEADER_SIZE)
+	{
+		return reply_error(reply, "carrier is too small");
+	}
+
+	if(writable && (fcntl(fd, F_GETFL) & O_ACCMODE) == O_RDONLY)
+	{
+		return reply_error(reply, "carrier is not open for writing");
+	}
+
+	*len = st.st_size;
+	*map = map_fd(fd, *len, writable, mapped);
+	if(*map == NULL)
+	{
+		return reply_error(reply, writable ? "carrier can't be mapped read/write" : "carrier can't be mapped");
+	}
+
+	if(stego_bmp_format(*map, format, data_offset) == e_failure)
+	{
+		unmap_fd(*map, *len, *mapped);
+		return reply_error(reply, "carrier is not a 24, 32 or 16 bpp uncompressed bmp image");
+	}
+
+	reply->capacity = (stego_bmp_capacity(*map) - BMP_HEADER_SIZE) / 8;
+	return e_success;
+}
+
+/* Checks that carriers of payload bits [0, nbits) are inside carrier file */
+static Status check_bounds(PixelFormat format, uint64_t data_offset, uint64_t len, uint64_t nbits, StegodReply *reply)
+{
+	if(nbits > 0 && data_offset + lsb_carrier_offset(format, nbits - 1) >= len)
+	{
+		return reply_error(reply, "carrier file is shorter than its bmp header says");
+	}
+	return e_success;
+}
+
+/* Encodes secret data fd into carrier fd in place */
+static Status job_encode(StegodJob *job, StegodReply *reply)
+{
+	uint8_t *map, *secret = NULL;
+	uint64_t len, data_offset;
+	int mapped, secret_mapped = 0;
+	PixelFormat format;
+	StegoHeader hdr;
+	uint8_t header[STEGO_HEADER_MAX];
+	struct stat st;
+
+	if(job->fds[1] == -1 || fstat(job->fds[1], &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		return reply_error(reply, "secret data is not a regular file or memfd");
+	}
+	// same empty check as check_capacity().
+	if(st.st_size <= 1)
+	{
+		return reply_error(reply, "secret data is empty");
+	}
+	if((job->req.flags & FLAG_ENCRYPTED) && !daemon_has_key)
+	{
+		return reply_error(reply, "daemon has no encryption key");
+	}
+	if((job->req.flags & ~FLAG_ENCRYPTED) != 0 || strnlen(job->req.extn, STEGO_EXTN_MAX + 1) > STEGO_EXTN_MAX)
+	{
+		return reply_error(reply, "invalid flags or secret file extension");
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.flags = job->req.flags;
+	hdr.extn_size = strlen(job->req.extn);
+	memcpy(hdr.extn, job->req.extn, hdr.extn_size);
+	hdr.data_size = st.st_size;
+	if((hdr.flags & FLAG_ENCRYPTED) && cipher_make_nonce(hdr.nonce) == e_failure)
+	{
+		return reply_error(reply, "unable to generate nonce");
+	}
+	uint header_len = stego_write_header(&hdr, header);
+
+	if(map_carrier(job->fds[0], 1, &map, &len, &mapped, &format, &data_offset, reply) == e_failure)
+	{
+		return e_failure;
+	}
+
+	// if => header and secret data doesn't fit in image, or in carrier file.
+	uint64_t nbits = (header_len + hdr.data_size) * 8;
+	if(stego_required_size(&hdr) >= stego_bmp_capacity(map))
+	{
+		unmap_fd(map, len, mapped);
+		return reply_error(reply, "carrier doesn't have the capacity to encode secret data");
+	}
+	if(check_bounds(format, data_offset, len, nbits, reply) == e_failure)
+	{
+		unmap_fd(map, len, mapped);
+		return e_failure;
+	}
+
+	if(hdr.data_size > 0)
+	{
+		secret = map_fd(job->fds[1], hdr.data_size, 0, &secret_mapped);
+		if(secret == NULL)
+		{
+			unmap_fd(map, len, mapped);
+			return reply_error(reply, "secret data can't be mapped");
+		}
+	}
+
+	// header, then secret data as it is or encrypted chunk by chunk.
+	// if => daemon runs with --verify, then each part is decoded again from carrier after it is encoded.
+	uint8_t *image = map + data_offset;
+	int verified = 1;
+	lsb_embed_pixels(format, image, header, 0, header_len * 8);
+	verified &= !options.verify || lsb_verify_pixels(format, image, header, 0, header_len * 8);
+	uint64_t bit_pos = (uint64_t)header_len * 8;
+	if(hdr.flags & FLAG_ENCRYPTED)
+	{
+		uint8_t chunk[STEGOD_CHUNK_SIZE];
+		CipherCtx cipher;
+		cipher_init(&cipher, daemon_key, hdr.nonce);
+		for(uint64_t done = 0; done < hdr.data_size; )
+		{
+			size_t n = (hdr.data_size - done < STEGOD_CHUNK_SIZE) ? hdr.data_size - done : STEGOD_CHUNK_SIZE;
+			memcpy(chunk, secret + done, n);
+			cipher_xor(&cipher, chunk, n);
+			lsb_embed_pixels(format, image + lsb_carrier_offset(format, bit_pos), chunk, bit_pos, n * 8);
+			verified &= !options.verify || lsb_verify_pixels(format, image + lsb_carrier_offset(format, bit_pos), chunk, bit_pos, n * 8);
+			bit_pos += n * 8;
+			done += n;
+		}
+	}
+	else if(hdr.data_size > 0)
+	{
+		lsb_embed_pixels(format, image + lsb_carrier_offset(format, bit_pos), secret, bit_pos, hdr.data_size * 8);
+		verified &= !options.verify || lsb_verify_pixels(format, image + lsb_carrier_offset(format, bit_pos), secret, bit_pos, hdr.data_size * 8);
+	}
+
+	// if => carrier was read to heap buffer, then changed carrier bytes are written back.
+	Status written = write_back_fd(job->fds[0], map, data_offset, data_offset + lsb_carrier_offset(format, nbits - 1) + 1, mapped);
+	if(secret != NULL)
+	{
+		unmap_fd(secret, hdr.data_size, secret_mapped);
+	}
+	unmap_fd(map, len, mapped);
+
+	if(written == e_failure)
+	{
+		return reply_error(reply, "encoded carrier can't be written");
+	}
+	if(!verified)
+	{
+		return reply_error(reply, "verify failed, encoded bits don't match payload");
+	}
+	reply->flags = hdr.flags;
+	memcpy(reply->extn, hdr.extn, hdr.extn_size + 1);
+	reply->data_size = hdr.data_size;
+	return e_success;
+}
+
+/* Decodes header from carrier, and secret data into new memfd if out_fd is not NULL */
+static Status job_decode(StegodJob *job, StegodReply *reply, int *out_fd)
+{
+	uint8_t *map;
+	uint64_t len, data_offset;
+	int mapped;
+	PixelFormat format;
+	StegoHeader hdr;
+	uint8_t header[STEGO_HEADER_MAX];
+
+	if(map_carrier(job->fds[0], 0, &map, &len, &mapped, &format, &data_offset, reply) == e_failure)
+	{
+		return e_failure;
+	}
+
+	// header is decoded from as many bytes as carrier has, up to its maximum size.
+	uint avail = STEGO_HEADER_MAX;
+	while(avail > 0 && data_offset + lsb_carrier_offset(format, (uint64_t)avail * 8 - 1) >= len)
+	{
+		avail--;
+	}
+	lsb_extract_pixels(format, map + data_offset, header, 0, avail * 8);
+	if(stego_read_header(header, avail, &hdr) == e_failure)
+	{
+		unmap_fd(map, len, mapped);
+		return reply_error(reply, "carrier has no valid stego header");
+	}
+
+	reply->flags = hdr.flags;
+	memcpy(reply->extn, hdr.extn, hdr.extn_size + 1);
+	reply->data_size = hdr.data_size;
+
+	uint64_t nbits = (hdr.header_size + hdr.data_size) * 8;
+	if(hdr.data_size > reply->capacity || check_bounds(format, data_offset, len, nbits, reply) == e_failure)
+	{
+		unmap_fd(map, len, mapped);
+		return reply_error(reply, "secret data size is more than carrier holds");
+	}
+	if((hdr.flags & FLAG_ENCRYPTED) && out_fd != NULL && !daemon_has_key)
+	{
+		unmap_fd(map, len, mapped);
+		return reply_error(reply, "daemon has no decryption key");
+	}
+
+	// if => query, then only header is needed.
+	if(out_fd == NULL)
+	{
+		unmap_fd(map, len, mapped);
+		return e_success;
+	}
+
+	int fd = memfd_create("stegod-secret", MFD_CLOEXEC);
+	uint8_t *data = MAP_FAILED;
+	if(fd != -1 && ftruncate(fd, hdr.data_size) == 0)
+	{
+		data = (hdr.data_size > 0) ? mmap(NULL, hdr.data_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : NULL;
+	}
+	if(fd == -1 || data == MAP_FAILED)
+	{
+		if(fd != -1)
+		{
+			close(fd);
+		}
+		unmap_fd(map, len, mapped);
+		return reply_error(reply, "unable to create memfd for secret data");
+	}
+
+	if(hdr.data_size > 0)
+	{
+		// secret data starts after header, at payload bit header_size * 8.
+		uint64_t bit_pos = (uint64_t)hdr.header_size * 8;
+		lsb_extract_pixels(format, map + data_offset + lsb_carrier_offset(format, bit_pos), data, bit_pos, hdr.data_size * 8);
+		if(hdr.flags & FLAG_ENCRYPTED)
+		{
+			CipherCtx cipher;
+			cipher_init(&cipher, daemon_key, hdr.nonce);
+			cipher_xor(&cipher, data, hdr.data_size);
+		}
+		munmap(data, hdr.data_size);
+	}
+	unmap_fd(map, len, mapped);
+
+	*out_fd = fd;
+	return e_success;
+}
+
+/* Worker thread, does jobs from queue till NULL job */
+static void *stegod_worker(void *arg)
+{
+	(void)arg;
+	StegodJob *job;
+
+	while((job = queue_pop(&queue)) != NULL)
+	{
+		StegodReply reply;
+		int out_fd = -1;
+
+		memset(&reply, 0, sizeof(reply));
+		reply.magic = STEGOD_MAGIC;
+		reply.id = job->req.id;
+		reply.status = e_success;
+
+		if(job->req.op == STEGOD_ENCODE)
+		{
+			job_encode(job, &reply);
+		}
+		else if(job->req.op == STEGOD_DECODE)
+		{
+			job_decode(job, &reply, &out_fd);
+		}
+		else if(job->req.op == STEGOD_QUERY)
+		{
+			job_decode(job, &reply, NULL);
+		}
+		else
+		{
+			reply_error(&reply, "unknown request");
+		}
+
+		send_reply(job->conn_fd, &reply, out_fd);
+
+		if(out_fd != -1)
+		{
+			close(out_fd);
+		}
+		for(int i=0; i<2; i++)
+		{
+			if(job->fds[i] != -1)
+			{
+				close(job->fds[i]);
+			}
+		}
+		close(job->conn_fd);
+		free(job);
+	}
+
+	return NULL;
+}
+
+/* Receives one request from client, returns e_failure if client has closed */
+static Status receive_request(int conn_fd)
+{
+	StegodJob *job = malloc(sizeof(StegodJob));
+	if(job == NULL)
+	{
+		return e_failure;
+	}
+
+	struct iovec iov = { &job->req, sizeof(job->req) };
+	union
+	{
+		struct cmsghdr hdr;
+		char buf[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+	struct msghdr msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	ssize_t n = recvmsg(conn_fd, &msg, MSG_CMSG_CLOEXEC);
+	if(n <= 0)
+	{
+		free(job);
+		return e_failure;
+	}
+
+	// passed fds are taken first, so they are closed even if request is wrong.
+	job->fds[0] = job->fds[1] = -1;
+	for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+	{
+		if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+		{
+			int nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+			memcpy(job->fds, CMSG_DATA(cmsg), (nfds > 2 ? 2 : nfds) * sizeof(int));
+		}
+	}
+
+	if(n != sizeof(job->req) || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) || job->req.magic != STEGOD_MAGIC)
+	{
+		job->req.op = 0;
+	}
+	job->req.extn[STEGO_EXTN_MAX] = '\0';
+
+	job->conn_fd = dup(conn_fd);
+	if(job->conn_fd == -1 || queue_push(&queue, job) == e_failure)
+	{
+		// if => queue is full, then client gets busy reply.
+		StegodReply reply;
+		memset(&reply, 0, sizeof(reply));
+		reply.magic = STEGOD_MAGIC;
+		reply.id = job->req.id;
+		reply_error(&reply, "daemon is busy");
+		send_reply(conn_fd, &reply, -1);
+
+		for(int i=0; i<2; i++)
+		{
+			if(job->fds[i] != -1)
+			{
+				close(job->fds[i]);
+			}
+		}
+		if(job->conn_fd != -1)
+		{
+			close(job->conn_fd);
+		}
+		free(job);
+	}
+
+	return e_success;
+}
+
+/* Stops accept loop */
+static void stegod_signal(int sig)
+{
+	(void)sig;
+	daemon_stop = 1;
+}
+
+/* Listen on socket and do requests till SIGINT/SIGTERM */
+Status do_daemon(const char *socket_path)
+{
+	struct sockaddr_un addr;
+
+	if(strlen(socket_path) >= sizeof(addr.sun_path))
+	{
+		printf("ERROR: Socket path %s is too long.\n", socket_path);
+		return e_failure;
+	}
+
+	// key is loaded once if => --encrypt or --key-file, else encrypted requests fail with no key.
+	if(options.encrypt)
+	{
+		if(cipher_load_key(options.key_fname, daemon_key) == e_failure)
+		{
+			return e_failure;
+		}
+		daemon_has_key = 1;
+	}
+
+	int listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if(listen_fd == -1)
+	{
+		perror("socket");
+		return e_failure;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socket_path);
+
+	// socket file is made only for owner.
+	mode_t old_mask = umask(077);
+	int ret = bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+	umask(old_mask);
+	if(ret != 0 || listen(listen_fd, STEGOD_MAX_CLIENTS) != 0)
+	{
+		printf("ERROR: Unable to listen on %s : %s\n", socket_path, strerror(errno));
+		close(listen_fd);
+		return e_failure;
+	}
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = stegod_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	queue_init(&queue);
+	int nworkers = (options.threads > 0) ? options.threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if(nworkers < 1)
+	{
+		nworkers = 1;
+	}
+	pthread_t workers[nworkers];
+	for(int i=0; i<nworkers; i++)
+	{
+		pthread_create(&workers[i], NULL, stegod_worker, NULL);
+	}
+
+	print_info("INFO: Daemon listening on %s with %d workers\n", socket_path, nworkers);
+
+	// pfds[0] is listening socket, then connected clients.
+	struct pollfd pfds[STEGOD_MAX_CLIENTS + 1];
+	int nfds = 1;
+	pfds[0].fd = listen_fd;
+	pfds[0].events = POLLIN;
+
+	while(!daemon_stop)
+	{
+		if(poll(pfds, nfds, -1) < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			perror("poll");
+			break;
+		}
+
+		for(int i=nfds-1; i>=1; i--)
+		{
+			// if => client has sent request, or has closed.
+			if(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))
+			{
+				if(!(pfds[i].revents & POLLIN) || receive_request(pfds[i].fd) == e_failure)
+				{
+					close(pfds[i].fd);
+					pfds[i] = pfds[--nfds];
+				}
+			}
+		}
+
+		if(pfds[0].revents & POLLIN)
+		{
+			int conn_fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+			if(conn_fd != -1)
+			{
+				if(nfds == STEGOD_MAX_CLIENTS + 1)
+				{
+					close(conn_fd);
+				}
+				else
+				{
+					pfds[nfds].fd = conn_fd;
+					pfds[nfds].events = POLLIN;
+					pfds[nfds].revents = 0;
+					nfds++;
+				}
+			}
+		}
+	}
+
+	// workers finish queued jobs, then stop on NULL jobs.
+	for(int i=0; i<nworkers; i++)
+	{
+		while(queue_push(&queue, NULL) == e_failure)
+		{
+			usleep(1000);
+		}
+	}
+	for(int i=0; i<nworkers; i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+	for(int i=1; i<nfds; i++)
+	{
+		close(pfds[i].fd);
+	}
+	close(listen_fd);
+	unlink(socket_path);
+
+	print_info("INFO: Daemon stopped\n");
+	return e_success;
+}
@@ -0,0 +1,91 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Stego Daemon over UNIX Socket
+ *
+ *                              -> ./a.out --daemon=<socket_path> keeps running and does encode/decode/query requests from local clients.
+ *                              -> Requests and replies are single messages on a SOCK_SEQPACKET UNIX socket (socket is made only for owner).
+ *                              -> Carrier and payload bytes are not sent on socket, file descriptors (memfd or file) are passed with
+ *                                 SCM_RIGHTS. Memfds sealed with F_SEAL_SHRINK are mapped by daemon, so image bytes are never copied
+ *                                 between processes, other fds are read and written with pread/pwrite (a mapped file which client
+ *                                 truncates would kill daemon with SIGBUS).
+ *                              -> Encode changes LSB of carrier in place (client gives a copy of image), decode gives back a new memfd
+ *                                 with secret data, query only decodes header.
+ *                              -> Main thread polls socket and pushes jobs to a lock-free bounded queue, worker threads (--threads=<n>)
+ *                                 pop jobs and send reply on same connection, so one client can have many requests in flight.
+ *                              -> No INFO messages are printed per request, errors are sent back in reply.
+ *                              -> With --encrypt (or --key-file=<file>), encryption key (key file or STEGO_KEY) is loaded once when daemon
+ *                                 starts, without it encrypted requests are answered with an error.
+ */
+
+
+
+
+#ifndef STEGOD_H
+#define STEGOD_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+#include "stego.h"
+
+/* First word of every request and reply */
+#define STEGOD_MAGIC 0x53544744u
+
+/* Request types */
+#define STEGOD_ENCODE 1			// => fds : carrier (read/write), secret data (read)
+#define STEGOD_DECODE 2			// => fds : carrier (read), reply has secret data memfd
+#define STEGOD_QUERY 3			// => fds : carrier (read), only header is decoded
+
+/* Maximum clients connected at same time */
+#define STEGOD_MAX_CLIENTS 64
+
+/* Jobs in queue (power of 2) */
+#define STEGOD_QUEUE_SIZE 256
+
+/* Secret data is encrypted in chunks of this size before encoding */
+#define STEGOD_CHUNK_SIZE (64 * 1024)
+
+/* Error message size of reply */
+#define STEGOD_ERROR_SIZE 128
+
+/*
+ * Request message, carrier and secret data
+ * sizes are taken from passed fds
+ */
+
+typedef struct _StegodRequest
+{
+    uint32_t magic;			// => STEGOD_MAGIC
+    uint32_t op;			// => STEGOD_ENCODE, STEGOD_DECODE or STEGOD_QUERY
+    uint64_t id;			// => copied to reply, to match replies of requests in flight
+    uint32_t flags;			// => FLAG_* bits for encode (FLAG_ENCRYPTED)
+    char extn[STEGO_EXTN_MAX + 1];	// => secret file extension for encode
+
+} StegodRequest;
+
+/*
+ * Reply message, decode has secret data memfd passed with it
+ */
+
+typedef struct _StegodReply
+{
+    uint32_t magic;			// => STEGOD_MAGIC
+    uint32_t status;			// => e_success or e_failure
+    uint64_t id;			// => id of request
+    uint32_t flags;			// => FLAG_* bits of header
+    char extn[STEGO_EXTN_MAX + 1];	// => secret file extension
+    uint64_t data_size;			// => secret file size
+    uint64_t capacity;			// => no. of payload bytes carrier can hold
+    char error[STEGOD_ERROR_SIZE];	// => error message if e_failure
+
+} StegodReply;
+
+
+/* Daemon function prototypes */
+
+/* Listen on socket and do requests till SIGINT/SIGTERM */
+Status do_daemon(const char *socket_path);
+
+#endif
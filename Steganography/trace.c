@@ -0,0 +1,301 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Trace-event Timeline
+ *
+ *                              -> With --trace=<file>, begin and end of every stage (STATS_STAGE), batch job, and block read/process/write
+ *                                 of batch and pipeline threads are recorded with monotonic clock and thread id.
+ *                              -> Each thread appends events to its own buffer (thread local), buffers are only linked into a global list
+ *                                 with compare-and-swap when they are made, so recording takes no lock and threads don't wait on each other.
+ *                              -> At exit, all buffers are written to file as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev),
+ *                                 one track per thread, so overlap of jobs and stages across threads can be seen.
+ *                              -> Jobs of io_uring batch engine overlap on one thread, so they are async events (matched by job id).
+ *                              -> When trace is not asked, trace_begin() and trace_end() return immediately.
+ */
+
+
+
+
+#define _GNU_SOURCE		// syscall()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "trace.h"
+#include "options.h"
+#include "types.h"
+
+/* Buffers of all threads, new buffers are pushed at head */
+static TraceBuffer *trace_list;
+
+/* Current buffer of calling thread */
+static __thread TraceBuffer *trace_local;
+
+/* Clock at start of run, event times are relative to it */
+static uint64_t trace_begin_ns;
+
+/* Events not recorded because buffer couldn't be allocated */
+static uint64_t trace_dropped;
+
+/* Trace file, opened at start so a wrong path is known before run */
+static FILE *trace_fptr;
+
+/* Function Definitions */
+
+/* Monotonic clock in nanoseconds */
+static uint64_t trace_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+
+/* Gets buffer of calling thread with space for one event, a new buffer is made if it is full (NULL => out of memory) */
+static TraceBuffer *trace_buffer(void)
+{
+	TraceBuffer *buf = trace_local;
+	if(buf != NULL && buf->count < TRACE_BUFFER_EVENTS)
+	{
+		return buf;
+	}
+
+	TraceBuffer *fresh = malloc(sizeof(TraceBuffer));
+	if(fresh == NULL)
+	{
+		__atomic_add_fetch(&trace_dropped, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	fresh->tid = syscall(SYS_gettid);
+	fresh->count = 0;
+	// thread name is only kept in first buffer of thread, so it is written once.
+	fresh->thread_name[0] = '\0';
+
+	// only list head is shared, it is swapped in with compare-and-swap (retried if other thread pushed meanwhile).
+	fresh->next = __atomic_load_n(&trace_list, __ATOMIC_RELAXED);
+	while(!__atomic_compare_exchange_n(&trace_list, &fresh->next, fresh, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+	{
+	}
+	trace_local = fresh;
+	return fresh;
+}
+
+
+
+/* Appends one event to buffer of calling thread */
+static void trace_record(char phase, const char *name, uint64_t id, const char *detail, Status status)
+{
+	TraceBuffer *buf = trace_buffer();
+	if(buf == NULL)
+	{
+		return;
+	}
+	TraceEvent *ev = &buf->events[buf->count++];
+	ev->time_ns = trace_now();
+	ev->name = name;
+	ev->id = id;
+	ev->phase = phase;
+	ev->status = (status == e_failure);
+	snprintf(ev->detail, TRACE_DETAIL_SIZE, "%s", (detail != NULL) ? detail : "");
+}
+
+
+
+/* Writes string as JSON string */
+static void trace_print_string(FILE *fptr, const char *str)
+{
+	fputc('"', fptr);
+	for(; *str != '\0'; str++)
+	{
+		if(*str == '"' || *str == '\\')
+		{
+			fputc('\\', fptr);
+			fputc(*str, fptr);
+		}
+		else if((unsigned char)*str < 0x20)
+		{
+			fprintf(fptr, "\\u%04x", (unsigned char)*str);
+		}
+		else
+		{
+			fputc(*str, fptr);
+		}
+	}
+	fputc('"', fptr);
+}
+
+
+
+/* Writes all buffers to trace file and frees them, registered with atexit() */
+static void trace_write(void)
+{
+	FILE *fptr = trace_fptr;
+	TraceBuffer *list = NULL;
+
+	// list is reversed, so buffers are in order they were made, and events of a thread stay in time order.
+	while(trace_list != NULL)
+	{
+		TraceBuffer *next = trace_list->next;
+		trace_list->next = list;
+		list = trace_list;
+		trace_list = next;
+	}
+	trace_list = list;
+
+	long pid = getpid();
+	uint64_t written = 0;
+	fprintf(fptr, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	fprintf(fptr, "{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": %ld, \"tid\": %ld, \"args\": {\"name\": \"stego\"}}", pid, pid);
+
+	for(TraceBuffer *buf = trace_list; buf != NULL; buf = buf->next)
+	{
+		if(buf->thread_name[0] != '\0')
+		{
+			fprintf(fptr, ",\n{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": %ld, \"tid\": %ld, \"args\": {\"name\": ", pid, buf->tid);
+			trace_print_string(fptr, buf->thread_name);
+			fprintf(fptr, "}}");
+		}
+		for(int i=0; i<buf->count; i++)
+		{
+			TraceEvent *ev = &buf->events[i];
+			// ts is in microseconds, async events need category and id to be matched.
+			fprintf(fptr, ",\n{\"ph\": \"%c\", \"name\": ", ev->phase);
+			trace_print_string(fptr, ev->name);
+			fprintf(fptr, ", \"cat\": \"stego\", \"pid\": %ld, \"tid\": %ld, \"ts\": %.3f", pid, buf->tid, (ev->time_ns - trace_begin_ns) / 1000.0);
+			if(ev->phase == 'b' || ev->phase == 'e')
+			{
+				fprintf(fptr, ", \"id\": %llu", (unsigned long long)ev->id);
+			}
+			if(ev->detail[0] != '\0')
+			{
+				fprintf(fptr, ", \"args\": {\"file\": ");
+				trace_print_string(fptr, ev->detail);
+				fprintf(fptr, "}");
+			}
+			else if(ev->phase == 'E' || ev->phase == 'e')
+			{
+				fprintf(fptr, ", \"args\": {\"status\": \"%s\"}", ev->status ? "failure" : "success");
+			}
+			fprintf(fptr, "}");
+			written++;
+		}
+	}
+	fprintf(fptr, "\n]}\n");
+
+	if(fclose(fptr) != 0)
+	{
+		perror("fclose");
+		printf("ERROR: Unable to write trace file %s\n", options.trace_fname);
+	}
+	else
+	{
+		print_info("INFO: Trace of %llu events written to %s\n", (unsigned long long)written, options.trace_fname);
+	}
+	if(trace_dropped > 0)
+	{
+		printf("ERROR: %llu trace events dropped, out of memory.\n", (unsigned long long)trace_dropped);
+	}
+
+	while(trace_list != NULL)
+	{
+		TraceBuffer *next = trace_list->next;
+		free(trace_list);
+		trace_list = next;
+	}
+	trace_local = NULL;
+}
+
+
+
+/* Starts trace of whole run */
+void trace_start(void)
+{
+	if(options.trace_fname == NULL)
+	{
+		return;
+	}
+	trace_fptr = fopen(options.trace_fname, "w");
+	// if => trace file can't be made, then run is done without trace.
+	if(trace_fptr == NULL)
+	{
+		perror("fopen");
+		printf("ERROR: Unable to open trace file %s, tracing is off.\n", options.trace_fname);
+		options.trace_fname = NULL;
+		return;
+	}
+	trace_begin_ns = trace_now();
+	atexit(trace_write);
+	trace_thread("main");
+}
+
+
+
+/* Names calling thread in trace */
+void trace_thread(const char *name)
+{
+	if(options.trace_fname == NULL)
+	{
+		return;
+	}
+	TraceBuffer *buf = trace_buffer();
+	if(buf != NULL)
+	{
+		snprintf(buf->thread_name, TRACE_THREAD_NAME_SIZE, "%s", name);
+	}
+}
+
+
+
+/* Begins an event of calling thread */
+void trace_begin(const char *name, const char *detail)
+{
+	if(options.trace_fname == NULL)
+	{
+		return;
+	}
+	trace_record('B', name, 0, detail, e_success);
+}
+
+
+
+/* Ends last begun event of calling thread, status is returned as it is */
+Status trace_end(Status status)
+{
+	if(options.trace_fname == NULL)
+	{
+		return status;
+	}
+	// end events are matched with begin events by order, so name is not needed.
+	trace_record('E', "", 0, NULL, status);
+	return status;
+}
+
+
+
+/* Begins an async event */
+void trace_async_begin(const char *name, uint64_t id, const char *detail)
+{
+	if(options.trace_fname == NULL)
+	{
+		return;
+	}
+	trace_record('b', name, id, detail, e_success);
+}
+
+
+
+/* Ends async event of same name and id */
+void trace_async_end(const char *name, uint64_t id, Status status)
+{
+	if(options.trace_fname == NULL)
+	{
+		return;
+	}
+	trace_record('e', name, id, NULL, status);
+}
@@ -0,0 +1,83 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Trace-event Timeline
+ *
+ *                              -> With --trace=<file>, begin and end of every stage (STATS_STAGE), batch job, and block read/process/write
+ *                                 of batch and pipeline threads are recorded with monotonic clock and thread id.
+ *                              -> Each thread appends events to its own buffer (thread local), buffers are only linked into a global list
+ *                                 with compare-and-swap when they are made, so recording takes no lock and threads don't wait on each other.
+ *                              -> At exit, all buffers are written to file as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev),
+ *                                 one track per thread, so overlap of jobs and stages across threads can be seen.
+ *                              -> Jobs of io_uring batch engine overlap on one thread, so they are async events (matched by job id).
+ *                              -> When trace is not asked, trace_begin() and trace_end() return immediately.
+ */
+
+
+
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+
+/* No. of events in one thread buffer, full buffer is followed by a new one */
+#define TRACE_BUFFER_EVENTS 4096
+
+/* Max. length of event detail (file name of job) kept in trace */
+#define TRACE_DETAIL_SIZE 64
+
+/* Max. length of thread name */
+#define TRACE_THREAD_NAME_SIZE 32
+
+/* Runs one function call between trace_begin() and trace_end(), value is Status of call */
+#define TRACE_STAGE(name, call)	(trace_begin(name, NULL), trace_end(call))
+
+/* One begin or end event */
+typedef struct _TraceEvent
+{
+    uint64_t time_ns;				// => monotonic clock in nanoseconds
+    const char *name;				// => Stores event name (string literal)
+    uint64_t id;				// => async event id (job no.), 0 for others
+    char phase;					// => 'B'/'E' begin/end, 'b'/'e' async begin/end
+    char status;				// => 1 if end event has e_failure
+    char detail[TRACE_DETAIL_SIZE];		// => Stores detail of begin event ("" => none)
+
+} TraceEvent;
+
+/* Events of one thread */
+typedef struct _TraceBuffer
+{
+    struct _TraceBuffer *next;			// => next buffer in global list
+    long tid;					// => thread id of buffer owner
+    char thread_name[TRACE_THREAD_NAME_SIZE];	// => Stores thread name ("" => none)
+    int count;					// => no. of events in buffer
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+
+} TraceBuffer;
+
+
+/* Trace function prototypes */
+
+/* Start trace of whole run, trace file is written at exit */
+void trace_start(void);
+
+/* Name calling thread in trace */
+void trace_thread(const char *name);
+
+/* Begin an event of calling thread, detail is shown as its arg (NULL => none) */
+void trace_begin(const char *name, const char *detail);
+
+/* End last begun event of calling thread, returns status as it is */
+Status trace_end(Status status);
+
+/* Begin an async event, which may overlap other events of same thread */
+void trace_async_begin(const char *name, uint64_t id, const char *detail);
+
+/* End async event of same name and id */
+void trace_async_end(const char *name, uint64_t id, Status status);
+
+#endif
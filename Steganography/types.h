@@ -46,6 +46,8 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <stdint.h>
+
 /* User defined types */
 typedef unsigned int uint;
 
@@ -61,7 +63,18 @@ typedef enum
 {
     e_encode,
     e_decode,
+    e_batch,
+    e_materialize,
+    e_update,
     e_unsupported
 } OperationType;
 
+/* PixelFormat of carrier image, decides which bytes of each pixel have payload bits */
+typedef enum
+{
+    e_bgr24,		// => 3 bytes per pixel, all 3 used (also row padding, as before)
+    e_bgra32,		// => 4 bytes per pixel, alpha byte is skipped
+    e_rgb16		// => 2 bytes per pixel, only low byte (blue lsb) is used
+} PixelFormat;
+
 #endif
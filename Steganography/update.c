@@ -0,0 +1,318 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Incremental Update of Stego Image
+ *
+ *                              -> Stego header is decoded from image first, it should be a plain "#*" or "#+" header (not encrypted).
+ *                              -> New header is made with stego_write_header() for new secret file, and payload is header and then
+ *                                 secret file data, same as encoding.
+ *                              -> For each chunk, carrier bytes are read with pread(), old payload bytes are extracted and compared
+ *                                 with new ones, and if chunk differs, new bytes are encoded into carrier bytes.
+ *                              -> Only runs of changed payload bytes (8 carrier bytes each, 16 for 16 bpp) are written back with pwrite(),
+ *                                 runs closer than UPDATE_MERGE_GAP bytes are joined, so one edit is one pwrite().
+ *                              -> With --verify, encoded bits are checked before chunk is written, and with --metrics changed bytes,
+ *                                 MSE and PSNR are against image before update.
+ *                              -> Image with st_nlink > 1 is copied with pread()/write() to mkstemp() file next to it (copy-on-write),
+ *                                 mode is kept, and rename() puts updated copy in place only after all chunks are written.
+ */
+
+
+
+
+#define _FILE_OFFSET_BITS 64	// 64-bit file offsets, for images bigger than 2 GB
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "update.h"
+#include "stego.h"
+#include "lsb.h"
+#include "stats.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Decodes stego header from carrier bytes of image file */
+static Status update_read_header(int fd, PixelFormat format, uint64_t data_offset, uint64_t file_size, StegoHeader *hdr)
+{
+	uint8_t payload[STEGO_HEADER_MAX];
+	uint8_t span[2 * 8 * STEGO_HEADER_MAX];
+	uint nbytes = STEGO_HEADER_MAX;
+
+	// if => image is smaller than biggest header, then only bytes which have carriers in file are decoded.
+	while(nbytes > 0 && data_offset + lsb_carrier_offset(format, (uint64_t)nbytes * 8 - 1) >= file_size)
+	{
+		nbytes--;
+	}
+	size_t len = lsb_carrier_offset(format, (uint64_t)nbytes * 8 - 1) + 1;
+	if(nbytes == 0 || pread(fd, span, len, data_offset) != (ssize_t)len)
+	{
+		return e_failure;
+	}
+	lsb_extract_pixels(format, span, payload, 0, (size_t)nbytes * 8);
+	return stego_read_header(payload, nbytes, hdr);
+}
+
+/* Gets n payload bytes from offset done : header bytes first, then secret file data */
+static Status update_fill(uint8_t *chunk, size_t n, uint64_t done, const uint8_t *header, uint header_size, FILE *fptr_secret)
+{
+	size_t i = 0;
+	for(; i < n && done + i < header_size; i++)
+	{
+		chunk[i] = header[done + i];
+	}
+	if(i < n && fread(chunk + i, 1, n - i, fptr_secret) != n - i)
+	{
+		printf("ERROR: Secret file is shorter than its size.\n");
+		return e_failure;
+	}
+	return e_success;
+}
+
+/* Encodes payload bytes which differ from decoded ones, and writes only their carrier bytes */
+static Status update_payload(int fd, PixelFormat format, uint64_t data_offset, const uint8_t *header, uint header_size, uint64_t payload_size, FILE *fptr_secret)
+{
+	// carrier bytes of a chunk are at most 2 bytes per bit (16 bpp).
+	static uint8_t chunk[UPDATE_CHUNK_SIZE], old[UPDATE_CHUNK_SIZE];
+	static uint8_t span[2 * 8 * UPDATE_CHUNK_SIZE];
+	uint64_t changed = 0, written = 0;
+
+	for(uint64_t done = 0; done < payload_size; done += UPDATE_CHUNK_SIZE)
+	{
+		size_t n = (payload_size - done < UPDATE_CHUNK_SIZE) ? payload_size - done : UPDATE_CHUNK_SIZE;
+		uint64_t bit_pos = done * 8;
+		uint64_t from = data_offset + lsb_carrier_offset(format, bit_pos);
+		size_t len = data_offset + lsb_carrier_offset(format, bit_pos + n * 8 - 1) + 1 - from;
+		if(update_fill(chunk, n, done, header, header_size, fptr_secret) == e_failure || pread(fd, span, len, from) != (ssize_t)len)
+		{
+			return e_failure;
+		}
+		lsb_extract_pixels(format, span, old, bit_pos, n * 8);
+
+		// if => chunk is same as already encoded one, then nothing is written for it.
+		if(memcmp(chunk, old, n) == 0)
+		{
+			continue;
+		}
+		if(options.metrics)
+		{
+			stats_add_changes(lsb_count_flips(format, 0, span, chunk, bit_pos, n * 8));
+		}
+		lsb_embed_pixels(format, span, chunk, bit_pos, n * 8);
+		// if => --verify, then encoded bits are checked before they are written.
+		if(options.verify && !lsb_verify_pixels(format, span, chunk, bit_pos, n * 8))
+		{
+			printf("ERROR: Verify failed, encoded bits don't match new payload.\n");
+			return e_failure;
+		}
+
+		// each run starts at a changed byte and ends at last changed byte before a gap of more than UPDATE_MERGE_GAP bytes.
+		for(size_t i = 0; i < n; )
+		{
+			if(chunk[i] == old[i])
+			{
+				i++;
+				continue;
+			}
+			size_t last = i;
+			for(size_t j = i + 1; j < n && j - last <= UPDATE_MERGE_GAP; j++)
+			{
+				if(chunk[j] != old[j])
+				{
+					last = j;
+					changed++;
+				}
+			}
+			changed++;
+			uint64_t run_from = data_offset + lsb_carrier_offset(format, (done + i) * 8);
+			size_t run_len = data_offset + lsb_carrier_offset(format, (done + last) * 8 + 7) + 1 - run_from;
+			if(pwrite(fd, span + (run_from - from), run_len, run_from) != (ssize_t)run_len)
+			{
+				perror("pwrite");
+				return e_failure;
+			}
+			written += run_len;
+			i = last + 1;
+		}
+	}
+
+	print_info("INFO: %llu of %llu payload bytes changed, %llu carrier bytes written\n", (unsigned long long)changed, (unsigned long long)payload_size, (unsigned long long)written);
+	return e_success;
+}
+
+/* Copies image file to new temp file of same dir, gives fd of copy (-1 => copy failed, temp file is removed) */
+static int update_private_copy(int fd, const char *fname, const struct stat *st, char *tmp_path)
+{
+	static uint8_t buf[UPDATE_CHUNK_SIZE];
+
+	if(snprintf(tmp_path, UPDATE_PATH_SIZE, "%s.XXXXXX", fname) >= UPDATE_PATH_SIZE)
+	{
+		printf("ERROR: Path of %s is too long.\n", fname);
+		tmp_path[0] = '\0';
+		return -1;
+	}
+	int copy = mkstemp(tmp_path);
+	if(copy == -1)
+	{
+		perror("mkstemp");
+		tmp_path[0] = '\0';
+		return -1;
+	}
+
+	for(uint64_t off = 0; off < (uint64_t)st->st_size; )
+	{
+		ssize_t r = pread(fd, buf, sizeof(buf), off);
+		if(r <= 0 || write(copy, buf, r) != r)
+		{
+			perror("copy");
+			close(copy);
+			unlink(tmp_path);
+			tmp_path[0] = '\0';
+			return -1;
+		}
+		off += r;
+	}
+	fchmod(copy, st->st_mode & 07777);
+	return copy;
+}
+
+/* Update secret file of stego image in place (./a.out -u) */
+Status do_update(char *argv[])
+{
+	uint8_t bmp_header[BMP_HEADER_SIZE];
+	uint8_t header[STEGO_HEADER_MAX];
+	PixelFormat format;
+	uint64_t data_offset;
+	StegoHeader old_hdr, new_hdr;
+	struct stat st, secret_st;
+
+	// image should be .bmp file and secret file .txt/.sh/.c file, same as encode args.
+	char *extn = strstr(argv[3], ".");
+	if(strstr(argv[2], ".") == NULL || strcmp(strstr(argv[2], "."), ".bmp") != 0)
+	{
+		printf("ERROR: %s is not a .bmp file.\n", argv[2]);
+		return e_failure;
+	}
+	if(extn == NULL || (strcmp(extn, ".txt") != 0 && strcmp(extn, ".sh") != 0 && strcmp(extn, ".c") != 0))
+	{
+		printf("ERROR: Secret message file should be .txt/.sh/.c file only.\n");
+		return e_failure;
+	}
+	// if => --encrypt, --channels or --ecc, then whole payload changes (new nonce) or its layout is different, so it can't be updated.
+	if(options.encrypt || options.channels || options.ecc_parity)
+	{
+		printf("ERROR: --encrypt, --channels and --ecc can't be used with -u, encode the image again.\n");
+		return e_failure;
+	}
+
+	print_info("INFO: ## Updating Procedure Started ##\n");
+	int fd = open(argv[2], O_RDWR);
+	if(fd == -1)
+	{
+		perror("open");
+		printf("ERROR: Unable to open file %s\n", argv[2]);
+		return e_failure;
+	}
+	if(fstat(fd, &st) != 0 || pread(fd, bmp_header, BMP_HEADER_SIZE, 0) != BMP_HEADER_SIZE || stego_bmp_format(bmp_header, &format, &data_offset) == e_failure)
+	{
+		printf("ERROR: %s is not a supported .bmp file.\n", argv[2]);
+		close(fd);
+		return e_failure;
+	}
+	if(STATS_STAGE("update_read_header", update_read_header(fd, format, data_offset, st.st_size, &old_hdr)) == e_failure)
+	{
+		printf("ERROR: %s has no stego header, encode it with -e first.\n", argv[2]);
+		close(fd);
+		return e_failure;
+	}
+	if(old_hdr.flags & FLAG_ENCRYPTED)
+	{
+		printf("ERROR: %s is encrypted, it can't be updated without reusing its nonce, encode it again.\n", argv[2]);
+		close(fd);
+		return e_failure;
+	}
+
+	FILE *fptr_secret = fopen(argv[3], "rb");
+	if(fptr_secret == NULL)
+	{
+		perror("fopen");
+		printf("ERROR: Unable to open file %s\n", argv[3]);
+		close(fd);
+		return e_failure;
+	}
+	if(fstat(fileno(fptr_secret), &secret_st) != 0 || !S_ISREG(secret_st.st_mode))
+	{
+		printf("ERROR: Secret file %s should be a regular file.\n", argv[3]);
+		fclose(fptr_secret);
+		close(fd);
+		return e_failure;
+	}
+
+	//if secret file is empty then print empty (same as encoding).
+	if(secret_st.st_size <= 1)
+	{
+		printf("ERROR: %s file is empty\n", argv[3]);
+		fclose(fptr_secret);
+		close(fd);
+		return e_failure;
+	}
+
+	// new header has same fields as encoding of new secret file.
+	memset(&new_hdr, 0, sizeof(new_hdr));
+	new_hdr.extn_size = strlen(extn);
+	memcpy(new_hdr.extn, extn, new_hdr.extn_size);
+	new_hdr.data_size = secret_st.st_size;
+	stego_write_header(&new_hdr, header);
+	uint64_t payload_size = new_hdr.header_size + new_hdr.data_size;
+
+	// if => new payload doesn't fit in image, then image is not touched.
+	if(stego_required_size(&new_hdr) > stego_bmp_capacity(bmp_header) || data_offset + lsb_carrier_offset(format, payload_size * 8 - 1) >= (uint64_t)st.st_size)
+	{
+		printf("ERROR: Image %s doesn't have the capacity to encode %s\n", argv[2], argv[3]);
+		fclose(fptr_secret);
+		close(fd);
+		return e_failure;
+	}
+	if(options.metrics)
+	{
+		stats_set_samples(stego_bmp_capacity(bmp_header) - BMP_HEADER_SIZE);
+	}
+
+	// if => image has other hard links, then they share its data, so a private copy is updated and renamed over image.
+	char tmp_path[UPDATE_PATH_SIZE] = "";
+	if(st.st_nlink > 1)
+	{
+		print_info("INFO: %s has %lu hard links, it is copied before update\n", argv[2], (unsigned long)st.st_nlink);
+		int copy = update_private_copy(fd, argv[2], &st, tmp_path);
+		close(fd);
+		if(copy == -1)
+		{
+			printf("ERROR: Unable to copy %s for update.\n", argv[2]);
+			fclose(fptr_secret);
+			return e_failure;
+		}
+		fd = copy;
+	}
+
+	Status ret = STATS_STAGE("update_payload", update_payload(fd, format, data_offset, header, new_hdr.header_size, payload_size, fptr_secret));
+	fclose(fptr_secret);
+	if(close(fd) != 0 || ret == e_failure || (tmp_path[0] != '\0' && rename(tmp_path, argv[2]) != 0))
+	{
+		if(tmp_path[0] != '\0')
+		{
+			unlink(tmp_path);
+		}
+		printf("ERROR: Updating %s failed.\n", argv[2]);
+		return e_failure;
+	}
+
+	print_info("INFO: Updated %s with %s (%llu bytes, was %llu bytes)\n", argv[2], argv[3], (unsigned long long)new_hdr.data_size, (unsigned long long)old_hdr.data_size);
+	return e_success;
+}
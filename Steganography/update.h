@@ -0,0 +1,42 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Incremental Update of Stego Image
+ *
+ *                              -> ./a.out -u <stego.bmp> <new secret file> changes secret file of already encoded image in place.
+ *                              -> New payload (header and secret data) is compared with payload decoded from image, chunk by chunk,
+ *                                 and only carrier bytes of payload bytes which differ are written back (with pwrite()).
+ *                              -> So a small edit of a big secret file writes only a few carrier bytes, plus carrier bytes of size field.
+ *                              -> Image is same as one encoded from its carrier with new secret file, except LSBs after end of new
+ *                                 payload (old payload is not cleared if new one is shorter, decoding stops at new size anyway).
+ *                              -> If image file has other hard links (e.g. made by ln), it is copied to temp file of same dir, copy is
+ *                                 updated and renamed over image, so other links keep old secret file.
+ *                              -> Encrypted (--encrypt), channel (--channels) and ECC (--ecc) images can't be updated, they should be encoded again.
+ */
+
+
+
+
+#ifndef UPDATE_H
+#define UPDATE_H
+
+#include "types.h" // Contains user defined types
+
+/* Payload bytes compared at a time */
+#define UPDATE_CHUNK_SIZE (64 * 1024)
+
+/* Runs of changed payload bytes which are closer than this are written with one pwrite() */
+#define UPDATE_MERGE_GAP 64
+
+/* Maximum path size of temp copy of image */
+#define UPDATE_PATH_SIZE 4096
+
+
+/* Update function prototypes */
+
+/* Update secret file of stego image in place (./a.out -u) */
+Status do_update(char *argv[]);
+
+#endif
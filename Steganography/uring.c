@@ -0,0 +1,166 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Minimal io_uring Wrapper
+ *
+ *                              -> Used by batch mode to keep many reads and writes in flight across files.
+ *                              -> Built only with -DHAVE_IO_URING, it uses io_uring syscalls directly, so liburing is not needed.
+ *                              -> Submission and completion rings are mmaped, head/tail are accessed with acquire/release atomics.
+ *                              -> Buffers can be registered once and used with READ_FIXED/WRITE_FIXED.
+ */
+
+
+
+
+#ifdef HAVE_IO_URING
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "uring.h"
+#include "types.h"
+
+/* Function Definitions */
+
+/* Sets up io_uring and mmaps submission ring, completion ring and sqe array */
+Status uring_init(Uring *ring, unsigned entries)
+{
+	struct io_uring_params params;
+	memset(ring, 0, sizeof(*ring));
+	memset(&params, 0, sizeof(params));
+
+	ring->ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+	// if => io_uring is not supported or not allowed, then caller uses other engine.
+	if(ring->ring_fd < 0)
+	{
+		return e_failure;
+	}
+
+	ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQ_RING);
+	ring->cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_CQ_RING);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+	if(ring->sq_ptr == MAP_FAILED || ring->cq_ptr == MAP_FAILED || ring->sqes == MAP_FAILED)
+	{
+		uring_exit(ring);
+		return e_failure;
+	}
+
+	char *sq = ring->sq_ptr, *cq = ring->cq_ptr;
+	ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+	ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+	ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+	ring->sq_entries = params.sq_entries;
+	ring->sq_local_tail = *ring->sq_tail;
+
+	ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+	ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+	return e_success;
+}
+
+
+
+/* Registers fixed buffers, so kernel doesn't map pages for every read/write */
+Status uring_register_buffers(Uring *ring, const struct iovec *iovs, unsigned count)
+{
+	if(syscall(__NR_io_uring_register, ring->ring_fd, IORING_REGISTER_BUFFERS, iovs, count) < 0)
+	{
+		return e_failure;
+	}
+	return e_success;
+}
+
+
+
+/* Gets next free sqe, it is cleared before returning */
+struct io_uring_sqe *uring_get_sqe(Uring *ring)
+{
+	unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+	// if => submission ring is full.
+	if(ring->sq_local_tail - head >= ring->sq_entries)
+	{
+		return NULL;
+	}
+
+	unsigned index = ring->sq_local_tail & *ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	ring->sq_array[index] = index;
+	ring->sq_local_tail++;
+	return sqe;
+}
+
+
+
+/* Publishes prepared sqes, submits them and waits for wait_nr completions */
+int uring_submit_and_wait(Uring *ring, unsigned wait_nr)
+{
+	unsigned tail = *ring->sq_tail;
+	unsigned to_submit = ring->sq_local_tail - tail;
+
+	// release store, so kernel sees sqe contents before new tail.
+	__atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+
+	unsigned flags = (wait_nr > 0) ? IORING_ENTER_GETEVENTS : 0;
+	return syscall(__NR_io_uring_enter, ring->ring_fd, to_submit, wait_nr, flags, NULL, 0);
+}
+
+
+
+/* Gets next completion without waiting */
+struct io_uring_cqe *uring_peek_cqe(Uring *ring)
+{
+	unsigned head = *ring->cq_head;
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+	if(head == tail)
+	{
+		return NULL;
+	}
+	return &ring->cqes[head & *ring->cq_mask];
+}
+
+
+
+/* Marks completion as seen, so kernel can reuse the cqe */
+void uring_cqe_seen(Uring *ring)
+{
+	__atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+
+
+/* Unmaps rings and closes io_uring fd */
+void uring_exit(Uring *ring)
+{
+	if(ring->sqes != NULL && ring->sqes != MAP_FAILED)
+	{
+		munmap(ring->sqes, ring->sqes_size);
+	}
+	if(ring->cq_ptr != NULL && ring->cq_ptr != MAP_FAILED)
+	{
+		munmap(ring->cq_ptr, ring->cq_size);
+	}
+	if(ring->sq_ptr != NULL && ring->sq_ptr != MAP_FAILED)
+	{
+		munmap(ring->sq_ptr, ring->sq_size);
+	}
+	if(ring->ring_fd >= 0)
+	{
+		close(ring->ring_fd);
+	}
+	ring->ring_fd = -1;
+}
+
+#endif
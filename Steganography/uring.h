@@ -0,0 +1,77 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Minimal io_uring Wrapper
+ *
+ *                              -> Used by batch mode to keep many reads and writes in flight across files.
+ *                              -> Built only with -DHAVE_IO_URING, it uses io_uring syscalls directly, so liburing is not needed.
+ *                              -> Submission and completion rings are mmaped, head/tail are accessed with acquire/release atomics.
+ *                              -> Buffers can be registered once and used with READ_FIXED/WRITE_FIXED.
+ */
+
+
+
+
+#ifndef URING_H
+#define URING_H
+
+#ifdef HAVE_IO_URING
+
+#include <stddef.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store io_uring fd and mmaped rings
+ */
+
+typedef struct _Uring
+{
+    int ring_fd;				// => io_uring fd
+
+    /* Submission ring */
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned sq_entries;
+    unsigned sq_local_tail;			// => tail including prepared but not submitted sqes
+    struct io_uring_sqe *sqes;
+
+    /* Completion ring */
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    /* mmaped areas */
+    void *sq_ptr, *cq_ptr;
+    size_t sq_size, cq_size, sqes_size;
+
+} Uring;
+
+
+/* io_uring function prototypes */
+
+/* Setup io_uring with given no. of entries */
+Status uring_init(Uring *ring, unsigned entries);
+
+/* Register fixed buffers */
+Status uring_register_buffers(Uring *ring, const struct iovec *iovs, unsigned count);
+
+/* Get next free sqe, NULL if submission ring is full */
+struct io_uring_sqe *uring_get_sqe(Uring *ring);
+
+/* Submit prepared sqes and wait for at least wait_nr completions */
+int uring_submit_and_wait(Uring *ring, unsigned wait_nr);
+
+/* Get next completion, NULL if none */
+struct io_uring_cqe *uring_peek_cqe(Uring *ring);
+
+/* Mark completion as seen */
+void uring_cqe_seen(Uring *ring);
+
+/* Unmap rings and close io_uring fd */
+void uring_exit(Uring *ring);
+
+#endif
+
+#endif
@@ -0,0 +1,460 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Watch-folder Encoding
+ *
+ *                              -> inotify watch is added before dir is scanned, so a file dropped while scanning is not missed
+ *                                 (it can be queued twice, second job only writes same stego image again).
+ *                              -> Main thread polls inotify fd, each complete secret file (or pair carrier) becomes a WatchJob on
+ *                                 queue, queue is a linked list under mutex and semaphore wakes idle workers (no polling delay).
+ *                              -> Workers run job with batch_run_job() in their own block buffer, batch_job_finish() renames
+ *                                 temp file to stego image name only if encoding is done successfully, else temp file is removed.
+ *                              -> Temp file is in encoded dir, so rename is in same file system and stego image appears at once.
+ *                              -> On SIGINT/SIGTERM, events are no longer read, queued jobs are finished and workers stop.
+ */
+
+
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include "watch.h"
+#include "batch.h"
+#include "lsb.h"
+#include "png.h"
+#include "trace.h"
+#include "common.h"
+#include "options.h"
+#include "types.h"
+
+/* Secret file extensions, same as encode args */
+static const char *watch_extns[] = { ".txt", ".sh", ".c" };
+
+/* Set by SIGINT/SIGTERM */
+static volatile sig_atomic_t watch_stop;
+
+/* Job queue : jobs are appended at tail and taken from head */
+static WatchJob *queue_head;
+static WatchJob *queue_tail;
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static sem_t queue_items;			// => no. of jobs in queue (and one stop per worker at end)
+
+/* Watched dir, encoded dir and carrier file given in args (NULL => pairs only) */
+static const char *watch_dir;
+static char watch_out_dir[WATCH_PATH_SIZE];
+static const char *watch_carrier;
+
+/* No. of jobs queued, used as job no. and in temp file name */
+static int watch_jobs;
+
+/* Function Definitions */
+
+/* Appends job to queue and wakes one worker */
+static void queue_push(WatchJob *wjob)
+{
+	wjob->next = NULL;
+	pthread_mutex_lock(&queue_lock);
+	if(queue_tail == NULL)
+	{
+		queue_head = wjob;
+	}
+	else
+	{
+		queue_tail->next = wjob;
+	}
+	queue_tail = wjob;
+	pthread_mutex_unlock(&queue_lock);
+	sem_post(&queue_items);
+}
+
+
+
+/* Takes job from queue, waits till a job is pushed, NULL means stop */
+static WatchJob *queue_pop(void)
+{
+	while(sem_wait(&queue_items) != 0 && errno == EINTR)
+	{
+	}
+	pthread_mutex_lock(&queue_lock);
+	WatchJob *wjob = queue_head;
+	if(wjob != NULL)
+	{
+		queue_head = wjob->next;
+		if(queue_head == NULL)
+		{
+			queue_tail = NULL;
+		}
+	}
+	pthread_mutex_unlock(&queue_lock);
+	return wjob;
+}
+
+
+
+/* Worker, runs queued jobs till stop */
+static void *watch_worker(void *arg)
+{
+	(void)arg;
+	uint8_t *block = aligned_alloc(BATCH_DIRECT_ALIGN, BATCH_BLOCK_SIZE);
+	// if => block buffer can't be allocated, then this worker stops, jobs are run by other workers.
+	if(block == NULL)
+	{
+		printf("ERROR: Out of memory for block buffer of watch worker.\n");
+		return NULL;
+	}
+	trace_thread("watch worker");
+
+	WatchJob *wjob;
+	while((wjob = queue_pop()) != NULL)
+	{
+		BatchJob *job = &wjob->job;
+		trace_begin("job", wjob->secret_fname);
+		batch_run_job(job, block);
+		trace_begin("batch_job_finish", NULL);
+		batch_job_finish(job);
+		trace_end(job->status);
+		trace_end(job->status);
+		free(wjob);
+	}
+	free(block);
+	return NULL;
+}
+
+
+
+/* Gets secret file extension of file name (NULL => not a secret file) */
+static const char *watch_secret_extn(const char *name)
+{
+	const char *dot = strrchr(name, '.');
+	if(dot == NULL || dot == name)
+	{
+		return NULL;
+	}
+	for(uint i=0; i<sizeof(watch_extns) / sizeof(watch_extns[0]); i++)
+	{
+		if(strcmp(dot, watch_extns[i]) == 0)
+		{
+			return watch_extns[i];
+		}
+	}
+	return NULL;
+}
+
+
+
+/* Makes path of dir and name without its last cut bytes, followed by suffix (0 => path is too long) */
+static int watch_path(char *path, const char *dir, const char *name, size_t cut, const char *suffix)
+{
+	int len = snprintf(path, WATCH_PATH_SIZE, "%s/%.*s%s", dir, (int)(strlen(name) - cut), name, suffix);
+	return (len > 0 && len < WATCH_PATH_SIZE);
+}
+
+
+
+/* Queues encoding of secret file name of watched dir */
+static void watch_queue_secret(const char *name, const char *extn)
+{
+	WatchJob *wjob = calloc(1, sizeof(WatchJob));
+	if(wjob == NULL)
+	{
+		printf("ERROR: Out of memory for %s\n", name);
+		return;
+	}
+	BatchJob *job = &wjob->job;
+	size_t cut = strlen(extn);
+
+	// if => pair carrier <name>.bmp is in dir, then it is used, else carrier given in args.
+	struct stat st;
+	int ok = watch_path(wjob->secret_fname, watch_dir, name, 0, "") && watch_path(wjob->carrier_fname, watch_dir, name, cut, ".bmp");
+	if(ok && stat(wjob->carrier_fname, &st) != 0)
+	{
+		if(watch_carrier == NULL)
+		{
+			print_info("INFO: %s is waiting for its carrier %s\n", wjob->secret_fname, wjob->carrier_fname);
+			free(wjob);
+			return;
+		}
+		ok = (snprintf(wjob->carrier_fname, WATCH_PATH_SIZE, "%s", watch_carrier) < WATCH_PATH_SIZE);
+	}
+
+	// stego image is written to hidden temp file of encoded dir, and renamed when it is complete.
+	int seq = ++watch_jobs;
+	ok = ok && watch_path(job->final_fname, watch_out_dir, name, cut, ".bmp");
+	ok = ok && snprintf(wjob->temp_fname, WATCH_PATH_SIZE, "%s/.%.*s.%d.tmp", watch_out_dir, (int)(strlen(name) - cut), name, seq) < WATCH_PATH_SIZE;
+	if(ok == 0)
+	{
+		printf("ERROR: Path of %s is too long.\n", name);
+		free(wjob);
+		return;
+	}
+
+	// same job fields as a batch line "-e <carrier> <secret> <temp>".
+	job->line_no = seq;
+	job->fd_in = job->fd_out = -1;
+	job->status = e_success;
+	job->direct = options.direct;
+	job->type = e_encode;
+	job->args[0] = "watch";
+	job->args[1] = "-e";
+	job->args[2] = wjob->carrier_fname;
+	job->args[3] = wjob->secret_fname;
+	job->args[4] = wjob->temp_fname;
+	job->encInfo.src_image_fname = wjob->carrier_fname;
+	job->encInfo.extn_image_file = ".bmp";
+	job->encInfo.secret_fname = wjob->secret_fname;
+	job->encInfo.extn_secret_file = (char *)extn;
+	job->encInfo.stego_image_fname = wjob->temp_fname;
+
+	queue_push(wjob);
+}
+
+
+
+/* Handles a complete file of watched dir */
+static void watch_file(const char *name)
+{
+	// hidden files are temp files of writers, they are renamed to real name when done.
+	if(name[0] == '.')
+	{
+		return;
+	}
+
+	const char *extn = watch_secret_extn(name);
+	if(extn != NULL)
+	{
+		watch_queue_secret(name, extn);
+		return;
+	}
+
+	// if => pair carrier, then secret files of same name are encoded in it.
+	size_t len = strlen(name);
+	if(len > 4 && strcmp(name + len - 4, ".bmp") == 0)
+	{
+		for(uint i=0; i<sizeof(watch_extns) / sizeof(watch_extns[0]); i++)
+		{
+			char path[WATCH_PATH_SIZE];
+			struct stat st;
+			if(watch_path(path, watch_dir, name, 4, watch_extns[i]) && stat(path, &st) == 0 && S_ISREG(st.st_mode))
+			{
+				watch_queue_secret(strrchr(path, '/') + 1, watch_extns[i]);
+			}
+		}
+	}
+}
+
+
+
+/* Queues secret files of dir which don't have stego image yet */
+static Status watch_scan(void)
+{
+	DIR *dp = opendir(watch_dir);
+	if(dp == NULL)
+	{
+		perror("opendir");
+		printf("ERROR: Unable to open dir %s\n", watch_dir);
+		return e_failure;
+	}
+
+	struct dirent *de;
+	while((de = readdir(dp)) != NULL)
+	{
+		const char *extn = watch_secret_extn(de->d_name);
+		char out_fname[WATCH_PATH_SIZE];
+		struct stat st;
+		if(de->d_name[0] == '.' || extn == NULL)
+		{
+			continue;
+		}
+		if(watch_path(out_fname, watch_out_dir, de->d_name, strlen(extn), ".bmp") && stat(out_fname, &st) == 0)
+		{
+			continue;
+		}
+		watch_queue_secret(de->d_name, extn);
+	}
+	closedir(dp);
+	return e_success;
+}
+
+
+
+/* Stops event loop */
+static void watch_signal(int sig)
+{
+	(void)sig;
+	watch_stop = 1;
+}
+
+
+
+/* Watch dir and encode secret files till SIGINT/SIGTERM */
+Status do_watch(const char *dir, const char *carrier_fname)
+{
+	// watch jobs are batch jobs, so same options as batch can't be asked.
+	if(options.channels != 0 && options.channels != CHANNEL_ALL)
+	{
+		printf("ERROR: --channels can't be used with --watch.\n");
+		return e_failure;
+	}
+	if(options.ecc_parity != 0)
+	{
+		printf("ERROR: --ecc can't be used with --watch.\n");
+		return e_failure;
+	}
+	if(carrier_fname != NULL && (png_is_png(carrier_fname) || access(carrier_fname, R_OK) != 0))
+	{
+		printf("ERROR: %s is not a readable .bmp file.\n", carrier_fname);
+		return e_failure;
+	}
+
+	watch_dir = dir;
+	watch_carrier = carrier_fname;
+	if(snprintf(watch_out_dir, sizeof(watch_out_dir), "%s/%s", dir, WATCH_OUT_DIR) >= (int)sizeof(watch_out_dir))
+	{
+		printf("ERROR: Path of dir %s is too long.\n", dir);
+		return e_failure;
+	}
+	if(mkdir(watch_out_dir, 0777) != 0 && errno != EEXIST)
+	{
+		perror("mkdir");
+		printf("ERROR: Unable to make dir %s\n", watch_out_dir);
+		return e_failure;
+	}
+
+	// key is loaded once for all jobs.
+	if(batch_load_key() == e_failure)
+	{
+		return e_failure;
+	}
+
+	int ifd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(ifd == -1 || inotify_add_watch(ifd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR) == -1)
+	{
+		perror("inotify");
+		printf("ERROR: Unable to watch dir %s\n", dir);
+		if(ifd != -1)
+		{
+			close(ifd);
+		}
+		batch_clear_key();
+		return e_failure;
+	}
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = watch_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	// signals are blocked in workers, so they always interrupt poll() of this thread.
+	sigset_t stop_set, old_set;
+	sigemptyset(&stop_set);
+	sigaddset(&stop_set, SIGINT);
+	sigaddset(&stop_set, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stop_set, &old_set);
+
+	sem_init(&queue_items, 0, 0);
+	int nworkers = (options.threads > 0) ? options.threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if(nworkers < 1)
+	{
+		nworkers = 1;
+	}
+	pthread_t workers[nworkers];
+	int started = 0;
+	for(int i=0; i<nworkers; i++)
+	{
+		if(pthread_create(&workers[i], NULL, watch_worker, NULL) != 0)
+		{
+			break;
+		}
+		started++;
+	}
+	pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+
+	Status ret = e_success;
+	if(started == 0)
+	{
+		printf("ERROR: Unable to start watch workers.\n");
+		ret = e_failure;
+		watch_stop = 1;
+	}
+	else
+	{
+		print_info("INFO: Watching %s with %d workers, stego images are written to %s\n", dir, started, watch_out_dir);
+		ret = watch_scan();
+	}
+
+	// buffer is aligned for struct inotify_event.
+	char buf[WATCH_EVENT_BUF_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+	struct pollfd pfd = { ifd, POLLIN, 0 };
+
+	while(!watch_stop && ret == e_success)
+	{
+		if(poll(&pfd, 1, -1) < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			perror("poll");
+			ret = e_failure;
+			break;
+		}
+
+		ssize_t len;
+		while((len = read(ifd, buf, sizeof(buf))) > 0)
+		{
+			for(char *p = buf; p < buf + len; p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len)
+			{
+				struct inotify_event *ev = (struct inotify_event *)p;
+				// if => events were dropped, then dir is scanned again for secret files not yet encoded.
+				if(ev->mask & IN_Q_OVERFLOW)
+				{
+					watch_scan();
+				}
+				else if(ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+				{
+					printf("ERROR: Watched dir %s is removed or moved.\n", dir);
+					ret = e_failure;
+				}
+				else if(ev->len > 0 && !(ev->mask & IN_ISDIR))
+				{
+					watch_file(ev->name);
+				}
+			}
+		}
+		if(len < 0 && errno != EAGAIN && errno != EINTR)
+		{
+			perror("read");
+			ret = e_failure;
+		}
+	}
+
+	// workers finish queued jobs, then stop when queue is empty.
+	for(int i=0; i<started; i++)
+	{
+		sem_post(&queue_items);
+	}
+	for(int i=0; i<started; i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+	sem_destroy(&queue_items);
+	close(ifd);
+	batch_clear_key();
+
+	print_info("INFO: Watch stopped, %d jobs queued\n", watch_jobs);
+	return ret;
+}
@@ -0,0 +1,60 @@
+/*
+ *      Name            :       Ashith P Amin
+ *
+ *      Date            :       18/10/2026
+ *
+ *      Description     :       Watch-folder Encoding
+ *
+ *                              -> ./a.out --watch=<dir> [.bmp_carrier_file] encodes secret files dropped in dir as soon as they are
+ *                                 closed after writing (or moved into dir), instead of polling dir and running a.out per file.
+ *                              -> inotify reports IN_CLOSE_WRITE and IN_MOVED_TO of dir, so a file is picked up in the same
+ *                                 millisecond it is complete, and a half written file is never encoded.
+ *                              -> Naming rule : <name>.txt/.sh/.c is encoded in <name>.bmp of dir if it is there (pair), else in
+ *                                 carrier file given in args. A pair carrier dropped after its secret file encodes it again.
+ *                              -> Stego image is <dir>/encoded/<name>.bmp, it is written to hidden temp file in same dir and renamed
+ *                                 when complete, so readers of encoded dir never see a half written image.
+ *                              -> Main thread only reads events and queues jobs, jobs are run by pool of worker threads (--threads=<n>)
+ *                                 with same block engine as batch (24 bpp carriers, --encrypt, --verify, --direct).
+ *                              -> Secret files already in dir without stego image are encoded at start (and after event queue overflow).
+ *                              -> Files starting with '.' are skipped. Runs till SIGINT/SIGTERM, queued jobs are finished before exit.
+ */
+
+
+
+
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "types.h" // Contains user defined types
+#include "batch.h"
+
+/* Subdir of watched dir for stego images (not watched itself) */
+#define WATCH_OUT_DIR "encoded"
+
+/* Maximum path size (same as batch output file name) */
+#define WATCH_PATH_SIZE 256
+
+/* Size of inotify event buffer */
+#define WATCH_EVENT_BUF_SIZE 4096
+
+/*
+ * One queued encoding, batch job args point to its paths
+ */
+
+typedef struct _WatchJob
+{
+    BatchJob job;				// => batch encode job
+    char secret_fname[WATCH_PATH_SIZE];		// => Stores the secret file path
+    char carrier_fname[WATCH_PATH_SIZE];	// => Stores the carrier image path
+    char temp_fname[WATCH_PATH_SIZE];		// => Stores the temp stego image path (job output, renamed when done)
+    struct _WatchJob *next;			// => next job in queue
+
+} WatchJob;
+
+
+/* Watch function prototypes */
+
+/* Watch dir and encode secret files till SIGINT/SIGTERM */
+Status do_watch(const char *dir, const char *carrier_fname);
+
+#endif